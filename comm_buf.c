@@ -0,0 +1,159 @@
+/**
+ * @file comm_buf.c
+ * @brief Reference-counted frame buffers implementation
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#include "comm_buf.h"
+#include <stdlib.h>
+#include <string.h>
+
+static comm_buf_pool_t comm_buf_default;
+static bool comm_buf_default_ready = false;
+
+comm_result_t comm_buf_pool_init(comm_buf_pool_t *pool)
+{
+    uint8_t i = 0U;
+
+    if (pool == NULL)
+    {
+        return COMM_ERROR;
+    }
+    memset(pool, 0, sizeof(comm_buf_pool_t));
+    pool->mutex = osMutexNew(NULL);
+    if (pool->mutex == NULL)
+    {
+        return COMM_ERROR;
+    }
+    for (i = 0U; i < COMM_BUF_POOL_SIZE; i++)
+    {
+        pool->bufs[i].pool = pool;
+        pool->bufs[i].next = pool->free_list;
+        pool->free_list = &pool->bufs[i];
+    }
+    pool->free_count = COMM_BUF_POOL_SIZE;
+    pool->total = COMM_BUF_POOL_SIZE;
+    return COMM_OK;
+}
+
+comm_result_t comm_buf_pool_grow(comm_buf_pool_t *pool, uint32_t count)
+{
+    comm_buf_t *slab = NULL;
+    uint32_t i = 0U;
+
+    if (pool == NULL || count == 0U)
+    {
+        return COMM_ERROR;
+    }
+    /* 一次分配，之后随池子一直存在 */
+    slab = (comm_buf_t *)calloc(count, sizeof(comm_buf_t));
+    if (slab == NULL)
+    {
+        return COMM_ERROR;
+    }
+    if (osMutexAcquire(pool->mutex, osWaitForever) != osOK)
+    {
+        free(slab);
+        return COMM_ERROR;
+    }
+    for (i = 0U; i < count; i++)
+    {
+        slab[i].pool = pool;
+        slab[i].next = pool->free_list;
+        pool->free_list = &slab[i];
+    }
+    pool->free_count += count;
+    pool->total += count;
+    (void)osMutexRelease(pool->mutex);
+    return COMM_OK;
+}
+
+comm_buf_pool_t *comm_buf_default_pool(void)
+{
+    if (!comm_buf_default_ready)
+    {
+        if (comm_buf_pool_init(&comm_buf_default) != COMM_OK)
+        {
+            return NULL;
+        }
+        comm_buf_default_ready = true;
+    }
+    return &comm_buf_default;
+}
+
+comm_buf_t *comm_buf_alloc(comm_buf_pool_t *pool)
+{
+    comm_buf_t *buf = NULL;
+
+    if (pool == NULL || osMutexAcquire(pool->mutex, osWaitForever) != osOK)
+    {
+        return NULL;
+    }
+    if (pool->free_list != NULL)
+    {
+        buf = pool->free_list;
+        pool->free_list = buf->next;
+        pool->free_count--;
+        buf->next = NULL;
+        buf->refcnt = 1U;
+        buf->len = 0U;
+    }
+    else
+    {
+        pool->alloc_fail++;
+    }
+    (void)osMutexRelease(pool->mutex);
+    return buf;
+}
+
+comm_buf_t *comm_buf_ref(comm_buf_t *buf)
+{
+    if (buf == NULL || osMutexAcquire(buf->pool->mutex, osWaitForever) != osOK)
+    {
+        return NULL;
+    }
+    buf->refcnt++;
+    (void)osMutexRelease(buf->pool->mutex);
+    return buf;
+}
+
+void comm_buf_release(comm_buf_t *buf)
+{
+    comm_buf_pool_t *pool = NULL;
+
+    if (buf == NULL)
+    {
+        return;
+    }
+    pool = buf->pool;
+    if (osMutexAcquire(pool->mutex, osWaitForever) != osOK)
+    {
+        return;
+    }
+    if (buf->refcnt > 0U)
+    {
+        buf->refcnt--;
+        if (buf->refcnt == 0U)
+        {
+            buf->next = pool->free_list;
+            pool->free_list = buf;
+            pool->free_count++;
+        }
+    }
+    (void)osMutexRelease(pool->mutex);
+}
+
+uint32_t comm_buf_pool_free_count(comm_buf_pool_t *pool)
+{
+    uint32_t count = 0U;
+
+    if (pool != NULL && osMutexAcquire(pool->mutex, osWaitForever) == osOK)
+    {
+        count = pool->free_count;
+        (void)osMutexRelease(pool->mutex);
+    }
+    return count;
+}
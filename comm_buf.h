@@ -0,0 +1,115 @@
+/**
+ * @file comm_buf.h
+ * @brief Reference-counted frame buffers for the TX path
+ *
+ * A frame is encoded once into a pool buffer and the buffer itself travels
+ * to the transport: the controller keeps one reference for resends, every
+ * hand-off to the transport adds one, and the transport drops its reference
+ * after the bytes are on the wire. The buffer goes back to the pool when
+ * the last reference is released, so a resend puts the very same memory
+ * on the wire again instead of re-encoding it.
+ *
+ * Reference counts and the free list are guarded by the pool mutex, so
+ * references may be taken and released from any thread.
+ *
+ * A controller keeps its last frame for resends until the next command,
+ * so the pool grows with the links using it: every controller that gets
+ * a buffer send function adds COMM_BUF_LINK_SLICE buffers with
+ * comm_buf_pool_grow(). The base buffers are headroom shared by
+ * everyone, e.g. for bulk transfer windows.
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#ifndef COMM_BUF_H
+#define COMM_BUF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cmsis_os2.h"
+#include "comm_def.h"
+
+#ifndef COMM_BUF_POOL_SIZE
+#define COMM_BUF_POOL_SIZE      16U     /* base frames shared by all controllers */
+#endif
+#ifndef COMM_BUF_LINK_SLICE
+#define COMM_BUF_LINK_SLICE     2U      /* added per controller: its kept frame and one in flight */
+#endif
+#define COMM_BUF_DATA_LEN       COMM_PROTOCOL_MAX_BUFF_LEN
+
+struct comm_buf_pool;
+
+/**
+ * @brief One encoded frame
+ */
+typedef struct comm_buf {
+    struct comm_buf_pool *pool; /**< pool the buffer returns to */
+    struct comm_buf *next;      /**< next free buffer while on the free list */
+    uint8_t refcnt;             /**< 0 while the buffer is free */
+    uint16_t len;               /**< encoded bytes in data */
+    uint8_t data[COMM_BUF_DATA_LEN];
+} comm_buf_t;
+
+/**
+ * @brief Pool of frame buffers: a fixed base plus slices added per link
+ */
+typedef struct comm_buf_pool {
+    comm_buf_t bufs[COMM_BUF_POOL_SIZE];
+    comm_buf_t *free_list;                  /**< stack of free buffers */
+    uint32_t free_count;
+    uint32_t total;                         /**< base plus grown buffers */
+    uint32_t alloc_fail;                    /**< allocations that found the pool empty */
+    osMutexId_t mutex;
+} comm_buf_pool_t;
+
+/**
+ * @brief Initialize a pool, every buffer starts free
+ * @return COMM_OK, or COMM_ERROR if the mutex cannot be created
+ */
+comm_result_t comm_buf_pool_init(comm_buf_pool_t *pool);
+
+/**
+ * @brief Add @p count buffers to a pool
+ *
+ * The buffers are allocated once and stay with the pool; call it when a
+ * new user of the pool is set up, not per frame.
+ *
+ * @return COMM_OK, or COMM_ERROR if the memory cannot be allocated
+ */
+comm_result_t comm_buf_pool_grow(comm_buf_pool_t *pool, uint32_t count);
+
+/**
+ * @brief Process-wide TX pool, created on first use
+ *
+ * Like comm_timer_default_wheel(), the first call must not race with
+ * another first call; comm_ctrl_init() and comm_mgr_init() make it.
+ *
+ * @return Pool, or NULL if it could not be created
+ */
+comm_buf_pool_t *comm_buf_default_pool(void);
+
+/**
+ * @brief Take a free buffer
+ * @return Buffer holding one reference with len 0, or NULL if the pool is empty
+ */
+comm_buf_t *comm_buf_alloc(comm_buf_pool_t *pool);
+
+/**
+ * @brief Add a reference
+ * @return @p buf, for passing it on in one expression
+ */
+comm_buf_t *comm_buf_ref(comm_buf_t *buf);
+
+/**
+ * @brief Drop a reference, the buffer is freed with the last one
+ */
+void comm_buf_release(comm_buf_t *buf);
+
+/**
+ * @brief Free buffers left in a pool
+ */
+uint32_t comm_buf_pool_free_count(comm_buf_pool_t *pool);
+
+#endif // COMM_BUF_H
@@ -0,0 +1,288 @@
+/**
+ * @file comm_bulk.c
+ * @brief Windowed, resumable bulk transfer implementation
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#include "comm_bulk.h"
+#include "comm_table.h"
+#include <string.h>
+
+static comm_bulk_slot_t *comm_bulk_slot(comm_bulk_t *bulk, uint32_t chunk)
+{
+    return &bulk->slots[chunk % COMM_BULK_WINDOW_MAX];
+}
+
+static uint32_t comm_bulk_chunk_bytes(const comm_bulk_t *bulk, uint32_t chunk)
+{
+    uint32_t offset = chunk * bulk->cfg.chunk_size;
+    uint32_t left = bulk->size - offset;
+
+    return (left < bulk->cfg.chunk_size) ? left : bulk->cfg.chunk_size;
+}
+
+static uint32_t comm_bulk_bytes_before(const comm_bulk_t *bulk, uint32_t chunk)
+{
+    return (chunk >= bulk->chunk_num) ? bulk->size : chunk * bulk->cfg.chunk_size;
+}
+
+/* 发送失败按一次未应答的发送处理：下一次 comm_bulk_poll() 重发并计入重试 */
+static bool comm_bulk_send_chunk(comm_bulk_t *bulk, uint32_t chunk, uint32_t now)
+{
+    comm_result_t ret = COMM_ERROR;
+    uint8_t frame[COMM_BULK_CHUNK_MAX + 2U];
+    uint32_t len = comm_bulk_chunk_bytes(bulk, chunk);
+    comm_bulk_slot_t *slot = comm_bulk_slot(bulk, chunk);
+
+    frame[0] = (uint8_t)(chunk >> 8U);
+    frame[1] = (uint8_t)chunk;
+    memcpy(&frame[2], &bulk->image[chunk * bulk->cfg.chunk_size], len);
+    ret = comm_ctrl_send_frame(bulk->ctrl, COMM_BULK_CMD_ID, frame, (uint8_t)(len + 2U));
+    slot->sent_tick = (ret == COMM_OK) ? now : (now - bulk->timeout_ms);
+    slot->in_flight = true;
+    return ret == COMM_OK;
+}
+
+/* 更新进度快照并通知应用，回调在锁外执行 */
+static void comm_bulk_report(comm_bulk_t *bulk, comm_bulk_state_t state, uint32_t now)
+{
+    comm_bulk_progress_t snapshot;
+    uint32_t elapsed = now - bulk->start_tick;
+    uint32_t acked = comm_bulk_bytes_before(bulk, bulk->base);
+
+    if (elapsed == 0U)
+    {
+        elapsed = 1U;
+    }
+    if (osMutexAcquire(bulk->ctrl->mutex, osWaitForever) != osOK)
+    {
+        return;
+    }
+    bulk->progress.state = state;
+    bulk->progress.total_bytes = bulk->size;
+    bulk->progress.acked_bytes = acked;
+    bulk->progress.checkpoint = bulk->base;
+    bulk->progress.bytes_per_sec = (uint32_t)(((uint64_t)(acked - bulk->start_bytes) * 1000U) / elapsed);
+    snapshot = bulk->progress;
+    (void)osMutexRelease(bulk->ctrl->mutex);
+
+    if (bulk->cfg.progress_cb != NULL)
+    {
+        bulk->cfg.progress_cb(bulk->cfg.cb_ctx, &snapshot);
+    }
+}
+
+static comm_result_t comm_bulk_post(comm_bulk_t *bulk, uint32_t msg_id, uint32_t arg)
+{
+    message_t msg;
+
+    msg.msg_id = msg_id;
+    msg.msg_data = (uint8_t *)bulk;
+    msg.msg_len = arg;
+    return comm_ctrl_post(bulk->ctrl, &msg);
+}
+
+comm_result_t comm_bulk_init(comm_bulk_t *bulk, const comm_bulk_config_t *cfg)
+{
+    if (bulk == NULL)
+    {
+        return COMM_ERROR;
+    }
+    memset(bulk, 0, sizeof(comm_bulk_t));
+    if (cfg != NULL)
+    {
+        bulk->cfg = *cfg;
+    }
+    if (bulk->cfg.window == 0U)
+    {
+        bulk->cfg.window = COMM_BULK_DEFAULT_WINDOW;
+    }
+    if (bulk->cfg.chunk_size == 0U)
+    {
+        bulk->cfg.chunk_size = COMM_BULK_CHUNK_MAX;
+    }
+    if (bulk->cfg.window > COMM_BULK_WINDOW_MAX || bulk->cfg.chunk_size > COMM_BULK_CHUNK_MAX)
+    {
+        return COMM_ERROR;
+    }
+    bulk->progress.state = COMM_BULK_STATE_IDLE;
+    return COMM_OK;
+}
+
+comm_result_t comm_bulk_start(comm_bulk_t *bulk, comm_ctrl_t *comm_ctrl, const uint8_t *image, uint32_t size)
+{
+    const comm_cmd_table_t *entry = NULL;
+
+    if (bulk == NULL || comm_ctrl == NULL || image == NULL || size == 0U ||
+        bulk->progress.state == COMM_BULK_STATE_RUNNING)
+    {
+        return COMM_ERROR;
+    }
+    /* 应答 ID 与缺省的超时、重发次数取自该控制器的命令表 */
+    entry = comm_table_lookup_send(comm_ctrl->table, COMM_BULK_CMD_ID);
+    if (entry == NULL)
+    {
+        return COMM_ERROR;
+    }
+    bulk->resp_id = entry->resp_cmd_id;
+    bulk->timeout_ms = (bulk->cfg.timeout_ms != 0U) ? bulk->cfg.timeout_ms : entry->timeout;
+    bulk->retry = (bulk->cfg.retry != 0U) ? bulk->cfg.retry : entry->retry_count;
+    bulk->ctrl = comm_ctrl;
+    bulk->image = image;
+    bulk->size = size;
+    bulk->chunk_num = (size + bulk->cfg.chunk_size - 1U) / bulk->cfg.chunk_size;
+    bulk->progress.retransmits = 0U;
+    return comm_bulk_post(bulk, MESSAGE_ID_COMM_BULK_START, 0U);
+}
+
+comm_result_t comm_bulk_resume(comm_bulk_t *bulk, uint32_t checkpoint)
+{
+    if (bulk == NULL || bulk->ctrl == NULL || checkpoint >= bulk->chunk_num)
+    {
+        return COMM_ERROR;
+    }
+    return comm_bulk_post(bulk, MESSAGE_ID_COMM_BULK_START, checkpoint);
+}
+
+comm_result_t comm_bulk_stop(comm_bulk_t *bulk)
+{
+    if (bulk == NULL || bulk->ctrl == NULL)
+    {
+        return COMM_ERROR;
+    }
+    return comm_bulk_post(bulk, MESSAGE_ID_COMM_BULK_STOP, 0U);
+}
+
+comm_result_t comm_bulk_get_progress(comm_bulk_t *bulk, comm_bulk_progress_t *progress)
+{
+    if (bulk == NULL || progress == NULL)
+    {
+        return COMM_ERROR;
+    }
+    if (bulk->ctrl == NULL)
+    {
+        *progress = bulk->progress;
+        return COMM_OK;
+    }
+    if (osMutexAcquire(bulk->ctrl->mutex, osWaitForever) != osOK)
+    {
+        return COMM_ERROR;
+    }
+    *progress = bulk->progress;
+    (void)osMutexRelease(bulk->ctrl->mutex);
+    return COMM_OK;
+}
+
+void comm_bulk_on_start(comm_bulk_t *bulk, uint32_t checkpoint, uint32_t now)
+{
+    if (bulk == NULL || checkpoint >= bulk->chunk_num)
+    {
+        return;
+    }
+    memset(bulk->slots, 0, sizeof(bulk->slots));
+    bulk->base = checkpoint;
+    bulk->next = checkpoint;
+    bulk->start_tick = now;
+    bulk->start_bytes = comm_bulk_bytes_before(bulk, checkpoint);
+    comm_bulk_report(bulk, COMM_BULK_STATE_RUNNING, now);
+    comm_bulk_poll(bulk, now);
+}
+
+void comm_bulk_on_stop(comm_bulk_t *bulk)
+{
+    if (bulk == NULL || bulk->progress.state != COMM_BULK_STATE_RUNNING)
+    {
+        return;
+    }
+    comm_bulk_report(bulk, COMM_BULK_STATE_PAUSED, osKernelGetTickCount());
+}
+
+bool comm_bulk_on_recv(comm_bulk_t *bulk, const comm_data_t *data, uint32_t now)
+{
+    uint16_t offset = 0U;
+    uint32_t chunk = 0U;
+    comm_bulk_slot_t *slot = NULL;
+
+    if (bulk == NULL || data == NULL || bulk->progress.state != COMM_BULK_STATE_RUNNING)
+    {
+        return false;
+    }
+    if (data->comm_id != bulk->resp_id)
+    {
+        return false;
+    }
+    if (data->comm_len < 3U)
+    {
+        return true;
+    }
+    /* 16 位序号映射回窗口内的分块号，窗口外的是过期应答 */
+    offset = (uint16_t)((((uint16_t)data->comm_data[0] << 8U) | data->comm_data[1]) - (uint16_t)bulk->base);
+    if (offset >= (bulk->next - bulk->base))
+    {
+        return true;
+    }
+    chunk = bulk->base + offset;
+    slot = comm_bulk_slot(bulk, chunk);
+    if (!slot->in_flight || slot->acked)
+    {
+        return true;
+    }
+    if (data->comm_data[2] != COMM_BULK_STATUS_OK)
+    {
+        /* rejected: resent by the next comm_bulk_poll(), counts as a retry */
+        slot->sent_tick = now - bulk->timeout_ms;
+        return true;
+    }
+    slot->acked = true;
+    if (chunk == bulk->base)
+    {
+        while (bulk->base < bulk->next && comm_bulk_slot(bulk, bulk->base)->acked)
+        {
+            memset(comm_bulk_slot(bulk, bulk->base), 0, sizeof(comm_bulk_slot_t));
+            bulk->base++;
+        }
+        comm_bulk_report(bulk, (bulk->base == bulk->chunk_num) ? COMM_BULK_STATE_DONE : COMM_BULK_STATE_RUNNING, now);
+    }
+    return true;
+}
+
+void comm_bulk_poll(comm_bulk_t *bulk, uint32_t now)
+{
+    uint32_t chunk = 0U;
+
+    if (bulk == NULL || bulk->progress.state != COMM_BULK_STATE_RUNNING)
+    {
+        return;
+    }
+    /* 只重发超时的分块 */
+    for (chunk = bulk->base; chunk < bulk->next; chunk++)
+    {
+        comm_bulk_slot_t *slot = comm_bulk_slot(bulk, chunk);
+        if (!slot->in_flight || slot->acked || (now - slot->sent_tick) < bulk->timeout_ms)
+        {
+            continue;
+        }
+        if (slot->retries >= bulk->retry)
+        {
+            comm_bulk_report(bulk, COMM_BULK_STATE_FAILED, now);
+            return;
+        }
+        slot->retries++;
+        bulk->progress.retransmits++;
+        if (!comm_bulk_send_chunk(bulk, chunk, now))
+        {
+            return;     /* 链路发不出去，本轮不再发送 */
+        }
+    }
+    while (bulk->next < bulk->chunk_num && (bulk->next - bulk->base) < bulk->cfg.window)
+    {
+        bulk->next++;
+        if (!comm_bulk_send_chunk(bulk, bulk->next - 1U, now))
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,168 @@
+/**
+ * @file comm_bulk.h
+ * @brief Windowed, resumable bulk transfer on top of comm_ctrl
+ *
+ * Splits an image into chunks and sends them with COMM_PROG_UPDATE while
+ * keeping up to a configurable window of chunks in flight. Each chunk is
+ * acknowledged individually; only timed out or rejected chunks are sent
+ * again (selective repeat). The checkpoint is the first chunk not yet
+ * acknowledged: every chunk before it has reached the slave, so a transfer
+ * interrupted by a reconnect resumes from there with comm_bulk_resume().
+ *
+ * Chunk frames bypass the controller FSM and share the link with the
+ * normal command traffic:
+ *   request  : [COMM_PROG_UPDATE_REQ][seq_hi][seq_lo][data ...]
+ *   response : [COMM_PROG_UPDATE_RESP][seq_hi][seq_lo][status]
+ * seq is the chunk index modulo 65536, status 0 means accepted.
+ *
+ * The engine runs on the controller thread. Its timers are checked every
+ * time the controller handles a message, so retransmission granularity is
+ * the controller period.
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#ifndef COMM_BULK_H
+#define COMM_BULK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "comm_ctrl.h"
+
+#define COMM_BULK_CMD_ID            0x08U   /* COMM_PROG_UPDATE_REQ */
+#define COMM_BULK_WINDOW_MAX        16U
+/* one frame carries at most 31 bytes: id, 2 bytes seq, data */
+#define COMM_BULK_CHUNK_MAX         ((COMM_PROTOCOL_MAX_VALID_DATA_LEN / 2U) - 3U)
+/* keep one receive buffer for the response of the regular command */
+#define COMM_BULK_DEFAULT_WINDOW    (COMM_RECV_DATA_QUEUE_SIZE - 1U)
+#define COMM_BULK_STATUS_OK         0x00U
+
+typedef enum{
+    COMM_BULK_STATE_IDLE = 0U,
+    COMM_BULK_STATE_RUNNING,
+    COMM_BULK_STATE_PAUSED,     /* stopped by the application, resumable */
+    COMM_BULK_STATE_DONE,
+    COMM_BULK_STATE_FAILED,     /* a chunk ran out of retries, resumable */
+}comm_bulk_state_t;
+
+/**
+ * @brief Progress snapshot
+ */
+typedef struct {
+    comm_bulk_state_t state;
+    uint32_t total_bytes;       /**< image size */
+    uint32_t acked_bytes;       /**< bytes before the checkpoint */
+    uint32_t checkpoint;        /**< first chunk not yet acknowledged */
+    uint32_t bytes_per_sec;     /**< throughput since the last (re)start */
+    uint32_t retransmits;       /**< chunks sent more than once */
+} comm_bulk_progress_t;
+
+typedef void (*comm_bulk_progress_cb_t)(void *ctx, const comm_bulk_progress_t *progress);
+
+/**
+ * @brief Transfer parameters, zero fields take the defaults
+ */
+typedef struct {
+    uint8_t window;                     /**< chunks in flight, 1..COMM_BULK_WINDOW_MAX */
+    uint8_t chunk_size;                 /**< data bytes per chunk, 1..COMM_BULK_CHUNK_MAX */
+    uint16_t timeout_ms;                /**< ack timeout, 0 = value in the controller's comm_table */
+    uint16_t retry;                     /**< resends per chunk, 0 = value in the controller's comm_table */
+    comm_bulk_progress_cb_t progress_cb;/**< called on the controller thread, may be NULL */
+    void *cb_ctx;
+} comm_bulk_config_t;
+
+/* one in-flight chunk, indexed by chunk % COMM_BULK_WINDOW_MAX */
+typedef struct {
+    uint32_t sent_tick;
+    uint16_t retries;
+    bool in_flight;
+    bool acked;
+} comm_bulk_slot_t;
+
+/**
+ * @brief Transfer context
+ */
+typedef struct comm_bulk {
+    comm_ctrl_t *ctrl;
+    comm_bulk_config_t cfg;
+    uint8_t resp_id;                    /**< ack id, from the controller's table at start */
+    uint16_t timeout_ms;                /**< cfg value or the table's, set at start */
+    uint16_t retry;                     /**< cfg value or the table's, set at start */
+    const uint8_t *image;
+    uint32_t size;
+    uint32_t chunk_num;
+    uint32_t base;                      /**< first unacknowledged chunk (checkpoint) */
+    uint32_t next;                      /**< first chunk never sent */
+    comm_bulk_slot_t slots[COMM_BULK_WINDOW_MAX];
+    comm_bulk_progress_t progress;      /**< guarded by ctrl->mutex */
+    uint32_t start_tick;
+    uint32_t start_bytes;
+} comm_bulk_t;
+
+/**
+ * @brief Initialize a transfer context
+ * @param bulk Context
+ * @param cfg Parameters, NULL for the defaults
+ * @return COMM_OK, or COMM_ERROR on invalid parameters
+ */
+comm_result_t comm_bulk_init(comm_bulk_t *bulk, const comm_bulk_config_t *cfg);
+
+/**
+ * @brief Start sending @p image over @p comm_ctrl from the first chunk
+ *
+ * The image must stay valid until the transfer is done, failed or stopped.
+ * Only one transfer can be attached to a controller at a time. The ack id
+ * and the default timeout and retries come from the controller's table.
+ *
+ * @return COMM_OK if the start request was posted to the controller,
+ *         COMM_ERROR also if that table has no COMM_BULK_CMD_ID entry
+ */
+comm_result_t comm_bulk_start(comm_bulk_t *bulk, comm_ctrl_t *comm_ctrl, const uint8_t *image, uint32_t size);
+
+/**
+ * @brief Restart a stopped, failed or interrupted transfer from a checkpoint
+ *
+ * @param bulk Context previously started with comm_bulk_start()
+ * @param checkpoint First chunk to send, usually progress.checkpoint
+ * @return COMM_OK if the resume request was posted to the controller
+ */
+comm_result_t comm_bulk_resume(comm_bulk_t *bulk, uint32_t checkpoint);
+
+/**
+ * @brief Detach the transfer from its controller, keeping the checkpoint
+ */
+comm_result_t comm_bulk_stop(comm_bulk_t *bulk);
+
+/**
+ * @brief Copy the current progress
+ */
+comm_result_t comm_bulk_get_progress(comm_bulk_t *bulk, comm_bulk_progress_t *progress);
+
+/**
+ * @brief Controller hook: (re)start sending from @p checkpoint
+ */
+void comm_bulk_on_start(comm_bulk_t *bulk, uint32_t checkpoint, uint32_t now);
+
+/**
+ * @brief Controller hook: pause the transfer, in-flight chunks are forgotten
+ */
+void comm_bulk_on_stop(comm_bulk_t *bulk);
+
+/**
+ * @brief Controller hook: consume a chunk acknowledgement
+ *
+ * Does not send; the window is refilled by the comm_bulk_poll() that
+ * follows every controller message, once the receive buffer is released.
+ *
+ * @return true if @p data belonged to this transfer
+ */
+bool comm_bulk_on_recv(comm_bulk_t *bulk, const comm_data_t *data, uint32_t now);
+
+/**
+ * @brief Controller hook: resend timed out chunks and fill the window
+ */
+void comm_bulk_poll(comm_bulk_t *bulk, uint32_t now);
+
+#endif // COMM_BULK_H
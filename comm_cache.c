@@ -0,0 +1,182 @@
+/**
+ * @file comm_cache.c
+ * @brief Response cache implementation
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#include "comm_cache.h"
+#include <string.h>
+
+static bool comm_cache_entry_alive(const comm_cache_entry_t *entry, uint32_t now)
+{
+    return entry->valid && ((int32_t)(entry->expire - now) > 0);
+}
+
+static bool comm_cache_entry_match(const comm_cache_entry_t *entry, uint8_t cmd_id,
+                                   const uint8_t *req_data, uint8_t req_len)
+{
+    return entry->valid && (entry->cmd_id == cmd_id) && (entry->req_len == req_len) &&
+           ((req_len == 0U) || (memcmp(entry->req_data, req_data, req_len) == 0));
+}
+
+comm_result_t comm_cache_init(comm_cache_t *cache)
+{
+    if (cache == NULL)
+    {
+        return COMM_ERROR;
+    }
+    memset(cache, 0, sizeof(comm_cache_t));
+    cache->mutex = osMutexNew(NULL);
+    if (cache->mutex == NULL)
+    {
+        return COMM_ERROR;
+    }
+    return COMM_OK;
+}
+
+bool comm_cache_lookup(comm_cache_t *cache, uint8_t cmd_id, const uint8_t *req_data, uint8_t req_len,
+                       uint8_t *resp_id, uint8_t *resp_data, uint8_t *resp_len)
+{
+    bool hit = false;
+    uint32_t now = 0U;
+    uint8_t i = 0U;
+
+    if (cache == NULL || (req_data == NULL && req_len != 0U) || resp_id == NULL ||
+        resp_data == NULL || resp_len == NULL)
+    {
+        return false;
+    }
+    if (osMutexAcquire(cache->mutex, osWaitForever) != osOK)
+    {
+        return false;
+    }
+    now = osKernelGetTickCount();
+    for (i = 0U; i < COMM_CACHE_ENTRY_NUM; i++)
+    {
+        comm_cache_entry_t *entry = &cache->entries[i];
+        if (comm_cache_entry_match(entry, cmd_id, req_data, req_len))
+        {
+            if (comm_cache_entry_alive(entry, now))
+            {
+                *resp_id = entry->resp_id;
+                *resp_len = entry->resp_len;
+                memcpy(resp_data, entry->resp_data, entry->resp_len);
+                hit = true;
+            }
+            else
+            {
+                entry->valid = false;
+            }
+            break;
+        }
+    }
+    if (hit)
+    {
+        cache->hits++;
+    }
+    else
+    {
+        cache->misses++;
+    }
+    (void)osMutexRelease(cache->mutex);
+    return hit;
+}
+
+comm_result_t comm_cache_store(comm_cache_t *cache, uint8_t cmd_id, const uint8_t *req_data, uint8_t req_len,
+                               uint8_t resp_id, const uint8_t *resp_data, uint8_t resp_len, uint32_t ttl_ms)
+{
+    comm_cache_entry_t *slot = NULL;
+    uint32_t now = 0U;
+    uint8_t i = 0U;
+
+    if (cache == NULL || ttl_ms == 0U || req_len > COMM_DATA_MAX_LEN || resp_len > COMM_DATA_MAX_LEN ||
+        (req_data == NULL && req_len != 0U) || (resp_data == NULL && resp_len != 0U))
+    {
+        return COMM_ERROR;
+    }
+    if (osMutexAcquire(cache->mutex, osWaitForever) != osOK)
+    {
+        return COMM_ERROR;
+    }
+    now = osKernelGetTickCount();
+    /* 同一请求优先覆盖，其次空闲或过期条目，最后淘汰最早到期的条目 */
+    for (i = 0U; i < COMM_CACHE_ENTRY_NUM; i++)
+    {
+        if (comm_cache_entry_match(&cache->entries[i], cmd_id, req_data, req_len))
+        {
+            slot = &cache->entries[i];
+            break;
+        }
+    }
+    for (i = 0U; (slot == NULL) && (i < COMM_CACHE_ENTRY_NUM); i++)
+    {
+        if (!comm_cache_entry_alive(&cache->entries[i], now))
+        {
+            slot = &cache->entries[i];
+        }
+    }
+    if (slot == NULL)
+    {
+        slot = &cache->entries[0];
+        for (i = 1U; i < COMM_CACHE_ENTRY_NUM; i++)
+        {
+            if ((int32_t)(cache->entries[i].expire - slot->expire) < 0)
+            {
+                slot = &cache->entries[i];
+            }
+        }
+    }
+
+    slot->valid = true;
+    slot->cmd_id = cmd_id;
+    slot->req_len = req_len;
+    if (req_len != 0U)
+    {
+        memcpy(slot->req_data, req_data, req_len);
+    }
+    slot->resp_id = resp_id;
+    slot->resp_len = resp_len;
+    if (resp_len != 0U)
+    {
+        memcpy(slot->resp_data, resp_data, resp_len);
+    }
+    slot->expire = now + ttl_ms;
+    (void)osMutexRelease(cache->mutex);
+    return COMM_OK;
+}
+
+void comm_cache_invalidate(comm_cache_t *cache, uint8_t cmd_id)
+{
+    uint8_t i = 0U;
+
+    if (cache == NULL || osMutexAcquire(cache->mutex, osWaitForever) != osOK)
+    {
+        return;
+    }
+    for (i = 0U; i < COMM_CACHE_ENTRY_NUM; i++)
+    {
+        if (cache->entries[i].cmd_id == cmd_id)
+        {
+            cache->entries[i].valid = false;
+        }
+    }
+    (void)osMutexRelease(cache->mutex);
+}
+
+void comm_cache_invalidate_all(comm_cache_t *cache)
+{
+    uint8_t i = 0U;
+
+    if (cache == NULL || osMutexAcquire(cache->mutex, osWaitForever) != osOK)
+    {
+        return;
+    }
+    for (i = 0U; i < COMM_CACHE_ENTRY_NUM; i++)
+    {
+        cache->entries[i].valid = false;
+    }
+    (void)osMutexRelease(cache->mutex);
+}
@@ -0,0 +1,104 @@
+/**
+ * @file comm_cache.h
+ * @brief Response cache for read-only queries
+ *
+ * Small fixed-size cache of responses keyed by command id and request
+ * payload. Entries expire after the TTL configured per command in
+ * comm_table (see comm_table_get_cache_ttl_by_send()) and can be dropped
+ * explicitly. A controller with a cache attached answers cacheable single
+ * commands from the cache without touching the link.
+ *
+ * The cache is protected by its own mutex: lookups run on the application
+ * thread, stores on the controller thread.
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#ifndef COMM_CACHE_H
+#define COMM_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cmsis_os2.h"
+#include "comm_def.h"
+
+#define COMM_CACHE_ENTRY_NUM    8U
+
+/**
+ * @brief One cached request/response pair
+ */
+typedef struct {
+    bool valid;                             /**< entry holds a response */
+    uint8_t cmd_id;                         /**< send command id */
+    uint8_t req_len;                        /**< request payload length */
+    uint8_t req_data[COMM_DATA_MAX_LEN];    /**< request payload (key) */
+    uint8_t resp_id;                        /**< response command id */
+    uint8_t resp_len;                       /**< response payload length */
+    uint8_t resp_data[COMM_DATA_MAX_LEN];   /**< response payload */
+    uint32_t expire;                        /**< kernel tick after which the entry is stale */
+} comm_cache_entry_t;
+
+/**
+ * @brief Cache context
+ */
+typedef struct {
+    comm_cache_entry_t entries[COMM_CACHE_ENTRY_NUM];
+    osMutexId_t mutex;
+    uint32_t hits;                          /**< lookups answered from the cache */
+    uint32_t misses;                        /**< lookups that had to go to the link */
+} comm_cache_t;
+
+/**
+ * @brief Initialize an empty cache
+ * @param cache Cache to initialize
+ * @return COMM_OK on success, COMM_ERROR if the mutex cannot be created
+ */
+comm_result_t comm_cache_init(comm_cache_t *cache);
+
+/**
+ * @brief Look up a response for a request
+ *
+ * @param cache Cache
+ * @param cmd_id Send command id
+ * @param req_data Request payload
+ * @param req_len Request payload length
+ * @param resp_id Output response command id
+ * @param resp_data Output buffer of at least COMM_DATA_MAX_LEN bytes
+ * @param resp_len Output response payload length
+ * @return true on a fresh hit, false on miss or expired entry
+ */
+bool comm_cache_lookup(comm_cache_t *cache, uint8_t cmd_id, const uint8_t *req_data, uint8_t req_len,
+                       uint8_t *resp_id, uint8_t *resp_data, uint8_t *resp_len);
+
+/**
+ * @brief Store a response for a request
+ *
+ * Replaces an entry with the same key, otherwise a free or expired entry,
+ * otherwise the entry closest to expiry.
+ *
+ * @param cache Cache
+ * @param cmd_id Send command id
+ * @param req_data Request payload
+ * @param req_len Request payload length
+ * @param resp_id Response command id
+ * @param resp_data Response payload
+ * @param resp_len Response payload length
+ * @param ttl_ms Lifetime of the entry in milliseconds (0 stores nothing)
+ * @return COMM_OK if stored, COMM_ERROR otherwise
+ */
+comm_result_t comm_cache_store(comm_cache_t *cache, uint8_t cmd_id, const uint8_t *req_data, uint8_t req_len,
+                               uint8_t resp_id, const uint8_t *resp_data, uint8_t resp_len, uint32_t ttl_ms);
+
+/**
+ * @brief Drop every entry of one command id
+ */
+void comm_cache_invalidate(comm_cache_t *cache, uint8_t cmd_id);
+
+/**
+ * @brief Drop every entry
+ */
+void comm_cache_invalidate_all(comm_cache_t *cache);
+
+#endif // COMM_CACHE_H
@@ -0,0 +1,279 @@
+/**
+ * @file comm_capture.c
+ * @brief Wire traffic recorder and replay driver implementation
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#include "comm_capture.h"
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define COMM_CAPTURE_ALIGN(n)   (((n) + 7U) & ~(size_t)7U)
+
+uint64_t comm_capture_now_ns(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void comm_capture_open_fail(comm_capture_t *cap)
+{
+    if (cap->fd >= 0)
+    {
+        (void)close(cap->fd);
+        cap->fd = -1;
+    }
+    (void)osMutexDelete(cap->mutex);
+    cap->mutex = NULL;
+}
+
+comm_result_t comm_capture_open(comm_capture_t *cap, const char *path, size_t capacity)
+{
+    comm_capture_file_hdr_t *hdr = NULL;
+    void *base = NULL;
+
+    if (cap == NULL || path == NULL)
+    {
+        return COMM_ERROR;
+    }
+    memset(cap, 0, sizeof(comm_capture_t));
+    cap->fd = -1;
+    if (capacity == 0U)
+    {
+        capacity = COMM_CAPTURE_DEFAULT_SIZE;
+    }
+    if (capacity < sizeof(comm_capture_file_hdr_t))
+    {
+        return COMM_ERROR;
+    }
+    cap->mutex = osMutexNew(NULL);
+    if (cap->mutex == NULL)
+    {
+        return COMM_ERROR;
+    }
+    cap->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (cap->fd < 0)
+    {
+        comm_capture_open_fail(cap);
+        return COMM_ERROR;
+    }
+    /* allocate the whole file up front: appends then only touch memory, and a
+     * full disk fails here instead of with SIGBUS on a store into a hole */
+    if (posix_fallocate(cap->fd, 0, (off_t)capacity) != 0)
+    {
+        comm_capture_open_fail(cap);
+        return COMM_ERROR;
+    }
+    base = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, cap->fd, 0);
+    if (base == MAP_FAILED)
+    {
+        comm_capture_open_fail(cap);
+        return COMM_ERROR;
+    }
+    cap->base = (uint8_t *)base;
+    cap->capacity = capacity;
+    cap->t0_ns = comm_capture_now_ns();
+    hdr = (comm_capture_file_hdr_t *)cap->base;
+    hdr->magic = COMM_CAPTURE_MAGIC;
+    hdr->version = COMM_CAPTURE_VERSION;
+    hdr->hdr_len = (uint16_t)sizeof(comm_capture_file_hdr_t);
+    hdr->t0_ns = cap->t0_ns;
+    cap->offset = sizeof(comm_capture_file_hdr_t);
+    return COMM_OK;
+}
+
+void comm_capture_record(comm_capture_t *cap, uint16_t link_id, comm_capture_dir_t dir,
+                         const uint8_t *data, uint16_t len)
+{
+    comm_capture_rec_t *rec = NULL;
+    size_t need = 0U;
+    uint64_t now = 0U;
+
+    if (cap == NULL || (data == NULL && len != 0U))
+    {
+        return;
+    }
+    /* announce the call before looking at stopped, close waits for it */
+    (void)__atomic_fetch_add(&cap->users, 1U, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&cap->stopped, __ATOMIC_SEQ_CST) || cap->base == NULL)
+    {
+        (void)__atomic_fetch_sub(&cap->users, 1U, __ATOMIC_RELEASE);
+        return;
+    }
+    now = comm_capture_now_ns();
+    need = COMM_CAPTURE_ALIGN(sizeof(comm_capture_rec_t) + len);
+    if (osMutexAcquire(cap->mutex, osWaitForever) != osOK)
+    {
+        (void)__atomic_fetch_sub(&cap->users, 1U, __ATOMIC_RELEASE);
+        return;
+    }
+    if (cap->offset + need <= cap->capacity)
+    {
+        rec = (comm_capture_rec_t *)(cap->base + cap->offset);
+        rec->ts_ns = now - cap->t0_ns;
+        rec->link_id = link_id;
+        rec->dir = (uint8_t)dir;
+        rec->len = len;
+        rec->reserved = 0U;
+        if (len != 0U)
+        {
+            memcpy((uint8_t *)(rec + 1), data, len);
+        }
+        __atomic_store_n(&rec->valid, 1U, __ATOMIC_RELEASE);
+        cap->offset += need;
+        cap->records++;
+    }
+    else
+    {
+        cap->dropped++;
+    }
+    (void)osMutexRelease(cap->mutex);
+    (void)__atomic_fetch_sub(&cap->users, 1U, __ATOMIC_RELEASE);
+}
+
+void comm_capture_close(comm_capture_t *cap)
+{
+    if (cap == NULL || cap->base == NULL || __atomic_load_n(&cap->stopped, __ATOMIC_SEQ_CST))
+    {
+        return;
+    }
+    /* new calls now return at once; wait out the ones already inside */
+    __atomic_store_n(&cap->stopped, true, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&cap->users, __ATOMIC_ACQUIRE) != 0U)
+    {
+        osDelay(1U);
+    }
+    (void)munmap(cap->base, cap->capacity);
+    cap->base = NULL;
+    (void)ftruncate(cap->fd, (off_t)cap->offset);
+    (void)close(cap->fd);
+    cap->fd = -1;
+    (void)osMutexDelete(cap->mutex);
+    cap->mutex = NULL;
+}
+
+comm_result_t comm_replay_open(comm_replay_t *rp, const char *path)
+{
+    struct stat st;
+    const comm_capture_file_hdr_t *hdr = NULL;
+    void *base = NULL;
+
+    if (rp == NULL || path == NULL)
+    {
+        return COMM_ERROR;
+    }
+    memset(rp, 0, sizeof(comm_replay_t));
+    rp->fd = open(path, O_RDONLY);
+    if (rp->fd < 0)
+    {
+        return COMM_ERROR;
+    }
+    if (fstat(rp->fd, &st) != 0 || (size_t)st.st_size < sizeof(comm_capture_file_hdr_t))
+    {
+        (void)close(rp->fd);
+        rp->fd = -1;
+        return COMM_ERROR;
+    }
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, rp->fd, 0);
+    if (base == MAP_FAILED)
+    {
+        (void)close(rp->fd);
+        rp->fd = -1;
+        return COMM_ERROR;
+    }
+    hdr = (const comm_capture_file_hdr_t *)base;
+    if (hdr->magic != COMM_CAPTURE_MAGIC || hdr->version != COMM_CAPTURE_VERSION)
+    {
+        (void)munmap(base, (size_t)st.st_size);
+        (void)close(rp->fd);
+        rp->fd = -1;
+        return COMM_ERROR;
+    }
+    rp->base = (const uint8_t *)base;
+    rp->size = (size_t)st.st_size;
+    rp->offset = hdr->hdr_len;
+    return COMM_OK;
+}
+
+bool comm_replay_next(comm_replay_t *rp, const comm_capture_rec_t **rec, const uint8_t **data)
+{
+    const comm_capture_rec_t *cur = NULL;
+
+    if (rp == NULL || rp->base == NULL || rec == NULL || data == NULL ||
+        rp->offset + sizeof(comm_capture_rec_t) > rp->size)
+    {
+        return false;
+    }
+    cur = (const comm_capture_rec_t *)(rp->base + rp->offset);
+    if (cur->valid != 1U || rp->offset + sizeof(comm_capture_rec_t) + cur->len > rp->size)
+    {
+        return false;   /* end of a capture that was not closed cleanly */
+    }
+    *rec = cur;
+    *data = (const uint8_t *)(cur + 1);
+    rp->offset += COMM_CAPTURE_ALIGN(sizeof(comm_capture_rec_t) + cur->len);
+    return true;
+}
+
+void comm_replay_rewind(comm_replay_t *rp)
+{
+    if (rp != NULL && rp->base != NULL)
+    {
+        rp->offset = ((const comm_capture_file_hdr_t *)rp->base)->hdr_len;
+    }
+}
+
+uint32_t comm_replay_run(comm_replay_t *rp, bool realtime, comm_replay_cb_t cb, void *ctx)
+{
+    const comm_capture_rec_t *rec = NULL;
+    const uint8_t *data = NULL;
+    uint64_t start_ns = 0U;
+    uint64_t first_ts = 0U;
+    uint64_t elapsed = 0U;
+    uint32_t count = 0U;
+
+    if (rp == NULL || cb == NULL)
+    {
+        return 0U;
+    }
+    start_ns = comm_capture_now_ns();
+    while (comm_replay_next(rp, &rec, &data))
+    {
+        if (realtime)
+        {
+            if (count == 0U)
+            {
+                first_ts = rec->ts_ns;
+            }
+            elapsed = comm_capture_now_ns() - start_ns;
+            if ((rec->ts_ns - first_ts) > elapsed + 1000000ULL)
+            {
+                osDelay((uint32_t)(((rec->ts_ns - first_ts) - elapsed) / 1000000ULL));
+            }
+        }
+        cb(ctx, rec, data);
+        count++;
+    }
+    return count;
+}
+
+void comm_replay_close(comm_replay_t *rp)
+{
+    if (rp == NULL || rp->base == NULL)
+    {
+        return;
+    }
+    (void)munmap((void *)rp->base, rp->size);
+    (void)close(rp->fd);
+    rp->base = NULL;
+    rp->fd = -1;
+}
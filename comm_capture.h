@@ -0,0 +1,158 @@
+/**
+ * @file comm_capture.h
+ * @brief Wire traffic recorder and replay driver
+ *
+ * The recorder appends every TX and RX chunk, as it was handed to or read
+ * from the transport, to a capture file mapped into memory. The file is
+ * sized once when it is opened; appending a record is a memcpy under a
+ * mutex plus a vDSO clock read, so recording adds no system call per frame.
+ * When the mapping is full further records are counted as dropped.
+ *
+ * File layout (host byte order, every record 8-byte aligned):
+ *   comm_capture_file_hdr_t
+ *   { comm_capture_rec_t, data[len], pad to 8 } ...
+ * A record is published by setting its valid byte last, so a capture cut
+ * short by a crash ends at the last complete record.
+ *
+ * The replay driver maps a capture read-only and hands its records to a
+ * callback, either as fast as possible or paced by the recorded timestamps.
+ * Feeding the RX records to comm_protocol_decoder_process() (e.g. through
+ * lib_comm_replay()) reproduces a field session against the current decoder
+ * and controller, and doubles as a benchmark on a real traffic mix.
+ *
+ * POSIX only (mmap), like drv_socket.
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#ifndef COMM_CAPTURE_H
+#define COMM_CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cmsis_os2.h"
+#include "comm_def.h"
+
+#define COMM_CAPTURE_MAGIC          0x50414343U     /* "CCAP" */
+#define COMM_CAPTURE_VERSION        1U
+#define COMM_CAPTURE_DEFAULT_SIZE   (16UL * 1024UL * 1024UL)
+
+typedef enum {
+    COMM_CAPTURE_DIR_TX = 0U,
+    COMM_CAPTURE_DIR_RX,
+} comm_capture_dir_t;
+
+/**
+ * @brief File header
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t hdr_len;           /**< sizeof(comm_capture_file_hdr_t) */
+    uint64_t t0_ns;             /**< CLOCK_MONOTONIC at open, records are relative to it */
+} comm_capture_file_hdr_t;
+
+/**
+ * @brief Record header, followed by len data bytes
+ */
+typedef struct {
+    uint64_t ts_ns;             /**< ns since t0 */
+    uint16_t link_id;
+    uint8_t dir;                /**< comm_capture_dir_t */
+    uint8_t valid;              /**< 1 once the record is complete */
+    uint16_t len;
+    uint16_t reserved;
+} comm_capture_rec_t;
+
+/**
+ * @brief Recorder
+ */
+typedef struct {
+    int fd;
+    uint8_t *base;              /**< mapping, NULL when closed */
+    size_t capacity;            /**< mapped bytes */
+    size_t offset;              /**< next record */
+    uint64_t t0_ns;
+    uint32_t records;
+    uint32_t dropped;           /**< records that did not fit */
+    osMutexId_t mutex;
+    bool stopped;               /**< set by close, record calls return at once */
+    uint32_t users;             /**< record calls in progress, close waits for 0 */
+} comm_capture_t;
+
+/**
+ * @brief Replay cursor over a mapped capture
+ */
+typedef struct {
+    int fd;
+    const uint8_t *base;
+    size_t size;
+    size_t offset;
+} comm_replay_t;
+
+typedef void (*comm_replay_cb_t)(void *ctx, const comm_capture_rec_t *rec, const uint8_t *data);
+
+/**
+ * @brief Create (truncate) a capture file and map it
+ * @param cap Recorder
+ * @param path File path
+ * @param capacity File size to reserve, 0 for COMM_CAPTURE_DEFAULT_SIZE
+ * @return COMM_OK, or COMM_ERROR if the file cannot be created, allocated
+ *         (e.g. disk full) or mapped
+ */
+comm_result_t comm_capture_open(comm_capture_t *cap, const char *path, size_t capacity);
+
+/**
+ * @brief Append one chunk, safe from any thread, no-op on a closed recorder
+ */
+void comm_capture_record(comm_capture_t *cap, uint16_t link_id, comm_capture_dir_t dir,
+                         const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Unmap and shrink the file to the recorded size
+ *
+ * Safe while other threads are still recording: it waits for the calls in
+ * progress, and later calls return without touching the file. @p cap must
+ * stay valid as long as any thread may still call comm_capture_record().
+ */
+void comm_capture_close(comm_capture_t *cap);
+
+/**
+ * @brief Map a capture file for replay
+ * @return COMM_OK, or COMM_ERROR if the file is missing or not a capture
+ */
+comm_result_t comm_replay_open(comm_replay_t *rp, const char *path);
+
+/**
+ * @brief Next complete record
+ * @return false at the end of the capture
+ */
+bool comm_replay_next(comm_replay_t *rp, const comm_capture_rec_t **rec, const uint8_t **data);
+
+/**
+ * @brief Go back to the first record
+ */
+void comm_replay_rewind(comm_replay_t *rp);
+
+/**
+ * @brief Deliver the remaining records to @p cb
+ *
+ * @param rp Replay cursor
+ * @param realtime true to keep the recorded gaps (1 ms resolution), false for full speed
+ * @param cb Callback, runs on the calling thread
+ * @param ctx Callback context
+ * @return Number of records delivered
+ */
+uint32_t comm_replay_run(comm_replay_t *rp, bool realtime, comm_replay_cb_t cb, void *ctx);
+
+void comm_replay_close(comm_replay_t *rp);
+
+/**
+ * @brief CLOCK_MONOTONIC in ns, the time base of the capture
+ */
+uint64_t comm_capture_now_ns(void);
+
+#endif // COMM_CAPTURE_H
@@ -0,0 +1,646 @@
+/**
+ * @file comm_cmd_ap3.h
+ * @brief Typed command payloads for the AP3 command set
+ *
+ * Generated by tools/comm_codegen.py from ap3_cmd.json, do not edit.
+ *
+ * encode() fills a comm_data_t ready for comm_ctrl_send_single_command();
+ * decode() checks the response ID and length once and unpacks the fields.
+ */
+
+#ifndef COMM_CMD_AP3_H
+#define COMM_CMD_AP3_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "comm_ctrl.h"
+#include "comm_codec.h"
+
+/* USER_OPERATION: 0xF0 -> 0xF1 */
+#define COMM_AP3_USER_OPERATION_REQ                      0xF0U
+#define COMM_AP3_USER_OPERATION_RESP                     0xF1U
+#define COMM_AP3_USER_OPERATION_CMD_LEN                  6U
+#define COMM_AP3_USER_OPERATION_RESP_LEN                 15U
+typedef char comm_ap3_user_operation_len_check_t[(COMM_AP3_USER_OPERATION_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_USER_OPERATION_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+typedef struct {
+    uint8_t data[6];
+} comm_ap3_user_operation_cmd_t;
+
+static inline void comm_ap3_user_operation_encode(comm_data_t *out, const comm_ap3_user_operation_cmd_t *cmd)
+{
+    out->comm_id = COMM_AP3_USER_OPERATION_REQ;
+    out->comm_len = COMM_AP3_USER_OPERATION_CMD_LEN;
+    memcpy(&out->comm_data[0], cmd->data, 6U);
+}
+
+typedef struct {
+    uint8_t data[15];
+} comm_ap3_user_operation_resp_t;
+
+static inline bool comm_ap3_user_operation_decode(const comm_data_t *in, comm_ap3_user_operation_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_USER_OPERATION_RESP || in->comm_len != COMM_AP3_USER_OPERATION_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 15U);
+    return true;
+}
+
+/* ENTER_SETTING: 0x20 -> 0x21 */
+#define COMM_AP3_ENTER_SETTING_REQ                       0x20U
+#define COMM_AP3_ENTER_SETTING_RESP                      0x21U
+#define COMM_AP3_ENTER_SETTING_CMD_LEN                   0U
+#define COMM_AP3_ENTER_SETTING_RESP_LEN                  1U
+typedef char comm_ap3_enter_setting_len_check_t[(COMM_AP3_ENTER_SETTING_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_ENTER_SETTING_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_enter_setting_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_ENTER_SETTING_REQ;
+    out->comm_len = COMM_AP3_ENTER_SETTING_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data;
+} comm_ap3_enter_setting_resp_t;
+
+static inline bool comm_ap3_enter_setting_decode(const comm_data_t *in, comm_ap3_enter_setting_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_ENTER_SETTING_RESP || in->comm_len != COMM_AP3_ENTER_SETTING_RESP_LEN)
+    {
+        return false;
+    }
+    resp->data = (uint8_t)in->comm_data[0];
+    return true;
+}
+
+/* EXIT_SETTING: 0x22 -> 0x23 */
+#define COMM_AP3_EXIT_SETTING_REQ                        0x22U
+#define COMM_AP3_EXIT_SETTING_RESP                       0x23U
+#define COMM_AP3_EXIT_SETTING_CMD_LEN                    0U
+#define COMM_AP3_EXIT_SETTING_RESP_LEN                   1U
+typedef char comm_ap3_exit_setting_len_check_t[(COMM_AP3_EXIT_SETTING_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_EXIT_SETTING_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_exit_setting_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_EXIT_SETTING_REQ;
+    out->comm_len = COMM_AP3_EXIT_SETTING_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data;
+} comm_ap3_exit_setting_resp_t;
+
+static inline bool comm_ap3_exit_setting_decode(const comm_data_t *in, comm_ap3_exit_setting_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_EXIT_SETTING_RESP || in->comm_len != COMM_AP3_EXIT_SETTING_RESP_LEN)
+    {
+        return false;
+    }
+    resp->data = (uint8_t)in->comm_data[0];
+    return true;
+}
+
+/* FC_SET: 0x04 -> 0x05 */
+#define COMM_AP3_FC_SET_REQ                              0x04U
+#define COMM_AP3_FC_SET_RESP                             0x05U
+#define COMM_AP3_FC_SET_CMD_LEN                          0U
+#define COMM_AP3_FC_SET_RESP_LEN                         2U
+typedef char comm_ap3_fc_set_len_check_t[(COMM_AP3_FC_SET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_FC_SET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_fc_set_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_FC_SET_REQ;
+    out->comm_len = COMM_AP3_FC_SET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[2];
+} comm_ap3_fc_set_resp_t;
+
+static inline bool comm_ap3_fc_set_decode(const comm_data_t *in, comm_ap3_fc_set_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_FC_SET_RESP || in->comm_len != COMM_AP3_FC_SET_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 2U);
+    return true;
+}
+
+/* PROG_UPDATE: 0x08 -> 0x09 */
+#define COMM_AP3_PROG_UPDATE_REQ                         0x08U
+#define COMM_AP3_PROG_UPDATE_RESP                        0x09U
+#define COMM_AP3_PROG_UPDATE_CMD_LEN                     0U
+#define COMM_AP3_PROG_UPDATE_RESP_LEN                    2U
+typedef char comm_ap3_prog_update_len_check_t[(COMM_AP3_PROG_UPDATE_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_PROG_UPDATE_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_prog_update_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_PROG_UPDATE_REQ;
+    out->comm_len = COMM_AP3_PROG_UPDATE_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[2];
+} comm_ap3_prog_update_resp_t;
+
+static inline bool comm_ap3_prog_update_decode(const comm_data_t *in, comm_ap3_prog_update_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_PROG_UPDATE_RESP || in->comm_len != COMM_AP3_PROG_UPDATE_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 2U);
+    return true;
+}
+
+/* BUZZER_VOLUME: 0x0E -> 0x0F */
+#define COMM_AP3_BUZZER_VOLUME_REQ                       0x0EU
+#define COMM_AP3_BUZZER_VOLUME_RESP                      0x0FU
+#define COMM_AP3_BUZZER_VOLUME_CMD_LEN                   0U
+#define COMM_AP3_BUZZER_VOLUME_RESP_LEN                  2U
+typedef char comm_ap3_buzzer_volume_len_check_t[(COMM_AP3_BUZZER_VOLUME_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_BUZZER_VOLUME_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_buzzer_volume_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_BUZZER_VOLUME_REQ;
+    out->comm_len = COMM_AP3_BUZZER_VOLUME_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[2];
+} comm_ap3_buzzer_volume_resp_t;
+
+static inline bool comm_ap3_buzzer_volume_decode(const comm_data_t *in, comm_ap3_buzzer_volume_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_BUZZER_VOLUME_RESP || in->comm_len != COMM_AP3_BUZZER_VOLUME_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 2U);
+    return true;
+}
+
+/* FACTORY_INIT: 0x40 -> 0x41 */
+#define COMM_AP3_FACTORY_INIT_REQ                        0x40U
+#define COMM_AP3_FACTORY_INIT_RESP                       0x41U
+#define COMM_AP3_FACTORY_INIT_CMD_LEN                    0U
+#define COMM_AP3_FACTORY_INIT_RESP_LEN                   1U
+typedef char comm_ap3_factory_init_len_check_t[(COMM_AP3_FACTORY_INIT_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_FACTORY_INIT_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_factory_init_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_FACTORY_INIT_REQ;
+    out->comm_len = COMM_AP3_FACTORY_INIT_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data;
+} comm_ap3_factory_init_resp_t;
+
+static inline bool comm_ap3_factory_init_decode(const comm_data_t *in, comm_ap3_factory_init_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_FACTORY_INIT_RESP || in->comm_len != COMM_AP3_FACTORY_INIT_RESP_LEN)
+    {
+        return false;
+    }
+    resp->data = (uint8_t)in->comm_data[0];
+    return true;
+}
+
+/* FC_CALIB_START: 0x42 -> 0x43 */
+#define COMM_AP3_FC_CALIB_START_REQ                      0x42U
+#define COMM_AP3_FC_CALIB_START_RESP                     0x43U
+#define COMM_AP3_FC_CALIB_START_CMD_LEN                  0U
+#define COMM_AP3_FC_CALIB_START_RESP_LEN                 1U
+typedef char comm_ap3_fc_calib_start_len_check_t[(COMM_AP3_FC_CALIB_START_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_FC_CALIB_START_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_fc_calib_start_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_FC_CALIB_START_REQ;
+    out->comm_len = COMM_AP3_FC_CALIB_START_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data;
+} comm_ap3_fc_calib_start_resp_t;
+
+static inline bool comm_ap3_fc_calib_start_decode(const comm_data_t *in, comm_ap3_fc_calib_start_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_FC_CALIB_START_RESP || in->comm_len != COMM_AP3_FC_CALIB_START_RESP_LEN)
+    {
+        return false;
+    }
+    resp->data = (uint8_t)in->comm_data[0];
+    return true;
+}
+
+/* FC_CALIB_GET: 0x44 -> 0x45 */
+#define COMM_AP3_FC_CALIB_GET_REQ                        0x44U
+#define COMM_AP3_FC_CALIB_GET_RESP                       0x45U
+#define COMM_AP3_FC_CALIB_GET_CMD_LEN                    0U
+#define COMM_AP3_FC_CALIB_GET_RESP_LEN                   1U
+typedef char comm_ap3_fc_calib_get_len_check_t[(COMM_AP3_FC_CALIB_GET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_FC_CALIB_GET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_fc_calib_get_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_FC_CALIB_GET_REQ;
+    out->comm_len = COMM_AP3_FC_CALIB_GET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data;
+} comm_ap3_fc_calib_get_resp_t;
+
+static inline bool comm_ap3_fc_calib_get_decode(const comm_data_t *in, comm_ap3_fc_calib_get_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_FC_CALIB_GET_RESP || in->comm_len != COMM_AP3_FC_CALIB_GET_RESP_LEN)
+    {
+        return false;
+    }
+    resp->data = (uint8_t)in->comm_data[0];
+    return true;
+}
+
+/* FC_CALIB_GET_STOP: 0x46 -> 0x47 */
+#define COMM_AP3_FC_CALIB_GET_STOP_REQ                   0x46U
+#define COMM_AP3_FC_CALIB_GET_STOP_RESP                  0x47U
+#define COMM_AP3_FC_CALIB_GET_STOP_CMD_LEN               0U
+#define COMM_AP3_FC_CALIB_GET_STOP_RESP_LEN              1U
+typedef char comm_ap3_fc_calib_get_stop_len_check_t[(COMM_AP3_FC_CALIB_GET_STOP_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_FC_CALIB_GET_STOP_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_fc_calib_get_stop_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_FC_CALIB_GET_STOP_REQ;
+    out->comm_len = COMM_AP3_FC_CALIB_GET_STOP_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data;
+} comm_ap3_fc_calib_get_stop_resp_t;
+
+static inline bool comm_ap3_fc_calib_get_stop_decode(const comm_data_t *in, comm_ap3_fc_calib_get_stop_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_FC_CALIB_GET_STOP_RESP || in->comm_len != COMM_AP3_FC_CALIB_GET_STOP_RESP_LEN)
+    {
+        return false;
+    }
+    resp->data = (uint8_t)in->comm_data[0];
+    return true;
+}
+
+/* FC_CALIB_MEMORY_SET: 0x48 -> 0x49 */
+#define COMM_AP3_FC_CALIB_MEMORY_SET_REQ                 0x48U
+#define COMM_AP3_FC_CALIB_MEMORY_SET_RESP                0x49U
+#define COMM_AP3_FC_CALIB_MEMORY_SET_CMD_LEN             0U
+#define COMM_AP3_FC_CALIB_MEMORY_SET_RESP_LEN            1U
+typedef char comm_ap3_fc_calib_memory_set_len_check_t[(COMM_AP3_FC_CALIB_MEMORY_SET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_FC_CALIB_MEMORY_SET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_fc_calib_memory_set_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_FC_CALIB_MEMORY_SET_REQ;
+    out->comm_len = COMM_AP3_FC_CALIB_MEMORY_SET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data;
+} comm_ap3_fc_calib_memory_set_resp_t;
+
+static inline bool comm_ap3_fc_calib_memory_set_decode(const comm_data_t *in, comm_ap3_fc_calib_memory_set_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_FC_CALIB_MEMORY_SET_RESP || in->comm_len != COMM_AP3_FC_CALIB_MEMORY_SET_RESP_LEN)
+    {
+        return false;
+    }
+    resp->data = (uint8_t)in->comm_data[0];
+    return true;
+}
+
+/* MOTOR_SPEED_CALIB_START: 0x4C -> 0x4D */
+#define COMM_AP3_MOTOR_SPEED_CALIB_START_REQ             0x4CU
+#define COMM_AP3_MOTOR_SPEED_CALIB_START_RESP            0x4DU
+#define COMM_AP3_MOTOR_SPEED_CALIB_START_CMD_LEN         0U
+#define COMM_AP3_MOTOR_SPEED_CALIB_START_RESP_LEN        1U
+typedef char comm_ap3_motor_speed_calib_start_len_check_t[(COMM_AP3_MOTOR_SPEED_CALIB_START_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_MOTOR_SPEED_CALIB_START_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_motor_speed_calib_start_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_MOTOR_SPEED_CALIB_START_REQ;
+    out->comm_len = COMM_AP3_MOTOR_SPEED_CALIB_START_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data;
+} comm_ap3_motor_speed_calib_start_resp_t;
+
+static inline bool comm_ap3_motor_speed_calib_start_decode(const comm_data_t *in, comm_ap3_motor_speed_calib_start_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_MOTOR_SPEED_CALIB_START_RESP || in->comm_len != COMM_AP3_MOTOR_SPEED_CALIB_START_RESP_LEN)
+    {
+        return false;
+    }
+    resp->data = (uint8_t)in->comm_data[0];
+    return true;
+}
+
+/* MOTOR_LOW_SPEED_CALIB_GET: 0x4E -> 0x4F */
+#define COMM_AP3_MOTOR_LOW_SPEED_CALIB_GET_REQ           0x4EU
+#define COMM_AP3_MOTOR_LOW_SPEED_CALIB_GET_RESP          0x4FU
+#define COMM_AP3_MOTOR_LOW_SPEED_CALIB_GET_CMD_LEN       0U
+#define COMM_AP3_MOTOR_LOW_SPEED_CALIB_GET_RESP_LEN      1U
+typedef char comm_ap3_motor_low_speed_calib_get_len_check_t[(COMM_AP3_MOTOR_LOW_SPEED_CALIB_GET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_MOTOR_LOW_SPEED_CALIB_GET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_motor_low_speed_calib_get_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_MOTOR_LOW_SPEED_CALIB_GET_REQ;
+    out->comm_len = COMM_AP3_MOTOR_LOW_SPEED_CALIB_GET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data;
+} comm_ap3_motor_low_speed_calib_get_resp_t;
+
+static inline bool comm_ap3_motor_low_speed_calib_get_decode(const comm_data_t *in, comm_ap3_motor_low_speed_calib_get_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_MOTOR_LOW_SPEED_CALIB_GET_RESP || in->comm_len != COMM_AP3_MOTOR_LOW_SPEED_CALIB_GET_RESP_LEN)
+    {
+        return false;
+    }
+    resp->data = (uint8_t)in->comm_data[0];
+    return true;
+}
+
+/* MOTOR_HIGH_SPEED_CALIB_GET: 0x50 -> 0x51 */
+#define COMM_AP3_MOTOR_HIGH_SPEED_CALIB_GET_REQ          0x50U
+#define COMM_AP3_MOTOR_HIGH_SPEED_CALIB_GET_RESP         0x51U
+#define COMM_AP3_MOTOR_HIGH_SPEED_CALIB_GET_CMD_LEN      0U
+#define COMM_AP3_MOTOR_HIGH_SPEED_CALIB_GET_RESP_LEN     1U
+typedef char comm_ap3_motor_high_speed_calib_get_len_check_t[(COMM_AP3_MOTOR_HIGH_SPEED_CALIB_GET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_MOTOR_HIGH_SPEED_CALIB_GET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_motor_high_speed_calib_get_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_MOTOR_HIGH_SPEED_CALIB_GET_REQ;
+    out->comm_len = COMM_AP3_MOTOR_HIGH_SPEED_CALIB_GET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data;
+} comm_ap3_motor_high_speed_calib_get_resp_t;
+
+static inline bool comm_ap3_motor_high_speed_calib_get_decode(const comm_data_t *in, comm_ap3_motor_high_speed_calib_get_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_MOTOR_HIGH_SPEED_CALIB_GET_RESP || in->comm_len != COMM_AP3_MOTOR_HIGH_SPEED_CALIB_GET_RESP_LEN)
+    {
+        return false;
+    }
+    resp->data = (uint8_t)in->comm_data[0];
+    return true;
+}
+
+/* MOTOR_SPEED_CALIB_GET_STOP: 0x52 -> 0x53 */
+#define COMM_AP3_MOTOR_SPEED_CALIB_GET_STOP_REQ          0x52U
+#define COMM_AP3_MOTOR_SPEED_CALIB_GET_STOP_RESP         0x53U
+#define COMM_AP3_MOTOR_SPEED_CALIB_GET_STOP_CMD_LEN      0U
+#define COMM_AP3_MOTOR_SPEED_CALIB_GET_STOP_RESP_LEN     1U
+typedef char comm_ap3_motor_speed_calib_get_stop_len_check_t[(COMM_AP3_MOTOR_SPEED_CALIB_GET_STOP_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_MOTOR_SPEED_CALIB_GET_STOP_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_motor_speed_calib_get_stop_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_MOTOR_SPEED_CALIB_GET_STOP_REQ;
+    out->comm_len = COMM_AP3_MOTOR_SPEED_CALIB_GET_STOP_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data;
+} comm_ap3_motor_speed_calib_get_stop_resp_t;
+
+static inline bool comm_ap3_motor_speed_calib_get_stop_decode(const comm_data_t *in, comm_ap3_motor_speed_calib_get_stop_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_MOTOR_SPEED_CALIB_GET_STOP_RESP || in->comm_len != COMM_AP3_MOTOR_SPEED_CALIB_GET_STOP_RESP_LEN)
+    {
+        return false;
+    }
+    resp->data = (uint8_t)in->comm_data[0];
+    return true;
+}
+
+/* MACHINE_ID: 0x80 -> 0x81 */
+#define COMM_AP3_MACHINE_ID_REQ                          0x80U
+#define COMM_AP3_MACHINE_ID_RESP                         0x81U
+#define COMM_AP3_MACHINE_ID_CMD_LEN                      0U
+#define COMM_AP3_MACHINE_ID_RESP_LEN                     9U
+typedef char comm_ap3_machine_id_len_check_t[(COMM_AP3_MACHINE_ID_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_MACHINE_ID_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_machine_id_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_MACHINE_ID_REQ;
+    out->comm_len = COMM_AP3_MACHINE_ID_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[9];
+} comm_ap3_machine_id_resp_t;
+
+static inline bool comm_ap3_machine_id_decode(const comm_data_t *in, comm_ap3_machine_id_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_MACHINE_ID_RESP || in->comm_len != COMM_AP3_MACHINE_ID_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 9U);
+    return true;
+}
+
+/* SERIAL_NUMBER_GET: 0x82 -> 0x83 */
+#define COMM_AP3_SERIAL_NUMBER_GET_REQ                   0x82U
+#define COMM_AP3_SERIAL_NUMBER_GET_RESP                  0x83U
+#define COMM_AP3_SERIAL_NUMBER_GET_CMD_LEN               0U
+#define COMM_AP3_SERIAL_NUMBER_GET_RESP_LEN              9U
+typedef char comm_ap3_serial_number_get_len_check_t[(COMM_AP3_SERIAL_NUMBER_GET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_SERIAL_NUMBER_GET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_serial_number_get_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_SERIAL_NUMBER_GET_REQ;
+    out->comm_len = COMM_AP3_SERIAL_NUMBER_GET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[9];
+} comm_ap3_serial_number_get_resp_t;
+
+static inline bool comm_ap3_serial_number_get_decode(const comm_data_t *in, comm_ap3_serial_number_get_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_SERIAL_NUMBER_GET_RESP || in->comm_len != COMM_AP3_SERIAL_NUMBER_GET_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 9U);
+    return true;
+}
+
+/* SOFTWARE_VERSION_GET: 0x84 -> 0x85 */
+#define COMM_AP3_SOFTWARE_VERSION_GET_REQ                0x84U
+#define COMM_AP3_SOFTWARE_VERSION_GET_RESP               0x85U
+#define COMM_AP3_SOFTWARE_VERSION_GET_CMD_LEN            0U
+#define COMM_AP3_SOFTWARE_VERSION_GET_RESP_LEN           3U
+typedef char comm_ap3_software_version_get_len_check_t[(COMM_AP3_SOFTWARE_VERSION_GET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_SOFTWARE_VERSION_GET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_software_version_get_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_SOFTWARE_VERSION_GET_REQ;
+    out->comm_len = COMM_AP3_SOFTWARE_VERSION_GET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[3];
+} comm_ap3_software_version_get_resp_t;
+
+static inline bool comm_ap3_software_version_get_decode(const comm_data_t *in, comm_ap3_software_version_get_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_SOFTWARE_VERSION_GET_RESP || in->comm_len != COMM_AP3_SOFTWARE_VERSION_GET_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 3U);
+    return true;
+}
+
+/* ERROR_INFO_GET: 0x86 -> 0x87 */
+#define COMM_AP3_ERROR_INFO_GET_REQ                      0x86U
+#define COMM_AP3_ERROR_INFO_GET_RESP                     0x87U
+#define COMM_AP3_ERROR_INFO_GET_CMD_LEN                  0U
+#define COMM_AP3_ERROR_INFO_GET_RESP_LEN                 3U
+typedef char comm_ap3_error_info_get_len_check_t[(COMM_AP3_ERROR_INFO_GET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_ERROR_INFO_GET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_error_info_get_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_ERROR_INFO_GET_REQ;
+    out->comm_len = COMM_AP3_ERROR_INFO_GET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[3];
+} comm_ap3_error_info_get_resp_t;
+
+static inline bool comm_ap3_error_info_get_decode(const comm_data_t *in, comm_ap3_error_info_get_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_ERROR_INFO_GET_RESP || in->comm_len != COMM_AP3_ERROR_INFO_GET_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 3U);
+    return true;
+}
+
+/* PROG_INFO_GET: 0x88 -> 0x89 */
+#define COMM_AP3_PROG_INFO_GET_REQ                       0x88U
+#define COMM_AP3_PROG_INFO_GET_RESP                      0x89U
+#define COMM_AP3_PROG_INFO_GET_CMD_LEN                   0U
+#define COMM_AP3_PROG_INFO_GET_RESP_LEN                  9U
+typedef char comm_ap3_prog_info_get_len_check_t[(COMM_AP3_PROG_INFO_GET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_PROG_INFO_GET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_prog_info_get_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_PROG_INFO_GET_REQ;
+    out->comm_len = COMM_AP3_PROG_INFO_GET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[9];
+} comm_ap3_prog_info_get_resp_t;
+
+static inline bool comm_ap3_prog_info_get_decode(const comm_data_t *in, comm_ap3_prog_info_get_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_PROG_INFO_GET_RESP || in->comm_len != COMM_AP3_PROG_INFO_GET_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 9U);
+    return true;
+}
+
+/* SETTING_INFO_GET: 0x8C -> 0x8D */
+#define COMM_AP3_SETTING_INFO_GET_REQ                    0x8CU
+#define COMM_AP3_SETTING_INFO_GET_RESP                   0x8DU
+#define COMM_AP3_SETTING_INFO_GET_CMD_LEN                0U
+#define COMM_AP3_SETTING_INFO_GET_RESP_LEN               3U
+typedef char comm_ap3_setting_info_get_len_check_t[(COMM_AP3_SETTING_INFO_GET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_SETTING_INFO_GET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_setting_info_get_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_SETTING_INFO_GET_REQ;
+    out->comm_len = COMM_AP3_SETTING_INFO_GET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[3];
+} comm_ap3_setting_info_get_resp_t;
+
+static inline bool comm_ap3_setting_info_get_decode(const comm_data_t *in, comm_ap3_setting_info_get_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_SETTING_INFO_GET_RESP || in->comm_len != COMM_AP3_SETTING_INFO_GET_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 3U);
+    return true;
+}
+
+/* MACHINE_TYPE_GET: 0x8E -> 0x8F */
+#define COMM_AP3_MACHINE_TYPE_GET_REQ                    0x8EU
+#define COMM_AP3_MACHINE_TYPE_GET_RESP                   0x8FU
+#define COMM_AP3_MACHINE_TYPE_GET_CMD_LEN                0U
+#define COMM_AP3_MACHINE_TYPE_GET_RESP_LEN               2U
+typedef char comm_ap3_machine_type_get_len_check_t[(COMM_AP3_MACHINE_TYPE_GET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_MACHINE_TYPE_GET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_machine_type_get_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_MACHINE_TYPE_GET_REQ;
+    out->comm_len = COMM_AP3_MACHINE_TYPE_GET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[2];
+} comm_ap3_machine_type_get_resp_t;
+
+static inline bool comm_ap3_machine_type_get_decode(const comm_data_t *in, comm_ap3_machine_type_get_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_MACHINE_TYPE_GET_RESP || in->comm_len != COMM_AP3_MACHINE_TYPE_GET_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 2U);
+    return true;
+}
+
+/* CMD_DATA_GET: 0x90 -> 0x91 */
+#define COMM_AP3_CMD_DATA_GET_REQ                        0x90U
+#define COMM_AP3_CMD_DATA_GET_RESP                       0x91U
+#define COMM_AP3_CMD_DATA_GET_CMD_LEN                    0U
+#define COMM_AP3_CMD_DATA_GET_RESP_LEN                   32U
+typedef char comm_ap3_cmd_data_get_len_check_t[(COMM_AP3_CMD_DATA_GET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_AP3_CMD_DATA_GET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_ap3_cmd_data_get_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_AP3_CMD_DATA_GET_REQ;
+    out->comm_len = COMM_AP3_CMD_DATA_GET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[32];
+} comm_ap3_cmd_data_get_resp_t;
+
+static inline bool comm_ap3_cmd_data_get_decode(const comm_data_t *in, comm_ap3_cmd_data_get_resp_t *resp)
+{
+    if (in->comm_id != COMM_AP3_CMD_DATA_GET_RESP || in->comm_len != COMM_AP3_CMD_DATA_GET_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 32U);
+    return true;
+}
+
+#endif // COMM_CMD_AP3_H
@@ -0,0 +1,457 @@
+/**
+ * @file comm_cmd_x7.h
+ * @brief Typed command payloads for the X7 command set
+ *
+ * Generated by tools/comm_codegen.py from x7_cmd.json, do not edit.
+ *
+ * encode() fills a comm_data_t ready for comm_ctrl_send_single_command();
+ * decode() checks the response ID and length once and unpacks the fields.
+ */
+
+#ifndef COMM_CMD_X7_H
+#define COMM_CMD_X7_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "comm_ctrl.h"
+#include "comm_codec.h"
+
+/* USER_OPERATION: 0xF0 -> 0xF1 */
+#define COMM_X7_USER_OPERATION_REQ                       0xF0U
+#define COMM_X7_USER_OPERATION_RESP                      0xF1U
+#define COMM_X7_USER_OPERATION_CMD_LEN                   6U
+#define COMM_X7_USER_OPERATION_RESP_LEN                  13U
+typedef char comm_x7_user_operation_len_check_t[(COMM_X7_USER_OPERATION_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_X7_USER_OPERATION_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+typedef struct {
+    uint8_t data[6];
+} comm_x7_user_operation_cmd_t;
+
+static inline void comm_x7_user_operation_encode(comm_data_t *out, const comm_x7_user_operation_cmd_t *cmd)
+{
+    out->comm_id = COMM_X7_USER_OPERATION_REQ;
+    out->comm_len = COMM_X7_USER_OPERATION_CMD_LEN;
+    memcpy(&out->comm_data[0], cmd->data, 6U);
+}
+
+typedef struct {
+    uint8_t data[13];
+} comm_x7_user_operation_resp_t;
+
+static inline bool comm_x7_user_operation_decode(const comm_data_t *in, comm_x7_user_operation_resp_t *resp)
+{
+    if (in->comm_id != COMM_X7_USER_OPERATION_RESP || in->comm_len != COMM_X7_USER_OPERATION_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 13U);
+    return true;
+}
+
+/* ENTER_SETTING: 0x20 -> 0x21 */
+#define COMM_X7_ENTER_SETTING_REQ                        0x20U
+#define COMM_X7_ENTER_SETTING_RESP                       0x21U
+#define COMM_X7_ENTER_SETTING_CMD_LEN                    0U
+#define COMM_X7_ENTER_SETTING_RESP_LEN                   1U
+typedef char comm_x7_enter_setting_len_check_t[(COMM_X7_ENTER_SETTING_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_X7_ENTER_SETTING_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_x7_enter_setting_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_X7_ENTER_SETTING_REQ;
+    out->comm_len = COMM_X7_ENTER_SETTING_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data;
+} comm_x7_enter_setting_resp_t;
+
+static inline bool comm_x7_enter_setting_decode(const comm_data_t *in, comm_x7_enter_setting_resp_t *resp)
+{
+    if (in->comm_id != COMM_X7_ENTER_SETTING_RESP || in->comm_len != COMM_X7_ENTER_SETTING_RESP_LEN)
+    {
+        return false;
+    }
+    resp->data = (uint8_t)in->comm_data[0];
+    return true;
+}
+
+/* EXIT_SETTING: 0x22 -> 0x23 */
+#define COMM_X7_EXIT_SETTING_REQ                         0x22U
+#define COMM_X7_EXIT_SETTING_RESP                        0x23U
+#define COMM_X7_EXIT_SETTING_CMD_LEN                     0U
+#define COMM_X7_EXIT_SETTING_RESP_LEN                    1U
+typedef char comm_x7_exit_setting_len_check_t[(COMM_X7_EXIT_SETTING_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_X7_EXIT_SETTING_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_x7_exit_setting_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_X7_EXIT_SETTING_REQ;
+    out->comm_len = COMM_X7_EXIT_SETTING_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data;
+} comm_x7_exit_setting_resp_t;
+
+static inline bool comm_x7_exit_setting_decode(const comm_data_t *in, comm_x7_exit_setting_resp_t *resp)
+{
+    if (in->comm_id != COMM_X7_EXIT_SETTING_RESP || in->comm_len != COMM_X7_EXIT_SETTING_RESP_LEN)
+    {
+        return false;
+    }
+    resp->data = (uint8_t)in->comm_data[0];
+    return true;
+}
+
+/* BUZZER_VOLUME: 0x0E -> 0x0F */
+#define COMM_X7_BUZZER_VOLUME_REQ                        0x0EU
+#define COMM_X7_BUZZER_VOLUME_RESP                       0x0FU
+#define COMM_X7_BUZZER_VOLUME_CMD_LEN                    0U
+#define COMM_X7_BUZZER_VOLUME_RESP_LEN                   2U
+typedef char comm_x7_buzzer_volume_len_check_t[(COMM_X7_BUZZER_VOLUME_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_X7_BUZZER_VOLUME_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_x7_buzzer_volume_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_X7_BUZZER_VOLUME_REQ;
+    out->comm_len = COMM_X7_BUZZER_VOLUME_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[2];
+} comm_x7_buzzer_volume_resp_t;
+
+static inline bool comm_x7_buzzer_volume_decode(const comm_data_t *in, comm_x7_buzzer_volume_resp_t *resp)
+{
+    if (in->comm_id != COMM_X7_BUZZER_VOLUME_RESP || in->comm_len != COMM_X7_BUZZER_VOLUME_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 2U);
+    return true;
+}
+
+/* CLEAN_MODE_START: 0x50 -> 0x51 */
+#define COMM_X7_CLEAN_MODE_START_REQ                     0x50U
+#define COMM_X7_CLEAN_MODE_START_RESP                    0x51U
+#define COMM_X7_CLEAN_MODE_START_CMD_LEN                 0U
+#define COMM_X7_CLEAN_MODE_START_RESP_LEN                1U
+typedef char comm_x7_clean_mode_start_len_check_t[(COMM_X7_CLEAN_MODE_START_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_X7_CLEAN_MODE_START_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_x7_clean_mode_start_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_X7_CLEAN_MODE_START_REQ;
+    out->comm_len = COMM_X7_CLEAN_MODE_START_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data;
+} comm_x7_clean_mode_start_resp_t;
+
+static inline bool comm_x7_clean_mode_start_decode(const comm_data_t *in, comm_x7_clean_mode_start_resp_t *resp)
+{
+    if (in->comm_id != COMM_X7_CLEAN_MODE_START_RESP || in->comm_len != COMM_X7_CLEAN_MODE_START_RESP_LEN)
+    {
+        return false;
+    }
+    resp->data = (uint8_t)in->comm_data[0];
+    return true;
+}
+
+/* CLEAN_MODE_STOP: 0x52 -> 0x53 */
+#define COMM_X7_CLEAN_MODE_STOP_REQ                      0x52U
+#define COMM_X7_CLEAN_MODE_STOP_RESP                     0x53U
+#define COMM_X7_CLEAN_MODE_STOP_CMD_LEN                  0U
+#define COMM_X7_CLEAN_MODE_STOP_RESP_LEN                 1U
+typedef char comm_x7_clean_mode_stop_len_check_t[(COMM_X7_CLEAN_MODE_STOP_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_X7_CLEAN_MODE_STOP_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_x7_clean_mode_stop_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_X7_CLEAN_MODE_STOP_REQ;
+    out->comm_len = COMM_X7_CLEAN_MODE_STOP_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data;
+} comm_x7_clean_mode_stop_resp_t;
+
+static inline bool comm_x7_clean_mode_stop_decode(const comm_data_t *in, comm_x7_clean_mode_stop_resp_t *resp)
+{
+    if (in->comm_id != COMM_X7_CLEAN_MODE_STOP_RESP || in->comm_len != COMM_X7_CLEAN_MODE_STOP_RESP_LEN)
+    {
+        return false;
+    }
+    resp->data = (uint8_t)in->comm_data[0];
+    return true;
+}
+
+/* CLM_START: 0x54 -> 0x55 */
+#define COMM_X7_CLM_START_REQ                            0x54U
+#define COMM_X7_CLM_START_RESP                           0x55U
+#define COMM_X7_CLM_START_CMD_LEN                        0U
+#define COMM_X7_CLM_START_RESP_LEN                       1U
+typedef char comm_x7_clm_start_len_check_t[(COMM_X7_CLM_START_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_X7_CLM_START_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_x7_clm_start_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_X7_CLM_START_REQ;
+    out->comm_len = COMM_X7_CLM_START_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data;
+} comm_x7_clm_start_resp_t;
+
+static inline bool comm_x7_clm_start_decode(const comm_data_t *in, comm_x7_clm_start_resp_t *resp)
+{
+    if (in->comm_id != COMM_X7_CLM_START_RESP || in->comm_len != COMM_X7_CLM_START_RESP_LEN)
+    {
+        return false;
+    }
+    resp->data = (uint8_t)in->comm_data[0];
+    return true;
+}
+
+/* CLM_STOP: 0x56 -> 0x57 */
+#define COMM_X7_CLM_STOP_REQ                             0x56U
+#define COMM_X7_CLM_STOP_RESP                            0x57U
+#define COMM_X7_CLM_STOP_CMD_LEN                         0U
+#define COMM_X7_CLM_STOP_RESP_LEN                        1U
+typedef char comm_x7_clm_stop_len_check_t[(COMM_X7_CLM_STOP_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_X7_CLM_STOP_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_x7_clm_stop_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_X7_CLM_STOP_REQ;
+    out->comm_len = COMM_X7_CLM_STOP_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data;
+} comm_x7_clm_stop_resp_t;
+
+static inline bool comm_x7_clm_stop_decode(const comm_data_t *in, comm_x7_clm_stop_resp_t *resp)
+{
+    if (in->comm_id != COMM_X7_CLM_STOP_RESP || in->comm_len != COMM_X7_CLM_STOP_RESP_LEN)
+    {
+        return false;
+    }
+    resp->data = (uint8_t)in->comm_data[0];
+    return true;
+}
+
+/* MACHINE_ID: 0x80 -> 0x81 */
+#define COMM_X7_MACHINE_ID_REQ                           0x80U
+#define COMM_X7_MACHINE_ID_RESP                          0x81U
+#define COMM_X7_MACHINE_ID_CMD_LEN                       0U
+#define COMM_X7_MACHINE_ID_RESP_LEN                      9U
+typedef char comm_x7_machine_id_len_check_t[(COMM_X7_MACHINE_ID_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_X7_MACHINE_ID_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_x7_machine_id_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_X7_MACHINE_ID_REQ;
+    out->comm_len = COMM_X7_MACHINE_ID_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[9];
+} comm_x7_machine_id_resp_t;
+
+static inline bool comm_x7_machine_id_decode(const comm_data_t *in, comm_x7_machine_id_resp_t *resp)
+{
+    if (in->comm_id != COMM_X7_MACHINE_ID_RESP || in->comm_len != COMM_X7_MACHINE_ID_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 9U);
+    return true;
+}
+
+/* SERIAL_NUMBER_GET: 0x82 -> 0x83 */
+#define COMM_X7_SERIAL_NUMBER_GET_REQ                    0x82U
+#define COMM_X7_SERIAL_NUMBER_GET_RESP                   0x83U
+#define COMM_X7_SERIAL_NUMBER_GET_CMD_LEN                0U
+#define COMM_X7_SERIAL_NUMBER_GET_RESP_LEN               9U
+typedef char comm_x7_serial_number_get_len_check_t[(COMM_X7_SERIAL_NUMBER_GET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_X7_SERIAL_NUMBER_GET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_x7_serial_number_get_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_X7_SERIAL_NUMBER_GET_REQ;
+    out->comm_len = COMM_X7_SERIAL_NUMBER_GET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[9];
+} comm_x7_serial_number_get_resp_t;
+
+static inline bool comm_x7_serial_number_get_decode(const comm_data_t *in, comm_x7_serial_number_get_resp_t *resp)
+{
+    if (in->comm_id != COMM_X7_SERIAL_NUMBER_GET_RESP || in->comm_len != COMM_X7_SERIAL_NUMBER_GET_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 9U);
+    return true;
+}
+
+/* SOFTWARE_VERSION_GET: 0x84 -> 0x85 */
+#define COMM_X7_SOFTWARE_VERSION_GET_REQ                 0x84U
+#define COMM_X7_SOFTWARE_VERSION_GET_RESP                0x85U
+#define COMM_X7_SOFTWARE_VERSION_GET_CMD_LEN             0U
+#define COMM_X7_SOFTWARE_VERSION_GET_RESP_LEN            3U
+typedef char comm_x7_software_version_get_len_check_t[(COMM_X7_SOFTWARE_VERSION_GET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_X7_SOFTWARE_VERSION_GET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_x7_software_version_get_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_X7_SOFTWARE_VERSION_GET_REQ;
+    out->comm_len = COMM_X7_SOFTWARE_VERSION_GET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[3];
+} comm_x7_software_version_get_resp_t;
+
+static inline bool comm_x7_software_version_get_decode(const comm_data_t *in, comm_x7_software_version_get_resp_t *resp)
+{
+    if (in->comm_id != COMM_X7_SOFTWARE_VERSION_GET_RESP || in->comm_len != COMM_X7_SOFTWARE_VERSION_GET_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 3U);
+    return true;
+}
+
+/* ERROR_INFO_GET: 0x86 -> 0x87 */
+#define COMM_X7_ERROR_INFO_GET_REQ                       0x86U
+#define COMM_X7_ERROR_INFO_GET_RESP                      0x87U
+#define COMM_X7_ERROR_INFO_GET_CMD_LEN                   0U
+#define COMM_X7_ERROR_INFO_GET_RESP_LEN                  3U
+typedef char comm_x7_error_info_get_len_check_t[(COMM_X7_ERROR_INFO_GET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_X7_ERROR_INFO_GET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_x7_error_info_get_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_X7_ERROR_INFO_GET_REQ;
+    out->comm_len = COMM_X7_ERROR_INFO_GET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[3];
+} comm_x7_error_info_get_resp_t;
+
+static inline bool comm_x7_error_info_get_decode(const comm_data_t *in, comm_x7_error_info_get_resp_t *resp)
+{
+    if (in->comm_id != COMM_X7_ERROR_INFO_GET_RESP || in->comm_len != COMM_X7_ERROR_INFO_GET_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 3U);
+    return true;
+}
+
+/* MODE_INFO_GET: 0x88 -> 0x89 */
+#define COMM_X7_MODE_INFO_GET_REQ                        0x88U
+#define COMM_X7_MODE_INFO_GET_RESP                       0x89U
+#define COMM_X7_MODE_INFO_GET_CMD_LEN                    0U
+#define COMM_X7_MODE_INFO_GET_RESP_LEN                   9U
+typedef char comm_x7_mode_info_get_len_check_t[(COMM_X7_MODE_INFO_GET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_X7_MODE_INFO_GET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_x7_mode_info_get_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_X7_MODE_INFO_GET_REQ;
+    out->comm_len = COMM_X7_MODE_INFO_GET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[9];
+} comm_x7_mode_info_get_resp_t;
+
+static inline bool comm_x7_mode_info_get_decode(const comm_data_t *in, comm_x7_mode_info_get_resp_t *resp)
+{
+    if (in->comm_id != COMM_X7_MODE_INFO_GET_RESP || in->comm_len != COMM_X7_MODE_INFO_GET_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 9U);
+    return true;
+}
+
+/* LAST_MEMORY_GET: 0x8A -> 0x8B */
+#define COMM_X7_LAST_MEMORY_GET_REQ                      0x8AU
+#define COMM_X7_LAST_MEMORY_GET_RESP                     0x8BU
+#define COMM_X7_LAST_MEMORY_GET_CMD_LEN                  0U
+#define COMM_X7_LAST_MEMORY_GET_RESP_LEN                 2U
+typedef char comm_x7_last_memory_get_len_check_t[(COMM_X7_LAST_MEMORY_GET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_X7_LAST_MEMORY_GET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_x7_last_memory_get_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_X7_LAST_MEMORY_GET_REQ;
+    out->comm_len = COMM_X7_LAST_MEMORY_GET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[2];
+} comm_x7_last_memory_get_resp_t;
+
+static inline bool comm_x7_last_memory_get_decode(const comm_data_t *in, comm_x7_last_memory_get_resp_t *resp)
+{
+    if (in->comm_id != COMM_X7_LAST_MEMORY_GET_RESP || in->comm_len != COMM_X7_LAST_MEMORY_GET_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 2U);
+    return true;
+}
+
+/* SETTING_INFO_GET: 0x8C -> 0x8D */
+#define COMM_X7_SETTING_INFO_GET_REQ                     0x8CU
+#define COMM_X7_SETTING_INFO_GET_RESP                    0x8DU
+#define COMM_X7_SETTING_INFO_GET_CMD_LEN                 0U
+#define COMM_X7_SETTING_INFO_GET_RESP_LEN                2U
+typedef char comm_x7_setting_info_get_len_check_t[(COMM_X7_SETTING_INFO_GET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_X7_SETTING_INFO_GET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_x7_setting_info_get_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_X7_SETTING_INFO_GET_REQ;
+    out->comm_len = COMM_X7_SETTING_INFO_GET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[2];
+} comm_x7_setting_info_get_resp_t;
+
+static inline bool comm_x7_setting_info_get_decode(const comm_data_t *in, comm_x7_setting_info_get_resp_t *resp)
+{
+    if (in->comm_id != COMM_X7_SETTING_INFO_GET_RESP || in->comm_len != COMM_X7_SETTING_INFO_GET_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 2U);
+    return true;
+}
+
+/* CMD_DATA_GET: 0x90 -> 0x91 */
+#define COMM_X7_CMD_DATA_GET_REQ                         0x90U
+#define COMM_X7_CMD_DATA_GET_RESP                        0x91U
+#define COMM_X7_CMD_DATA_GET_CMD_LEN                     0U
+#define COMM_X7_CMD_DATA_GET_RESP_LEN                    5U
+typedef char comm_x7_cmd_data_get_len_check_t[(COMM_X7_CMD_DATA_GET_CMD_LEN <= COMM_DATA_MAX_LEN && COMM_X7_CMD_DATA_GET_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];
+
+static inline void comm_x7_cmd_data_get_encode(comm_data_t *out)
+{
+    out->comm_id = COMM_X7_CMD_DATA_GET_REQ;
+    out->comm_len = COMM_X7_CMD_DATA_GET_CMD_LEN;
+}
+
+typedef struct {
+    uint8_t data[5];
+} comm_x7_cmd_data_get_resp_t;
+
+static inline bool comm_x7_cmd_data_get_decode(const comm_data_t *in, comm_x7_cmd_data_get_resp_t *resp)
+{
+    if (in->comm_id != COMM_X7_CMD_DATA_GET_RESP || in->comm_len != COMM_X7_CMD_DATA_GET_RESP_LEN)
+    {
+        return false;
+    }
+    memcpy(resp->data, &in->comm_data[0], 5U);
+    return true;
+}
+
+#endif // COMM_CMD_X7_H
@@ -0,0 +1,67 @@
+/**
+ * @file comm_codec.h
+ * @brief Byte order helpers for payload fields
+ *
+ * Used by the generated per-model command headers (comm_cmd_<model>.h,
+ * see tools/comm_codegen.py) to read and write multi-byte fields of a
+ * comm_data_t payload without unaligned access.
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#ifndef COMM_CODEC_H
+#define COMM_CODEC_H
+
+#include <stdint.h>
+
+static inline void comm_codec_put_u16be(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static inline void comm_codec_put_u16le(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void comm_codec_put_u32be(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static inline void comm_codec_put_u32le(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint16_t comm_codec_get_u16be(const uint8_t *p)
+{
+    return (uint16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+static inline uint16_t comm_codec_get_u16le(const uint8_t *p)
+{
+    return (uint16_t)(((uint16_t)p[1] << 8) | p[0]);
+}
+
+static inline uint32_t comm_codec_get_u32be(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline uint32_t comm_codec_get_u32le(const uint8_t *p)
+{
+    return ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | p[0];
+}
+
+#endif // COMM_CODEC_H
@@ -1,11 +1,16 @@
 #include "comm_ctrl.h"
 #include "comm_protocol.h"
+#include "comm_table.h"
+#include "comm_bulk.h"
+#include "comm_script.h"
 #include <string.h>
+#include <stddef.h>
 #define DEBUG_COMM_CTRL 1
+#define COMM_CTRL_DEFAULT_RETRY 4U      /* resends of a command not in comm_table (the pre-table value) */
+#define COMM_CTRL_DEFAULT_TIMEOUT 20U   /* response timeout in ms of a command not in comm_table */
 #if DEBUG_COMM_CTRL
 #include <stdio.h>
 #include <sys/time.h>
-static uint32_t timeout_cnt = 0;
 static uint64_t start_time_ms = 0;
 static inline uint64_t get_timestamp_ms(void) {
     struct timeval tv;
@@ -18,7 +23,7 @@ static inline uint64_t get_timestamp_ms(void) {
 }
 #define DEBUG(fmt, ...)  printf("[%llu ms] " fmt, (unsigned long long)get_timestamp_ms(), ##__VA_ARGS__)
 #else
-#define DEBUG() do {} while(0)
+#define DEBUG(...) do {} while(0)
 #endif
 
 typedef enum{
@@ -38,17 +43,19 @@ typedef enum{
     COMM_CTRL_STATE_WAIT_RESP,
     COMM_CTRL_STATE_STOP,
     COMM_CTRL_STATE_ERROR,
+    COMM_CTRL_STATE_MAX,
 }comm_fsm_state_t;
 
 static void comm_ctrl_timeout_timer_start(comm_ctrl_t *comm_ctrl, uint16_t timeout_ms);
 static void comm_ctrl_preiod_timer_start(comm_ctrl_t *comm_ctrl, uint16_t period_ms);
 static void comm_ctrl_timeout_timer_stop(comm_ctrl_t *comm_ctrl);
 /* thread-safe wrappers removed; callers use queue->mutex + comm_cmd_queue_* */
-static comm_result_t comm_ctrl_load_data_to_cmd(comm_data_t* data, comm_type_t type,comm_cmd_t* cmd ,bool is_reset_retry);
+static comm_result_t comm_ctrl_load_data_to_cmd(const comm_table_t *table, comm_data_t* data, comm_type_t type,comm_cmd_t* cmd ,bool is_reset_retry);
 static void comm_ctrl_preiod_timer_stop(comm_ctrl_t *comm_ctrl);
 static comm_result_t comm_ctrl_send_msg(comm_ctrl_t *comm_ctrl, message_t *msg);
+static comm_result_t comm_ctrl_send_owned_msg(comm_ctrl_t *comm_ctrl, message_t *msg);
 /* Recv buffer pool function declarations */
-static comm_result_t comm_ctrl_recv_pool_init(recv_buffer_pool_t *pool);
+static comm_result_t comm_ctrl_recv_pool_init(recv_buffer_pool_t *pool, osMutexId_t lock);
 static comm_result_t comm_ctrl_recv_pool_alloc_idle(recv_buffer_pool_t *pool, uint8_t *out_idx);
 static comm_result_t comm_ctrl_recv_pool_free_idle(recv_buffer_pool_t *pool, uint8_t idx);
 static comm_result_t comm_ctrl_recv_pool_pop_recv(recv_buffer_pool_t *pool, uint8_t *out_idx);
@@ -58,12 +65,133 @@ static comm_result_t comm_ctrl_recv_pool_push_ready(recv_buffer_pool_t *pool, ui
 static comm_data_t* comm_ctrl_recv_pool_get_buf(recv_buffer_pool_t *pool, uint8_t idx);
 static void comm_ctrl_fsm_actrion_send_cycle(void* handle);
 static comm_result_t comm_ctrl_send_cmd(comm_ctrl_t *comm_ctrl);
+static comm_buf_t *comm_ctrl_encode_frame(comm_ctrl_t *comm_ctrl, uint8_t cmd_id, const uint8_t *data, uint8_t len);
+static void comm_ctrl_cycle_timer_start_once(comm_ctrl_t *comm_ctrl, uint16_t delay_ms);
+static const msg_dispatch_t *comm_ctrl_msg_dispatch_build(void);
+
+typedef enum{
+    COMM_CTRL_STAT_SENT = 0,
+    COMM_CTRL_STAT_RESP,
+    COMM_CTRL_STAT_TIMEOUT,
+    COMM_CTRL_STAT_RETRY,
+    COMM_CTRL_STAT_EXHAUSTED,
+    COMM_CTRL_STAT_REJECTED,
+}comm_ctrl_stat_t;
+
+/* MESSAGE_ID_COMM_UPDATE_PERIOD_CMD 携带的负载 */
+typedef struct{
+    comm_data_t cmd;
+    uint32_t seq;       /* comm_ctrl_t.period_seq at the time of the call */
+}comm_ctrl_period_update_t;
+
+/* 统计块无锁：计数在控制器线程更新（rejected 在接收线程），快照逐项原子读取 */
+static void comm_ctrl_stats_event(comm_ctrl_t *comm_ctrl, comm_ctrl_stat_t stat, uint8_t cmd_id, uint32_t latency)
+{
+    comm_stats_t *stats = comm_ctrl->stats;
+
+    if (stats == NULL)
+    {
+        return;
+    }
+    switch (stat)
+    {
+        case COMM_CTRL_STAT_SENT:
+            comm_stats_on_sent(stats, cmd_id);
+            break;
+        case COMM_CTRL_STAT_RESP:
+            comm_stats_on_resp(stats, cmd_id, latency);
+            break;
+        case COMM_CTRL_STAT_TIMEOUT:
+            comm_stats_on_timeout(stats, cmd_id);
+            break;
+        case COMM_CTRL_STAT_RETRY:
+            comm_stats_on_retry(stats, cmd_id);
+            break;
+        case COMM_CTRL_STAT_REJECTED:
+            comm_stats_on_rejected(stats);
+            break;
+        case COMM_CTRL_STAT_EXHAUSTED:
+        default:
+            comm_stats_on_exhausted(stats, cmd_id);
+            break;
+    }
+}
+
+/*
+ * Closed-loop modes: called once the current command is finished (response
+ * handled or timed out) to schedule the next send. The FIXED mode is driven
+ * by the periodic timer only.
+ *
+ * BACK_TO_BACK waits poll_interval after a response, the slave's turnaround
+ * time, however long the response took; after a timeout the slave has been
+ * silent long enough, so it sends again right away. RESP_TO_SEND always
+ * waits the full poll_interval after the response or timeout.
+ */
+static void comm_ctrl_schedule_next_cycle(comm_ctrl_t *comm_ctrl, bool responded)
+{
+    uint16_t delay = 0U;
+
+    switch (comm_ctrl->poll_mode)
+    {
+        case COMM_POLL_MODE_BACK_TO_BACK:
+            delay = responded ? comm_ctrl->poll_interval : 0U;
+            break;
+        case COMM_POLL_MODE_RESP_TO_SEND:
+            delay = comm_ctrl->poll_interval;
+            break;
+        case COMM_POLL_MODE_FIXED:
+        default:
+            return;
+    }
+    if (delay == 0U)
+    {
+        /* handled by the same fsm_poll() once the state is back to IDLE */
+        fsm_send_event(&comm_ctrl->fsm, COMM_CTRL_EVENT_SEND_CYCLE);
+    }
+    else
+    {
+        comm_ctrl_cycle_timer_start_once(comm_ctrl, delay);
+    }
+}
+
+/* 脚本结束（完成或失败）：解除挂接并通知应用 */
+static void comm_ctrl_script_end(comm_ctrl_t *comm_ctrl)
+{
+    comm_script_t *script = comm_ctrl->script;
+
+    comm_ctrl->script = NULL;
+    comm_ctrl->cur_cmd.cmd_type = COMM_TYPE_NONE;
+    if(script != NULL && script->done_cb != NULL)
+    {
+        script->done_cb(script->cb_ctx, script);
+    }
+}
+
+/*
+ * A script step finished (response or timeout). Returns true if the next
+ * attempt was raised right away, false once the script has ended.
+ */
+static bool comm_ctrl_script_continue(comm_ctrl_t *comm_ctrl)
+{
+    if(comm_script_get_state(comm_ctrl->script) == COMM_SCRIPT_STATE_RUNNING)
+    {
+        fsm_send_event(&comm_ctrl->fsm, COMM_CTRL_EVENT_SEND_CYCLE);
+        return true;
+    }
+    DEBUG("script finished, state %d\n", comm_script_get_state(comm_ctrl->script));
+    comm_ctrl_script_end(comm_ctrl);
+    return false;
+}
+
 static void comm_ctrl_fsm_actrion_start(void* handle)
 {
     DEBUG("comm ctrl fsm started\n");
     comm_ctrl_t *comm_ctrl = (comm_ctrl_t *)handle;
     comm_ctrl->cur_cmd.cmd_type = COMM_TYPE_NONE;
-    comm_ctrl_preiod_timer_start(comm_ctrl, 50); /* Start period timer with 1s period */
+    if (comm_ctrl->poll_mode == COMM_POLL_MODE_FIXED)
+    {
+        comm_ctrl_preiod_timer_start(comm_ctrl, comm_ctrl->poll_interval);
+    }
     fsm_send_event(&comm_ctrl->fsm, COMM_CTRL_EVENT_SEND_CYCLE);
 }
 
@@ -82,31 +210,52 @@ static void comm_ctrl_fsm_actrion_recv_resp(void* handle)
     comm_ctrl_t *comm_ctrl = (comm_ctrl_t *)handle;
     comm_ctrl_timeout_timer_stop(comm_ctrl); /* Stop timeout timer */
     comm_ctrl->cur_cmd.is_timeout = false;
-    comm_ctrl->cur_cmd.retry_count = 4U;
-        DEBUG("timeout count : %d\n", timeout_cnt);
+    if(comm_ctrl->cur_cmd.cmd_type == COMM_TYPE_SCRIPT && comm_ctrl_script_continue(comm_ctrl))
+    {
+        return;
+    }
+    comm_ctrl_schedule_next_cycle(comm_ctrl, true);
 }
 
 static void comm_ctrl_fsm_actrion_resp_timeout(void* handle)
 {
     DEBUG("comm ctrl fsm resp timeout\n");
     comm_ctrl_t *comm_ctrl = (comm_ctrl_t *)handle;
-    // if((--comm_ctrl->cur_cmd.retry_count) > 0U)
-    // {
-    //     comm_ctrl->cur_cmd.is_timeout = true;
-    //     DEBUG("retry send command, remaining retry count: %u\n", comm_ctrl->cur_cmd.retry_count);
-    // }
-    // else
-    // {
-    //     fsm_send_event(&comm_ctrl->fsm, COMM_CTRL_EVENT_ERROR);
-    //     DEBUG("command retry exhausted\n");
-    // }
-    if((comm_ctrl->cur_cmd.retry_count) > 0U)
+    uint8_t cmd_id = comm_ctrl->cur_cmd.send_cmd_id;
+    comm_ctrl_stats_event(comm_ctrl, COMM_CTRL_STAT_TIMEOUT, cmd_id, 0U);
+    if(comm_ctrl->cur_cmd.cmd_type == COMM_TYPE_SCRIPT)
+    {
+        if(comm_script_on_timeout(comm_ctrl->script, osKernelGetTickCount()) == COMM_SCRIPT_STATE_RUNNING)
+        {
+            comm_ctrl_stats_event(comm_ctrl, COMM_CTRL_STAT_RETRY, cmd_id, 0U);
+        }
+        else
+        {
+            comm_ctrl_stats_event(comm_ctrl, COMM_CTRL_STAT_EXHAUSTED, cmd_id, 0U);
+        }
+        if(!comm_ctrl_script_continue(comm_ctrl))
+        {
+            comm_ctrl_schedule_next_cycle(comm_ctrl, false);
+        }
+        return;
+    }
+    /* 单次命令按 comm_table 的重试次数重发，周期命令在下个周期重新发送 */
+    if(comm_ctrl->cur_cmd.cmd_type == COMM_TYPE_SINGLE)
     {
-        comm_ctrl->cur_cmd.is_timeout = true;
-        DEBUG("retry send command, remaining retry count: %u\n", comm_ctrl->cur_cmd.retry_count);
+        if(comm_ctrl->cur_cmd.retry_count > 0U)
+        {
+            comm_ctrl->cur_cmd.retry_count--;
+            comm_ctrl->cur_cmd.is_timeout = true;
+            comm_ctrl_stats_event(comm_ctrl, COMM_CTRL_STAT_RETRY, cmd_id, 0U);
+            DEBUG("retry send command, remaining retry count: %u\n", comm_ctrl->cur_cmd.retry_count);
+        }
+        else
+        {
+            comm_ctrl_stats_event(comm_ctrl, COMM_CTRL_STAT_EXHAUSTED, cmd_id, 0U);
+            DEBUG("command 0x%02X retry exhausted, dropped\n", cmd_id);
+        }
     }
-    timeout_cnt++;
-    DEBUG("timeout count : %d\n", timeout_cnt);
+    comm_ctrl_schedule_next_cycle(comm_ctrl, false);
 }
 
 static void comm_ctrl_fsm_actrion_error(void* handle)
@@ -127,172 +276,145 @@ static const struct fsm_transition comm_ctrl_fsm_transitions[] = {
 };
 #define COMM_CTRL_FSM_TRANSITIONS_SIZE   (sizeof(comm_ctrl_fsm_transitions) / sizeof(comm_ctrl_fsm_transitions[0]))
 
+/* 所有控制器共用同一张跳转表，由 comm_ctrl_tables_init() 编译一次 */
+static struct fsm_cell comm_ctrl_fsm_cells[COMM_CTRL_STATE_MAX * COMM_CTRL_EVENT_MAX];
+static fsm_jump_t comm_ctrl_fsm_jump;
 
+/* 周期、超时等事件重复挂起时合并，RECV_RESP 逐个入队，不会被挤掉 */
+#define COMM_CTRL_FSM_COALESCE_MASK     ((1UL << COMM_CTRL_EVENT_START) | (1UL << COMM_CTRL_EVENT_SEND_CYCLE) | \
+                                         (1UL << COMM_CTRL_EVENT_RECV_TIMEOUT) | (1UL << COMM_CTRL_EVENT_ERROR) | \
+                                         (1UL << COMM_CTRL_EVENT_RESTART))
 
-/************************************************************************************/
-static comm_result_t comm_ctrl_recv_pool_init(recv_buffer_pool_t *pool)
+static const fsm_jump_t *comm_ctrl_fsm_jump_build(void)
 {
-    if (pool == NULL)
-    {
-        return COMM_ERROR;
-    }
-    memset(pool, 0, sizeof(recv_buffer_pool_t));
-    pool->idle_queue = osMessageQueueNew(COMM_RECV_DATA_QUEUE_SIZE, sizeof(uint8_t), NULL);
-    if(pool->idle_queue == NULL)
-    {
-        return COMM_ERROR;
-    }
-    pool->recv_queue = osMessageQueueNew(COMM_RECV_DATA_QUEUE_SIZE, sizeof(uint8_t), NULL);
-    if(pool->recv_queue == NULL)
-    {
-        osMessageQueueDelete(pool->idle_queue);
-        return COMM_ERROR;
-    }
-    pool->ready_queue = osMessageQueueNew(COMM_RECV_DATA_QUEUE_SIZE, sizeof(uint8_t), NULL);
-    if(pool->ready_queue == NULL)
-    {
-        osMessageQueueDelete(pool->idle_queue);
-        osMessageQueueDelete(pool->recv_queue);
-        return COMM_ERROR;
-    }
-    for(uint8_t i = 0U; i < COMM_RECV_DATA_QUEUE_SIZE; i++)
+    fsm_compile_result_t result = FSM_COMPILE_OK;
+    size_t bad_index = 0U;
+
+    result = fsm_compile(&comm_ctrl_fsm_jump, comm_ctrl_fsm_transitions, COMM_CTRL_FSM_TRANSITIONS_SIZE,
+                         comm_ctrl_fsm_cells, COMM_CTRL_STATE_MAX, COMM_CTRL_EVENT_MAX, &bad_index);
+    if (result != FSM_COMPILE_OK)
     {
-        osMessageQueuePut(pool->idle_queue, &i, 0U, 0U);
+        /* keep the linear scan, the table needs fixing */
+        DEBUG("comm ctrl fsm table entry %u rejected: %d\n", (unsigned)bad_index, (int)result);
+        return NULL;
     }
-    return COMM_OK;
+    return &comm_ctrl_fsm_jump;
 }
 
-static comm_result_t comm_ctrl_recv_pool_deinit(recv_buffer_pool_t *pool)
+
+
+/************************************************************************************/
+/* 索引环形队列操作，调用者需持有 pool->lock */
+static bool comm_ctrl_index_ring_put(recv_index_ring_t *ring, uint8_t idx)
 {
-    if (pool == NULL)
+    if (ring->count >= COMM_RECV_DATA_QUEUE_SIZE)
     {
-        return COMM_ERROR;
+        return false;
     }
-    osMessageQueueDelete(pool->idle_queue);
-    osMessageQueueDelete(pool->recv_queue);
-    osMessageQueueDelete(pool->ready_queue);
-    pool->idle_queue = NULL;
-    pool->recv_queue = NULL;
-    pool->ready_queue = NULL;
-    return COMM_OK;
+    ring->idx[(ring->head + ring->count) % COMM_RECV_DATA_QUEUE_SIZE] = idx;
+    ring->count++;
+    return true;
 }
 
-/* 从 idle 队列获取一个可用索引 */
-static comm_result_t comm_ctrl_recv_pool_alloc_idle(recv_buffer_pool_t *pool, uint8_t *out_idx)
+static bool comm_ctrl_index_ring_get(recv_index_ring_t *ring, uint8_t *out_idx)
 {
-    uint8_t idx = (uint8_t)0xFFU;
-    osStatus_t status;
-    comm_result_t result = COMM_ERROR;
-
-    if ((pool == NULL) || (out_idx == NULL))
-    {
-        return COMM_ERROR;
-    }
-    status = osMessageQueueGet(pool->idle_queue, &idx, NULL, 0U);
-    if (status == osOK)
+    if (ring->count == 0U)
     {
-        *out_idx = idx;
-        result = COMM_OK;
+        return false;
     }
-    return result;
+    *out_idx = ring->idx[ring->head];
+    ring->head = (uint8_t)((ring->head + 1U) % COMM_RECV_DATA_QUEUE_SIZE);
+    ring->count--;
+    return true;
 }
 
-/* 将索引归还到 idle 队列 */
-static comm_result_t comm_ctrl_recv_pool_free_idle(recv_buffer_pool_t *pool, uint8_t idx)
+static comm_result_t comm_ctrl_recv_pool_put(recv_buffer_pool_t *pool, recv_index_ring_t *ring, uint8_t idx)
 {
-    osStatus_t status;
     comm_result_t result = COMM_ERROR;
 
     if (pool == NULL || idx >= COMM_RECV_DATA_QUEUE_SIZE)
     {
         return COMM_ERROR;
     }
-
-    status = osMessageQueuePut(pool->idle_queue, &idx, 0U, 0U);
-    if (status == osOK)
+    if (osMutexAcquire(pool->lock, osWaitForever) == osOK)
     {
-        result = COMM_OK;
+        if (comm_ctrl_index_ring_put(ring, idx))
+        {
+            result = COMM_OK;
+        }
+        (void)osMutexRelease(pool->lock);
     }
-
     return result;
 }
 
-/* 从 recv 队列取出一个索引 */
-static comm_result_t comm_ctrl_recv_pool_pop_recv(recv_buffer_pool_t *pool, uint8_t *out_idx)
+static comm_result_t comm_ctrl_recv_pool_get(recv_buffer_pool_t *pool, recv_index_ring_t *ring, uint8_t *out_idx)
 {
-    uint8_t idx = (uint8_t)0xFFU;
-    osStatus_t status;
     comm_result_t result = COMM_ERROR;
 
     if ((pool == NULL) || (out_idx == NULL))
     {
         return COMM_ERROR;
     }
-    status = osMessageQueueGet(pool->recv_queue, &idx, NULL, 0U);
-    if (status == osOK)
+    if (osMutexAcquire(pool->lock, osWaitForever) == osOK)
     {
-        *out_idx = idx;
-        result = COMM_OK;
+        if (comm_ctrl_index_ring_get(ring, out_idx))
+        {
+            result = COMM_OK;
+        }
+        (void)osMutexRelease(pool->lock);
     }
     return result;
 }
 
-/* 将索引放入 recv 队列（入队） */
-static comm_result_t comm_ctrl_recv_pool_push_recv(recv_buffer_pool_t *pool, uint8_t idx)
+static comm_result_t comm_ctrl_recv_pool_init(recv_buffer_pool_t *pool, osMutexId_t lock)
 {
-    osStatus_t status;
-    comm_result_t result = COMM_ERROR;
-
-    if (pool == NULL || idx >= COMM_RECV_DATA_QUEUE_SIZE)
+    if (pool == NULL || lock == NULL)
     {
         return COMM_ERROR;
     }
-    status = osMessageQueuePut(pool->recv_queue, &idx, 0U, 0U);
-    if (status == osOK)
+    memset(pool, 0, sizeof(recv_buffer_pool_t));
+    pool->lock = lock;
+    for(uint8_t i = 0U; i < COMM_RECV_DATA_QUEUE_SIZE; i++)
     {
-        result = COMM_OK;
+        (void)comm_ctrl_index_ring_put(&pool->idle_queue, i);
     }
+    return COMM_OK;
+}
 
-    return result;
+/* 从 idle 队列获取一个可用索引 */
+static comm_result_t comm_ctrl_recv_pool_alloc_idle(recv_buffer_pool_t *pool, uint8_t *out_idx)
+{
+    return comm_ctrl_recv_pool_get(pool, &pool->idle_queue, out_idx);
 }
 
-/* 从 ready 队列取出一个索引 */
-static comm_result_t comm_ctrl_recv_pool_pop_ready(recv_buffer_pool_t *pool, uint8_t *out_idx)
+/* 将索引归还到 idle 队列 */
+static comm_result_t comm_ctrl_recv_pool_free_idle(recv_buffer_pool_t *pool, uint8_t idx)
 {
-    uint8_t idx = (uint8_t)0xFFU;
-    osStatus_t status;
-    comm_result_t result = COMM_ERROR;
+    return comm_ctrl_recv_pool_put(pool, &pool->idle_queue, idx);
+}
 
-    if ((pool == NULL) || (out_idx == NULL))
-    {
-        return COMM_ERROR;
-    }
-    status = osMessageQueueGet(pool->ready_queue, &idx, NULL, 0U);
-    if (status == osOK)
-    {
-        *out_idx = idx;
-        result = COMM_OK;
-    }
-    return result;
+/* 从 recv 队列取出一个索引 */
+static comm_result_t comm_ctrl_recv_pool_pop_recv(recv_buffer_pool_t *pool, uint8_t *out_idx)
+{
+    return comm_ctrl_recv_pool_get(pool, &pool->recv_queue, out_idx);
 }
 
 /* 将索引放入 recv 队列（入队） */
-static comm_result_t comm_ctrl_recv_pool_push_ready(recv_buffer_pool_t *pool, uint8_t idx)
+static comm_result_t comm_ctrl_recv_pool_push_recv(recv_buffer_pool_t *pool, uint8_t idx)
 {
-    osStatus_t status;
-    comm_result_t result = COMM_ERROR;
+    return comm_ctrl_recv_pool_put(pool, &pool->recv_queue, idx);
+}
 
-    if (pool == NULL || idx >= COMM_RECV_DATA_QUEUE_SIZE)
-    {
-        return COMM_ERROR;
-    }
-    status = osMessageQueuePut(pool->ready_queue, &idx, 0U, 0U);
-    if (status == osOK)
-    {
-        result = COMM_OK;
-    }
+/* 从 ready 队列取出一个索引 */
+static comm_result_t comm_ctrl_recv_pool_pop_ready(recv_buffer_pool_t *pool, uint8_t *out_idx)
+{
+    return comm_ctrl_recv_pool_get(pool, &pool->ready_queue, out_idx);
+}
 
-    return result;
+/* 将索引放入 ready 队列（入队） */
+static comm_result_t comm_ctrl_recv_pool_push_ready(recv_buffer_pool_t *pool, uint8_t idx)
+{
+    return comm_ctrl_recv_pool_put(pool, &pool->ready_queue, idx);
 }
 
 /* 根据索引(id)获取缓冲区指针 */
@@ -312,106 +434,110 @@ static comm_data_t* comm_ctrl_recv_pool_get_buf(recv_buffer_pool_t *pool, uint8_
 
 /************************************************************************************/
 
-static void comm_ctrl_timeout_timer_callback(void* argument)
+/*
+ * Timer expiry. A standalone controller's timers run on the service wheel's
+ * thread and post a message to the controller thread; a shared
+ * controller's timers run on its worker thread, which already owns the
+ * controller, so the message is dispatched directly.
+ */
+static void comm_ctrl_timer_fire(comm_ctrl_t *comm_ctrl, uint32_t msg_id, uint32_t seq)
 {
-    //send message
-    DEBUG("time callback : timeout\n");
-    comm_ctrl_t *comm_ctrl = (comm_ctrl_t *)argument;
     message_t msg;
-    msg.msg_id = MESSAGE_ID_COMM_SEND_TIMEOUT;
+    msg.msg_id = msg_id;
     msg.msg_data = NULL;
-    msg.msg_len = 0;
-    comm_ctrl_send_msg(comm_ctrl, &msg);
+    msg.msg_len = seq;  /* no payload, msg_len carries the sequence */
+    if(comm_ctrl->is_shared)
+    {
+        (void)comm_ctrl_dispatch(comm_ctrl, &msg);
+    }
+    else
+    {
+        comm_ctrl_send_msg(comm_ctrl, &msg);
+    }
 }
 
-static void comm_ctrl_timeout_timer_init(comm_ctrl_t *comm_ctrl)
+static void comm_ctrl_timeout_timer_callback(void* argument)
 {
-    //init timer
-    comm_ctrl->timeout_timer = osTimerNew(comm_ctrl_timeout_timer_callback, osTimerOnce, (void *)comm_ctrl, NULL);
+    DEBUG("time callback : timeout\n");
+    comm_ctrl_t *comm_ctrl = (comm_ctrl_t *)argument;
+    comm_ctrl_timer_fire(comm_ctrl, MESSAGE_ID_COMM_SEND_TIMEOUT,
+                         __atomic_load_n(&comm_ctrl->timeout_seq, __ATOMIC_ACQUIRE));
 }
 
+/*
+ * A timeout already posted when the timer is stopped or restarted still
+ * reaches the controller; every start and stop bumps timeout_seq so
+ * comm_ctrl_send_timeout can tell that message from the current one.
+ */
 static void comm_ctrl_timeout_timer_start(comm_ctrl_t *comm_ctrl, uint16_t timeout_ms)
 {
-    //start timer
-    if(comm_ctrl != NULL && comm_ctrl->timeout_timer != NULL)
+    if(comm_ctrl != NULL)
     {
-        osTimerStart(comm_ctrl->timeout_timer, timeout_ms);
+        __atomic_store_n(&comm_ctrl->timeout_seq, comm_ctrl->timeout_seq + 1U, __ATOMIC_RELEASE);
+        comm_timer_start(comm_ctrl->wheel, &comm_ctrl->timeout_timer, timeout_ms, false);
     }
 }   
 
 static void comm_ctrl_timeout_timer_stop(comm_ctrl_t *comm_ctrl)
 {
-    //stop timer
-    if(comm_ctrl != NULL && comm_ctrl->timeout_timer != NULL)
-    {
-        osTimerStop(comm_ctrl->timeout_timer);
-    }
-}
-
-static void comm_ctrl_timeout_timer_restart(comm_ctrl_t *comm_ctrl, uint16_t timeout_ms)
-{
-    //restart timer
-    if(comm_ctrl != NULL && comm_ctrl->timeout_timer != NULL)
+    if(comm_ctrl != NULL)
     {
-        osTimerStop(comm_ctrl->timeout_timer);
-        osTimerStart(comm_ctrl->timeout_timer, timeout_ms);
+        comm_timer_stop(comm_ctrl->wheel, &comm_ctrl->timeout_timer);
+        __atomic_store_n(&comm_ctrl->timeout_seq, comm_ctrl->timeout_seq + 1U, __ATOMIC_RELEASE);
     }
 }
 
 static void comm_ctrl_preiod_timer_callback(void* argument)
 {
-    //send message
     DEBUG("time callback : period timer\n");
-    comm_ctrl_t *comm_ctrl = (comm_ctrl_t *)argument;
-    message_t msg;
-    msg.msg_id = MESSAGE_ID_COMM_SEND_CYCLE;
-    msg.msg_data = NULL;
-    msg.msg_len = 0;
-    comm_ctrl_send_msg(comm_ctrl, &msg);
+    comm_ctrl_timer_fire((comm_ctrl_t *)argument, MESSAGE_ID_COMM_SEND_CYCLE, 0U);
 }
 
-static void comm_ctrl_preiod_timer_init(comm_ctrl_t *comm_ctrl)
+static void comm_ctrl_timers_init(comm_ctrl_t *comm_ctrl, comm_timer_wheel_t *wheel)
 {
-    //init timer
-    comm_ctrl->preiod_timer = osTimerNew(comm_ctrl_preiod_timer_callback, osTimerPeriodic, (void *)comm_ctrl, NULL);
-
+    comm_ctrl->wheel = wheel;
+    comm_timer_init(&comm_ctrl->timeout_timer, comm_ctrl_timeout_timer_callback, (void *)comm_ctrl);
+    comm_timer_init(&comm_ctrl->preiod_timer, comm_ctrl_preiod_timer_callback, (void *)comm_ctrl);
 }
 
 static void comm_ctrl_preiod_timer_start(comm_ctrl_t *comm_ctrl, uint16_t period_ms)
 {
-    //start timer
-    if(comm_ctrl != NULL && comm_ctrl->preiod_timer != NULL)
+    if(comm_ctrl != NULL)
     {
-        osTimerStart(comm_ctrl->preiod_timer, period_ms);
+        comm_timer_start(comm_ctrl->wheel, &comm_ctrl->preiod_timer, period_ms, true);
     }
 }
 
 static void comm_ctrl_preiod_timer_stop(comm_ctrl_t *comm_ctrl)
 {
-    //stop timer
-    if(comm_ctrl != NULL && comm_ctrl->preiod_timer != NULL)
+    if(comm_ctrl != NULL)
     {
-        osTimerStop(comm_ctrl->preiod_timer);
+        comm_timer_stop(comm_ctrl->wheel, &comm_ctrl->preiod_timer);
     }
 }
 
-static void comm_ctrl_preiod_timer_restart(comm_ctrl_t *comm_ctrl, uint16_t period_ms)
+/* One-shot use of the period timer for the closed-loop modes */
+static void comm_ctrl_cycle_timer_start_once(comm_ctrl_t *comm_ctrl, uint16_t delay_ms)
 {
-    //restart timer
-    if(comm_ctrl != NULL && comm_ctrl->preiod_timer != NULL)
+    if(comm_ctrl != NULL)
     {
-        osTimerStop(comm_ctrl->preiod_timer);
-        osTimerStart(comm_ctrl->preiod_timer, period_ms);
+        comm_timer_start(comm_ctrl->wheel, &comm_ctrl->preiod_timer, delay_ms, false);
     }
 }
 
-static void comm_ctrl_set_period_command(comm_ctrl_t *comm_ctrl, comm_data_t *cmd)
+/* 周期命令更新带序号，只接受比当前更新的，队列里滞后的旧更新被忽略 */
+static void comm_ctrl_set_period_command(comm_ctrl_t *comm_ctrl, const comm_data_t *cmd, uint32_t seq)
 {
     if ((comm_ctrl != NULL) && (cmd != NULL))
     {
         if (osMutexAcquire(comm_ctrl->mutex, osWaitForever) == osOK)
         {
-            memcpy(&comm_ctrl->period_cmd, cmd, sizeof(comm_data_t));
+            if ((int32_t)(seq - comm_ctrl->period_seq_applied) > 0)
+            {
+                memcpy(&comm_ctrl->period_cmd, cmd, sizeof(comm_data_t));
+                comm_ctrl->period_seq_applied = seq;
+                comm_ctrl->period_changed = true;   /* re-encode on the next cycle */
+            }
 
             (void)osMutexRelease(comm_ctrl->mutex);
         }
@@ -431,23 +557,65 @@ static void comm_ctrl_get_period_command(comm_ctrl_t *comm_ctrl, comm_data_t *cm
     }
 }
 
-static comm_result_t comm_ctrl_load_data_to_cmd(comm_data_t* data, comm_type_t type,comm_cmd_t* cmd ,bool is_reset_retry)
+static comm_result_t comm_ctrl_load_data_to_cmd(const comm_table_t *table, comm_data_t* data, comm_type_t type,comm_cmd_t* cmd ,bool is_reset_retry)
 {
+    const comm_cmd_table_t *entry = NULL;
+
     if(data == NULL || cmd == NULL)
     {
         return COMM_ERROR;
     }
     cmd->send_cmd_id = data->comm_id;
     memcpy(&cmd->send_data, data, sizeof(comm_data_t));
+    entry = comm_table_lookup_send(table, data->comm_id);
+    cmd->timeout = (entry != NULL) ? entry->timeout : COMM_CTRL_DEFAULT_TIMEOUT;
     if(is_reset_retry)
     {
-        cmd->retry_count = 4;
+        cmd->retry_count = (entry != NULL) ? entry->retry_count : COMM_CTRL_DEFAULT_RETRY;
     }
     cmd->is_timeout = false;
     cmd->cmd_type = type;
     return COMM_OK;
 }
 
+/* 共用表的编译状态：0 未编译，1 编译中，2 完成；并发调用者等待第一个完成 */
+static uint8_t comm_ctrl_tables_state = 0U;
+static const fsm_jump_t *comm_ctrl_fsm_jump_table = NULL;
+static const msg_dispatch_t *comm_ctrl_msg_dispatch_table = NULL;
+
+void comm_ctrl_tables_init(void)
+{
+    uint8_t expected = 0U;
+
+    if (__atomic_load_n(&comm_ctrl_tables_state, __ATOMIC_ACQUIRE) == 2U)
+    {
+        return;
+    }
+    if (__atomic_compare_exchange_n(&comm_ctrl_tables_state, &expected, 1U, false,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+    {
+        comm_table_init();
+        comm_ctrl_fsm_jump_table = comm_ctrl_fsm_jump_build();
+        comm_ctrl_msg_dispatch_table = comm_ctrl_msg_dispatch_build();
+        __atomic_store_n(&comm_ctrl_tables_state, 2U, __ATOMIC_RELEASE);
+        return;
+    }
+    while (__atomic_load_n(&comm_ctrl_tables_state, __ATOMIC_ACQUIRE) != 2U)
+    {
+    }
+}
+
+/* 两种初始化共用：状态机与消息分发表（编译一次，所有控制器共用） */
+static void comm_ctrl_init_tables(comm_ctrl_t *comm_ctrl)
+{
+    comm_ctrl_tables_init();
+    fsm_init(&comm_ctrl->fsm, comm_ctrl_fsm_transitions,
+             COMM_CTRL_FSM_TRANSITIONS_SIZE, COMM_CTRL_STATE_NONE,
+             (void *)comm_ctrl);
+    fsm_use_jump_table(&comm_ctrl->fsm, comm_ctrl_fsm_jump_table);
+    fsm_set_coalesce(&comm_ctrl->fsm, COMM_CTRL_FSM_COALESCE_MASK);
+    comm_ctrl->msg_dispatch = comm_ctrl_msg_dispatch_table;
+}
 
 comm_result_t comm_ctrl_init(comm_ctrl_t *comm_ctrl)
 {
@@ -455,25 +623,42 @@ comm_result_t comm_ctrl_init(comm_ctrl_t *comm_ctrl)
     
     if (comm_ctrl != NULL)
     {
-        comm_ctrl->msg_queue = mesasge_queue_create(16U);
-        /* Initialize FSM */
-        fsm_init(&comm_ctrl->fsm, comm_ctrl_fsm_transitions, 
-                 COMM_CTRL_FSM_TRANSITIONS_SIZE, COMM_CTRL_STATE_NONE, 
-                 (void *)comm_ctrl);
-        fsm_create_event_queue(&comm_ctrl->fsm, 4U);
-        /* Single command queue: initialize (creates its own mutex) */
-        comm_ctrl->single_cmd_queue = osMessageQueueNew(COMM_SINGLE_CMD_QUEUE_SIZE, sizeof(comm_cmd_t), NULL);
-        if(comm_ctrl->single_cmd_queue == NULL)
+        comm_ctrl->is_shared = false;
+        comm_ctrl->link_id = 0U;
+        /* only the thread running comm_ctrl_process() receives */
+        comm_ctrl->msg_queue = message_queue_create_backend(16U, MSG_BACKEND_MPSC);
+        comm_ctrl_init_tables(comm_ctrl);
+        fsm_create_mpsc_event_queue(&comm_ctrl->fsm, COMM_CTRL_FSM_EVENT_SIZE);
+        comm_ctrl->mutex = osMutexNew(NULL);
+        /* events posted without a queue would be lost silently */
+        if(comm_ctrl->msg_queue == NULL || comm_ctrl->fsm.event_ring == NULL || comm_ctrl->mutex == NULL)
         {
             return COMM_ERROR;
         }
+        /* Single command ring shares the controller mutex */
+        memset(&comm_ctrl->single_cmd_queue, 0, sizeof(single_buffer_pool_t));
+        comm_ctrl_recv_pool_init(&comm_ctrl->recv_pool, comm_ctrl->mutex);
 
-        comm_ctrl_recv_pool_init(&comm_ctrl->recv_pool);
-
-        comm_ctrl->mutex = osMutexNew(NULL);
-        comm_ctrl_timeout_timer_init(comm_ctrl);
-        comm_ctrl_preiod_timer_init(comm_ctrl);
+        comm_ctrl_timers_init(comm_ctrl, comm_timer_default_wheel());
+        if(comm_ctrl->wheel == NULL)
+        {
+            return COMM_ERROR;
+        }
         comm_ctrl->period_cmd.comm_len = 1U; /* No period command initially */
+        comm_ctrl->poll_mode = COMM_POLL_MODE_FIXED;
+        comm_ctrl->poll_interval = COMM_CTRL_DEFAULT_PERIOD_MS;
+        comm_ctrl->send_buf_func = NULL;
+        comm_ctrl->tx_pool = comm_buf_default_pool();
+        comm_ctrl->cur_cmd.frame = NULL;
+        comm_ctrl->period_changed = false;
+        comm_ctrl->period_seq = 0U;
+        comm_ctrl->period_seq_applied = 0U;
+        comm_ctrl->cache = NULL;
+        comm_ctrl->table = NULL;
+        comm_ctrl->bulk = NULL;
+        comm_ctrl->script = NULL;
+        comm_ctrl->stats = NULL;
+        ret = COMM_OK;
     }
     else
     {
@@ -483,46 +668,175 @@ comm_result_t comm_ctrl_init(comm_ctrl_t *comm_ctrl)
     return ret;
 }
 
-comm_result_t comm_ctrl_set_send_func(comm_ctrl_t *comm_ctrl, comm_send_func_t send_func)
+/*
+ * Shared mode: the controller posts into the owner's message queue and uses
+ * the owner's mutex. Timers live on the owner's wheel, which the owner
+ * advances on its own thread, and FSM events go to an inline ring, so no
+ * RTOS object is created per controller.
+ */
+comm_result_t comm_ctrl_init_shared(comm_ctrl_t *comm_ctrl, const comm_ctrl_shared_t *shared)
+{
+    if (comm_ctrl == NULL || shared == NULL || shared->msg_queue == NULL || shared->mutex == NULL ||
+        shared->wheel == NULL)
+    {
+        return COMM_ERROR;
+    }
+    memset(comm_ctrl, 0, sizeof(comm_ctrl_t));
+    comm_ctrl->is_shared = true;
+    comm_ctrl->link_id = shared->link_id;
+    comm_ctrl->msg_queue = shared->msg_queue;
+    comm_ctrl->mutex = shared->mutex;
+    comm_ctrl_timers_init(comm_ctrl, shared->wheel);
+    comm_ctrl_init_tables(comm_ctrl);
+    fsm_attach_local_event_ring(&comm_ctrl->fsm, comm_ctrl->fsm_events, COMM_CTRL_FSM_EVENT_SIZE);
+    comm_ctrl_recv_pool_init(&comm_ctrl->recv_pool, comm_ctrl->mutex);
+    comm_ctrl->period_cmd.comm_len = 1U; /* No period command initially */
+    comm_ctrl->poll_mode = COMM_POLL_MODE_FIXED;
+    comm_ctrl->poll_interval = COMM_CTRL_DEFAULT_PERIOD_MS;
+    comm_ctrl->tx_pool = comm_buf_default_pool();
+    return COMM_OK;
+}
+
+comm_result_t comm_ctrl_set_send_buf_func(comm_ctrl_t *comm_ctrl, comm_send_buf_func_t send_buf_func, void *ctx)
+{
+    comm_result_t ret = COMM_ERROR;
+    if (comm_ctrl != NULL && send_buf_func != NULL && comm_ctrl->tx_pool != NULL)
+    {
+        /* the first switch to the buffer path brings this link's share of the pool */
+        if (comm_ctrl->send_buf_func == NULL && comm_buf_pool_grow(comm_ctrl->tx_pool, COMM_BUF_LINK_SLICE) != COMM_OK)
+        {
+            return COMM_ERROR;
+        }
+        comm_ctrl->send_buf_func = send_buf_func;
+        comm_ctrl->send_ctx = ctx;
+        ret = COMM_OK;
+    }
+    return ret;
+}
+
+comm_result_t comm_ctrl_set_send_func(comm_ctrl_t *comm_ctrl, comm_send_func_t send_func, void *ctx)
 {
     comm_result_t ret = COMM_ERROR;
     if (comm_ctrl != NULL && send_func != NULL)
     {
         comm_ctrl->send_func = send_func;
+        comm_ctrl->send_ctx = ctx;
         ret = COMM_OK;
     }
     return ret;
 }
 
+comm_result_t comm_ctrl_set_cache(comm_ctrl_t *comm_ctrl, comm_cache_t *cache)
+{
+    if (comm_ctrl == NULL)
+    {
+        return COMM_ERROR;
+    }
+    comm_ctrl->cache = cache;
+    return COMM_OK;
+}
+
+comm_result_t comm_ctrl_set_trace(comm_ctrl_t *comm_ctrl, fsm_trace_t *trace)
+{
+    if (comm_ctrl == NULL)
+    {
+        return COMM_ERROR;
+    }
+    fsm_attach_trace(&comm_ctrl->fsm, trace);
+    return COMM_OK;
+}
+
+comm_result_t comm_ctrl_set_table(comm_ctrl_t *comm_ctrl, const comm_table_t *table)
+{
+    if (comm_ctrl == NULL)
+    {
+        return COMM_ERROR;
+    }
+    comm_ctrl->table = table;
+    return COMM_OK;
+}
+
+comm_result_t comm_ctrl_set_poll_mode(comm_ctrl_t *comm_ctrl, comm_poll_mode_t mode, uint16_t interval_ms)
+{
+    if (comm_ctrl == NULL || mode > COMM_POLL_MODE_RESP_TO_SEND)
+    {
+        return COMM_ERROR;
+    }
+    if (mode != COMM_POLL_MODE_BACK_TO_BACK && interval_ms == 0U)
+    {
+        return COMM_ERROR;
+    }
+    comm_ctrl->poll_mode = mode;
+    comm_ctrl->poll_interval = interval_ms;
+    return COMM_OK;
+}
+
 comm_result_t comm_ctrl_start(comm_ctrl_t *comm_ctrl)
 {
     comm_result_t ret = COMM_ERROR;
     if (comm_ctrl != NULL)
     {
+        /* FSM events are raised on the controller thread, see comm_ctrl_start_msg() */
         message_t msg;
-        fsm_send_event(&comm_ctrl->fsm, COMM_CTRL_EVENT_START);
-        msg.msg_id = MESSAGE_ID_COMM_NOTIFY;
+        msg.msg_id = MESSAGE_ID_COMM_START;
         msg.msg_data = NULL;
         msg.msg_len = 0;
-        comm_ctrl_send_msg(comm_ctrl, &msg);
-        ret = COMM_OK;
+        ret = comm_ctrl_send_msg(comm_ctrl, &msg);
     }
     return ret;
 }
 
+static void comm_ctrl_start_msg(void* ctx, message_t* msg);
 static void comm_ctrl_notify(void* ctx, message_t* msg);
 static void comm_ctrl_update_period_cmd(void* ctx, message_t* msg);
 static void comm_ctrl_send_timeout(void* ctx, message_t* msg);
 static void comm_ctrl_send_cycle(void* ctx, message_t* msg);
 static void comm_ctrl_recv_data(void* ctx, message_t* msg);
+static void comm_ctrl_bulk_start(void* ctx, message_t* msg);
+static void comm_ctrl_bulk_stop(void* ctx, message_t* msg);
+static void comm_ctrl_script_msg(void* ctx, message_t* msg);
 static const msg_table_t comm_ctrl_msg_table[] = {
+    {MESSAGE_ID_COMM_START,                 comm_ctrl_start_msg},
     {MESSAGE_ID_COMM_NOTIFY,                comm_ctrl_notify},
     {MESSAGE_ID_COMM_UPDATE_PERIOD_CMD,     comm_ctrl_update_period_cmd},
     {MESSAGE_ID_COMM_SEND_TIMEOUT,          comm_ctrl_send_timeout},
     {MESSAGE_ID_COMM_SEND_CYCLE,            comm_ctrl_send_cycle},
     {MESSAGE_ID_COMM_RECV_DATA,             comm_ctrl_recv_data},
+    {MESSAGE_ID_COMM_BULK_START,            comm_ctrl_bulk_start},
+    {MESSAGE_ID_COMM_BULK_STOP,             comm_ctrl_bulk_stop},
+    {MESSAGE_ID_COMM_SCRIPT,                comm_ctrl_script_msg},
 };
 #define COMM_CTRL_MSG_TABLE_SIZE   (sizeof(comm_ctrl_msg_table) / sizeof(comm_ctrl_msg_table[0]))
+
+/* 消息分发表同样只编译一次，所有控制器共用 */
+static msg_callback comm_ctrl_msg_slots[MESSAGE_ID_COMM_MAX];
+static msg_dispatch_t comm_ctrl_msg_dispatch;
+
+static const msg_dispatch_t *comm_ctrl_msg_dispatch_build(void)
+{
+    msg_status_t status = MSG_OK;
+
+    status = message_dispatch_build(&comm_ctrl_msg_dispatch, comm_ctrl_msg_table, COMM_CTRL_MSG_TABLE_SIZE,
+                                    comm_ctrl_msg_slots, MESSAGE_ID_COMM_MAX);
+    if (status != MSG_OK)
+    {
+        /* keep the linear scan, the table needs fixing */
+        DEBUG("comm ctrl msg table rejected: %d\n", (int)status);
+        return NULL;
+    }
+    return &comm_ctrl_msg_dispatch;
+}
+static void comm_ctrl_start_msg(void* ctx, message_t* msg)
+{
+    comm_ctrl_t *comm_ctrl = (comm_ctrl_t *)ctx;
+    if(comm_ctrl == NULL || msg == NULL)
+    {
+        return;
+    }
+    DEBUG("comm ctrl msg: start\n");
+    fsm_send_event(&comm_ctrl->fsm, COMM_CTRL_EVENT_START);
+}
+
 static void comm_ctrl_notify(void* ctx, message_t* msg)
 {
     comm_ctrl_t *comm_ctrl = (comm_ctrl_t *)ctx;
@@ -533,14 +847,21 @@ static void comm_ctrl_notify(void* ctx, message_t* msg)
     DEBUG("comm ctrl msg: notify\n");
 }
 
+/* msg_data 为内存池中的 comm_ctrl_period_update_t，分发结束后由接收方释放 */
 static void comm_ctrl_update_period_cmd(void* ctx, message_t* msg)
 {
     comm_ctrl_t *comm_ctrl = (comm_ctrl_t *)ctx;
+    const comm_ctrl_period_update_t *update = NULL;
     if(comm_ctrl == NULL || msg == NULL)
     {
         return;
     }
     DEBUG("comm ctrl msg: update period cmd\n");
+    if(msg->msg_data != NULL && msg->msg_len == sizeof(comm_ctrl_period_update_t))
+    {
+        update = (const comm_ctrl_period_update_t *)msg->msg_data;
+        comm_ctrl_set_period_command(comm_ctrl, &update->cmd, update->seq);
+    }
 }
 static void comm_ctrl_send_timeout(void* ctx, message_t* msg)
 {
@@ -549,6 +870,11 @@ static void comm_ctrl_send_timeout(void* ctx, message_t* msg)
     {
         return;
     }
+    if(msg->msg_len != comm_ctrl->timeout_seq)
+    {
+        DEBUG("comm ctrl msg: stale timeout dropped\n");
+        return;
+    }
 DEBUG("comm ctrl msg: timeout\n");
     fsm_send_event(&comm_ctrl->fsm, COMM_CTRL_EVENT_RECV_TIMEOUT);
 }
@@ -562,6 +888,25 @@ static void comm_ctrl_send_cycle(void* ctx, message_t* msg)
     DEBUG("comm ctrl msg: send cycle\n");
     fsm_send_event(&comm_ctrl->fsm, COMM_CTRL_EVENT_SEND_CYCLE);
 }
+/* 单次命令的应答若可缓存则写入缓存 */
+static void comm_ctrl_cache_store(comm_ctrl_t *comm_ctrl, const comm_data_t *data)
+{
+    const comm_cmd_t *cmd = &comm_ctrl->cur_cmd;
+    const comm_cmd_table_t *entry = NULL;
+
+    if(comm_ctrl->cache == NULL || cmd->cmd_type != COMM_TYPE_SINGLE)
+    {
+        return;
+    }
+    entry = comm_table_lookup_send(comm_ctrl->table, cmd->send_cmd_id);
+    if(entry == NULL || entry->cache_ttl == 0U || entry->resp_cmd_id != data->comm_id)
+    {
+        return;
+    }
+    (void)comm_cache_store(comm_ctrl->cache, cmd->send_cmd_id, cmd->send_data.comm_data, cmd->send_data.comm_len,
+                           data->comm_id, data->comm_data, data->comm_len, entry->cache_ttl);
+}
+
 static void comm_ctrl_recv_data(void* ctx, message_t* msg)
 {
     comm_ctrl_t *comm_ctrl = (comm_ctrl_t *)ctx;
@@ -584,6 +929,12 @@ static void comm_ctrl_recv_data(void* ctx, message_t* msg)
         return;
     }
 
+    if(comm_ctrl->bulk != NULL && comm_bulk_on_recv(comm_ctrl->bulk, data, osKernelGetTickCount()))
+    {
+        comm_ctrl_recv_pool_free_idle(&comm_ctrl->recv_pool, buf_idx);
+        return;
+    }
+
     if(fsm_get_current_state(&comm_ctrl->fsm) != COMM_CTRL_STATE_WAIT_RESP)
     {
         //timeout already, discard
@@ -595,99 +946,441 @@ static void comm_ctrl_recv_data(void* ctx, message_t* msg)
     //     comm_ctrl_recv_pool_free_idle(&comm_ctrl->recv_pool, buf_idx);
 
     // }
+    else if(comm_ctrl->cur_cmd.cmd_type == COMM_TYPE_SCRIPT)
+    {
+        comm_ctrl_stats_event(comm_ctrl, COMM_CTRL_STAT_RESP, comm_ctrl->cur_cmd.send_cmd_id,
+                              osKernelGetTickCount() - comm_ctrl->cur_cmd.send_tick);
+        /* script responses stay in the script, the ready queue is for the application */
+        (void)comm_script_on_resp(comm_ctrl->script, data, osKernelGetTickCount());
+        comm_ctrl_recv_pool_free_idle(&comm_ctrl->recv_pool, buf_idx);
+        fsm_send_event(&comm_ctrl->fsm, COMM_CTRL_EVENT_RECV_RESP);
+    }
     else
     {
         DEBUG("recv data matched current command, process it\n");
+        comm_ctrl_stats_event(comm_ctrl, COMM_CTRL_STAT_RESP, comm_ctrl->cur_cmd.send_cmd_id,
+                              osKernelGetTickCount() - comm_ctrl->cur_cmd.send_tick);
+        comm_ctrl_cache_store(comm_ctrl, data);
         comm_ctrl_recv_pool_push_ready(&comm_ctrl->recv_pool, buf_idx);
         fsm_send_event(&comm_ctrl->fsm, COMM_CTRL_EVENT_RECV_RESP);
     }
 }
 
+static void comm_ctrl_bulk_start(void* ctx, message_t* msg)
+{
+    comm_ctrl_t *comm_ctrl = (comm_ctrl_t *)ctx;
+    struct comm_bulk *bulk = NULL;
+    if(comm_ctrl == NULL || msg == NULL || msg->msg_data == NULL)
+    {
+        return;
+    }
+    DEBUG("comm ctrl msg: bulk start\n");
+    bulk = (struct comm_bulk *)msg->msg_data;
+    if(comm_ctrl->bulk != NULL && comm_ctrl->bulk != bulk)
+    {
+        DEBUG("another bulk transfer is running\n");
+        return;
+    }
+    comm_ctrl->bulk = bulk;
+    comm_bulk_on_start(bulk, msg->msg_len, osKernelGetTickCount());
+}
+
+static void comm_ctrl_bulk_stop(void* ctx, message_t* msg)
+{
+    comm_ctrl_t *comm_ctrl = (comm_ctrl_t *)ctx;
+    if(comm_ctrl == NULL || msg == NULL)
+    {
+        return;
+    }
+    DEBUG("comm ctrl msg: bulk stop\n");
+    if(comm_ctrl->bulk != NULL && comm_ctrl->bulk == (struct comm_bulk *)msg->msg_data)
+    {
+        comm_bulk_on_stop(comm_ctrl->bulk);
+    }
+}
+
+static void comm_ctrl_script_msg(void* ctx, message_t* msg)
+{
+    comm_ctrl_t *comm_ctrl = (comm_ctrl_t *)ctx;
+    comm_script_t *script = NULL;
+    if(comm_ctrl == NULL || msg == NULL || msg->msg_data == NULL)
+    {
+        return;
+    }
+    DEBUG("comm ctrl msg: script\n");
+    script = (comm_script_t *)msg->msg_data;
+    if(comm_ctrl->script != NULL)
+    {
+        DEBUG("another script is running\n");
+        script->state = COMM_SCRIPT_STATE_FAILED;
+        if(script->done_cb != NULL)
+        {
+            script->done_cb(script->cb_ctx, script);
+        }
+        return;
+    }
+    comm_ctrl->script = script;
+    if(fsm_get_current_state(&comm_ctrl->fsm) == COMM_CTRL_STATE_IDLE)
+    {
+        /* 不等周期定时器，立即发送第一步 */
+        fsm_send_event(&comm_ctrl->fsm, COMM_CTRL_EVENT_SEND_CYCLE);
+    }
+}
+
 comm_result_t comm_ctrl_process(comm_ctrl_t *comm_ctrl,uint32_t timeout_ms)
 {
     if(comm_ctrl == NULL || comm_ctrl->msg_queue == NULL)
     {
         return COMM_ERROR;
     }
-    message_t msg;
-    if(message_queue_receive(comm_ctrl->msg_queue, &msg, timeout_ms) == MSG_OK)
+    message_t msgs[COMM_CTRL_PROCESS_BATCH];
+    uint32_t count = message_queue_receive_batch(comm_ctrl->msg_queue, msgs, COMM_CTRL_PROCESS_BATCH, timeout_ms);
+    uint32_t i = 0U;
+    for(i = 0U; i < count; i++)
+    {
+        (void)comm_ctrl_dispatch(comm_ctrl, &msgs[i]);
+        message_release(&msgs[i]);
+    }
+    return COMM_OK;
+}
+
+/* 处理一条已经出队的消息，共享队列的所有者按 link id 找到控制器后调用 */
+comm_result_t comm_ctrl_dispatch(comm_ctrl_t *comm_ctrl, message_t *msg)
+{
+    message_t local;
+    if(comm_ctrl == NULL || msg == NULL)
+    {
+        return COMM_ERROR;
+    }
+    local = *msg;
+    local.msg_id = COMM_CTRL_MSG_BASE(msg->msg_id);
+    if(comm_ctrl->msg_dispatch != NULL)
+    {
+        (void)message_dispatch(comm_ctrl->msg_dispatch, &local, (void *)comm_ctrl);
+    }
+    else
     {
-        message_table_proccess(comm_ctrl_msg_table, COMM_CTRL_MSG_TABLE_SIZE, &msg, (void *)comm_ctrl);
-        fsm_poll(&comm_ctrl->fsm);
+        message_table_proccess(comm_ctrl_msg_table, COMM_CTRL_MSG_TABLE_SIZE, &local, (void *)comm_ctrl);
+    }
+    fsm_poll(&comm_ctrl->fsm);
+    if(comm_ctrl->bulk != NULL)
+    {
+        /* every message doubles as a tick for the bulk retransmit timers */
+        comm_bulk_poll(comm_ctrl->bulk, osKernelGetTickCount());
+        if(comm_ctrl->bulk->progress.state != COMM_BULK_STATE_RUNNING)
+        {
+            comm_ctrl->bulk = NULL;
+        }
     }
     return COMM_OK;
 }
 
+comm_result_t comm_ctrl_post(comm_ctrl_t *comm_ctrl, message_t *msg)
+{
+    return comm_ctrl_send_msg(comm_ctrl, msg);
+}
+
 static comm_result_t comm_ctrl_send_msg(comm_ctrl_t *comm_ctrl, message_t *msg)
 {
+    message_t tagged;
     if(comm_ctrl == NULL || comm_ctrl->msg_queue == NULL || msg == NULL)
     {
         return COMM_ERROR;
     }
-    if(osMessageQueuePut(comm_ctrl->msg_queue, msg, 0U, 0U) != osOK)
+    tagged = *msg;
+    tagged.msg_id = COMM_CTRL_MSG_ID(comm_ctrl->link_id, msg->msg_id);
+    if(message_queue_send(comm_ctrl->msg_queue, &tagged, 0U) != MSG_OK)
     {
         return COMM_ERROR;
     }
     return COMM_OK;
 }
 
+/* msg_data 来自默认内存池，发送后归接收方所有，失败时已被释放 */
+static comm_result_t comm_ctrl_send_owned_msg(comm_ctrl_t *comm_ctrl, message_t *msg)
+{
+    message_t tagged;
+    if(comm_ctrl == NULL || comm_ctrl->msg_queue == NULL || msg == NULL)
+    {
+        message_payload_free(message_arena_default(), (msg != NULL) ? msg->msg_data : NULL);
+        return COMM_ERROR;
+    }
+    tagged = *msg;
+    tagged.msg_id = COMM_CTRL_MSG_ID(comm_ctrl->link_id, msg->msg_id);
+    if(message_queue_send_owned(comm_ctrl->msg_queue, &tagged, message_arena_default(), 0U) != MSG_OK)
+    {
+        return COMM_ERROR;
+    }
+    return COMM_OK;
+}
+
+/* 单次命令环形队列，由 comm_ctrl->mutex 保护 */
+static bool comm_ctrl_single_cmd_put(comm_ctrl_t *comm_ctrl, const comm_data_t *cmd)
+{
+    bool ok = false;
+    single_buffer_pool_t *ring = &comm_ctrl->single_cmd_queue;
+
+    if (osMutexAcquire(comm_ctrl->mutex, osWaitForever) == osOK)
+    {
+        if (ring->count < COMM_SINGLE_CMD_QUEUE_SIZE)
+        {
+            memcpy(&ring->buffers[(ring->head + ring->count) % COMM_SINGLE_CMD_QUEUE_SIZE], cmd, sizeof(comm_data_t));
+            ring->count++;
+            ok = true;
+        }
+        (void)osMutexRelease(comm_ctrl->mutex);
+    }
+    return ok;
+}
+
+static bool comm_ctrl_single_cmd_get(comm_ctrl_t *comm_ctrl, comm_data_t *cmd)
+{
+    bool ok = false;
+    single_buffer_pool_t *ring = &comm_ctrl->single_cmd_queue;
+
+    if (osMutexAcquire(comm_ctrl->mutex, osWaitForever) == osOK)
+    {
+        if (ring->count > 0U)
+        {
+            memcpy(cmd, &ring->buffers[ring->head], sizeof(comm_data_t));
+            ring->head = (uint8_t)((ring->head + 1U) % COMM_SINGLE_CMD_QUEUE_SIZE);
+            ring->count--;
+            ok = true;
+        }
+        (void)osMutexRelease(comm_ctrl->mutex);
+    }
+    return ok;
+}
 
 static comm_result_t comm_ctrl_send_cmd(comm_ctrl_t *comm_ctrl)
 {
+    comm_script_step_t *step = comm_script_current(comm_ctrl->script);
     comm_data_t cmd_data;
     comm_data_t* send_cmd_data = NULL;
     comm_type_t cmd_type = COMM_TYPE_NONE;
-    uint8_t send_buf[COMM_DATA_MAX_LEN + 1U] = {0};
-    uint16_t send_len = 0U;
+    bool reuse_frame = false;
     //单次命令重发
     if(comm_ctrl->cur_cmd.is_timeout == true && comm_ctrl->cur_cmd.cmd_type == COMM_TYPE_SINGLE)
     {
         DEBUG("resend command id: 0x%02X\n", comm_ctrl->cur_cmd.send_cmd_id);
         comm_ctrl->cur_cmd.is_timeout = false;
+        reuse_frame = true;
 
     }
-    else if ( osMessageQueueGet(comm_ctrl->single_cmd_queue, &cmd_data, NULL, 0U) == osOK)//有单次命令
+    else if (step != NULL)//脚本优先，步骤之间不插入其它命令
+    {
+        DEBUG("send script step %u id: 0x%02X\n", comm_ctrl->script->current, step->cmd.comm_id);
+        comm_ctrl_load_data_to_cmd(comm_ctrl->table, &step->cmd, COMM_TYPE_SCRIPT, &comm_ctrl->cur_cmd, true);
+        comm_ctrl->cur_cmd.resp_cmd_id = step->expect_resp_id;
+        comm_script_on_sent(comm_ctrl->script, osKernelGetTickCount());
+    }
+    else if (comm_ctrl_single_cmd_get(comm_ctrl, &cmd_data))//有单次命令
     {
         DEBUG("send single command id: 0x%02X\n", cmd_data.comm_id);
         send_cmd_data = &cmd_data;
         cmd_type = COMM_TYPE_SINGLE;
+#if DEBUG_COMM_CTRL
         printf("data to send:");
         for (uint16_t i = 0; i < cmd_data.comm_len; i++)
         {
             printf("%02X ", cmd_data.comm_data[i]);
         }
         printf("\n");
+#endif
         //装填在发送
-        comm_ctrl_load_data_to_cmd(send_cmd_data, COMM_TYPE_SINGLE, &comm_ctrl->cur_cmd, true);
+        comm_ctrl_load_data_to_cmd(comm_ctrl->table, send_cmd_data, COMM_TYPE_SINGLE, &comm_ctrl->cur_cmd, true);
     }
     else//发送周期命令
     {
         DEBUG("send period command id: 0x%02X\n", comm_ctrl->period_cmd.comm_id);
         send_cmd_data = &comm_ctrl->period_cmd;
         cmd_type = COMM_TYPE_PERIOD;
+        if (osMutexAcquire(comm_ctrl->mutex, osWaitForever) == osOK)
+        {
+            /* 周期命令未变化时沿用上一帧 */
+            reuse_frame = (comm_ctrl->cur_cmd.cmd_type == cmd_type) && !comm_ctrl->period_changed;
+            comm_ctrl->period_changed = false;
+            (void)osMutexRelease(comm_ctrl->mutex);
+        }
         if(comm_ctrl->cur_cmd.cmd_type == cmd_type)//上一次是定周期命令，就不需要要重置retry_count
         {
-            comm_ctrl_load_data_to_cmd(send_cmd_data, COMM_TYPE_PERIOD, &comm_ctrl->cur_cmd, false);
+            comm_ctrl_load_data_to_cmd(comm_ctrl->table, send_cmd_data, COMM_TYPE_PERIOD, &comm_ctrl->cur_cmd, false);
         }
         else//上一次发送的时候单次命令
         {
-            comm_ctrl_load_data_to_cmd(send_cmd_data, COMM_TYPE_PERIOD, &comm_ctrl->cur_cmd, true);
+            comm_ctrl_load_data_to_cmd(comm_ctrl->table, send_cmd_data, COMM_TYPE_PERIOD, &comm_ctrl->cur_cmd, true);
         }
     }
-    comm_ctrl->cur_cmd.timeout = 20U;
+    if(comm_ctrl->cur_cmd.cmd_type == COMM_TYPE_SCRIPT)
+    {
+        comm_ctrl->cur_cmd.timeout = step->timeout_ms;
+    }
     comm_ctrl_timeout_timer_start(comm_ctrl, comm_ctrl->cur_cmd.timeout); /* Start timeout timer with 5s timeout */    
-    if(comm_ctrl->send_func != NULL)
+    comm_ctrl->cur_cmd.send_tick = osKernelGetTickCount();
+    comm_ctrl_stats_event(comm_ctrl, COMM_CTRL_STAT_SENT, comm_ctrl->cur_cmd.send_cmd_id, 0U);
+    if(comm_ctrl->send_buf_func == NULL)
     {
-        send_buf[0] = comm_ctrl->cur_cmd.send_cmd_id;
-        memcpy(&send_buf[1], &comm_ctrl->cur_cmd.send_data.comm_data, comm_ctrl->cur_cmd.send_data.comm_len);
-        send_len = comm_ctrl->cur_cmd.send_data.comm_len + 1U;
-        comm_ctrl->send_func(send_buf, send_len);
+        return comm_ctrl_send_frame(comm_ctrl, comm_ctrl->cur_cmd.send_cmd_id,
+                                    comm_ctrl->cur_cmd.send_data.comm_data, comm_ctrl->cur_cmd.send_data.comm_len);
     }
-    else
+    if(!reuse_frame || comm_ctrl->cur_cmd.frame == NULL)
+    {
+        comm_buf_release(comm_ctrl->cur_cmd.frame);
+        comm_ctrl->cur_cmd.frame = comm_ctrl_encode_frame(comm_ctrl, comm_ctrl->cur_cmd.send_cmd_id,
+                                                          comm_ctrl->cur_cmd.send_data.comm_data,
+                                                          comm_ctrl->cur_cmd.send_data.comm_len);
+        if(comm_ctrl->cur_cmd.frame == NULL)
+        {
+            return COMM_ERROR;  /* the timeout resends */
+        }
+    }
+    /* the transport gets its own reference, ours stays for resends */
+    comm_ctrl->send_buf_func(comm_ctrl->send_ctx, comm_buf_ref(comm_ctrl->cur_cmd.frame));
+    return COMM_OK;
+}
+
+/* 从发送池取一块缓冲并就地编码，失败返回 NULL */
+static comm_buf_t *comm_ctrl_encode_frame(comm_ctrl_t *comm_ctrl, uint8_t cmd_id, const uint8_t *data, uint8_t len)
+{
+    comm_buf_t *buf = comm_buf_alloc(comm_ctrl->tx_pool);
+
+    if(buf == NULL)
+    {
+        DEBUG("tx pool empty\n");
+        return NULL;
+    }
+    if(comm_protocol_encode_frame(buf->data, (uint16_t)sizeof(buf->data), cmd_id, data, len, &buf->len) != COMM_OK)
+    {
+        comm_buf_release(buf);
+        return NULL;
+    }
+    return buf;
+}
+
+comm_result_t comm_ctrl_send_frame(comm_ctrl_t *comm_ctrl, uint8_t cmd_id, const uint8_t *data, uint8_t len)
+{
+    uint8_t send_buf[COMM_DATA_MAX_LEN + 1U] = {0};
+    comm_buf_t *buf = NULL;
+
+    if(comm_ctrl == NULL || len > COMM_DATA_MAX_LEN || (data == NULL && len != 0U))
+    {
+        return COMM_ERROR;
+    }
+    if(comm_ctrl->send_buf_func != NULL)
+    {
+        buf = comm_ctrl_encode_frame(comm_ctrl, cmd_id, data, len);
+        if(buf == NULL)
+        {
+            return COMM_ERROR;
+        }
+        comm_ctrl->send_buf_func(comm_ctrl->send_ctx, buf);
+        return COMM_OK;
+    }
+    if(comm_ctrl->send_func == NULL)
     {
         DEBUG("send function not set\n");
         return COMM_ERROR;
     }
+    send_buf[0] = cmd_id;
+    if(len != 0U)
+    {
+        memcpy(&send_buf[1], data, len);
+    }
+    comm_ctrl->send_func(comm_ctrl->send_ctx, send_buf, (uint16_t)(len + 1U));
+    return COMM_OK;
+}
+
+/*
+ * Cache hit: the response goes straight to the ready queue, the link is not
+ * used. Falls back to the wire if no receive buffer is free.
+ */
+static bool comm_ctrl_cache_answer(comm_ctrl_t *comm_ctrl, const comm_data_t *cmd)
+{
+    const comm_cmd_table_t *entry = NULL;
+    uint8_t buf_idx = 0xFFU;
+    comm_data_t *buf = NULL;
+
+    if (comm_ctrl->cache == NULL)
+    {
+        return false;
+    }
+    entry = comm_table_lookup_send(comm_ctrl->table, cmd->comm_id);
+    if (entry == NULL || entry->cache_ttl == 0U)
+    {
+        return false;
+    }
+    if (comm_ctrl_recv_pool_alloc_idle(&comm_ctrl->recv_pool, &buf_idx) != COMM_OK)
+    {
+        return false;
+    }
+    buf = comm_ctrl_recv_pool_get_buf(&comm_ctrl->recv_pool, buf_idx);
+    if (buf == NULL || !comm_cache_lookup(comm_ctrl->cache, cmd->comm_id, cmd->comm_data, cmd->comm_len,
+                                          &buf->comm_id, buf->comm_data, &buf->comm_len))
+    {
+        (void)comm_ctrl_recv_pool_free_idle(&comm_ctrl->recv_pool, buf_idx);
+        return false;
+    }
+    if (comm_ctrl_recv_pool_push_ready(&comm_ctrl->recv_pool, buf_idx) != COMM_OK)
+    {
+        (void)comm_ctrl_recv_pool_free_idle(&comm_ctrl->recv_pool, buf_idx);
+        return false;
+    }
+    return true;
+}
+
+comm_result_t comm_ctrl_run_script(comm_ctrl_t *comm_ctrl, comm_script_t *script)
+{
+    message_t msg;
+    if (comm_ctrl == NULL || script == NULL || script->state == COMM_SCRIPT_STATE_RUNNING)
+    {
+        return COMM_ERROR;
+    }
+    /* not attached yet, safe to reset on the caller's thread */
+    comm_script_begin(script, comm_ctrl->table, osKernelGetTickCount());
+    if (script->state != COMM_SCRIPT_STATE_RUNNING)
+    {
+        return COMM_ERROR;
+    }
+    msg.msg_id = MESSAGE_ID_COMM_SCRIPT;
+    msg.msg_data = (uint8_t *)script;
+    msg.msg_len = 0;
+    if (comm_ctrl_send_msg(comm_ctrl, &msg) != COMM_OK)
+    {
+        script->state = COMM_SCRIPT_STATE_IDLE;
+        return COMM_ERROR;
+    }
+    return COMM_OK;
+}
+
+comm_result_t comm_ctrl_set_stats(comm_ctrl_t *comm_ctrl, comm_stats_t *stats)
+{
+    if (comm_ctrl == NULL)
+    {
+        return COMM_ERROR;
+    }
+    comm_stats_reset(stats);
+    comm_ctrl->stats = stats;
+    return COMM_OK;
+}
+
+comm_result_t comm_ctrl_get_stats(comm_ctrl_t *comm_ctrl, comm_stats_t *snapshot)
+{
+    if (comm_ctrl == NULL || snapshot == NULL || comm_ctrl->stats == NULL)
+    {
+        return COMM_ERROR;
+    }
+    comm_stats_snapshot(comm_ctrl->stats, snapshot);
+    fsm_get_event_counters(&comm_ctrl->fsm, &snapshot->events_coalesced, &snapshot->events_dropped);
+    return COMM_OK;
+}
+
+comm_result_t comm_ctrl_reset_stats(comm_ctrl_t *comm_ctrl)
+{
+    if (comm_ctrl == NULL || comm_ctrl->stats == NULL)
+    {
+        return COMM_ERROR;
+    }
+    comm_stats_clear(comm_ctrl->stats);
     return COMM_OK;
 }
 
@@ -697,8 +1390,13 @@ comm_result_t comm_ctrl_send_single_command(comm_ctrl_t *comm_ctrl, comm_data_t
     
     if ((comm_ctrl != NULL) && (cmd != NULL))
     {
+        if (comm_ctrl_cache_answer(comm_ctrl, cmd))
+        {
+            DEBUG("single command id: 0x%02X answered from cache\n", cmd->comm_id);
+            return COMM_OK;
+        }
         /* Enqueue command to single command queue (function is thread-safe) */
-        if (osMessageQueuePut(comm_ctrl->single_cmd_queue, cmd, 0U, 0U) == osOK)
+        if (comm_ctrl_single_cmd_put(comm_ctrl, cmd))
         {
             DEBUG("enqueue single command id: 0x%02X\n", cmd->comm_id);
             ret = COMM_OK;
@@ -710,40 +1408,96 @@ comm_result_t comm_ctrl_send_single_command(comm_ctrl_t *comm_ctrl, comm_data_t
 comm_result_t comm_ctrl_send_period_command(comm_ctrl_t *comm_ctrl, comm_data_t *cmd)
 {
     comm_result_t ret = COMM_ERROR;
+    comm_ctrl_period_update_t *update = NULL;
+    uint32_t seq = 0U;
+    message_t msg;
     if ((comm_ctrl != NULL) && (cmd != NULL))
     {
-        comm_ctrl_set_period_command(comm_ctrl, cmd);
+        /*
+         * Once the controller runs, the new command travels with the message
+         * and is applied on the controller thread between two cycles. Before
+         * start, or when the arena or the queue is full, it is stored directly
+         * so the queue is left to the start message. Either way the update
+         * carries a sequence number, so a direct store is never overwritten
+         * by an older update still waiting in the queue.
+         */
+        seq = __atomic_add_fetch(&comm_ctrl->period_seq, 1U, __ATOMIC_RELAXED);
+        if (fsm_get_current_state(&comm_ctrl->fsm) != COMM_CTRL_STATE_NONE)
+        {
+            update = (comm_ctrl_period_update_t *)message_payload_alloc(message_arena_default(),
+                                                                       sizeof(comm_ctrl_period_update_t));
+        }
+        if (update != NULL)
+        {
+            memcpy(&update->cmd, cmd, sizeof(comm_data_t));
+            update->seq = seq;
+            msg.msg_data = (uint8_t *)update;
+            msg.msg_id = MESSAGE_ID_COMM_UPDATE_PERIOD_CMD;
+            msg.msg_len = sizeof(comm_ctrl_period_update_t);
+            ret = comm_ctrl_send_owned_msg(comm_ctrl, &msg);
+        }
+        if (ret != COMM_OK)
+        {
+            comm_ctrl_set_period_command(comm_ctrl, cmd, seq);
+            ret = COMM_OK;
+        }
     }
     return ret;
 }
 
-comm_result_t comm_ctrl_save_recv_data(comm_ctrl_t *comm_ctrl, uint8_t *data, uint16_t len)
+/* 解码器把 [id][data...] 直接写到 comm_id 处，要求两者在结构体中相邻 */
+typedef char comm_data_layout_check[(offsetof(comm_data_t, comm_data) == 1U) ? 1 : -1];
+
+static uint8_t comm_ctrl_recv_pool_index(recv_buffer_pool_t *pool, const comm_data_t *buf)
 {
-    comm_result_t ret = COMM_ERROR;
-    uint8_t buf_idx = 0xFFU;
-    comm_data_t* buf = NULL;
-    if ((comm_ctrl == NULL) || (data == NULL) || len > COMM_DATA_MAX_LEN || len <= 1U)
+    if ((buf < &pool->buffers[0]) || (buf >= &pool->buffers[COMM_RECV_DATA_QUEUE_SIZE]))
     {
-        DEBUG("invalid param \n");
+        return 0xFFU;
+    }
+    return (uint8_t)(buf - pool->buffers);
+}
 
-        return ret;
+/*
+ * 按链路命令表检查应答：ID 必须是表中的应答 ID，长度与 resp_data_len 一致。
+ * 未设置命令表的链路按内置表检查。
+ */
+static bool comm_ctrl_recv_check(comm_ctrl_t *comm_ctrl, const uint8_t *payload, uint16_t len)
+{
+    const comm_cmd_table_t *entry = NULL;
+
+    entry = comm_table_lookup_resp(comm_ctrl->table, payload[0]);
+    if (entry != NULL && (entry->resp_data_len == 0U || entry->resp_data_len == (uint16_t)(len - 1U)))
+    {
+        return true;
     }
-    /* Allocate buffer from pool */
-    if (comm_ctrl_recv_pool_alloc_idle(&comm_ctrl->recv_pool, &buf_idx) != COMM_OK)
+    DEBUG("drop frame id 0x%02X len %u\n", payload[0], len);
+    comm_ctrl_stats_event(comm_ctrl, COMM_CTRL_STAT_REJECTED, payload[0], 0U);
+    return false;
+}
+
+comm_data_t *comm_ctrl_recv_loan(comm_ctrl_t *comm_ctrl)
+{
+    uint8_t buf_idx = 0xFFU;
+
+    if (comm_ctrl == NULL)
     {
-        DEBUG("allocated fail\n");
-        return ret;
+        return NULL;
     }
-    buf = comm_ctrl_recv_pool_get_buf(&comm_ctrl->recv_pool, buf_idx);
-    if (buf == NULL)
+    if (comm_ctrl_recv_pool_alloc_idle(&comm_ctrl->recv_pool, &buf_idx) != COMM_OK)
     {
-        DEBUG("get buffer faill, %d\n",buf_idx);
-        return ret;
+        DEBUG("allocated fail\n");
+        return NULL;
     }
-    /* Copy data to buffer */
-    buf->comm_id = data[0];
-    buf->comm_len = len - 1;
-    memcpy(buf->comm_data, &data[1], buf->comm_len);
+    return comm_ctrl_recv_pool_get_buf(&comm_ctrl->recv_pool, buf_idx);
+}
+
+/* 已检查过的应答入接收队列并通知控制器 */
+static comm_result_t comm_ctrl_recv_enqueue(comm_ctrl_t *comm_ctrl, comm_data_t *buf, uint8_t buf_idx, uint16_t len)
+{
+    comm_result_t ret = COMM_ERROR;
+    message_t msg;
+
+    buf->comm_len = (uint8_t)(len - 1U);
         /* Push buffer index to recv queue */
     if (comm_ctrl_recv_pool_push_recv(&comm_ctrl->recv_pool, buf_idx) != COMM_OK)
     {
@@ -751,7 +1505,6 @@ comm_result_t comm_ctrl_save_recv_data(comm_ctrl_t *comm_ctrl, uint8_t *data, ui
         comm_ctrl_recv_pool_free_idle(&comm_ctrl->recv_pool, buf_idx);
         return ret;
     }
-    message_t msg;
     msg.msg_id = MESSAGE_ID_COMM_RECV_DATA;
     msg.msg_data = NULL;
     msg.msg_len = 0;
@@ -762,42 +1515,104 @@ comm_result_t comm_ctrl_save_recv_data(comm_ctrl_t *comm_ctrl, uint8_t *data, ui
     }
     else
     {
+        /* the index is already in the recv ring, the next recv message consumes it */
         DEBUG("send recv data msg faill\n");
-        comm_ctrl_recv_pool_free_idle(&comm_ctrl->recv_pool, buf_idx);
     }
     return ret;
 }
 
+comm_result_t comm_ctrl_recv_commit(comm_ctrl_t *comm_ctrl, comm_data_t *buf, uint16_t len)
+{
+    uint8_t buf_idx = 0xFFU;
 
-comm_result_t comm_ctrl_get_recv_data(comm_ctrl_t *comm_ctrl, comm_data_t *data)
+    if (comm_ctrl == NULL)
+    {
+        return COMM_ERROR;
+    }
+    buf_idx = comm_ctrl_recv_pool_index(&comm_ctrl->recv_pool, buf);
+    if (buf_idx == 0xFFU)
+    {
+        return COMM_ERROR;
+    }
+    if (len > COMM_DATA_MAX_LEN || len <= 1U || !comm_ctrl_recv_check(comm_ctrl, COMM_DATA_PAYLOAD(buf), len))
+    {
+        /* nothing usable was decoded, the loan goes back before it is queued */
+        comm_ctrl_recv_pool_free_idle(&comm_ctrl->recv_pool, buf_idx);
+        return COMM_ERROR;
+    }
+    return comm_ctrl_recv_enqueue(comm_ctrl, buf, buf_idx, len);
+}
+
+comm_data_t *comm_ctrl_recv_take(comm_ctrl_t *comm_ctrl)
 {
-    comm_result_t ret = COMM_ERROR;
     uint8_t buf_idx = 0xFFU;
-    comm_data_t* buf = NULL;
-    if ((comm_ctrl == NULL) || (data == NULL))
+
+    if (comm_ctrl == NULL)
     {
-        return ret;
+        return NULL;
     }
-    /* Pop buffer index from ready queue */
     if (comm_ctrl_recv_pool_pop_ready(&comm_ctrl->recv_pool, &buf_idx) != COMM_OK)
     {
-        // DEBUG("no ready data in pool\n");
-        return COMM_EMPTY_QUEUE;
+        return NULL;
     }
-    buf = comm_ctrl_recv_pool_get_buf(&comm_ctrl->recv_pool, buf_idx);
+    return comm_ctrl_recv_pool_get_buf(&comm_ctrl->recv_pool, buf_idx);
+}
+
+comm_result_t comm_ctrl_recv_return(comm_ctrl_t *comm_ctrl, comm_data_t *buf)
+{
+    uint8_t buf_idx = 0xFFU;
+
+    if (comm_ctrl == NULL)
+    {
+        return COMM_ERROR;
+    }
+    buf_idx = comm_ctrl_recv_pool_index(&comm_ctrl->recv_pool, buf);
+    if (buf_idx == 0xFFU)
+    {
+        return COMM_ERROR;
+    }
+    return comm_ctrl_recv_pool_free_idle(&comm_ctrl->recv_pool, buf_idx);
+}
+
+comm_result_t comm_ctrl_save_recv_data(comm_ctrl_t *comm_ctrl, uint8_t *data, uint16_t len)
+{
+    comm_data_t* buf = NULL;
+    if ((comm_ctrl == NULL) || (data == NULL) || len > COMM_DATA_MAX_LEN || len <= 1U)
+    {
+        DEBUG("invalid param \n");
+
+        return COMM_ERROR;
+    }
+    /* 先检查再借缓冲区，被拒绝的帧不占用接收池 */
+    if (!comm_ctrl_recv_check(comm_ctrl, data, len))
+    {
+        return COMM_ERROR;
+    }
+    buf = comm_ctrl_recv_loan(comm_ctrl);
     if (buf == NULL)
     {
-        DEBUG("get ready buffer fail, %d\n",buf_idx);
-        return ret;
+        return COMM_ERROR;
+    }
+    /* Copy data to buffer */
+    memcpy(COMM_DATA_PAYLOAD(buf), data, len);
+    return comm_ctrl_recv_enqueue(comm_ctrl, buf, comm_ctrl_recv_pool_index(&comm_ctrl->recv_pool, buf), len);
+}
+
+
+comm_result_t comm_ctrl_get_recv_data(comm_ctrl_t *comm_ctrl, comm_data_t *data)
+{
+    comm_data_t* buf = NULL;
+    if ((comm_ctrl == NULL) || (data == NULL))
+    {
+        return COMM_ERROR;
+    }
+    buf = comm_ctrl_recv_take(comm_ctrl);
+    if (buf == NULL)
+    {
+        return COMM_EMPTY_QUEUE;
     }
     /* Copy data from buffer */
     memcpy(data, buf, sizeof(comm_data_t));
     /* Free buffer back to idle queue */
-    if (comm_ctrl_recv_pool_free_idle(&comm_ctrl->recv_pool, buf_idx) != COMM_OK)
-    {
-        DEBUG("free idle buffer fail\n");
-        return ret;
-    }
-    ret = COMM_OK;
-    return ret;
+    return comm_ctrl_recv_return(comm_ctrl, buf);
 }
\ No newline at end of file
@@ -8,10 +8,24 @@
 #include "message.h"
 #include "cmsis_os2.h"
 #include "comm_def.h"
+#include "comm_cache.h"
+#include "comm_stats.h"
+#include "comm_timer.h"
+#include "comm_buf.h"
+#include "comm_table.h"
 
 /* Internal command queue */
 #define COMM_SINGLE_CMD_QUEUE_SIZE  6U
-#define COMM_RECV_DATA_QUEUE_SIZE   2U
+#ifndef COMM_RECV_DATA_QUEUE_SIZE
+#define COMM_RECV_DATA_QUEUE_SIZE   4U      /* also bounds the bulk transfer window, see comm_bulk.h */
+#endif
+#define COMM_CTRL_FSM_EVENT_SIZE    8U
+#define COMM_CTRL_PROCESS_BATCH     8U      /* messages comm_ctrl_process() takes per wake-up */
+
+/* Controllers sharing one message queue tag msg_id with their link id */
+#define COMM_CTRL_MSG_ID(link_id, id)   ((((uint32_t)(link_id)) << 16U) | (((uint32_t)(id)) & 0xFFFFU))
+#define COMM_CTRL_MSG_LINK(msg_id)      ((uint16_t)((uint32_t)(msg_id) >> 16U))
+#define COMM_CTRL_MSG_BASE(msg_id)      ((uint32_t)(msg_id) & 0xFFFFU)
 enum{
     MESSAGE_ID_COMM_START = 0U,
     MESSAGE_ID_COMM_NOTIFY,
@@ -20,15 +34,31 @@ enum{
     MESSAGE_ID_COMM_SEND_CYCLE,
     MESSAGE_ID_COMM_RECV_DATA,
     MESSAGE_ID_COMM_FINISH,
+    MESSAGE_ID_COMM_BULK_START,         /* msg_data: comm_bulk_t*, msg_len: first chunk */
+    MESSAGE_ID_COMM_BULK_STOP,          /* msg_data: comm_bulk_t* */
+    MESSAGE_ID_COMM_SCRIPT,             /* msg_data: comm_script_t* */
+    MESSAGE_ID_COMM_MAX,
 };
 
 typedef enum{
     COMM_TYPE_NONE = 0U,
     COMM_TYPE_SINGLE,
     COMM_TYPE_PERIOD,
+    COMM_TYPE_SCRIPT,
 }comm_type_t;
 
-typedef void(*comm_send_func_t)(uint8_t* data, uint16_t len);
+/* 周期命令的发送节奏 */
+typedef enum{
+    COMM_POLL_MODE_FIXED = 0U,      /* fixed tick, interval measured send to send (default) */
+    COMM_POLL_MODE_BACK_TO_BACK,    /* next send interval after the response (slave turnaround, may be 0), right after a timeout */
+    COMM_POLL_MODE_RESP_TO_SEND,    /* interval measured from response (or timeout) to next send, not 0 */
+}comm_poll_mode_t;
+
+#define COMM_CTRL_DEFAULT_PERIOD_MS 50U
+
+typedef void(*comm_send_func_t)(void* ctx, uint8_t* data, uint16_t len);
+/* 发送已编码的帧：接收方接管一个引用，发送完成后调用 comm_buf_release() */
+typedef void(*comm_send_buf_func_t)(void* ctx, comm_buf_t* buf);
 
 typedef struct 
 {
@@ -37,6 +67,10 @@ typedef struct
     uint8_t comm_len;                        ///< Length of message data in bytes
 } comm_data_t;
 
+/* [id][data...] as one byte run, comm_id and comm_data are adjacent */
+#define COMM_DATA_PAYLOAD(buf)      ((uint8_t *)&(buf)->comm_id)
+#define COMM_DATA_PAYLOAD_CAP       COMM_DATA_MAX_LEN
+
 typedef struct{
     comm_type_t cmd_type;
     comm_data_t send_data;
@@ -45,40 +79,123 @@ typedef struct{
     uint16_t timeout;
     uint16_t retry_count;
     bool is_timeout;
+    uint32_t send_tick;     /* kernel tick of the last send */
+    comm_buf_t *frame;      /* encoded frame, resent as is; NULL with a raw send_func */
 }comm_cmd_t;
 
+/* 索引环形队列，只存缓冲池下标 */
+typedef struct {
+    uint8_t idx[COMM_RECV_DATA_QUEUE_SIZE];
+    uint8_t head;
+    uint8_t count;
+} recv_index_ring_t;
+
 typedef struct {
     comm_data_t buffers[COMM_RECV_DATA_QUEUE_SIZE];  /* 缓冲池 */
-    osMessageQueueId_t idle_queue;
-    osMessageQueueId_t recv_queue;
-    osMessageQueueId_t ready_queue;
+    recv_index_ring_t idle_queue;
+    recv_index_ring_t recv_queue;
+    recv_index_ring_t ready_queue;
+    osMutexId_t lock;                                /* owner's mutex, may be shared */
 } recv_buffer_pool_t;
 
 typedef struct {
     comm_data_t buffers[COMM_SINGLE_CMD_QUEUE_SIZE];  /* 缓冲池 */
-    osMessageQueueId_t idle_queue;
-    osMessageQueueId_t work_queue;
+    uint8_t head;
+    uint8_t count;
 }single_buffer_pool_t;
 
+/* Resources a controller borrows from its owner instead of creating its own */
+typedef struct {
+    message_queue_t msg_queue;  /* queue shared by every controller of the owner */
+    osMutexId_t mutex;          /* lock shared by every controller of the owner */
+    uint16_t link_id;           /* stamped into every msg_id posted to msg_queue */
+    comm_timer_wheel_t *wheel;  /* owned wheel advanced by the owner's thread */
+} comm_ctrl_shared_t;
+
+struct comm_bulk;
+struct comm_script;
+
 typedef struct {
     fsm_t fsm;
     comm_cmd_t cur_cmd;
     message_queue_t msg_queue;
     comm_data_t period_cmd;
-    osMessageQueueId_t single_cmd_queue;
+    single_buffer_pool_t single_cmd_queue;
     recv_buffer_pool_t recv_pool; /* 接收缓冲池 */
     osMutexId_t mutex; 
-    osTimerId_t preiod_timer;
-    osTimerId_t timeout_timer;
+    comm_timer_t preiod_timer;
+    comm_timer_t timeout_timer;
+    uint32_t timeout_seq;                       /* bumped on every timeout start/stop, echoed by the timeout message */
+    comm_timer_wheel_t *wheel;                  /* default service wheel, or the owner's wheel */
     comm_send_func_t send_func;
+    comm_send_buf_func_t send_buf_func;         /* takes precedence over send_func */
+    void* send_ctx;
+    comm_buf_pool_t *tx_pool;                   /* frames handed to send_buf_func */
+    bool period_changed;                        /* period_cmd differs from the last encoded frame */
+    uint32_t period_seq;                        /* last sequence given to a period command update */
+    uint32_t period_seq_applied;                /* sequence of the update held in period_cmd */
+    bool is_shared;                             /* queue, mutex and timers owned by a manager */
+    uint16_t link_id;
+    event_t fsm_events[COMM_CTRL_FSM_EVENT_SIZE];  /* fsm event ring in shared mode */
+    comm_poll_mode_t poll_mode;
+    uint16_t poll_interval;                     /* period or response to next send delay in ms */
+    comm_cache_t *cache;                        /* response cache, NULL = disabled */
+    const comm_table_t *table;                  /* command set of the device, NULL = built-in */
+    struct comm_bulk *bulk;                     /* attached bulk transfer, NULL = none */
+    struct comm_script *script;                 /* running script, NULL = none */
+    const msg_dispatch_t *msg_dispatch;         /* compiled message table, NULL = linear scan */
+    comm_stats_t *stats;                        /* per command counters, NULL = disabled */
 }comm_ctrl_t;
 
+/* 编译所有控制器共用的状态机跳转表、消息分发表和内置命令表；comm_ctrl_init()、
+ * comm_ctrl_init_shared() 与 comm_mgr_init() 会调用，只在第一次真正编译 */
+void comm_ctrl_tables_init(void);
 comm_result_t comm_ctrl_init(comm_ctrl_t *comm_ctrl);
+comm_result_t comm_ctrl_init_shared(comm_ctrl_t *comm_ctrl, const comm_ctrl_shared_t *shared);
 comm_result_t comm_ctrl_process(comm_ctrl_t *comm_ctrl, uint32_t timeout_ms);
+comm_result_t comm_ctrl_dispatch(comm_ctrl_t *comm_ctrl, message_t *msg);
 comm_result_t comm_ctrl_start(comm_ctrl_t *comm_ctrl);
-comm_result_t comm_ctrl_set_send_func(comm_ctrl_t *comm_ctrl, comm_send_func_t send_func);
+comm_result_t comm_ctrl_set_send_func(comm_ctrl_t *comm_ctrl, comm_send_func_t send_func, void *ctx);
+/* 零拷贝发送：帧只编码一次，重发复用同一缓冲 */
+comm_result_t comm_ctrl_set_send_buf_func(comm_ctrl_t *comm_ctrl, comm_send_buf_func_t send_buf_func, void *ctx);
+/* 设置轮询模式，需在 comm_ctrl_start() 之前调用 */
+comm_result_t comm_ctrl_set_poll_mode(comm_ctrl_t *comm_ctrl, comm_poll_mode_t mode, uint16_t interval_ms);
+/* 挂接响应缓存，可多个控制器共用同一个缓存；传 NULL 关闭 */
+comm_result_t comm_ctrl_set_cache(comm_ctrl_t *comm_ctrl, comm_cache_t *cache);
+/* 指定该链路设备型号的命令表（如 comm_table_load_json() 加载的表）；传 NULL 使用内置表 */
+comm_result_t comm_ctrl_set_table(comm_ctrl_t *comm_ctrl, const comm_table_t *table);
+/* 直接发送一帧，不经过状态机，仅在控制器线程内调用（批量传输） */
+comm_result_t comm_ctrl_send_frame(comm_ctrl_t *comm_ctrl, uint8_t cmd_id, const uint8_t *data, uint8_t len);
+/* 向控制器投递消息，msg_id 不含 link id */
+comm_result_t comm_ctrl_post(comm_ctrl_t *comm_ctrl, message_t *msg);
+/* 提交命令脚本，脚本结束前其余命令暂停发送；脚本在结束前须保持有效 */
+comm_result_t comm_ctrl_run_script(comm_ctrl_t *comm_ctrl, struct comm_script *script);
+/* 记录状态机每次跳转及动作耗时，用 fsm_trace_slowest() 查询最慢的动作；传 NULL 关闭 */
+comm_result_t comm_ctrl_set_trace(comm_ctrl_t *comm_ctrl, fsm_trace_t *trace);
+/* 挂接统计块（调用者提供存储并清零），需在 comm_ctrl_start() 之前调用；传 NULL 关闭 */
+comm_result_t comm_ctrl_set_stats(comm_ctrl_t *comm_ctrl, comm_stats_t *stats);
+/* 在不停止通信的情况下拷贝一份统计快照，未挂接统计块时返回 COMM_ERROR */
+comm_result_t comm_ctrl_get_stats(comm_ctrl_t *comm_ctrl, comm_stats_t *snapshot);
+comm_result_t comm_ctrl_reset_stats(comm_ctrl_t *comm_ctrl);
 comm_result_t comm_ctrl_send_single_command(comm_ctrl_t *comm_ctrl, comm_data_t *cmd);
 comm_result_t comm_ctrl_send_period_command(comm_ctrl_t *comm_ctrl, comm_data_t *cmd);
 comm_result_t comm_ctrl_save_recv_data(comm_ctrl_t *comm_ctrl, uint8_t *data, uint16_t len);
 comm_result_t comm_ctrl_get_recv_data(comm_ctrl_t *comm_ctrl, comm_data_t *data);
+/*
+ * Zero-copy receive. The producer (decoder) borrows a pool buffer with
+ * comm_ctrl_recv_loan(), writes the payload [id][data...] to
+ * COMM_DATA_PAYLOAD(buf) (at most COMM_DATA_PAYLOAD_CAP bytes) and hands it
+ * over with comm_ctrl_recv_commit(); a len below 2, or a frame whose ID or
+ * length does not match the link's table (comm_ctrl_set_table(), the
+ * built-in one by default), returns the loan unused and posts nothing
+ * (counted in comm_stats_t.rejected).
+ * The application takes matched responses with comm_ctrl_recv_take() and
+ * gives the buffer back with comm_ctrl_recv_return(). Buffers held by the
+ * application are not available for new responses, so return them promptly.
+ * comm_ctrl_save_recv_data()/comm_ctrl_get_recv_data() are copying wrappers.
+ */
+comm_data_t *comm_ctrl_recv_loan(comm_ctrl_t *comm_ctrl);
+comm_result_t comm_ctrl_recv_commit(comm_ctrl_t *comm_ctrl, comm_data_t *buf, uint16_t len);
+comm_data_t *comm_ctrl_recv_take(comm_ctrl_t *comm_ctrl);
+comm_result_t comm_ctrl_recv_return(comm_ctrl_t *comm_ctrl, comm_data_t *buf);
 #endif // COMM_CTRL_H
\ No newline at end of file
@@ -1,5 +1,5 @@
-#ifndef COMM_TABLE_H
-#define COMM_TABLE_H
+#ifndef COMM_DEF_H
+#define COMM_DEF_H
 
 /**
  * @brief Result codes for protocol operations
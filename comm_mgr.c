@@ -0,0 +1,175 @@
+/**
+ * @file comm_mgr.c
+ * @brief Multi-link controller manager implementation
+ *
+ * Every worker blocks on its shared message queue with a timeout bounded by
+ * the next expiry of its timing wheel. Messages carry the link id in the
+ * upper half of msg_id (see COMM_CTRL_MSG_ID) and are dispatched to the
+ * owning controller. After each wake-up the worker advances the wheel on its
+ * own thread, so expired link timers dispatch directly and no timer thread
+ * or queue post is needed for timeouts and period ticks. The cost of a wake-up
+ * no longer depends on the number of links.
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#include "comm_mgr.h"
+#include "comm_table.h"
+#include <string.h>
+
+static void comm_mgr_worker_thread(void *argument)
+{
+    comm_mgr_worker_t *worker = (comm_mgr_worker_t *)argument;
+
+    while (1)
+    {
+        (void)comm_mgr_process(worker->mgr, worker->index, osWaitForever);
+    }
+}
+
+comm_result_t comm_mgr_init(comm_mgr_t *mgr, uint8_t worker_count, uint8_t queue_size)
+{
+    uint8_t i = 0U;
+
+    if (mgr == NULL || worker_count == 0U || worker_count > COMM_MGR_MAX_WORKERS)
+    {
+        return COMM_ERROR;
+    }
+    if (queue_size == 0U)
+    {
+        queue_size = COMM_MGR_DEFAULT_QUEUE_SIZE;
+    }
+    memset(mgr, 0, sizeof(comm_mgr_t));
+    mgr->mutex = osMutexNew(NULL);
+    if (mgr->mutex == NULL || comm_buf_default_pool() == NULL)
+    {
+        return COMM_ERROR;
+    }
+    /* shared tables are built here, before any worker thread runs */
+    comm_ctrl_tables_init();
+    for (i = 0U; i < worker_count; i++)
+    {
+        comm_mgr_worker_t *worker = &mgr->workers[i];
+        worker->mgr = mgr;
+        worker->index = i;
+        worker->msg_queue = message_queue_create_backend(queue_size, MSG_BACKEND_MPSC);
+        worker->mutex = osMutexNew(NULL);
+        if (worker->msg_queue == NULL || worker->mutex == NULL ||
+            comm_timer_wheel_init(&worker->wheel, false) != COMM_OK)
+        {
+            return COMM_ERROR;
+        }
+    }
+    mgr->worker_count = worker_count;
+    return COMM_OK;
+}
+
+comm_result_t comm_mgr_add_link(comm_mgr_t *mgr, comm_ctrl_t *comm_ctrl, uint16_t *link_id)
+{
+    comm_result_t ret = COMM_ERROR;
+    comm_ctrl_shared_t shared;
+    comm_mgr_worker_t *worker = NULL;
+    uint16_t id = 0U;
+
+    if (mgr == NULL || comm_ctrl == NULL || mgr->worker_count == 0U)
+    {
+        return COMM_ERROR;
+    }
+    if (osMutexAcquire(mgr->mutex, osWaitForever) != osOK)
+    {
+        return COMM_ERROR;
+    }
+    if (mgr->link_count < COMM_MGR_MAX_LINKS)
+    {
+        id = mgr->link_count;
+        worker = &mgr->workers[id % mgr->worker_count];
+        shared.msg_queue = worker->msg_queue;
+        shared.mutex = worker->mutex;
+        shared.link_id = id;
+        shared.wheel = &worker->wheel;
+        if (comm_ctrl_init_shared(comm_ctrl, &shared) == COMM_OK)
+        {
+            mgr->links[id] = comm_ctrl;
+            mgr->link_count++;
+            if (link_id != NULL)
+            {
+                *link_id = id;
+            }
+            ret = COMM_OK;
+        }
+    }
+    (void)osMutexRelease(mgr->mutex);
+    return ret;
+}
+
+comm_ctrl_t *comm_mgr_get_link(comm_mgr_t *mgr, uint16_t link_id)
+{
+    if (mgr == NULL || link_id >= mgr->link_count)
+    {
+        return NULL;
+    }
+    return mgr->links[link_id];
+}
+
+comm_result_t comm_mgr_start(comm_mgr_t *mgr)
+{
+    uint8_t i = 0U;
+
+    if (mgr == NULL || mgr->worker_count == 0U)
+    {
+        return COMM_ERROR;
+    }
+    for (i = 0U; i < mgr->worker_count; i++)
+    {
+        if (mgr->workers[i].thread == NULL)
+        {
+            mgr->workers[i].thread = osThreadNew(comm_mgr_worker_thread, &mgr->workers[i], NULL);
+            if (mgr->workers[i].thread == NULL)
+            {
+                return COMM_ERROR;
+            }
+        }
+    }
+    return COMM_OK;
+}
+
+comm_result_t comm_mgr_process(comm_mgr_t *mgr, uint8_t worker_idx, uint32_t timeout_ms)
+{
+    comm_mgr_worker_t *worker = NULL;
+    comm_ctrl_t *link = NULL;
+    message_t msgs[COMM_MGR_PROCESS_BATCH];
+    uint32_t count = 0U;
+    uint32_t i = 0U;
+    uint32_t wait = 0U;
+
+    if (mgr == NULL || worker_idx >= mgr->worker_count)
+    {
+        return COMM_ERROR;
+    }
+    worker = &mgr->workers[worker_idx];
+
+    comm_timer_advance(&worker->wheel, osKernelGetTickCount());
+    /* the wheel was just advanced, so its next expiry counts from now */
+    wait = comm_timer_next(&worker->wheel);
+    if (wait > timeout_ms)
+    {
+        wait = timeout_ms;
+    }
+
+    /* drain a burst with one wake-up; links are looked up per message */
+    count = message_queue_receive_batch(worker->msg_queue, msgs, COMM_MGR_PROCESS_BATCH, wait);
+    for (i = 0U; i < count; i++)
+    {
+        link = comm_mgr_get_link(mgr, COMM_CTRL_MSG_LINK(msgs[i].msg_id));
+        if (link != NULL)
+        {
+            (void)comm_ctrl_dispatch(link, &msgs[i]);
+        }
+        message_release(&msgs[i]);
+    }
+
+    comm_timer_advance(&worker->wheel, osKernelGetTickCount());
+    return COMM_OK;
+}
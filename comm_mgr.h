@@ -0,0 +1,107 @@
+/**
+ * @file comm_mgr.h
+ * @brief Multi-link controller manager interface
+ *
+ * The manager runs many comm_ctrl instances (links) from a small fixed set of
+ * worker threads. Each worker owns one message queue and one mutex that are
+ * shared by every link assigned to it, and a timing wheel (comm_timer.h)
+ * holding the timers of those links. A link therefore costs only the
+ * comm_ctrl_t state itself, with no RTOS objects of its own.
+ *
+ * Links are assigned to workers by link id (link_id % worker_count). All
+ * messages of a link are handled by the same worker, so the controller FSM
+ * never runs on two threads at once.
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#ifndef COMM_MGR_H
+#define COMM_MGR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "comm_ctrl.h"
+
+#define COMM_MGR_MAX_WORKERS        8U      /* upper bound of worker threads */
+#define COMM_MGR_MAX_LINKS          256U    /* upper bound of managed links */
+#define COMM_MGR_DEFAULT_QUEUE_SIZE 64U     /* per worker message queue depth */
+#define COMM_MGR_PROCESS_BATCH      16U     /* messages comm_mgr_process() takes per wake-up */
+
+struct comm_mgr;
+
+/**
+ * @brief Worker context: one thread, one queue, one mutex for many links
+ */
+typedef struct {
+    struct comm_mgr *mgr;       /**< owning manager */
+    uint8_t index;              /**< worker index */
+    message_queue_t msg_queue;  /**< message queue shared by the worker's links */
+    osMutexId_t mutex;          /**< mutex shared by the worker's links */
+    osThreadId_t thread;        /**< worker thread, NULL when driven by the caller */
+    comm_timer_wheel_t wheel;   /**< timers of the worker's links, owned by the worker thread */
+} comm_mgr_worker_t;
+
+/**
+ * @brief Manager context
+ */
+typedef struct comm_mgr {
+    comm_mgr_worker_t workers[COMM_MGR_MAX_WORKERS];
+    uint8_t worker_count;
+    comm_ctrl_t *links[COMM_MGR_MAX_LINKS];
+    uint16_t link_count;
+    osMutexId_t mutex;          /**< guards link registration */
+} comm_mgr_t;
+
+/**
+ * @brief Initialize the manager and create the worker queues
+ *
+ * @param mgr Manager to initialize
+ * @param worker_count Number of workers (1..COMM_MGR_MAX_WORKERS)
+ * @param queue_size Message queue depth per worker, 0 for the default
+ * @return COMM_OK on success, COMM_ERROR otherwise
+ */
+comm_result_t comm_mgr_init(comm_mgr_t *mgr, uint8_t worker_count, uint8_t queue_size);
+
+/**
+ * @brief Register a controller as a new link
+ *
+ * Initializes @p comm_ctrl in shared mode on the worker selected by the new
+ * link id. The caller sets the send function and commands afterwards and
+ * then calls comm_ctrl_start() as usual.
+ *
+ * @param mgr Manager
+ * @param comm_ctrl Controller storage owned by the caller
+ * @param link_id Optional output for the assigned link id
+ * @return COMM_OK on success, COMM_ERROR if the manager is full
+ */
+comm_result_t comm_mgr_add_link(comm_mgr_t *mgr, comm_ctrl_t *comm_ctrl, uint16_t *link_id);
+
+/**
+ * @brief Look up a controller by link id
+ * @return Controller pointer, or NULL if the id is unknown
+ */
+comm_ctrl_t *comm_mgr_get_link(comm_mgr_t *mgr, uint16_t link_id);
+
+/**
+ * @brief Create one thread per worker running comm_mgr_process() forever
+ * @return COMM_OK if every worker thread was created
+ */
+comm_result_t comm_mgr_start(comm_mgr_t *mgr);
+
+/**
+ * @brief Run one iteration of a worker loop on the calling thread
+ *
+ * Fires expired link timers, waits up to @p timeout_ms (bounded by the next
+ * timer expiry) for a message and dispatches it to its link. Use
+ * this instead of comm_mgr_start() to drive workers from existing threads.
+ *
+ * @param mgr Manager
+ * @param worker Worker index
+ * @param timeout_ms Longest time to wait for a message
+ * @return COMM_OK, or COMM_ERROR on invalid arguments
+ */
+comm_result_t comm_mgr_process(comm_mgr_t *mgr, uint8_t worker, uint32_t timeout_ms);
+
+#endif // COMM_MGR_H
@@ -410,8 +410,10 @@ comm_result_t comm_protocol_decoder_init(protocol_decoder_t *decoder)
 comm_result_t comm_protocol_decoder_process(protocol_decoder_t *decoder, uint8_t *buf, uint16_t len)
 {
     comm_result_t ret = COMM_ERROR;
-    uint8_t i = 0;
+    uint16_t i = 0;
     uint8_t bytes_buf[COMM_PROTOCOL_MAX_HEX_DATA_LEN] = {0};
+    uint8_t *dest = NULL;
+    uint16_t dest_cap = 0;
     uint16_t bytes_len = 0;
     const uint8_t *data_start = NULL;
     uint16_t data_len = 0;
@@ -438,11 +440,29 @@ comm_result_t comm_protocol_decoder_process(protocol_decoder_t *decoder, uint8_t
                 continue;  // Skip this frame, continue processing remaining bytes
             }
             
+            // Decode into a borrowed buffer if the owner supplies one
+            dest = bytes_buf;
+            dest_cap = sizeof(bytes_buf);
+            if (decoder->loan != NULL)
+            {
+                dest = decoder->loan(decoder->user_data, &dest_cap);
+                if (dest == NULL)
+                {
+                    DEBUG("no buffer for decoded frame, dropped\n");
+                    continue;
+                }
+            }
+            
             // Convert hex string to binary bytes
-            if (hex_str_to_bytes(data_start, data_len, bytes_buf, sizeof(bytes_buf), &bytes_len) == true)
+            if (hex_str_to_bytes(data_start, data_len, dest, dest_cap, &bytes_len) == true)
             {
                 // Successfully converted, trigger user callback with decoded payload
-                comm_protocol_decode_trigger_callback(decoder, bytes_buf, bytes_len);
+                comm_protocol_decode_trigger_callback(decoder, dest, bytes_len);
+            }
+            else if (decoder->loan != NULL)
+            {
+                // Give the borrowed buffer back
+                comm_protocol_decode_trigger_callback(decoder, dest, 0);
             }
         }    
     }
@@ -576,3 +596,58 @@ comm_result_t comm_protocol_encode(protocol_encoder_t *encoder, const uint8_t *p
     return ret;
 }
 
+
+/**
+ * @brief Set loan and completion callbacks
+ * 
+ * Stores both callbacks; decoder_process() checks the loan callback per frame.
+ */
+comm_result_t comm_protocol_decoder_set_loan(protocol_decoder_t *decoder, protocol_loan_cb_t loan,
+                                             protocol_decode_cb_t callback, void *user_data)
+{
+    comm_result_t ret = COMM_ERROR;
+    if (decoder != NULL)
+    {
+        decoder->loan = loan;
+        decoder->callback = callback;
+        decoder->user_data = user_data;
+        ret = COMM_OK;
+    }
+    return ret;
+}
+
+/**
+ * @brief Encode an id and its data into a caller buffer
+ * 
+ * Writes the same frame as comm_protocol_encode() for the payload
+ * [id][data...], but straight into @p out and without staging the payload
+ * first. The XOR checksum is folded in while the hex digits are written.
+ */
+comm_result_t comm_protocol_encode_frame(uint8_t *out, uint16_t out_size, uint8_t id,
+                                         const uint8_t *data, uint16_t data_len, uint16_t *out_len)
+{
+    uint16_t index = 0;
+    uint16_t i = 0;
+    uint8_t xor_val = 0;
+
+    if (out == NULL || out_len == NULL || (data == NULL && data_len > 0) ||
+        (uint32_t)(data_len + 1U) * 2U > COMM_PROTOCOL_MAX_VALID_DATA_LEN ||
+        out_size < (uint16_t)(((data_len + 1U) * 2U) + COMM_PROTOCOL_HEAD_TAIL_LEN + COMM_PROTOCOL_XOR_LEN))
+    {
+        return COMM_ERROR;
+    }
+    out[index++] = PROTOCOL_BYTE_HEAD;
+    (void)uint8_to_hex_chars(id, &out[index], &out[index + 1U]);
+    index += 2U;
+    for (i = 0; i < data_len; i++)
+    {
+        (void)uint8_to_hex_chars(data[i], &out[index], &out[index + 1U]);
+        index += 2U;
+    }
+    out[index++] = PROTOCOL_BYTE_TAIL;
+    (void)comm_protocol_cal_xor(out, index, 0, &xor_val);
+    (void)uint8_to_hex_chars(xor_val, &out[index], &out[index + 1U]);
+    index += 2U;
+    *out_len = index;
+    return COMM_OK;
+}
@@ -40,6 +40,14 @@ typedef enum {
  */
 typedef void (*protocol_decode_cb_t)(void *user_data, uint8_t *payload, uint16_t payload_len);
 
+/**
+ * @brief Borrow the destination of the next decoded payload
+ * @param user_data User-defined data pointer passed to callback
+ * @param capacity Output, bytes the returned buffer can hold
+ * @return Buffer, or NULL to drop the frame
+ */
+typedef uint8_t *(*protocol_loan_cb_t)(void *user_data, uint16_t *capacity);
+
 /**
  * @brief Protocol decoder context structure
  */
@@ -49,6 +57,7 @@ typedef struct {
     uint16_t data_len;                  /**< Current length of data in buffer */
     uint8_t xor[COMM_PROTOCOL_XOR_LEN]; /**< XOR checksum bytes (2 ASCII hex chars) */
     protocol_decode_cb_t callback;      /**< Callback function for decode completion */
+    protocol_loan_cb_t loan;            /**< Optional, supplies the payload buffer */
     void *user_data;                    /**< User-defined data for callback */
 } protocol_decoder_t;
 
@@ -132,6 +141,25 @@ comm_result_t comm_protocol_decoder_process(protocol_decoder_t *decoder, uint8_t
  */
 comm_result_t comm_protocol_decoder_set_callback(protocol_decoder_t *decoder, protocol_decode_cb_t callback, void *user_data);
 
+/**
+ * @brief Decode payloads straight into borrowed buffers
+ * 
+ * With a loan callback set, every checksum-valid frame is converted from hex
+ * directly into the buffer returned by @p loan, and @p callback is then
+ * invoked with that buffer, so the payload is never staged on the stack.
+ * The callback also runs with payload_len 0 when the frame turns out to be
+ * unusable (odd length, does not fit), so the owner can take the buffer
+ * back. Pass NULL callbacks to return to the stack buffer mode.
+ * 
+ * @param decoder Pointer to decoder structure
+ * @param loan Supplies the destination buffer
+ * @param callback Receives the filled (or empty) loaned buffer
+ * @param user_data User-defined data passed to both callbacks
+ * @return COMM_OK on success, COMM_ERROR if decoder is NULL
+ */
+comm_result_t comm_protocol_decoder_set_loan(protocol_decoder_t *decoder, protocol_loan_cb_t loan,
+                                             protocol_decode_cb_t callback, void *user_data);
+
 /**
  * @brief Reset protocol decoder to idle state
  * 
@@ -199,4 +227,22 @@ comm_result_t comm_protocol_encoder_init(protocol_encoder_t *encoder);
  */
 comm_result_t comm_protocol_encode(protocol_encoder_t *encoder, const uint8_t *payload, uint16_t payload_len);
 
+/**
+ * @brief Encode a command id and its data into a caller buffer
+ * 
+ * Produces the frame of the payload [id][data...] directly in @p out, e.g.
+ * a reference-counted TX buffer, so the frame is built once in the memory
+ * the transport sends from.
+ * 
+ * @param out Output buffer
+ * @param out_size Size of @p out, at least COMM_PROTOCOL_MAX_BUFF_LEN is always enough
+ * @param id First payload byte (command id)
+ * @param data Remaining payload bytes, may be NULL if @p data_len is 0
+ * @param data_len Number of bytes in @p data
+ * @param out_len Encoded frame length
+ * @return COMM_OK on success, COMM_ERROR if the payload or buffer is too long/short
+ */
+comm_result_t comm_protocol_encode_frame(uint8_t *out, uint16_t out_size, uint8_t id,
+                                         const uint8_t *data, uint16_t data_len, uint16_t *out_len);
+
 #endif // COMM_PROTOCOL_H
\ No newline at end of file
@@ -0,0 +1,173 @@
+/**
+ * @file comm_script.c
+ * @brief Command script implementation
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#include "comm_script.h"
+#include "comm_table.h"
+#include <string.h>
+
+static void comm_script_finish(comm_script_t *script, comm_script_state_t state, uint32_t now)
+{
+    script->elapsed_ms = now - script->start_tick;
+    script->state = state;
+}
+
+comm_result_t comm_script_init(comm_script_t *script, comm_script_done_cb_t done_cb, void *ctx)
+{
+    if (script == NULL)
+    {
+        return COMM_ERROR;
+    }
+    memset(script, 0, sizeof(comm_script_t));
+    script->state = COMM_SCRIPT_STATE_IDLE;
+    script->done_cb = done_cb;
+    script->cb_ctx = ctx;
+    return COMM_OK;
+}
+
+comm_result_t comm_script_add(comm_script_t *script, const comm_data_t *cmd, uint8_t expect_resp_id)
+{
+    comm_script_step_t *step = NULL;
+
+    if (script == NULL || cmd == NULL || cmd->comm_len > COMM_DATA_MAX_LEN ||
+        script->step_count >= COMM_SCRIPT_MAX_STEPS || script->state == COMM_SCRIPT_STATE_RUNNING)
+    {
+        return COMM_ERROR;
+    }
+    step = &script->steps[script->step_count];
+    memset(step, 0, sizeof(comm_script_step_t));
+    memcpy(&step->cmd, cmd, sizeof(comm_data_t));
+    step->expect_resp_id = expect_resp_id;
+    step->resp_from_table = (expect_resp_id == 0U);
+    script->step_count++;
+    return COMM_OK;
+}
+
+/* 按运行该脚本的控制器的命令表补全每一步的应答 id、超时与重发次数 */
+static bool comm_script_resolve(comm_script_t *script, const comm_table_t *table)
+{
+    const comm_cmd_table_t *entry = NULL;
+    comm_script_step_t *step = NULL;
+    uint8_t i = 0U;
+
+    for (i = 0U; i < script->step_count; i++)
+    {
+        step = &script->steps[i];
+        entry = comm_table_lookup_send(table, step->cmd.comm_id);
+        if (step->resp_from_table)
+        {
+            if (entry == NULL)
+            {
+                return false;
+            }
+            step->expect_resp_id = entry->resp_cmd_id;
+        }
+        step->timeout_ms = (entry != NULL) ? entry->timeout : COMM_SCRIPT_DEFAULT_TIMEOUT;
+        step->retry = (entry != NULL) ? entry->retry_count : COMM_SCRIPT_DEFAULT_RETRY;
+    }
+    return true;
+}
+
+comm_script_state_t comm_script_get_state(const comm_script_t *script)
+{
+    return (script == NULL) ? COMM_SCRIPT_STATE_IDLE : script->state;
+}
+
+void comm_script_begin(comm_script_t *script, const comm_table_t *table, uint32_t now)
+{
+    uint8_t i = 0U;
+
+    if (script == NULL || !comm_script_resolve(script, table))
+    {
+        return;
+    }
+    for (i = 0U; i < script->step_count; i++)
+    {
+        script->steps[i].attempts = 0U;
+        script->steps[i].elapsed_ms = 0U;
+        script->steps[i].result = COMM_INCOMPLETE;
+        script->steps[i].resp.comm_len = 0U;
+    }
+    script->current = 0U;
+    script->start_tick = now;
+    script->step_tick = now;
+    script->elapsed_ms = 0U;
+    if (script->step_count == 0U)
+    {
+        comm_script_finish(script, COMM_SCRIPT_STATE_DONE, now);
+        return;
+    }
+    script->state = COMM_SCRIPT_STATE_RUNNING;
+}
+
+comm_script_step_t *comm_script_current(comm_script_t *script)
+{
+    if (script == NULL || script->state != COMM_SCRIPT_STATE_RUNNING)
+    {
+        return NULL;
+    }
+    return &script->steps[script->current];
+}
+
+void comm_script_on_sent(comm_script_t *script, uint32_t now)
+{
+    comm_script_step_t *step = comm_script_current(script);
+
+    if (step == NULL)
+    {
+        return;
+    }
+    if (step->attempts == 0U)
+    {
+        script->step_tick = now;
+    }
+    step->attempts++;
+}
+
+comm_script_state_t comm_script_on_resp(comm_script_t *script, const comm_data_t *data, uint32_t now)
+{
+    comm_script_step_t *step = comm_script_current(script);
+
+    if (step == NULL || data == NULL)
+    {
+        return comm_script_get_state(script);
+    }
+    memcpy(&step->resp, data, sizeof(comm_data_t));
+    step->elapsed_ms = now - script->step_tick;
+    if (data->comm_id != step->expect_resp_id)
+    {
+        step->result = COMM_ERROR;
+        comm_script_finish(script, COMM_SCRIPT_STATE_FAILED, now);
+        return script->state;
+    }
+    step->result = COMM_OK;
+    script->current++;
+    if (script->current >= script->step_count)
+    {
+        comm_script_finish(script, COMM_SCRIPT_STATE_DONE, now);
+    }
+    return script->state;
+}
+
+comm_script_state_t comm_script_on_timeout(comm_script_t *script, uint32_t now)
+{
+    comm_script_step_t *step = comm_script_current(script);
+
+    if (step == NULL)
+    {
+        return comm_script_get_state(script);
+    }
+    /* attempts 包含首发，重发次数用尽则整个脚本失败 */
+    if (step->attempts > step->retry)
+    {
+        step->elapsed_ms = now - script->step_tick;
+        step->result = COMM_RETRY_EXHAUSTED;
+        comm_script_finish(script, COMM_SCRIPT_STATE_FAILED, now);
+    }
+    return script->state;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file comm_script.h
+ * @brief Command scripts executed by comm_ctrl as one transaction
+ *
+ * A script is an ordered list of commands with the response id each one
+ * must return, e.g. ENTER_SETTING, a few FC_SET writes, EXIT_SETTING. The
+ * controller sends the steps back to back on its own thread: the next step
+ * goes out as soon as the previous response is checked, with no round trip
+ * through the application, and neither periodic nor single commands are
+ * sent in between. The script stops at the first step that gets a wrong
+ * response or runs out of retries.
+ *
+ * Step responses are stored in the script, not in the receive queue. The
+ * completion callback runs on the controller thread.
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#ifndef COMM_SCRIPT_H
+#define COMM_SCRIPT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "comm_ctrl.h"
+#include "comm_table.h"
+
+#define COMM_SCRIPT_MAX_STEPS       16U
+#define COMM_SCRIPT_DEFAULT_TIMEOUT 1000U
+#define COMM_SCRIPT_DEFAULT_RETRY   3U
+
+typedef enum{
+    COMM_SCRIPT_STATE_IDLE = 0U,
+    COMM_SCRIPT_STATE_RUNNING,
+    COMM_SCRIPT_STATE_DONE,
+    COMM_SCRIPT_STATE_FAILED,
+}comm_script_state_t;
+
+/**
+ * @brief One step of a script
+ */
+typedef struct {
+    comm_data_t cmd;            /**< command to send */
+    uint8_t expect_resp_id;     /**< required response id */
+    bool resp_from_table;       /**< expect_resp_id is taken from the controller's table at start */
+    uint16_t timeout_ms;        /**< response timeout per attempt, from the controller's table at start */
+    uint16_t retry;             /**< resends after a timeout, from the controller's table at start */
+    comm_data_t resp;           /**< response received */
+    uint16_t attempts;          /**< times the command was sent */
+    uint32_t elapsed_ms;        /**< first send to accepted response */
+    comm_result_t result;       /**< COMM_OK, COMM_ERROR (wrong response) or COMM_RETRY_EXHAUSTED */
+} comm_script_step_t;
+
+struct comm_script;
+typedef void (*comm_script_done_cb_t)(void *ctx, struct comm_script *script);
+
+/**
+ * @brief Script context, owned by the application
+ */
+typedef struct comm_script {
+    comm_script_step_t steps[COMM_SCRIPT_MAX_STEPS];
+    uint8_t step_count;
+    uint8_t current;            /**< step in progress, or the failed step */
+    volatile comm_script_state_t state;
+    uint32_t start_tick;
+    uint32_t step_tick;         /**< first send of the current step */
+    uint32_t elapsed_ms;        /**< whole script, set when it ends */
+    comm_script_done_cb_t done_cb;
+    void *cb_ctx;
+} comm_script_t;
+
+/**
+ * @brief Initialize an empty script
+ * @param script Script
+ * @param done_cb Called on the controller thread when the script ends, may be NULL
+ * @param ctx Callback context
+ */
+comm_result_t comm_script_init(comm_script_t *script, comm_script_done_cb_t done_cb, void *ctx);
+
+/**
+ * @brief Append a step
+ *
+ * @param script Script
+ * @param cmd Command to send
+ * @param expect_resp_id Required response id, 0 to take it from the command
+ *        table of the controller that runs the script
+ * @return COMM_OK, or COMM_ERROR if the script is full or running
+ */
+comm_result_t comm_script_add(comm_script_t *script, const comm_data_t *cmd, uint8_t expect_resp_id);
+
+/**
+ * @brief Get the script state
+ */
+comm_script_state_t comm_script_get_state(const comm_script_t *script);
+
+/**
+ * @brief Controller hook: reset the steps and mark the script running
+ *
+ * Timeouts, retries and the response ids left to the table come from
+ * @p table (NULL = built-in). The script stays IDLE if a step needs a
+ * response id that @p table does not have.
+ */
+void comm_script_begin(comm_script_t *script, const comm_table_t *table, uint32_t now);
+
+/**
+ * @brief Controller hook: step to send next, NULL if the script is not running
+ */
+comm_script_step_t *comm_script_current(comm_script_t *script);
+
+/**
+ * @brief Controller hook: the current step was put on the link
+ */
+void comm_script_on_sent(comm_script_t *script, uint32_t now);
+
+/**
+ * @brief Controller hook: check a response against the current step
+ * @return Script state after the response
+ */
+comm_script_state_t comm_script_on_resp(comm_script_t *script, const comm_data_t *data, uint32_t now);
+
+/**
+ * @brief Controller hook: the current step timed out
+ * @return Script state, still RUNNING while retries are left
+ */
+comm_script_state_t comm_script_on_timeout(comm_script_t *script, uint32_t now);
+
+#endif // COMM_SCRIPT_H
@@ -0,0 +1,264 @@
+/**
+ * @file comm_stats.c
+ * @brief Per-command counters and latency histograms implementation
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#include "comm_stats.h"
+#include <string.h>
+
+#define COMM_STATS_ADD(field, n)   ((void)__atomic_fetch_add(&(field), (n), __ATOMIC_RELAXED))
+#define COMM_STATS_LOAD(field)     __atomic_load_n(&(field), __ATOMIC_RELAXED)
+#define COMM_STATS_STORE(field, v) __atomic_store_n(&(field), (v), __ATOMIC_RELAXED)
+
+/* 按 id 索引查找命令对应的统计项，首次出现时占用下一个空闲项；只有控制器线程调用 */
+static comm_stats_cmd_t *comm_stats_entry(comm_stats_t *stats, uint8_t cmd_id)
+{
+    comm_stats_cmd_t *free_entry = NULL;
+
+    if (stats == NULL)
+    {
+        return NULL;
+    }
+    if (stats->index[cmd_id] != 0U)
+    {
+        return &stats->cmds[stats->index[cmd_id] - 1U];
+    }
+    if (stats->count >= COMM_STATS_CMD_NUM)
+    {
+        COMM_STATS_ADD(stats->untracked, 1U);
+        return NULL;
+    }
+    free_entry = &stats->cmds[stats->count];
+    stats->count++;
+    stats->index[cmd_id] = stats->count;
+    free_entry->cmd_id = cmd_id;
+    /* readers see the id before the entry */
+    __atomic_store_n(&free_entry->used, true, __ATOMIC_RELEASE);
+    return free_entry;
+}
+
+void comm_stats_reset(comm_stats_t *stats)
+{
+    if (stats != NULL)
+    {
+        memset(stats, 0, sizeof(comm_stats_t));
+    }
+}
+
+static void comm_stats_copy_cmd(comm_stats_cmd_t *dst, comm_stats_cmd_t *src, bool clear)
+{
+    uint8_t i = 0U;
+
+    /* 快照逐项原子读取，清零时逐项原子交换 */
+#define COMM_STATS_TAKE(field) \
+    dst->field = clear ? __atomic_exchange_n(&src->field, 0U, __ATOMIC_RELAXED) : COMM_STATS_LOAD(src->field)
+    COMM_STATS_TAKE(sent);
+    COMM_STATS_TAKE(matched);
+    COMM_STATS_TAKE(timeouts);
+    COMM_STATS_TAKE(retries);
+    COMM_STATS_TAKE(exhausted);
+    COMM_STATS_TAKE(latency_max);
+    COMM_STATS_TAKE(latency_sum);
+    for (i = 0U; i < COMM_STATS_BUCKET_NUM; i++)
+    {
+        COMM_STATS_TAKE(hist[i]);
+    }
+#undef COMM_STATS_TAKE
+}
+
+void comm_stats_clear(comm_stats_t *stats)
+{
+    comm_stats_cmd_t scratch;
+    uint8_t i = 0U;
+
+    if (stats == NULL)
+    {
+        return;
+    }
+    for (i = 0U; i < COMM_STATS_CMD_NUM; i++)
+    {
+        comm_stats_copy_cmd(&scratch, &stats->cmds[i], true);
+    }
+    COMM_STATS_STORE(stats->untracked, 0U);
+    COMM_STATS_STORE(stats->rejected, 0U);
+}
+
+void comm_stats_snapshot(const comm_stats_t *stats, comm_stats_t *snapshot)
+{
+    comm_stats_t *src = (comm_stats_t *)stats;
+    uint8_t i = 0U;
+
+    if (stats == NULL || snapshot == NULL)
+    {
+        return;
+    }
+    memset(snapshot, 0, sizeof(comm_stats_t));
+    for (i = 0U; i < COMM_STATS_CMD_NUM; i++)
+    {
+        if (__atomic_load_n(&src->cmds[i].used, __ATOMIC_ACQUIRE))
+        {
+            snapshot->cmds[i].used = true;
+            snapshot->cmds[i].cmd_id = src->cmds[i].cmd_id;
+            comm_stats_copy_cmd(&snapshot->cmds[i], &src->cmds[i], false);
+        }
+    }
+    snapshot->untracked = COMM_STATS_LOAD(src->untracked);
+    snapshot->rejected = COMM_STATS_LOAD(src->rejected);
+}
+
+void comm_stats_on_sent(comm_stats_t *stats, uint8_t cmd_id)
+{
+    comm_stats_cmd_t *cmd = comm_stats_entry(stats, cmd_id);
+
+    if (cmd != NULL)
+    {
+        COMM_STATS_ADD(cmd->sent, 1U);
+    }
+}
+
+void comm_stats_on_resp(comm_stats_t *stats, uint8_t cmd_id, uint32_t latency)
+{
+    comm_stats_cmd_t *cmd = comm_stats_entry(stats, cmd_id);
+
+    if (cmd != NULL)
+    {
+        COMM_STATS_ADD(cmd->matched, 1U);
+        COMM_STATS_ADD(cmd->latency_sum, latency);
+        if (latency > COMM_STATS_LOAD(cmd->latency_max))
+        {
+            COMM_STATS_STORE(cmd->latency_max, latency);
+        }
+        COMM_STATS_ADD(cmd->hist[comm_stats_bucket(latency)], 1U);
+    }
+}
+
+void comm_stats_on_timeout(comm_stats_t *stats, uint8_t cmd_id)
+{
+    comm_stats_cmd_t *cmd = comm_stats_entry(stats, cmd_id);
+
+    if (cmd != NULL)
+    {
+        COMM_STATS_ADD(cmd->timeouts, 1U);
+    }
+}
+
+void comm_stats_on_retry(comm_stats_t *stats, uint8_t cmd_id)
+{
+    comm_stats_cmd_t *cmd = comm_stats_entry(stats, cmd_id);
+
+    if (cmd != NULL)
+    {
+        COMM_STATS_ADD(cmd->retries, 1U);
+    }
+}
+
+void comm_stats_on_exhausted(comm_stats_t *stats, uint8_t cmd_id)
+{
+    comm_stats_cmd_t *cmd = comm_stats_entry(stats, cmd_id);
+
+    if (cmd != NULL)
+    {
+        COMM_STATS_ADD(cmd->exhausted, 1U);
+    }
+}
+
+void comm_stats_on_rejected(comm_stats_t *stats)
+{
+    if (stats != NULL)
+    {
+        COMM_STATS_ADD(stats->rejected, 1U);
+    }
+}
+
+const comm_stats_cmd_t *comm_stats_find(const comm_stats_t *stats, uint8_t cmd_id)
+{
+    uint8_t i = 0U;
+
+    if (stats == NULL)
+    {
+        return NULL;
+    }
+    for (i = 0U; i < COMM_STATS_CMD_NUM; i++)
+    {
+        if (stats->cmds[i].used && stats->cmds[i].cmd_id == cmd_id)
+        {
+            return &stats->cmds[i];
+        }
+    }
+    return NULL;
+}
+
+uint8_t comm_stats_bucket(uint32_t latency)
+{
+    uint8_t msb = 0U;
+    uint32_t bucket = 0U;
+
+    if (latency < 4U)
+    {
+        return (uint8_t)latency;
+    }
+    while ((latency >> (msb + 1U)) != 0U)
+    {
+        msb++;
+    }
+    /* 每个 2 的幂区间分成两半 */
+    bucket = (2U * msb) + ((latency >> (msb - 1U)) & 1U);
+    return (bucket < COMM_STATS_BUCKET_NUM) ? (uint8_t)bucket : (uint8_t)(COMM_STATS_BUCKET_NUM - 1U);
+}
+
+uint32_t comm_stats_bucket_low(uint8_t bucket)
+{
+    uint32_t msb = 0U;
+
+    if (bucket < 4U)
+    {
+        return bucket;
+    }
+    msb = bucket / 2U;
+    return (2U | (bucket & 1U)) << (msb - 1U);
+}
+
+uint32_t comm_stats_percentile(const comm_stats_cmd_t *cmd, uint16_t permille)
+{
+    uint32_t total = 0U;
+    uint32_t rank = 0U;
+    uint32_t seen = 0U;
+    uint8_t i = 0U;
+
+    if (cmd == NULL || permille > 1000U)
+    {
+        return 0U;
+    }
+    for (i = 0U; i < COMM_STATS_BUCKET_NUM; i++)
+    {
+        total += cmd->hist[i];
+    }
+    if (total == 0U)
+    {
+        return 0U;
+    }
+    rank = (uint32_t)(((uint64_t)total * permille + 999U) / 1000U);
+    if (rank == 0U)
+    {
+        rank = 1U;
+    }
+    for (i = 0U; i < COMM_STATS_BUCKET_NUM; i++)
+    {
+        seen += cmd->hist[i];
+        if (seen >= rank)
+        {
+            if (i + 1U >= COMM_STATS_BUCKET_NUM)
+            {
+                return cmd->latency_max;
+            }
+            /* report the bucket's upper bound, never above the observed max */
+            return ((comm_stats_bucket_low((uint8_t)(i + 1U)) - 1U) < cmd->latency_max) ?
+                   (comm_stats_bucket_low((uint8_t)(i + 1U)) - 1U) : cmd->latency_max;
+        }
+    }
+    return cmd->latency_max;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file comm_stats.h
+ * @brief Per-command counters and latency histograms
+ *
+ * A controller with a stats block attached (comm_ctrl_set_stats()) keeps,
+ * for each command id it has sent, the number of requests, matched
+ * responses, timeouts, retries and exhausted retries, plus a log-bucketed
+ * (HDR style) histogram of the send to response latency in kernel ticks.
+ * The block lives outside comm_ctrl_t, so links without one stay small.
+ * It has room for every command of a full comm_table_t, and an id index
+ * finds the entry of a command without a search.
+ *
+ * Buckets 0..3 hold one value each; above that every power of two is
+ * split into two buckets, so the relative error stays below 50 % up to
+ * 65535 ticks in 32 buckets:
+ *   0, 1, 2, 3, 4-5, 6-7, 8-11, 12-15, 16-23, 24-31, ...
+ *
+ * No lock is taken. Entries are claimed and updated by one thread only,
+ * the controller thread (the rejected counter by the receive thread),
+ * every counter is a relaxed atomic, and comm_stats_snapshot() copies
+ * them field by field from any thread. A snapshot taken under traffic
+ * may therefore miss the events in flight while it is copied.
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#ifndef COMM_STATS_H
+#define COMM_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "comm_table.h"
+
+#ifndef COMM_STATS_CMD_NUM
+#define COMM_STATS_CMD_NUM          COMM_TABLE_MAX_ENTRIES  /* command ids tracked per controller */
+#endif
+#if COMM_STATS_CMD_NUM > 255U
+#error "COMM_STATS_CMD_NUM must fit the uint8_t id index"
+#endif
+#define COMM_STATS_BUCKET_NUM       32U
+
+/**
+ * @brief Statistics of one command id
+ */
+typedef struct {
+    bool used;
+    uint8_t cmd_id;
+    uint32_t sent;              /**< requests put on the link, resends included */
+    uint32_t matched;           /**< responses accepted */
+    uint32_t timeouts;          /**< response timeouts */
+    uint32_t retries;           /**< resends after a timeout */
+    uint32_t exhausted;         /**< commands dropped after the last retry */
+    uint32_t latency_max;       /**< ticks */
+    uint32_t latency_sum;       /**< ticks, for the mean */
+    uint32_t hist[COMM_STATS_BUCKET_NUM];
+} comm_stats_cmd_t;
+
+/**
+ * @brief Statistics of one controller
+ */
+typedef struct {
+    comm_stats_cmd_t cmds[COMM_STATS_CMD_NUM];
+    uint8_t index[COMM_TABLE_ID_COUNT];     /**< command id to entry + 1, 0 = none (controller thread only) */
+    uint8_t count;                          /**< entries claimed, in claim order (controller thread only) */
+    uint32_t untracked;         /**< events of ids that found no free entry */
+    uint32_t rejected;          /**< received frames failing the command table check */
+    uint32_t events_coalesced;  /**< fsm events merged into a pending copy (snapshot only) */
+    uint32_t events_dropped;    /**< fsm events lost to a full queue (snapshot only) */
+} comm_stats_t;
+
+/**
+ * @brief Forget every entry; only while no thread updates @p stats
+ */
+void comm_stats_reset(comm_stats_t *stats);
+
+/**
+ * @brief Zero every counter and keep the entries, safe under traffic
+ */
+void comm_stats_clear(comm_stats_t *stats);
+
+/**
+ * @brief Copy the counters, safe under traffic
+ */
+void comm_stats_snapshot(const comm_stats_t *stats, comm_stats_t *snapshot);
+
+void comm_stats_on_sent(comm_stats_t *stats, uint8_t cmd_id);
+void comm_stats_on_resp(comm_stats_t *stats, uint8_t cmd_id, uint32_t latency);
+void comm_stats_on_timeout(comm_stats_t *stats, uint8_t cmd_id);
+void comm_stats_on_retry(comm_stats_t *stats, uint8_t cmd_id);
+void comm_stats_on_exhausted(comm_stats_t *stats, uint8_t cmd_id);
+void comm_stats_on_rejected(comm_stats_t *stats);
+
+/**
+ * @brief Find the entry of a command id in a snapshot
+ * @return Entry, or NULL if the id was never sent
+ */
+const comm_stats_cmd_t *comm_stats_find(const comm_stats_t *stats, uint8_t cmd_id);
+
+/**
+ * @brief Histogram bucket of a latency
+ */
+uint8_t comm_stats_bucket(uint32_t latency);
+
+/**
+ * @brief Smallest latency that falls into @p bucket
+ */
+uint32_t comm_stats_bucket_low(uint8_t bucket);
+
+/**
+ * @brief Latency percentile from the histogram
+ *
+ * @param cmd Entry from a snapshot
+ * @param permille Percentile in 1/1000, e.g. 990 for p99
+ * @return Upper bound of the bucket holding the percentile, in ticks
+ */
+uint32_t comm_stats_percentile(const comm_stats_cmd_t *cmd, uint16_t permille);
+
+#endif // COMM_STATS_H
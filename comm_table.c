@@ -14,151 +14,196 @@
 
 #include "comm_table.h"
 
-typedef struct{
-    uint8_t send_cmd_id;
-    uint8_t resp_cmd_id;
-    uint16_t timeout;
-    uint16_t retry_count;
-}comm_cmd_table_t;
-
+/*
+ * RESP_LEN 是应答 ID 之后的字节数，取自 AP3 命令集（slave/ap3_cmd.json）。
+ * 随机型变化的应答（USER_OPERATION、SETTING_INFO_GET、CMD_DATA_GET）填 0 不检查，
+ * 需要检查时给链路加载对应机型的表。PROG_UPDATE 的应答是 comm_bulk 的
+ * [seq_hi][seq_lo][status]，为 3 字节。
+ */
 
 #define COMM_USER_OPERATION_REQ                     0xf0
 #define COMM_USER_OPERATION_RESP                    0xf1
 #define COMM_USER_OPERATION_TIMEOUT                 1000
 #define COMM_USER_OPERATION_RETRY                   3
-#define COMM_CMD_USER_OPERATION    COMM_USER_OPERATION_REQ, COMM_USER_OPERATION_RESP, COMM_USER_OPERATION_TIMEOUT, COMM_USER_OPERATION_RETRY
+#define COMM_USER_OPERATION_CACHE_TTL               0
+#define COMM_USER_OPERATION_RESP_LEN                0
+#define COMM_CMD_USER_OPERATION    COMM_USER_OPERATION_REQ, COMM_USER_OPERATION_RESP, COMM_USER_OPERATION_TIMEOUT, COMM_USER_OPERATION_RETRY, COMM_USER_OPERATION_CACHE_TTL, COMM_USER_OPERATION_RESP_LEN
 
 #define COMM_ENTER_SETTING_REQ                      0x20
 #define COMM_ENTER_SETTING_RESP                     0x21
 #define COMM_ENTER_SETTING_TIMEOUT                  1000
 #define COMM_ENTER_SETTING_RETRY                    3
-#define COMM_CMD_ENTER_SETTING    COMM_ENTER_SETTING_REQ, COMM_ENTER_SETTING_RESP, COMM_ENTER_SETTING_TIMEOUT, COMM_ENTER_SETTING_RETRY
+#define COMM_ENTER_SETTING_CACHE_TTL                0
+#define COMM_ENTER_SETTING_RESP_LEN                 1
+#define COMM_CMD_ENTER_SETTING    COMM_ENTER_SETTING_REQ, COMM_ENTER_SETTING_RESP, COMM_ENTER_SETTING_TIMEOUT, COMM_ENTER_SETTING_RETRY, COMM_ENTER_SETTING_CACHE_TTL, COMM_ENTER_SETTING_RESP_LEN
 
 #define COMM_EXIT_SETTING_REQ                       0x22
 #define COMM_EXIT_SETTING_RESP                      0x23
 #define COMM_EXIT_SETTING_TIMEOUT                   1000
 #define COMM_EXIT_SETTING_RETRY                     3
-#define COMM_CMD_EXIT_SETTING    COMM_EXIT_SETTING_REQ, COMM_EXIT_SETTING_RESP, COMM_EXIT_SETTING_TIMEOUT, COMM_EXIT_SETTING_RETRY
+#define COMM_EXIT_SETTING_CACHE_TTL                 0
+#define COMM_EXIT_SETTING_RESP_LEN                  1
+#define COMM_CMD_EXIT_SETTING    COMM_EXIT_SETTING_REQ, COMM_EXIT_SETTING_RESP, COMM_EXIT_SETTING_TIMEOUT, COMM_EXIT_SETTING_RETRY, COMM_EXIT_SETTING_CACHE_TTL, COMM_EXIT_SETTING_RESP_LEN
 
 #define COMM_FC_SET_REQ                             0x04
 #define COMM_FC_SET_RESP                            0x05
 #define COMM_FC_SET_TIMEOUT                         1000
 #define COMM_FC_SET_RETRY                           3
-#define COMM_CMD_FC_SET         COMM_FC_SET_REQ, COMM_FC_SET_RESP, COMM_FC_SET_TIMEOUT, COMM_FC_SET_RETRY
+#define COMM_FC_SET_CACHE_TTL                       0
+#define COMM_FC_SET_RESP_LEN                        2
+#define COMM_CMD_FC_SET         COMM_FC_SET_REQ, COMM_FC_SET_RESP, COMM_FC_SET_TIMEOUT, COMM_FC_SET_RETRY, COMM_FC_SET_CACHE_TTL, COMM_FC_SET_RESP_LEN
 
 #define COMM_PROG_UPDATE_REQ                        0x08
 #define COMM_PROG_UPDATE_RESP                       0x09
 #define COMM_PROG_UPDATE_TIMEOUT                    1000
 #define COMM_PROG_UPDATE_RETRY                      3
-#define COMM_CMD_PROG_UPDATE    COMM_PROG_UPDATE_REQ, COMM_PROG_UPDATE_RESP, COMM_PROG_UPDATE_TIMEOUT, COMM_PROG_UPDATE_RETRY
+#define COMM_PROG_UPDATE_CACHE_TTL                  0
+#define COMM_PROG_UPDATE_RESP_LEN                   3
+#define COMM_CMD_PROG_UPDATE    COMM_PROG_UPDATE_REQ, COMM_PROG_UPDATE_RESP, COMM_PROG_UPDATE_TIMEOUT, COMM_PROG_UPDATE_RETRY, COMM_PROG_UPDATE_CACHE_TTL, COMM_PROG_UPDATE_RESP_LEN
 
 #define COMM_BUZZER_VOLUME_REQ                      0x0e
 #define COMM_BUZZER_VOLUME_RESP                     0x0f
 #define COMM_BUZZER_VOLUME_TIMEOUT                  1000
 #define COMM_BUZZER_VOLUME_RETRY                    3
-#define COMM_CMD_BUZZER_VOLUME    COMM_BUZZER_VOLUME_REQ, COMM_BUZZER_VOLUME_RESP, COMM_BUZZER_VOLUME_TIMEOUT, COMM_BUZZER_VOLUME_RETRY
+#define COMM_BUZZER_VOLUME_CACHE_TTL                0
+#define COMM_BUZZER_VOLUME_RESP_LEN                 2
+#define COMM_CMD_BUZZER_VOLUME    COMM_BUZZER_VOLUME_REQ, COMM_BUZZER_VOLUME_RESP, COMM_BUZZER_VOLUME_TIMEOUT, COMM_BUZZER_VOLUME_RETRY, COMM_BUZZER_VOLUME_CACHE_TTL, COMM_BUZZER_VOLUME_RESP_LEN
 
 #define COMM_FACTORY_INIT_REQ                       0x40
 #define COMM_FACTORY_INIT_RESP                      0x41
 #define COMM_FACTORY_INIT_TIMEOUT                   1000
 #define COMM_FACTORY_INIT_RETRY                     3
-#define COMM_CMD_FACTORY_INIT    COMM_FACTORY_INIT_REQ, COMM_FACTORY_INIT_RESP, COMM_FACTORY_INIT_TIMEOUT, COMM_FACTORY_INIT_RETRY
+#define COMM_FACTORY_INIT_CACHE_TTL                 0
+#define COMM_FACTORY_INIT_RESP_LEN                  1
+#define COMM_CMD_FACTORY_INIT    COMM_FACTORY_INIT_REQ, COMM_FACTORY_INIT_RESP, COMM_FACTORY_INIT_TIMEOUT, COMM_FACTORY_INIT_RETRY, COMM_FACTORY_INIT_CACHE_TTL, COMM_FACTORY_INIT_RESP_LEN
 
 #define COMM_FC_CALIB_START_REQ                     0x42
 #define COMM_FC_CALIB_START_RESP                    0x43
 #define COMM_FC_CALIB_START_TIMEOUT                 1000
 #define COMM_FC_CALIB_START_RETRY                   3
-#define COMM_CMD_FC_CALIB_START    COMM_FC_CALIB_START_REQ, COMM_FC_CALIB_START_RESP, COMM_FC_CALIB_START_TIMEOUT, COMM_FC_CALIB_START_RETRY
+#define COMM_FC_CALIB_START_CACHE_TTL               0
+#define COMM_FC_CALIB_START_RESP_LEN                1
+#define COMM_CMD_FC_CALIB_START    COMM_FC_CALIB_START_REQ, COMM_FC_CALIB_START_RESP, COMM_FC_CALIB_START_TIMEOUT, COMM_FC_CALIB_START_RETRY, COMM_FC_CALIB_START_CACHE_TTL, COMM_FC_CALIB_START_RESP_LEN
 
 #define COMM_FC_CALIB_GET_REQ                       0x44
 #define COMM_FC_CALIB_GET_RESP                      0x45
 #define COMM_FC_CALIB_GET_TIMEOUT                   1000
 #define COMM_FC_CALIB_GET_RETRY                     3
-#define COMM_CMD_FC_CALIB_GET    COMM_FC_CALIB_GET_REQ, COMM_FC_CALIB_GET_RESP, COMM_FC_CALIB_GET_TIMEOUT, COMM_FC_CALIB_GET_RETRY
+#define COMM_FC_CALIB_GET_CACHE_TTL                 0
+#define COMM_FC_CALIB_GET_RESP_LEN                  1
+#define COMM_CMD_FC_CALIB_GET    COMM_FC_CALIB_GET_REQ, COMM_FC_CALIB_GET_RESP, COMM_FC_CALIB_GET_TIMEOUT, COMM_FC_CALIB_GET_RETRY, COMM_FC_CALIB_GET_CACHE_TTL, COMM_FC_CALIB_GET_RESP_LEN
 
 #define COMM_FC_CALIB_GET_STOP_REQ                  0x46
 #define COMM_FC_CALIB_GET_STOP_RESP                 0x47
 #define COMM_FC_CALIB_GET_STOP_TIMEOUT              1000
 #define COMM_FC_CALIB_GET_STOP_RETRY                3
-#define COMM_CMD_FC_CALIB_GET_STOP    COMM_FC_CALIB_GET_STOP_REQ, COMM_FC_CALIB_GET_STOP_RESP, COMM_FC_CALIB_GET_STOP_TIMEOUT, COMM_FC_CALIB_GET_STOP_RETRY
+#define COMM_FC_CALIB_GET_STOP_CACHE_TTL            0
+#define COMM_FC_CALIB_GET_STOP_RESP_LEN             1
+#define COMM_CMD_FC_CALIB_GET_STOP    COMM_FC_CALIB_GET_STOP_REQ, COMM_FC_CALIB_GET_STOP_RESP, COMM_FC_CALIB_GET_STOP_TIMEOUT, COMM_FC_CALIB_GET_STOP_RETRY, COMM_FC_CALIB_GET_STOP_CACHE_TTL, COMM_FC_CALIB_GET_STOP_RESP_LEN
 
 #define COMM_FC_CALIB_MEMORY_SET_REQ                0x48
 #define COMM_FC_CALIB_MEMORY_SET_RESP               0x49
 #define COMM_FC_CALIB_MEMORY_SET_TIMEOUT            1000
 #define COMM_FC_CALIB_MEMORY_SET_RETRY              3
-#define COMM_CMD_FC_CALIB_MEMORY_SET    COMM_FC_CALIB_MEMORY_SET_REQ, COMM_FC_CALIB_MEMORY_SET_RESP, COMM_FC_CALIB_MEMORY_SET_TIMEOUT, COMM_FC_CALIB_MEMORY_SET_RETRY
+#define COMM_FC_CALIB_MEMORY_SET_CACHE_TTL          0
+#define COMM_FC_CALIB_MEMORY_SET_RESP_LEN           1
+#define COMM_CMD_FC_CALIB_MEMORY_SET    COMM_FC_CALIB_MEMORY_SET_REQ, COMM_FC_CALIB_MEMORY_SET_RESP, COMM_FC_CALIB_MEMORY_SET_TIMEOUT, COMM_FC_CALIB_MEMORY_SET_RETRY, COMM_FC_CALIB_MEMORY_SET_CACHE_TTL, COMM_FC_CALIB_MEMORY_SET_RESP_LEN
 
 #define COMM_MOTOR_SPEED_CALIB_START_REQ            0x4c
 #define COMM_MOTOR_SPEED_CALIB_START_RESP           0x4d
 #define COMM_MOTOR_SPEED_CALIB_START_TIMEOUT        1000
 #define COMM_MOTOR_SPEED_CALIB_START_RETRY          3
-#define COMM_CMD_MOTOR_SPEED_CALIB_START    COMM_MOTOR_SPEED_CALIB_START_REQ, COMM_MOTOR_SPEED_CALIB_START_RESP, COMM_MOTOR_SPEED_CALIB_START_TIMEOUT, COMM_MOTOR_SPEED_CALIB_START_RETRY
+#define COMM_MOTOR_SPEED_CALIB_START_CACHE_TTL      0
+#define COMM_MOTOR_SPEED_CALIB_START_RESP_LEN       1
+#define COMM_CMD_MOTOR_SPEED_CALIB_START    COMM_MOTOR_SPEED_CALIB_START_REQ, COMM_MOTOR_SPEED_CALIB_START_RESP, COMM_MOTOR_SPEED_CALIB_START_TIMEOUT, COMM_MOTOR_SPEED_CALIB_START_RETRY, COMM_MOTOR_SPEED_CALIB_START_CACHE_TTL, COMM_MOTOR_SPEED_CALIB_START_RESP_LEN
 
 #define COMM_MOTOR_LOW_SPEED_CALIB_GET_REQ          0x4e
 #define COMM_MOTOR_LOW_SPEED_CALIB_GET_RESP         0x4f
 #define COMM_MOTOR_LOW_SPEED_CALIB_GET_TIMEOUT      1000
 #define COMM_MOTOR_LOW_SPEED_CALIB_GET_RETRY        3
-#define COMM_CMD_MOTOR_LOW_SPEED_CALIB_GET    COMM_MOTOR_LOW_SPEED_CALIB_GET_REQ, COMM_MOTOR_LOW_SPEED_CALIB_GET_RESP, COMM_MOTOR_LOW_SPEED_CALIB_GET_TIMEOUT, COMM_MOTOR_LOW_SPEED_CALIB_GET_RETRY
+#define COMM_MOTOR_LOW_SPEED_CALIB_GET_CACHE_TTL    0
+#define COMM_MOTOR_LOW_SPEED_CALIB_GET_RESP_LEN     1
+#define COMM_CMD_MOTOR_LOW_SPEED_CALIB_GET    COMM_MOTOR_LOW_SPEED_CALIB_GET_REQ, COMM_MOTOR_LOW_SPEED_CALIB_GET_RESP, COMM_MOTOR_LOW_SPEED_CALIB_GET_TIMEOUT, COMM_MOTOR_LOW_SPEED_CALIB_GET_RETRY, COMM_MOTOR_LOW_SPEED_CALIB_GET_CACHE_TTL, COMM_MOTOR_LOW_SPEED_CALIB_GET_RESP_LEN
 
 #define COMM_MOTOR_HIGH_SPEED_CALIB_GET_REQ         0x50
 #define COMM_MOTOR_HIGH_SPEED_CALIB_GET_RESP        0x51
 #define COMM_MOTOR_HIGH_SPEED_CALIB_GET_TIMEOUT     1000
 #define COMM_MOTOR_HIGH_SPEED_CALIB_GET_RETRY       3
-#define COMM_CMD_MOTOR_HIGH_SPEED_CALIB_GET    COMM_MOTOR_HIGH_SPEED_CALIB_GET_REQ, COMM_MOTOR_HIGH_SPEED_CALIB_GET_RESP, COMM_MOTOR_HIGH_SPEED_CALIB_GET_TIMEOUT, COMM_MOTOR_HIGH_SPEED_CALIB_GET_RETRY
+#define COMM_MOTOR_HIGH_SPEED_CALIB_GET_CACHE_TTL   0
+#define COMM_MOTOR_HIGH_SPEED_CALIB_GET_RESP_LEN    1
+#define COMM_CMD_MOTOR_HIGH_SPEED_CALIB_GET    COMM_MOTOR_HIGH_SPEED_CALIB_GET_REQ, COMM_MOTOR_HIGH_SPEED_CALIB_GET_RESP, COMM_MOTOR_HIGH_SPEED_CALIB_GET_TIMEOUT, COMM_MOTOR_HIGH_SPEED_CALIB_GET_RETRY, COMM_MOTOR_HIGH_SPEED_CALIB_GET_CACHE_TTL, COMM_MOTOR_HIGH_SPEED_CALIB_GET_RESP_LEN
 
 #define COMM_MOTOR_SPEED_CALIB_GET_STOP_REQ         0x52
 #define COMM_MOTOR_SPEED_CALIB_GET_STOP_RESP        0x53
 #define COMM_MOTOR_SPEED_CALIB_GET_STOP_TIMEOUT     1000
 #define COMM_MOTOR_SPEED_CALIB_GET_STOP_RETRY       3
-#define COMM_CMD_MOTOR_SPEED_CALIB_GET_STOP    COMM_MOTOR_SPEED_CALIB_GET_STOP_REQ, COMM_MOTOR_SPEED_CALIB_GET_STOP_RESP, COMM_MOTOR_SPEED_CALIB_GET_STOP_TIMEOUT, COMM_MOTOR_SPEED_CALIB_GET_STOP_RETRY
+#define COMM_MOTOR_SPEED_CALIB_GET_STOP_CACHE_TTL   0
+#define COMM_MOTOR_SPEED_CALIB_GET_STOP_RESP_LEN    1
+#define COMM_CMD_MOTOR_SPEED_CALIB_GET_STOP    COMM_MOTOR_SPEED_CALIB_GET_STOP_REQ, COMM_MOTOR_SPEED_CALIB_GET_STOP_RESP, COMM_MOTOR_SPEED_CALIB_GET_STOP_TIMEOUT, COMM_MOTOR_SPEED_CALIB_GET_STOP_RETRY, COMM_MOTOR_SPEED_CALIB_GET_STOP_CACHE_TTL, COMM_MOTOR_SPEED_CALIB_GET_STOP_RESP_LEN
 
 #define COMM_MACHINE_ID_REQ                         0x80
 #define COMM_MACHINE_ID_RESP                        0x81
 #define COMM_MACHINE_ID_TIMEOUT                     1000
 #define COMM_MACHINE_ID_RETRY                       3
-#define COMM_CMD_MACHINE_ID    COMM_MACHINE_ID_REQ, COMM_MACHINE_ID_RESP, COMM_MACHINE_ID_TIMEOUT, COMM_MACHINE_ID_RETRY
+#define COMM_MACHINE_ID_CACHE_TTL                   60000
+#define COMM_MACHINE_ID_RESP_LEN                    9
+#define COMM_CMD_MACHINE_ID    COMM_MACHINE_ID_REQ, COMM_MACHINE_ID_RESP, COMM_MACHINE_ID_TIMEOUT, COMM_MACHINE_ID_RETRY, COMM_MACHINE_ID_CACHE_TTL, COMM_MACHINE_ID_RESP_LEN
 
 #define COMM_SERIAL_NUMBER_GET_REQ                  0x82
 #define COMM_SERIAL_NUMBER_GET_RESP                 0x83
 #define COMM_SERIAL_NUMBER_GET_TIMEOUT              1000
 #define COMM_SERIAL_NUMBER_GET_RETRY                3
-#define COMM_CMD_SERIAL_NUMBER_GET    COMM_SERIAL_NUMBER_GET_REQ, COMM_SERIAL_NUMBER_GET_RESP, COMM_SERIAL_NUMBER_GET_TIMEOUT, COMM_SERIAL_NUMBER_GET_RETRY
+#define COMM_SERIAL_NUMBER_GET_CACHE_TTL            60000
+#define COMM_SERIAL_NUMBER_GET_RESP_LEN             9
+#define COMM_CMD_SERIAL_NUMBER_GET    COMM_SERIAL_NUMBER_GET_REQ, COMM_SERIAL_NUMBER_GET_RESP, COMM_SERIAL_NUMBER_GET_TIMEOUT, COMM_SERIAL_NUMBER_GET_RETRY, COMM_SERIAL_NUMBER_GET_CACHE_TTL, COMM_SERIAL_NUMBER_GET_RESP_LEN
 
 #define COMM_SOFTWART_VERSION_GET_REQ               0x84
 #define COMM_SOFTWART_VERSION_GET_RESP              0x85
 #define COMM_SOFTWART_VERSION_GET_TIMEOUT           1000
 #define COMM_SOFTWART_VERSION_GET_RETRY             3
-#define COMM_CMD_SOFTWART_VERSION_GET    COMM_SOFTWART_VERSION_GET_REQ, COMM_SOFTWART_VERSION_GET_RESP, COMM_SOFTWART_VERSION_GET_TIMEOUT, COMM_SOFTWART_VERSION_GET_RETRY
+#define COMM_SOFTWART_VERSION_GET_CACHE_TTL         60000
+#define COMM_SOFTWART_VERSION_GET_RESP_LEN          3
+#define COMM_CMD_SOFTWART_VERSION_GET    COMM_SOFTWART_VERSION_GET_REQ, COMM_SOFTWART_VERSION_GET_RESP, COMM_SOFTWART_VERSION_GET_TIMEOUT, COMM_SOFTWART_VERSION_GET_RETRY, COMM_SOFTWART_VERSION_GET_CACHE_TTL, COMM_SOFTWART_VERSION_GET_RESP_LEN
 
 #define COMM_ERROR_INFO_GET_REQ                     0x86
 #define COMM_ERROR_INFO_GET_RESP                    0x87
 #define COMM_ERROR_INFO_GET_TIMEOUT                 1000
 #define COMM_ERROR_INFO_GET_RETRY                   3
-#define COMM_CMD_ERROR_INFO_GET    COMM_ERROR_INFO_GET_REQ, COMM_ERROR_INFO_GET_RESP, COMM_ERROR_INFO_GET_TIMEOUT, COMM_ERROR_INFO_GET_RETRY
+#define COMM_ERROR_INFO_GET_CACHE_TTL               0
+#define COMM_ERROR_INFO_GET_RESP_LEN                3
+#define COMM_CMD_ERROR_INFO_GET    COMM_ERROR_INFO_GET_REQ, COMM_ERROR_INFO_GET_RESP, COMM_ERROR_INFO_GET_TIMEOUT, COMM_ERROR_INFO_GET_RETRY, COMM_ERROR_INFO_GET_CACHE_TTL, COMM_ERROR_INFO_GET_RESP_LEN
 
 #define COMM_PROG_INFO_GET_REQ                      0x88
 #define COMM_PROG_INFO_GET_RESP                     0x89
 #define COMM_PROG_INFO_GET_TIMEOUT                  1000
 #define COMM_PROG_INFO_GET_RETRY                    3
-#define COMM_CMD_PROG_INFO_GET    COMM_PROG_INFO_GET_REQ, COMM_PROG_INFO_GET_RESP, COMM_PROG_INFO_GET_TIMEOUT, COMM_PROG_INFO_GET_RETRY
+#define COMM_PROG_INFO_GET_CACHE_TTL                0
+#define COMM_PROG_INFO_GET_RESP_LEN                 9
+#define COMM_CMD_PROG_INFO_GET    COMM_PROG_INFO_GET_REQ, COMM_PROG_INFO_GET_RESP, COMM_PROG_INFO_GET_TIMEOUT, COMM_PROG_INFO_GET_RETRY, COMM_PROG_INFO_GET_CACHE_TTL, COMM_PROG_INFO_GET_RESP_LEN
 
 #define COMM_SETTING_INFO_GET_REQ                   0x8c
 #define COMM_SETTING_INFO_GET_RESP                  0x8d
 #define COMM_SETTING_INFO_GET_TIMEOUT               1000
 #define COMM_SETTING_INFO_GET_RETRY                 3
-#define COMM_CMD_SETTING_INFO_GET    COMM_SETTING_INFO_GET_REQ, COMM_SETTING_INFO_GET_RESP, COMM_SETTING_INFO_GET_TIMEOUT, COMM_SETTING_INFO_GET_RETRY
+#define COMM_SETTING_INFO_GET_CACHE_TTL             0
+#define COMM_SETTING_INFO_GET_RESP_LEN              0
+#define COMM_CMD_SETTING_INFO_GET    COMM_SETTING_INFO_GET_REQ, COMM_SETTING_INFO_GET_RESP, COMM_SETTING_INFO_GET_TIMEOUT, COMM_SETTING_INFO_GET_RETRY, COMM_SETTING_INFO_GET_CACHE_TTL, COMM_SETTING_INFO_GET_RESP_LEN
 
 #define COMM_MACHINE_TYPE_GET_REQ                   0x8e
 #define COMM_MACHINE_TYPE_GET_RESP                  0x8f
 #define COMM_MACHINE_TYPE_GET_TIMEOUT               1000
 #define COMM_MACHINE_TYPE_GET_RETRY                 3
-#define COMM_CMD_MACHINE_TYPE_GET    COMM_MACHINE_TYPE_GET_REQ, COMM_MACHINE_TYPE_GET_RESP, COMM_MACHINE_TYPE_GET_TIMEOUT, COMM_MACHINE_TYPE_GET_RETRY
+#define COMM_MACHINE_TYPE_GET_CACHE_TTL             60000
+#define COMM_MACHINE_TYPE_GET_RESP_LEN              2
+#define COMM_CMD_MACHINE_TYPE_GET    COMM_MACHINE_TYPE_GET_REQ, COMM_MACHINE_TYPE_GET_RESP, COMM_MACHINE_TYPE_GET_TIMEOUT, COMM_MACHINE_TYPE_GET_RETRY, COMM_MACHINE_TYPE_GET_CACHE_TTL, COMM_MACHINE_TYPE_GET_RESP_LEN
 
 #define COMM_CMD_DATA_GET_REQ                       0x90
 #define COMM_CMD_DATA_GET_RESP                      0x91
 #define COMM_CMD_DATA_GET_TIMEOUT                   1000
 #define COMM_CMD_DATA_GET_RETRY                     3
-#define COMM_CMD_CMD_DATA_GET    COMM_CMD_DATA_GET_REQ, COMM_CMD_DATA_GET_RESP, COMM_CMD_DATA_GET_TIMEOUT, COMM_CMD_DATA_GET_RETRY
+#define COMM_CMD_DATA_GET_CACHE_TTL                 0
+#define COMM_CMD_DATA_GET_RESP_LEN                  0
+#define COMM_CMD_CMD_DATA_GET    COMM_CMD_DATA_GET_REQ, COMM_CMD_DATA_GET_RESP, COMM_CMD_DATA_GET_TIMEOUT, COMM_CMD_DATA_GET_RETRY, COMM_CMD_DATA_GET_CACHE_TTL, COMM_CMD_DATA_GET_RESP_LEN
 
 static const comm_cmd_table_t comm_cmd_table[] = {
     {COMM_CMD_USER_OPERATION                        },
@@ -188,28 +233,109 @@ static const comm_cmd_table_t comm_cmd_table[] = {
 
 #define COMM_CMD_TABLE_SIZE (sizeof(comm_cmd_table) / sizeof(comm_cmd_table_t))
 
+static comm_table_t comm_table_builtin;
+static uint8_t comm_table_state = 0U;   /* 0 未建立，1 建立中，2 完成 */
+
+typedef char comm_table_size_check_t[(COMM_CMD_TABLE_SIZE <= COMM_TABLE_MAX_ENTRIES) ? 1 : -1];
+
+comm_result_t comm_table_build(comm_table_t *table, const comm_cmd_table_t *entries, uint8_t count)
+{
+    uint8_t i = 0;
+
+    if (table == NULL || (entries == NULL && count != 0U) || count > COMM_TABLE_MAX_ENTRIES)
+    {
+        return COMM_ERROR;
+    }
+    if (entries != table->entries && count != 0U)
+    {
+        memcpy(table->entries, entries, count * sizeof(comm_cmd_table_t));
+    }
+    table->count = count;
+    memset(table->send_index, 0, sizeof(table->send_index));
+    memset(table->resp_index, 0, sizeof(table->resp_index));
+    /* 倒序建立索引，ID 重复时与原线性查找一样以靠前的表项为准 */
+    for (i = count; i > 0U; i--)
+    {
+        table->send_index[table->entries[i - 1U].send_cmd_id] = i;
+        table->resp_index[table->entries[i - 1U].resp_cmd_id] = i;
+    }
+    return COMM_OK;
+}
+
+void comm_table_init(void)
+{
+    uint8_t expected = 0U;
+
+    if (__atomic_load_n(&comm_table_state, __ATOMIC_ACQUIRE) == 2U)
+    {
+        return;
+    }
+    /* 只有一个调用者建立索引，其余的等它完成 */
+    if (__atomic_compare_exchange_n(&comm_table_state, &expected, 1U, false,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+    {
+        (void)comm_table_build(&comm_table_builtin, comm_cmd_table, (uint8_t)COMM_CMD_TABLE_SIZE);
+        __atomic_store_n(&comm_table_state, 2U, __ATOMIC_RELEASE);
+        return;
+    }
+    while (__atomic_load_n(&comm_table_state, __ATOMIC_ACQUIRE) != 2U)
+    {
+    }
+}
+
+const comm_table_t *comm_table_default(void)
+{
+    comm_table_init();
+    return &comm_table_builtin;
+}
+
+const comm_cmd_table_t *comm_table_lookup_send(const comm_table_t *table, uint8_t send_cmd_id)
+{
+    uint8_t idx = 0;
+
+    if (table == NULL)
+    {
+        table = comm_table_default();
+    }
+    idx = table->send_index[send_cmd_id];
+    return (idx != 0U) ? &table->entries[idx - 1U] : NULL;
+}
+
+const comm_cmd_table_t *comm_table_lookup_resp(const comm_table_t *table, uint8_t resp_cmd_id)
+{
+    uint8_t idx = 0;
+
+    if (table == NULL)
+    {
+        table = comm_table_default();
+    }
+    idx = table->resp_index[resp_cmd_id];
+    return (idx != 0U) ? &table->entries[idx - 1U] : NULL;
+}
+
+const comm_cmd_table_t *comm_table_find_by_send(uint8_t send_cmd_id)
+{
+    return comm_table_lookup_send(NULL, send_cmd_id);
+}
+
+const comm_cmd_table_t *comm_table_find_by_resp(uint8_t resp_cmd_id)
+{
+    return comm_table_lookup_resp(NULL, resp_cmd_id);
+}
+
 /**
  * @brief Get response command ID by send command ID
  */
 bool comm_table_get_resp_by_send(uint8_t send_cmd_id, uint8_t *resp_cmd_id)
 {
-    bool found = false;
-    uint16_t i = 0;
-    
-    if (resp_cmd_id != NULL)
+    const comm_cmd_table_t *entry = comm_table_find_by_send(send_cmd_id);
+
+    if (entry == NULL || resp_cmd_id == NULL)
     {
-        for (i = 0; i < COMM_CMD_TABLE_SIZE; i++)
-        {
-            if (comm_cmd_table[i].send_cmd_id == send_cmd_id)
-            {
-                *resp_cmd_id = comm_cmd_table[i].resp_cmd_id;
-                found = true;
-                break;
-            }
-        }
+        return false;
     }
-    
-    return found;
+    *resp_cmd_id = entry->resp_cmd_id;
+    return true;
 }
 
 /**
@@ -217,23 +343,14 @@ bool comm_table_get_resp_by_send(uint8_t send_cmd_id, uint8_t *resp_cmd_id)
  */
 bool comm_table_get_send_by_resp(uint8_t resp_cmd_id, uint8_t *send_cmd_id)
 {
-    bool found = false;
-    uint16_t i = 0;
-    
-    if (send_cmd_id != NULL)
+    const comm_cmd_table_t *entry = comm_table_find_by_resp(resp_cmd_id);
+
+    if (entry == NULL || send_cmd_id == NULL)
     {
-        for (i = 0; i < COMM_CMD_TABLE_SIZE; i++)
-        {
-            if (comm_cmd_table[i].resp_cmd_id == resp_cmd_id)
-            {
-                *send_cmd_id = comm_cmd_table[i].send_cmd_id;
-                found = true;
-                break;
-            }
-        }
+        return false;
     }
-    
-    return found;
+    *send_cmd_id = entry->send_cmd_id;
+    return true;
 }
 
 /**
@@ -241,23 +358,14 @@ bool comm_table_get_send_by_resp(uint8_t resp_cmd_id, uint8_t *send_cmd_id)
  */
 bool comm_table_get_timeout_by_send(uint8_t send_cmd_id, uint16_t *timeout)
 {
-    bool found = false;
-    uint16_t i = 0;
-    
-    if (timeout != NULL)
+    const comm_cmd_table_t *entry = comm_table_find_by_send(send_cmd_id);
+
+    if (entry == NULL || timeout == NULL)
     {
-        for (i = 0; i < COMM_CMD_TABLE_SIZE; i++)
-        {
-            if (comm_cmd_table[i].send_cmd_id == send_cmd_id)
-            {
-                *timeout = comm_cmd_table[i].timeout;
-                found = true;
-                break;
-            }
-        }
+        return false;
     }
-    
-    return found;
+    *timeout = entry->timeout;
+    return true;
 }
 
 /**
@@ -265,23 +373,14 @@ bool comm_table_get_timeout_by_send(uint8_t send_cmd_id, uint16_t *timeout)
  */
 bool comm_table_get_timeout_by_resp(uint8_t resp_cmd_id, uint16_t *timeout)
 {
-    bool found = false;
-    uint16_t i = 0;
-    
-    if (timeout != NULL)
+    const comm_cmd_table_t *entry = comm_table_find_by_resp(resp_cmd_id);
+
+    if (entry == NULL || timeout == NULL)
     {
-        for (i = 0; i < COMM_CMD_TABLE_SIZE; i++)
-        {
-            if (comm_cmd_table[i].resp_cmd_id == resp_cmd_id)
-            {
-                *timeout = comm_cmd_table[i].timeout;
-                found = true;
-                break;
-            }
-        }
+        return false;
     }
-    
-    return found;
+    *timeout = entry->timeout;
+    return true;
 }
 
 /**
@@ -289,23 +388,29 @@ bool comm_table_get_timeout_by_resp(uint8_t resp_cmd_id, uint16_t *timeout)
  */
 bool comm_table_get_retry_by_send(uint8_t send_cmd_id, uint16_t *retry_count)
 {
-    bool found = false;
-    uint16_t i = 0;
-    
-    if (retry_count != NULL)
+    const comm_cmd_table_t *entry = comm_table_find_by_send(send_cmd_id);
+
+    if (entry == NULL || retry_count == NULL)
     {
-        for (i = 0; i < COMM_CMD_TABLE_SIZE; i++)
-        {
-            if (comm_cmd_table[i].send_cmd_id == send_cmd_id)
-            {
-                *retry_count = comm_cmd_table[i].retry_count;
-                found = true;
-                break;
-            }
-        }
+        return false;
     }
-    
-    return found;
+    *retry_count = entry->retry_count;
+    return true;
+}
+
+/**
+ * @brief Get response cache TTL by send command ID
+ */
+bool comm_table_get_cache_ttl_by_send(uint8_t send_cmd_id, uint32_t *ttl_ms)
+{
+    const comm_cmd_table_t *entry = comm_table_find_by_send(send_cmd_id);
+
+    if (entry == NULL || ttl_ms == NULL)
+    {
+        return false;
+    }
+    *ttl_ms = entry->cache_ttl;
+    return true;
 }
 
 /**
@@ -313,22 +418,12 @@ bool comm_table_get_retry_by_send(uint8_t send_cmd_id, uint16_t *retry_count)
  */
 bool comm_table_get_retry_by_resp(uint8_t resp_cmd_id, uint16_t *retry_count)
 {
-    bool found = false;
-    uint16_t i = 0;
-    
-    if (retry_count != NULL)
+    const comm_cmd_table_t *entry = comm_table_find_by_resp(resp_cmd_id);
+
+    if (entry == NULL || retry_count == NULL)
     {
-        for (i = 0; i < COMM_CMD_TABLE_SIZE; i++)
-        {
-            if (comm_cmd_table[i].resp_cmd_id == resp_cmd_id)
-            {
-                *retry_count = comm_cmd_table[i].retry_count;
-                found = true;
-                break;
-            }
-        }
+        return false;
     }
-    
-    return found;
+    *retry_count = entry->retry_count;
+    return true;
 }
-
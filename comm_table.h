@@ -19,6 +19,92 @@
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include "comm_def.h"
+
+#define COMM_TABLE_ID_COUNT     256U    /* one index slot per possible command ID */
+#define COMM_TABLE_MAX_ENTRIES  64U     /* commands in one comm_table_t */
+
+#define COMM_TABLE_DEFAULT_TIMEOUT  1000U   /* attributes for entries that do not set them */
+#define COMM_TABLE_DEFAULT_RETRY    3U
+
+/**
+ * @brief Attributes of one command, returned whole by a single lookup
+ */
+typedef struct{
+    uint8_t send_cmd_id;
+    uint8_t resp_cmd_id;
+    uint16_t timeout;
+    uint16_t retry_count;
+    uint32_t cache_ttl;     /* response cache lifetime in ms, 0 = never cached */
+    uint8_t resp_data_len;  /* response payload bytes after the ID, 0 = not checked */
+}comm_cmd_table_t;
+
+/**
+ * @brief An indexed command set
+ *
+ * The built-in table is one of these; per-model tables loaded at run time
+ * (comm_table_load_json()) are others, and a controller may be given its
+ * own with comm_ctrl_set_table(). Lookups are a direct index into the two
+ * 256-entry ID tables, whatever the table size.
+ */
+typedef struct{
+    comm_cmd_table_t entries[COMM_TABLE_MAX_ENTRIES];
+    uint8_t count;
+    uint8_t send_index[COMM_TABLE_ID_COUNT];    /* entry index + 1, 0 = not defined */
+    uint8_t resp_index[COMM_TABLE_ID_COUNT];
+}comm_table_t;
+
+/**
+ * @brief Build the built-in command table
+ *
+ * comm_ctrl_tables_init() builds it before any controller runs. A lookup
+ * that comes first builds it too; concurrent first callers wait for one
+ * build instead of racing on the index.
+ */
+void comm_table_init(void);
+
+/**
+ * @brief The built-in command table
+ */
+const comm_table_t *comm_table_default(void);
+
+/**
+ * @brief Fill a table from an entry array and index it
+ *
+ * When an ID appears twice the first entry wins, as in the built-in table.
+ *
+ * @param table Table to fill
+ * @param entries Command entries
+ * @param count Number of entries, at most COMM_TABLE_MAX_ENTRIES
+ * @return COMM_OK, or COMM_ERROR on bad arguments
+ */
+comm_result_t comm_table_build(comm_table_t *table, const comm_cmd_table_t *entries, uint8_t count);
+
+/**
+ * @brief Look up a command by send command ID in O(1)
+ * @param table Table, NULL for the built-in one
+ * @param send_cmd_id Send command ID
+ * @return Command attributes, or NULL if the ID is not in the table
+ */
+const comm_cmd_table_t *comm_table_lookup_send(const comm_table_t *table, uint8_t send_cmd_id);
+
+/**
+ * @brief Look up a command by response command ID in O(1)
+ * @param table Table, NULL for the built-in one
+ * @param resp_cmd_id Response command ID
+ * @return Command attributes, or NULL if the ID is not in the table
+ */
+const comm_cmd_table_t *comm_table_lookup_resp(const comm_table_t *table, uint8_t resp_cmd_id);
+
+/**
+ * @brief Look up a command in the built-in table by send command ID
+ */
+const comm_cmd_table_t *comm_table_find_by_send(uint8_t send_cmd_id);
+
+/**
+ * @brief Look up a command in the built-in table by response command ID
+ */
+const comm_cmd_table_t *comm_table_find_by_resp(uint8_t resp_cmd_id);
 
 /**
  * @brief Get response command ID by send command ID
@@ -68,4 +154,17 @@ bool comm_table_get_retry_by_send(uint8_t send_cmd_id, uint16_t *retry_count);
  */
 bool comm_table_get_retry_by_resp(uint8_t resp_cmd_id, uint16_t *retry_count);
 
+/**
+ * @brief Get response cache TTL by send command ID
+ *
+ * Read-only queries whose answer rarely changes (machine id, serial number,
+ * software version, machine type) carry a non-zero TTL; their responses
+ * may be served from a comm_cache_t instead of the link.
+ *
+ * @param send_cmd_id Send command ID
+ * @param ttl_ms Pointer to store TTL in milliseconds (0 = not cacheable)
+ * @return true if found, false if not found
+ */
+bool comm_table_get_cache_ttl_by_send(uint8_t send_cmd_id, uint32_t *ttl_ms);
+
 #endif // COMM_TABLE_H
\ No newline at end of file
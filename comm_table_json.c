@@ -0,0 +1,403 @@
+/**
+ * @file comm_table_json.c
+ * @brief Load a per-model command table from a slave JSON config
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#include "comm_table_json.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdio.h>
+
+#define COMM_JSON_KEY_LEN       COMM_TABLE_JSON_KEY_LEN
+#define COMM_JSON_MAX_DEPTH     8U
+
+typedef struct {
+    const char *p;
+    const char *end;
+    const char *begin;
+    char key[COMM_JSON_KEY_LEN];    /* 最近读到的键，出错时报告 */
+} comm_json_t;
+
+static void comm_json_skip_ws(comm_json_t *js)
+{
+    while (js->p < js->end && (*js->p == ' ' || *js->p == '\t' || *js->p == '\r' || *js->p == '\n'))
+    {
+        js->p++;
+    }
+}
+
+static bool comm_json_accept(comm_json_t *js, char c)
+{
+    comm_json_skip_ws(js);
+    if (js->p < js->end && *js->p == c)
+    {
+        js->p++;
+        return true;
+    }
+    return false;
+}
+
+/* 读取字符串，超出 cap 的部分丢弃；out 为 NULL 时只跳过 */
+static bool comm_json_string(comm_json_t *js, char *out, size_t cap)
+{
+    size_t n = 0U;
+
+    if (!comm_json_accept(js, '"'))
+    {
+        return false;
+    }
+    while (js->p < js->end && *js->p != '"')
+    {
+        if (*js->p == '\\')
+        {
+            js->p++;
+            if (js->p >= js->end)
+            {
+                return false;
+            }
+        }
+        if (out != NULL && n + 1U < cap)
+        {
+            out[n++] = *js->p;
+        }
+        js->p++;
+    }
+    if (out != NULL && cap > 0U)
+    {
+        out[n] = '\0';
+    }
+    if (js->p >= js->end)
+    {
+        return false;
+    }
+    js->p++;
+    return true;
+}
+
+/* 读取不大于 max 的十进制数，超出目标字段范围时失败 */
+static bool comm_json_uint(comm_json_t *js, uint32_t max, uint32_t *value)
+{
+    uint32_t v = 0U;
+    uint32_t digit = 0U;
+    bool digits = false;
+
+    comm_json_skip_ws(js);
+    while (js->p < js->end && *js->p >= '0' && *js->p <= '9')
+    {
+        digit = (uint32_t)(*js->p - '0');
+        if (v > (max - digit) / 10U)
+        {
+            return false;
+        }
+        v = (v * 10U) + digit;
+        digits = true;
+        js->p++;
+    }
+    *value = v;
+    return digits;
+}
+
+static bool comm_json_skip_value(comm_json_t *js, uint8_t depth)
+{
+    char close = '\0';
+
+    if (depth >= COMM_JSON_MAX_DEPTH)
+    {
+        return false;
+    }
+    comm_json_skip_ws(js);
+    if (js->p >= js->end)
+    {
+        return false;
+    }
+    if (*js->p == '"')
+    {
+        return comm_json_string(js, NULL, 0U);
+    }
+    if (*js->p == '{' || *js->p == '[')
+    {
+        close = (*js->p == '{') ? '}' : ']';
+        js->p++;
+        if (comm_json_accept(js, close))
+        {
+            return true;
+        }
+        do
+        {
+            if (close == '}' && (!comm_json_string(js, NULL, 0U) || !comm_json_accept(js, ':')))
+            {
+                return false;
+            }
+            if (!comm_json_skip_value(js, (uint8_t)(depth + 1U)))
+            {
+                return false;
+            }
+        } while (comm_json_accept(js, ','));
+        return comm_json_accept(js, close);
+    }
+    /* number, true, false, null */
+    while (js->p < js->end && *js->p != ',' && *js->p != '}' && *js->p != ']' &&
+           *js->p != ' ' && *js->p != '\t' && *js->p != '\r' && *js->p != '\n')
+    {
+        js->p++;
+    }
+    return true;
+}
+
+/* 命令 ID：十六进制字符串 "F0"，或十进制数字 */
+static bool comm_json_id(comm_json_t *js, uint8_t *id)
+{
+    char text[8];
+    uint32_t v = 0U;
+    uint8_t i = 0U;
+    char c = '\0';
+
+    comm_json_skip_ws(js);
+    if (js->p < js->end && *js->p != '"')
+    {
+        if (!comm_json_uint(js, 0xFFU, &v))
+        {
+            return false;
+        }
+        *id = (uint8_t)v;
+        return true;
+    }
+    if (!comm_json_string(js, text, sizeof(text)) || text[0] == '\0' || strlen(text) > 2U)
+    {
+        return false;
+    }
+    for (i = 0U; text[i] != '\0'; i++)
+    {
+        c = text[i];
+        if (c >= '0' && c <= '9')
+        {
+            v = (v << 4) | (uint32_t)(c - '0');
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+            v = (v << 4) | (uint32_t)(c - 'a' + 10);
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+            v = (v << 4) | (uint32_t)(c - 'A' + 10);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    *id = (uint8_t)v;
+    return true;
+}
+
+static bool comm_json_command(comm_json_t *js, comm_cmd_table_t *entry)
+{
+    const char *key = js->key;
+    uint32_t value = 0U;
+    bool has_send = false;
+    bool has_resp = false;
+    bool ok = true;
+
+    memset(entry, 0, sizeof(comm_cmd_table_t));
+    entry->timeout = COMM_TABLE_DEFAULT_TIMEOUT;
+    entry->retry_count = COMM_TABLE_DEFAULT_RETRY;
+    if (!comm_json_accept(js, '{'))
+    {
+        return false;
+    }
+    if (comm_json_accept(js, '}'))
+    {
+        return false;
+    }
+    do
+    {
+        if (!comm_json_string(js, js->key, sizeof(js->key)) || !comm_json_accept(js, ':'))
+        {
+            return false;
+        }
+        if (strcmp(key, "cmd_id") == 0)
+        {
+            ok = comm_json_id(js, &entry->send_cmd_id);
+            has_send = true;
+        }
+        else if (strcmp(key, "resp_id") == 0)
+        {
+            ok = comm_json_id(js, &entry->resp_cmd_id);
+            has_resp = true;
+        }
+        else if (strcmp(key, "resp_data_len") == 0)
+        {
+            ok = comm_json_uint(js, 0xFFU, &value);
+            entry->resp_data_len = (uint8_t)value;
+        }
+        else if (strcmp(key, "timeout") == 0)
+        {
+            ok = comm_json_uint(js, 0xFFFFU, &value);
+            entry->timeout = (uint16_t)value;
+        }
+        else if (strcmp(key, "retry") == 0)
+        {
+            ok = comm_json_uint(js, 0xFFFFU, &value);
+            entry->retry_count = (uint16_t)value;
+        }
+        else if (strcmp(key, "cache_ttl") == 0)
+        {
+            ok = comm_json_uint(js, UINT32_MAX, &value);
+            entry->cache_ttl = value;
+        }
+        else
+        {
+            ok = comm_json_skip_value(js, 2U);
+        }
+        if (!ok)
+        {
+            return false;
+        }
+    } while (comm_json_accept(js, ','));
+    return comm_json_accept(js, '}') && has_send && has_resp;
+}
+
+static bool comm_json_commands(comm_json_t *js, comm_cmd_table_t *entries, uint8_t *count)
+{
+    *count = 0U;
+    if (!comm_json_accept(js, '['))
+    {
+        return false;
+    }
+    if (comm_json_accept(js, ']'))
+    {
+        return true;
+    }
+    do
+    {
+        if (*count >= COMM_TABLE_MAX_ENTRIES || !comm_json_command(js, &entries[*count]))
+        {
+            return false;
+        }
+        (*count)++;
+    } while (comm_json_accept(js, ','));
+    return comm_json_accept(js, ']');
+}
+
+static bool comm_json_document(comm_json_t *js, comm_table_t *table)
+{
+    bool found = false;
+
+    if (!comm_json_accept(js, '{'))
+    {
+        return false;
+    }
+    if (!comm_json_accept(js, '}'))
+    {
+        do
+        {
+            if (!comm_json_string(js, js->key, sizeof(js->key)) || !comm_json_accept(js, ':'))
+            {
+                return false;
+            }
+            if (strcmp(js->key, "commands") == 0)
+            {
+                if (!comm_json_commands(js, table->entries, &table->count))
+                {
+                    return false;
+                }
+                found = true;
+            }
+            else if (!comm_json_skip_value(js, 1U))
+            {
+                return false;
+            }
+        } while (comm_json_accept(js, ','));
+        if (!comm_json_accept(js, '}'))
+        {
+            return false;
+        }
+    }
+    if (!found)
+    {
+        (void)snprintf(js->key, sizeof(js->key), "commands");
+    }
+    return found;
+}
+
+/* 出错位置：行号从 1 开始，键为出错时正在解析的键 */
+static void comm_json_report(const comm_json_t *js, comm_table_json_error_t *err)
+{
+    const char *q = NULL;
+
+    if (err == NULL)
+    {
+        return;
+    }
+    err->line = 1U;
+    for (q = js->begin; q < js->p; q++)
+    {
+        if (*q == '\n')
+        {
+            err->line++;
+        }
+    }
+    (void)snprintf(err->key, sizeof(err->key), "%s", js->key);
+}
+
+comm_result_t comm_table_parse_json(comm_table_t *table, const char *text, size_t len,
+                                    comm_table_json_error_t *err)
+{
+    comm_json_t js;
+
+    if (table == NULL || text == NULL)
+    {
+        return COMM_ERROR;
+    }
+    js.p = text;
+    js.end = text + len;
+    js.begin = text;
+    js.key[0] = '\0';
+    if (err != NULL)
+    {
+        memset(err, 0, sizeof(comm_table_json_error_t));
+    }
+    /* 先解析到 table->entries，再原地建立索引 */
+    memset(table, 0, sizeof(comm_table_t));
+    if (!comm_json_document(&js, table))
+    {
+        comm_json_report(&js, err);
+        return COMM_ERROR;
+    }
+    return comm_table_build(table, table->entries, table->count);
+}
+
+comm_result_t comm_table_load_json(comm_table_t *table, const char *path, comm_table_json_error_t *err)
+{
+    struct stat st;
+    void *base = NULL;
+    comm_result_t ret = COMM_ERROR;
+    int fd = -1;
+
+    if (table == NULL || path == NULL)
+    {
+        return COMM_ERROR;
+    }
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return COMM_ERROR;
+    }
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base != MAP_FAILED)
+        {
+            ret = comm_table_parse_json(table, (const char *)base, (size_t)st.st_size, err);
+            (void)munmap(base, (size_t)st.st_size);
+        }
+    }
+    (void)close(fd);
+    return ret;
+}
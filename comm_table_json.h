@@ -0,0 +1,63 @@
+/**
+ * @file comm_table_json.h
+ * @brief Load a per-model command table from a slave JSON config
+ *
+ * Reads the command set files used by the slave simulator
+ * (slave/x7_cmd.json, slave/ap3_cmd.json):
+ *
+ *   { "commands": [ { "name": "USER_OPERATION", "cmd_id": "F0", "resp_id": "F1",
+ *                     "resp_data_len": 13, "resp_hex": "..." }, ... ] }
+ *
+ * cmd_id and resp_id are hex strings (a plain number is accepted too).
+ * resp_data_len becomes the expected response length that a controller
+ * using the table checks every received frame against.
+ * The optional keys "timeout", "retry" and "cache_ttl" set the matching
+ * attributes; entries without them get COMM_TABLE_DEFAULT_TIMEOUT,
+ * COMM_TABLE_DEFAULT_RETRY and no caching. Other keys are ignored.
+ * A number that does not fit its field (resp_data_len above 255, timeout
+ * above 65535, ...) fails the load instead of being truncated.
+ *
+ * Parsing happens once at load time into a comm_table_t, so lookups on a
+ * loaded table cost the same as on the built-in one. POSIX only (mmap).
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#ifndef COMM_TABLE_JSON_H
+#define COMM_TABLE_JSON_H
+
+#include <stddef.h>
+#include "comm_table.h"
+
+#define COMM_TABLE_JSON_KEY_LEN     24U
+
+/** Where parsing stopped */
+typedef struct {
+    uint32_t line;                          /**< 1-based line of the offending text */
+    char key[COMM_TABLE_JSON_KEY_LEN];      /**< key being parsed, "" if none was read yet */
+} comm_table_json_error_t;
+
+/**
+ * @brief Parse a command set held in memory
+ * @param table Table to fill
+ * @param text JSON text, need not be NUL terminated
+ * @param len Length of @p text
+ * @param err Filled with the line and key of the failure, may be NULL
+ * @return COMM_OK, or COMM_ERROR on a syntax error, a bad ID, a number too
+ *         large for its field or too many commands
+ */
+comm_result_t comm_table_parse_json(comm_table_t *table, const char *text, size_t len,
+                                    comm_table_json_error_t *err);
+
+/**
+ * @brief Load a command set file
+ * @param table Table to fill
+ * @param path File path
+ * @param err Filled with the line and key of a parse failure, may be NULL
+ * @return COMM_OK, or COMM_ERROR if the file cannot be read or parsed
+ */
+comm_result_t comm_table_load_json(comm_table_t *table, const char *path, comm_table_json_error_t *err);
+
+#endif // COMM_TABLE_JSON_H
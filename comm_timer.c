@@ -0,0 +1,337 @@
+/**
+ * @file comm_timer.c
+ * @brief Hierarchical timing wheel implementation
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#include "comm_timer.h"
+#include <string.h>
+
+#define COMM_TIMER_FLAG_WAKE    0x0001U
+
+static comm_timer_wheel_t comm_timer_default;
+static bool comm_timer_default_ready = false;
+
+static void comm_timer_lock(comm_timer_wheel_t *wheel)
+{
+    if (wheel->mutex != NULL)
+    {
+        (void)osMutexAcquire(wheel->mutex, osWaitForever);
+    }
+}
+
+static void comm_timer_unlock(comm_timer_wheel_t *wheel)
+{
+    if (wheel->mutex != NULL)
+    {
+        (void)osMutexRelease(wheel->mutex);
+    }
+}
+
+static void comm_timer_list_init(comm_timer_t *head)
+{
+    head->next = head;
+    head->prev = head;
+}
+
+static bool comm_timer_list_empty(const comm_timer_t *head)
+{
+    return head->next == head;
+}
+
+static void comm_timer_list_add(comm_timer_t *head, comm_timer_t *timer)
+{
+    timer->prev = head->prev;
+    timer->next = head;
+    head->prev->next = timer;
+    head->prev = timer;
+}
+
+static void comm_timer_list_del(comm_timer_t *timer)
+{
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->next = timer;
+    timer->prev = timer;
+}
+
+/* 按到期时间与当前时间的差值选择层级，再按到期时间的对应位选择槽 */
+static void comm_timer_insert(comm_timer_wheel_t *wheel, comm_timer_t *timer)
+{
+    uint32_t delta = timer->expire - wheel->now;
+    uint32_t level = 0U;
+
+    while ((level < (COMM_TIMER_LEVELS - 1U)) && (delta >= (1UL << ((level + 1U) * COMM_TIMER_SLOT_BITS))))
+    {
+        level++;
+    }
+    comm_timer_list_add(&wheel->slots[level][(timer->expire >> (level * COMM_TIMER_SLOT_BITS)) & COMM_TIMER_SLOT_MASK], timer);
+    timer->active = true;
+    wheel->count++;
+}
+
+static void comm_timer_remove(comm_timer_wheel_t *wheel, comm_timer_t *timer)
+{
+    comm_timer_list_del(timer);
+    timer->active = false;
+    wheel->count--;
+}
+
+/* 把高层一个槽的定时器重新分配到低层 */
+static void comm_timer_cascade(comm_timer_wheel_t *wheel, uint32_t level, uint32_t index)
+{
+    comm_timer_t *head = &wheel->slots[level][index];
+    comm_timer_t *timer = NULL;
+
+    while (!comm_timer_list_empty(head))
+    {
+        timer = head->next;
+        comm_timer_remove(wheel, timer);
+        comm_timer_insert(wheel, timer);
+    }
+}
+
+/* 推进一个 tick；调用者持有锁，回调执行期间释放锁 */
+static void comm_timer_step(comm_timer_wheel_t *wheel)
+{
+    comm_timer_t pending;
+    comm_timer_t *head = NULL;
+    comm_timer_t *timer = NULL;
+    uint32_t level = 1U;
+    uint32_t index = 0U;
+
+    wheel->now++;
+    index = wheel->now & COMM_TIMER_SLOT_MASK;
+    while ((index == 0U) && (level < COMM_TIMER_LEVELS))
+    {
+        index = (wheel->now >> (level * COMM_TIMER_SLOT_BITS)) & COMM_TIMER_SLOT_MASK;
+        comm_timer_cascade(wheel, level, index);
+        level++;
+    }
+
+    head = &wheel->slots[0][wheel->now & COMM_TIMER_SLOT_MASK];
+    if (comm_timer_list_empty(head))
+    {
+        return;
+    }
+    /* move the due list aside so callbacks can stop entries that have not run yet */
+    comm_timer_list_init(&pending);
+    pending.next = head->next;
+    pending.prev = head->prev;
+    pending.next->prev = &pending;
+    pending.prev->next = &pending;
+    comm_timer_list_init(head);
+
+    while (!comm_timer_list_empty(&pending))
+    {
+        timer = pending.next;
+        comm_timer_remove(wheel, timer);
+        if (timer->period != 0U)
+        {
+            timer->expire = wheel->now + timer->period;
+            comm_timer_insert(wheel, timer);
+        }
+        comm_timer_unlock(wheel);
+        timer->cb(timer->ctx);
+        comm_timer_lock(wheel);
+    }
+}
+
+static uint32_t comm_timer_next_locked(comm_timer_wheel_t *wheel)
+{
+    uint32_t next = COMM_TIMER_SLOTS - (wheel->now & COMM_TIMER_SLOT_MASK);  /* next cascade */
+    uint32_t i = 0U;
+
+    if (wheel->count == 0U)
+    {
+        return osWaitForever;
+    }
+    for (i = 1U; i < next; i++)
+    {
+        if (!comm_timer_list_empty(&wheel->slots[0][(wheel->now + i) & COMM_TIMER_SLOT_MASK]))
+        {
+            return i;
+        }
+    }
+    return next;
+}
+
+static void comm_timer_service_thread(void *argument)
+{
+    comm_timer_wheel_t *wheel = (comm_timer_wheel_t *)argument;
+    uint32_t now = 0U;
+    uint32_t next = 0U;
+    uint32_t wait = 0U;
+
+    while (1)
+    {
+        now = osKernelGetTickCount();
+        comm_timer_lock(wheel);
+        while ((int32_t)(now - wheel->now) > 0)
+        {
+            comm_timer_step(wheel);
+        }
+        next = comm_timer_next_locked(wheel);
+        wheel->wake = (next == osWaitForever) ? (wheel->now + COMM_TIMER_MAX_TICKS) : (wheel->now + next);
+        comm_timer_unlock(wheel);
+
+        wait = (next == osWaitForever) ? osWaitForever : next;
+        (void)osThreadFlagsWait(COMM_TIMER_FLAG_WAKE, osFlagsWaitAny, wait);
+    }
+}
+
+comm_result_t comm_timer_wheel_init(comm_timer_wheel_t *wheel, bool locked)
+{
+    uint32_t level = 0U;
+    uint32_t slot = 0U;
+
+    if (wheel == NULL)
+    {
+        return COMM_ERROR;
+    }
+    memset(wheel, 0, sizeof(comm_timer_wheel_t));
+    for (level = 0U; level < COMM_TIMER_LEVELS; level++)
+    {
+        for (slot = 0U; slot < COMM_TIMER_SLOTS; slot++)
+        {
+            comm_timer_list_init(&wheel->slots[level][slot]);
+        }
+    }
+    wheel->now = osKernelGetTickCount();
+    if (locked)
+    {
+        wheel->mutex = osMutexNew(NULL);
+        if (wheel->mutex == NULL)
+        {
+            return COMM_ERROR;
+        }
+    }
+    return COMM_OK;
+}
+
+comm_result_t comm_timer_service_start(comm_timer_wheel_t *wheel)
+{
+    if (wheel == NULL || wheel->mutex == NULL)
+    {
+        return COMM_ERROR;
+    }
+    if (wheel->thread == NULL)
+    {
+        wheel->thread = osThreadNew(comm_timer_service_thread, wheel, NULL);
+    }
+    return (wheel->thread != NULL) ? COMM_OK : COMM_ERROR;
+}
+
+comm_timer_wheel_t *comm_timer_default_wheel(void)
+{
+    if (!comm_timer_default_ready)
+    {
+        if (comm_timer_wheel_init(&comm_timer_default, true) != COMM_OK ||
+            comm_timer_service_start(&comm_timer_default) != COMM_OK)
+        {
+            return NULL;
+        }
+        comm_timer_default_ready = true;
+    }
+    return &comm_timer_default;
+}
+
+void comm_timer_init(comm_timer_t *timer, comm_timer_cb_t cb, void *ctx)
+{
+    if (timer == NULL)
+    {
+        return;
+    }
+    comm_timer_list_init(timer);
+    timer->expire = 0U;
+    timer->period = 0U;
+    timer->cb = cb;
+    timer->ctx = ctx;
+    timer->active = false;
+}
+
+void comm_timer_start(comm_timer_wheel_t *wheel, comm_timer_t *timer, uint32_t ticks, bool periodic)
+{
+    bool wake = false;
+
+    if (wheel == NULL || timer == NULL || timer->cb == NULL)
+    {
+        return;
+    }
+    if (ticks == 0U)
+    {
+        ticks = 1U;
+    }
+    if (ticks > COMM_TIMER_MAX_TICKS)
+    {
+        ticks = COMM_TIMER_MAX_TICKS;
+    }
+    comm_timer_lock(wheel);
+    if (timer->active)
+    {
+        comm_timer_remove(wheel, timer);
+    }
+    /* relative to the caller's clock; the wheel may lag behind it by a few ticks */
+    timer->expire = osKernelGetTickCount() + ticks;
+    if ((int32_t)(timer->expire - wheel->now) <= 0)
+    {
+        timer->expire = wheel->now + 1U;
+    }
+    timer->period = periodic ? ticks : 0U;
+    comm_timer_insert(wheel, timer);
+    if (wheel->thread != NULL && (int32_t)(timer->expire - wheel->wake) < 0)
+    {
+        wheel->wake = timer->expire;
+        wake = true;
+    }
+    comm_timer_unlock(wheel);
+    if (wake)
+    {
+        (void)osThreadFlagsSet(wheel->thread, COMM_TIMER_FLAG_WAKE);
+    }
+}
+
+void comm_timer_stop(comm_timer_wheel_t *wheel, comm_timer_t *timer)
+{
+    if (wheel == NULL || timer == NULL)
+    {
+        return;
+    }
+    comm_timer_lock(wheel);
+    if (timer->active)
+    {
+        comm_timer_remove(wheel, timer);
+    }
+    comm_timer_unlock(wheel);
+}
+
+void comm_timer_advance(comm_timer_wheel_t *wheel, uint32_t now)
+{
+    if (wheel == NULL)
+    {
+        return;
+    }
+    comm_timer_lock(wheel);
+    while ((int32_t)(now - wheel->now) > 0)
+    {
+        comm_timer_step(wheel);
+    }
+    comm_timer_unlock(wheel);
+}
+
+uint32_t comm_timer_next(comm_timer_wheel_t *wheel)
+{
+    uint32_t next = osWaitForever;
+
+    if (wheel == NULL)
+    {
+        return next;
+    }
+    comm_timer_lock(wheel);
+    next = comm_timer_next_locked(wheel);
+    comm_timer_unlock(wheel);
+    return next;
+}
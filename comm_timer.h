@@ -0,0 +1,123 @@
+/**
+ * @file comm_timer.h
+ * @brief Hierarchical timing wheel for controller timers
+ *
+ * Four levels of 64 slots cover 2^24 ticks. A timer sits in an intrusive
+ * doubly linked list of one slot, so start and stop are O(1) and do not
+ * touch the kernel. Advancing the wheel costs O(1) per tick plus the
+ * cascade of one higher-level slot every 64 ticks.
+ *
+ * A wheel is used in one of two ways:
+ * - Service wheel: comm_timer_service_start() creates one thread that
+ *   sleeps until the next expiry and runs the callbacks. Start and stop
+ *   may be called from any thread; the wheel is protected by a mutex that
+ *   is released while a callback runs.
+ * - Owned wheel: the owner (e.g. a comm_mgr worker) calls
+ *   comm_timer_advance() from its own loop and bounds its waits with
+ *   comm_timer_next(). No lock is taken, every call must come from the
+ *   owner thread, and callbacks may run controller code directly.
+ *
+ * Callbacks may start or stop any timer of the same wheel, including
+ * their own.
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#ifndef COMM_TIMER_H
+#define COMM_TIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cmsis_os2.h"
+#include "comm_def.h"
+
+#define COMM_TIMER_LEVELS       4U
+#define COMM_TIMER_SLOT_BITS    6U
+#define COMM_TIMER_SLOTS        (1U << COMM_TIMER_SLOT_BITS)
+#define COMM_TIMER_SLOT_MASK    (COMM_TIMER_SLOTS - 1U)
+#define COMM_TIMER_MAX_TICKS    ((1UL << (COMM_TIMER_LEVELS * COMM_TIMER_SLOT_BITS)) - 1U)
+
+typedef void (*comm_timer_cb_t)(void *ctx);
+
+/**
+ * @brief Timer node, embedded in its owner
+ */
+typedef struct comm_timer {
+    struct comm_timer *next;
+    struct comm_timer *prev;
+    uint32_t expire;            /**< tick at which the timer fires */
+    uint32_t period;            /**< reload in ticks, 0 for one-shot */
+    comm_timer_cb_t cb;
+    void *ctx;
+    bool active;
+} comm_timer_t;
+
+/**
+ * @brief Timing wheel
+ */
+typedef struct {
+    comm_timer_t slots[COMM_TIMER_LEVELS][COMM_TIMER_SLOTS];   /**< list heads */
+    uint32_t now;               /**< last tick processed */
+    uint32_t count;             /**< armed timers */
+    osMutexId_t mutex;          /**< NULL for an owned wheel */
+    osThreadId_t thread;        /**< service thread, NULL for an owned wheel */
+    uint32_t wake;              /**< tick the service thread sleeps until */
+} comm_timer_wheel_t;
+
+/**
+ * @brief Initialize a wheel
+ * @param wheel Wheel
+ * @param locked true for a wheel shared between threads (service wheel)
+ * @return COMM_OK, or COMM_ERROR if the mutex cannot be created
+ */
+comm_result_t comm_timer_wheel_init(comm_timer_wheel_t *wheel, bool locked);
+
+/**
+ * @brief Create the thread that drives a locked wheel
+ */
+comm_result_t comm_timer_service_start(comm_timer_wheel_t *wheel);
+
+/**
+ * @brief Process-wide service wheel, created and started on first use
+ *
+ * The first call must not race with another first call; comm_ctrl_init()
+ * makes it, so create controllers from one thread.
+ *
+ * @return Wheel, or NULL if it could not be created
+ */
+comm_timer_wheel_t *comm_timer_default_wheel(void);
+
+/**
+ * @brief Bind a timer to its callback, the timer starts stopped
+ */
+void comm_timer_init(comm_timer_t *timer, comm_timer_cb_t cb, void *ctx);
+
+/**
+ * @brief (Re)arm a timer
+ *
+ * @param wheel Wheel
+ * @param timer Timer
+ * @param ticks Delay, 0 is rounded up to 1, longer than COMM_TIMER_MAX_TICKS is clamped
+ * @param periodic Reload with the same delay after each expiry
+ */
+void comm_timer_start(comm_timer_wheel_t *wheel, comm_timer_t *timer, uint32_t ticks, bool periodic);
+
+/**
+ * @brief Disarm a timer, harmless if it is not armed
+ */
+void comm_timer_stop(comm_timer_wheel_t *wheel, comm_timer_t *timer);
+
+/**
+ * @brief Fire every timer that expired up to @p now
+ */
+void comm_timer_advance(comm_timer_wheel_t *wheel, uint32_t now);
+
+/**
+ * @brief Ticks from the last advance until the wheel needs the next one
+ * @return Ticks, or osWaitForever if no timer is armed
+ */
+uint32_t comm_timer_next(comm_timer_wheel_t *wheel);
+
+#endif // COMM_TIMER_H
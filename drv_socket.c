@@ -1,6 +1,8 @@
 #include "drv_socket.h"
 #include "cmsis_os2.h"
+#include "comm_buf.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
@@ -10,19 +12,21 @@
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 
-static struct {
-	int fd;
-	int connected;
-} g_sock = { .fd = -1, .connected = 0 };
+/* add/remove request handed to the reactor thread, lives on the caller's stack */
+typedef struct drv_socket_reactor_req {
+	struct drv_socket_reactor_req *next;
+	drv_socket_conn_t *conn;
+	uint8_t remove;
+	uint8_t done;
+	comm_result_t result;
+} drv_socket_reactor_req_t;
 
-typedef struct
-{
-	uint16_t len;
-	uint8_t data[COMM_PROTOCOL_MAX_BUFF_LEN];
-} drv_tx_item_t;
-
-static osMessageQueueId_t g_tx_mq = NULL;
+/* connection behind the single-connection API */
+static drv_socket_conn_t g_conn = { .fd = -1, .connected = 0, .fd_lock = PTHREAD_MUTEX_INITIALIZER,
+				     .backoff_min_ms = DRV_SOCKET_BACKOFF_MIN_MS, .backoff_max_ms = DRV_SOCKET_BACKOFF_MAX_MS };
 
 static int set_nonblock(int fd, int enable)
 {
@@ -48,146 +52,465 @@ static int set_nonblock(int fd, int enable)
 	return (result == 0) ? 0 : -1;
 }
 
-int drv_socket_open(const char *host, uint16_t port, int nonblock)
+static uint32_t drv_socket_ms_to_ticks(uint32_t ms)
+{
+	uint32_t ticks = (uint32_t)(((uint64_t)ms * osKernelGetTickFreq() + 999U) / 1000U);
+
+	return (ticks != 0U) ? ticks : 1U;
+}
+
+/* xorshift32，只用于重连抖动 */
+static uint32_t drv_socket_conn_rand(drv_socket_conn_t *conn)
+{
+	uint32_t x = conn->rand_state;
+
+	if (x == 0U)
+	{
+		x = osKernelGetTickCount() ^ (uint32_t)(uintptr_t)conn ^ ((uint32_t)conn->peer_port << 16) ^ conn->peer_addr;
+		x = (x != 0U) ? x : 1U;
+	}
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	conn->rand_state = x;
+	return x;
+}
+
+void drv_socket_conn_init(drv_socket_conn_t *conn)
+{
+	if (conn == NULL)
+	{
+		return;
+	}
+	(void)memset(conn, 0, sizeof(drv_socket_conn_t));
+	conn->fd = -1;
+	(void)pthread_mutex_init(&conn->fd_lock, NULL);
+	conn->backoff_min_ms = DRV_SOCKET_BACKOFF_MIN_MS;
+	conn->backoff_max_ms = DRV_SOCKET_BACKOFF_MAX_MS;
+}
+
+void drv_socket_conn_set_callbacks(drv_socket_conn_t *conn, drv_socket_recv_cb_t on_recv,
+				   drv_socket_state_cb_t on_state, void *ctx)
+{
+	if (conn == NULL)
+	{
+		return;
+	}
+	conn->on_recv = on_recv;
+	conn->on_state = on_state;
+	conn->ctx = ctx;
+}
+
+void drv_socket_conn_set_reconnect(drv_socket_conn_t *conn, int enable, uint32_t min_ms, uint32_t max_ms,
+				   drv_socket_tx_policy_t policy)
+{
+	if (conn == NULL)
+	{
+		return;
+	}
+	conn->reconnect = enable ? 1U : 0U;
+	conn->backoff_min_ms = (min_ms != 0U) ? min_ms : DRV_SOCKET_BACKOFF_MIN_MS;
+	conn->backoff_max_ms = (max_ms != 0U) ? max_ms : DRV_SOCKET_BACKOFF_MAX_MS;
+	if (conn->backoff_max_ms < conn->backoff_min_ms)
+	{
+		conn->backoff_max_ms = conn->backoff_min_ms;
+	}
+	conn->tx_policy = (uint8_t)policy;
+}
+
+/* connect 已确认；退避要等连接稳定一段时间后才清零，连上即断的对端不会被以最短间隔反复重连 */
+static void drv_socket_conn_established(drv_socket_conn_t *conn)
+{
+	conn->state = DRV_SOCKET_STATE_CONNECTED;
+	conn->up_tick = osKernelGetTickCount();
+	__atomic_add_fetch(&conn->epoch, 1U, __ATOMIC_RELEASE);
+	__atomic_store_n(&conn->connected, 1, __ATOMIC_RELEASE);
+}
+
+/* 按保存的地址新建套接字并发起连接；返回 0 表示已连接或正在连接 */
+static int drv_socket_conn_connect(drv_socket_conn_t *conn)
 {
-	int result = -1;
 	struct sockaddr_in addr;
+	int flag = 1;
 
-	if (g_sock.connected)
+	conn->fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (conn->fd < 0)
 	{
-		return 0;
+		return -1;
 	}
 
-	g_sock.fd = socket(AF_INET, SOCK_STREAM, 0);
-	if (g_sock.fd < 0)
+	/* 禁用Nagle算法,减少小包延迟 */
+	if (setsockopt(conn->fd, IPPROTO_TCP, TCP_NODELAY, (char *)&flag, sizeof(flag)) < 0)
 	{
-		return result;
+		printf("Warning: Failed to disable Nagle algorithm\n");
+	}
+
+	if (set_nonblock(conn->fd, conn->nonblock) != 0)
+	{
+		(void)close(conn->fd);
+		conn->fd = -1;
+		return -1;
+	}
+
+	/* 重连时沿用上一条连接按突发量调大的接收缓冲；connect 前设置，窗口缩放才跟得上 */
+	if (conn->rx_rcvbuf != 0)
+	{
+		(void)setsockopt(conn->fd, SOL_SOCKET, SO_RCVBUF, &conn->rx_rcvbuf, sizeof(conn->rx_rcvbuf));
 	}
 
 	(void)memset(&addr, 0, sizeof(addr));
 	addr.sin_family = AF_INET;
-	addr.sin_port = htons(port);
+	addr.sin_port = conn->peer_port;
+	addr.sin_addr.s_addr = conn->peer_addr;
+	if (connect(conn->fd, (struct sockaddr *)&addr, sizeof(addr)) == 0)
+	{
+		drv_socket_conn_established(conn);
+		return 0;
+	}
+	if ((errno == EINPROGRESS) && conn->nonblock)
+	{
+		/* 连接结果要等可写后由 SO_ERROR 确认 */
+		conn->state = DRV_SOCKET_STATE_CONNECTING;
+		return 0;
+	}
+	(void)close(conn->fd);
+	conn->fd = -1;
+	return -1;
+}
+
+/* 非阻塞 connect 结束：SO_ERROR 为 0 才算连上 */
+static int drv_socket_conn_finish_connect(drv_socket_conn_t *conn)
+{
+	int err = 0;
+	socklen_t len = sizeof(err);
+
+	if ((getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0) || (err != 0))
+	{
+		return -1;
+	}
+	drv_socket_conn_established(conn);
+	return 0;
+}
+
+/* 安排下一次重连：指数退避，一半固定一半随机，同时断开的链路不会同时重连；
+ * 已在重连队列中的连接不再重复安排 */
+static void drv_socket_conn_schedule(drv_socket_conn_t *conn)
+{
+	uint32_t min_ms = (conn->backoff_min_ms != 0U) ? conn->backoff_min_ms : DRV_SOCKET_BACKOFF_MIN_MS;
+	uint32_t max_ms = (conn->backoff_max_ms != 0U) ? conn->backoff_max_ms : DRV_SOCKET_BACKOFF_MAX_MS;
+	uint32_t half = 0U;
+
+	if (conn->retry_queued != 0U)
+	{
+		return;
+	}
+	if (conn->backoff_ms == 0U)
+	{
+		conn->backoff_ms = min_ms;
+	}
+	else
+	{
+		conn->backoff_ms = (conn->backoff_ms > (max_ms / 2U)) ? max_ms : (conn->backoff_ms * 2U);
+	}
+	half = conn->backoff_ms / 2U;
+	conn->retry_tick = osKernelGetTickCount() +
+			   drv_socket_ms_to_ticks(half + (drv_socket_conn_rand(conn) % (half + 1U)));
+	__atomic_store_n(&conn->state, (uint8_t)DRV_SOCKET_STATE_BACKOFF, __ATOMIC_RELEASE);
+	if (conn->reactor != NULL)
+	{
+		conn->retry_next = conn->reactor->retry_head;
+		conn->reactor->retry_head = conn;
+		conn->retry_queued = 1U;
+	}
+}
+
+int drv_socket_conn_open(drv_socket_conn_t *conn, const char *host, uint16_t port, int nonblock)
+{
+	struct in_addr ip;
+
+	if (conn == NULL)
+	{
+		return -1;
+	}
+	if (conn->state != DRV_SOCKET_STATE_CLOSED)
+	{
+		return 0;
+	}
 	if (host == NULL)
 	{
 		host = "127.0.0.1";
 	}
-	if (inet_pton(AF_INET, host, &addr.sin_addr) != 1)
+	if (inet_pton(AF_INET, host, &ip) != 1)
 	{
-		(void)close(g_sock.fd);
-		g_sock.fd = -1;
-		return result;
+		return -1;
 	}
-
-	/* 禁用Nagle算法,减少小包延迟 */
-	int flag = 1;
-	if (setsockopt(g_sock.fd, IPPROTO_TCP, TCP_NODELAY, (char *)&flag, sizeof(flag)) < 0)
+	conn->peer_addr = ip.s_addr;
+	conn->peer_port = htons(port);
+	conn->nonblock = nonblock ? 1U : 0U;
+	conn->backoff_ms = 0U;
+	if (drv_socket_conn_connect(conn) == 0)
 	{
-		printf("Warning: Failed to disable Nagle algorithm\n");
+		return 0;
+	}
+	if (!conn->reconnect)
+	{
+		return -1;
 	}
+	/* 对端暂时不在，按退避继续尝试 */
+	drv_socket_conn_schedule(conn);
+	return 0;
+}
 
-	if (set_nonblock(g_sock.fd, nonblock) != 0)
+/* 释放已取出但未写完的帧 */
+static void drv_socket_conn_tx_drop_batch(drv_socket_conn_t *conn)
+{
+	while (conn->tx_batch_count > 0U)
 	{
-		(void)close(g_sock.fd);
-		g_sock.fd = -1;
-		return result;
+		conn->tx_batch_count--;
+		comm_buf_release(conn->tx_batch[conn->tx_batch_count]);
+		conn->tx_batch[conn->tx_batch_count] = NULL;
 	}
+	conn->tx_off = 0U;
+}
+
+/* TX 线程处理断线：DROP 释放全部排队帧，KEEP 让写了一半的帧重连后整帧重发 */
+static void drv_socket_conn_tx_down(drv_socket_conn_t *conn)
+{
+	comm_buf_t *buf = NULL;
 
-	if (connect(g_sock.fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+	if (conn->tx_policy == (uint8_t)DRV_SOCKET_TX_DROP)
 	{
-		if (errno != EINPROGRESS || !nonblock)
+		conn->tx_dropped += conn->tx_batch_count;
+		drv_socket_conn_tx_drop_batch(conn);
+		while ((conn->tx_mq != NULL) && (mpsc_queue_get(conn->tx_mq, &buf, 0U) == osOK))
 		{
-			(void)close(g_sock.fd);
-			g_sock.fd = -1;
-			return result;
+			comm_buf_release(buf);
+			conn->tx_dropped++;
 		}
 	}
+	conn->tx_off = 0U;
+}
 
-	g_sock.connected = 1;
-	result = 0;
-	return result;
+/* 连接断开或连接失败：关闭套接字，需要时安排重连；曾经连上过才通知上层。
+ * reactor 和 io_uring 连接的 TX 也在本线程，顺带处理排队帧；其他连接由 TX 线程自己处理 */
+static void drv_socket_conn_lost(drv_socket_conn_t *conn)
+{
+	int was_connected = (conn->state == DRV_SOCKET_STATE_CONNECTED);
+
+	if (was_connected &&
+	    ((osKernelGetTickCount() - conn->up_tick) >= drv_socket_ms_to_ticks(DRV_SOCKET_STABLE_MS)))
+	{
+		conn->backoff_ms = 0U;
+	}
+
+	if ((conn->reactor != NULL) || (conn->uring != NULL))
+	{
+		/* no wake-ups while down; the backend sends what is queued once reconnected */
+		__atomic_store_n(&conn->tx_armed, 1U, __ATOMIC_SEQ_CST);
+		drv_socket_conn_tx_down(conn);
+	}
+	if ((conn->reactor != NULL) && (conn->fd >= 0))
+	{
+		(void)epoll_ctl(conn->reactor->epfd, EPOLL_CTL_DEL, conn->fd, NULL);
+		conn->tx_out = 0U;
+	}
+	/* a TX thread writing to this fd finishes first, and sees connected 0 afterwards */
+	(void)pthread_mutex_lock(&conn->fd_lock);
+	if (conn->fd >= 0)
+	{
+		(void)close(conn->fd);
+		conn->fd = -1;
+	}
+	__atomic_store_n(&conn->connected, 0, __ATOMIC_RELEASE);
+	(void)pthread_mutex_unlock(&conn->fd_lock);
+	if (conn->reconnect)
+	{
+		drv_socket_conn_schedule(conn);
+	}
+	else
+	{
+		__atomic_store_n(&conn->state, (uint8_t)DRV_SOCKET_STATE_CLOSED, __ATOMIC_RELEASE);
+		if (conn->reactor != NULL)
+		{
+			drv_socket_reactor_remove(conn->reactor, conn);
+		}
+	}
+	if (was_connected && (conn->on_state != NULL))
+	{
+		conn->on_state(conn->ctx, 0);
+	}
 }
 
-void drv_socket_close(void)
+void drv_socket_conn_close(drv_socket_conn_t *conn)
 {
-	if (g_sock.fd >= 0)
+	if (conn == NULL)
+	{
+		return;
+	}
+	if (conn->reactor != NULL)
 	{
-		(void)close(g_sock.fd);
-		g_sock.fd = -1;
+		drv_socket_reactor_remove(conn->reactor, conn);
 	}
-	g_sock.connected = 0;
+	(void)pthread_mutex_lock(&conn->fd_lock);
+	if (conn->fd >= 0)
+	{
+		(void)close(conn->fd);
+		conn->fd = -1;
+	}
+	__atomic_store_n(&conn->connected, 0, __ATOMIC_RELEASE);
+	(void)pthread_mutex_unlock(&conn->fd_lock);
+	conn->state = DRV_SOCKET_STATE_CLOSED;
+	conn->backoff_ms = 0U;
+	drv_socket_conn_tx_drop_batch(conn);
+	free(conn->rx_buf);
+	conn->rx_buf = NULL;
+	conn->rx_cap = 0U;
+	conn->rx_peak = 0U;
 }
 
-int drv_socket_is_connected(void)
+int drv_socket_conn_is_connected(const drv_socket_conn_t *conn)
 {
-	return g_sock.connected;
+	return (conn != NULL) ? __atomic_load_n(&conn->connected, __ATOMIC_ACQUIRE) : 0;
 }
 
-size_t drv_socket_send(const uint8_t *buf, size_t len, int timeout_ms)
+drv_socket_state_t drv_socket_conn_get_state(const drv_socket_conn_t *conn)
 {
-	size_t sent = -1;
-	size_t total = 0U;
+	return (conn != NULL) ? (drv_socket_state_t)__atomic_load_n(&conn->state, __ATOMIC_ACQUIRE)
+			      : DRV_SOCKET_STATE_CLOSED;
+}
+
+/* 退避到期时发起重连，等待 timeout_ms 确认正在进行的连接 */
+static int drv_socket_conn_advance(drv_socket_conn_t *conn, int timeout_ms)
+{
+	struct pollfd pfd;
 
-	if ((buf == NULL) || (len == 0U) || (g_sock.fd < 0))
+	if (conn->state == DRV_SOCKET_STATE_BACKOFF)
 	{
-		return sent;
+		if ((int32_t)(osKernelGetTickCount() - conn->retry_tick) < 0)
+		{
+			return 0;
+		}
+		conn->reconnects++;
+		if (drv_socket_conn_connect(conn) != 0)
+		{
+			drv_socket_conn_schedule(conn);
+			return 0;
+		}
+		if ((conn->state == DRV_SOCKET_STATE_CONNECTED) && (conn->on_state != NULL))
+		{
+			conn->on_state(conn->ctx, 1);
+		}
 	}
-
-	if (timeout_ms > 0)
+	if (conn->state == DRV_SOCKET_STATE_CONNECTING)
 	{
-		struct pollfd pfd;
-		pfd.fd = g_sock.fd;
+		pfd.fd = conn->fd;
 		pfd.events = POLLOUT;
-		int pr = poll(&pfd, 1, timeout_ms);
-		if (pr <= 0)
+		pfd.revents = 0;
+		if (poll(&pfd, 1, timeout_ms) <= 0)
+		{
+			return 0;
+		}
+		if (drv_socket_conn_finish_connect(conn) != 0)
 		{
-			return sent;
+			drv_socket_conn_lost(conn);
+			return 0;
 		}
+		if (conn->on_state != NULL)
+		{
+			conn->on_state(conn->ctx, 1);
+		}
+	}
+	return (conn->state == DRV_SOCKET_STATE_CONNECTED) ? 1 : 0;
+}
+
+int drv_socket_conn_maintain(drv_socket_conn_t *conn, int timeout_ms)
+{
+	if (conn == NULL)
+	{
+		return 0;
+	}
+	if ((conn->reactor != NULL) || (conn->uring != NULL))
+	{
+		return drv_socket_conn_is_connected(conn);
+	}
+	return drv_socket_conn_advance(conn, timeout_ms);
+}
+
+int drv_socket_conn_retry(drv_socket_conn_t *conn)
+{
+	return (conn != NULL) ? drv_socket_conn_advance(conn, 0) : 0;
+}
+
+void drv_socket_conn_fail(drv_socket_conn_t *conn)
+{
+	if ((conn != NULL) && (conn->state != DRV_SOCKET_STATE_CLOSED))
+	{
+		drv_socket_conn_lost(conn);
 	}
+}
+
+ssize_t drv_socket_conn_send(drv_socket_conn_t *conn, const uint8_t *buf, size_t len, int timeout_ms)
+{
+	struct pollfd pfd;
+	size_t total = 0U;
+	ssize_t n = 0;
 
+	if ((conn == NULL) || (buf == NULL) || (len == 0U) || (conn->state == DRV_SOCKET_STATE_CLOSED))
+	{
+		return -1;
+	}
+	/* 连接状态只由接收一侧推进（见 drv_socket_conn_maintain()），这里只用已连上的套接字 */
+	(void)pthread_mutex_lock(&conn->fd_lock);
 	while (total < len)
 	{
-		size_t n = send(g_sock.fd, buf + total, len - total, 0);
+		if (drv_socket_conn_is_connected(conn) == 0)
+		{
+			break;
+		}
+		/* MSG_NOSIGNAL: a closed peer is an error return, not SIGPIPE */
+		n = send(conn->fd, buf + total, len - total, MSG_NOSIGNAL);
 		if (n > 0)
 		{
 			total += (size_t)n;
+			continue;
 		}
-		else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		if ((n == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) || (timeout_ms == 0))
 		{
-			struct pollfd pfd;
-			pfd.fd = g_sock.fd;
-			pfd.events = POLLOUT;
-			int pr = poll(&pfd, 1, timeout_ms);
-			if (pr <= 0)
-			{
-				break;
-			}
+			break;
 		}
-		else
+		/* socket buffer full: wait without the lock so a lost connection is not held up */
+		pfd.fd = conn->fd;
+		pfd.events = POLLOUT;
+		(void)pthread_mutex_unlock(&conn->fd_lock);
+		n = poll(&pfd, 1, timeout_ms);
+		(void)pthread_mutex_lock(&conn->fd_lock);
+		if (n <= 0)
 		{
 			break;
 		}
 	}
+	(void)pthread_mutex_unlock(&conn->fd_lock);
 
-	if (total > 0U)
-	{
-		sent = (size_t)total;
-	}
-	return sent;
+	return (total > 0U) ? (ssize_t)total : -1;
 }
 
-ssize_t drv_socket_recv(uint8_t *buf, size_t len, int timeout_ms)
+ssize_t drv_socket_conn_recv(drv_socket_conn_t *conn, uint8_t *buf, size_t len, int timeout_ms)
 {
 	ssize_t recvd = 0;
 
-	if ((buf == NULL) || (len == 0U) || (g_sock.fd < 0))
+	if ((conn == NULL) || (buf == NULL) || (len == 0U) || (conn->state == DRV_SOCKET_STATE_CLOSED))
 	{
 		return -1;
 	}
+	if (drv_socket_conn_maintain(conn, 0) == 0)
+	{
+		return 0;  /* connecting or waiting to reconnect, no data */
+	}
 
 	if (timeout_ms >= 0)
 	{
 		struct pollfd pfd;
-		pfd.fd = g_sock.fd;
+		pfd.fd = conn->fd;
 		pfd.events = POLLIN;
 		int pr = poll(&pfd, 1, timeout_ms);
 		if (pr <= 0)
@@ -196,7 +519,7 @@ ssize_t drv_socket_recv(uint8_t *buf, size_t len, int timeout_ms)
 		}
 	}
 
-	recvd = recv(g_sock.fd, buf, len, 0);
+	recvd = recv(conn->fd, buf, len, 0);
 	if (recvd < 0)
 	{
 		/* 非阻塞模式下,EAGAIN/EWOULDBLOCK 表示暂时无数据 */
@@ -205,129 +528,922 @@ ssize_t drv_socket_recv(uint8_t *buf, size_t len, int timeout_ms)
 			return 0;  /* treat as timeout, no data available */
 		}
 		/* 其他错误(如连接断开) */
-		g_sock.connected = 0;
+		drv_socket_conn_lost(conn);
 		return -1;
 	}
 	else if (recvd == 0)
 	{
 		/* 对端关闭连接 */
-		g_sock.connected = 0;
+		drv_socket_conn_lost(conn);
 	}
 	return recvd;
 }
 
-comm_result_t drv_socket_tx_queue_init(uint32_t capacity)
+/* 按最近的突发量调整接收缓冲：放大立即生效，缩小留一倍余量避免来回抖动 */
+static void drv_socket_conn_rx_adapt(drv_socket_conn_t *conn, uint32_t burst)
 {
-	comm_result_t result = COMM_ERROR;
-	uint32_t item_size = sizeof(drv_tx_item_t);
+	uint32_t decayed = conn->rx_peak - (conn->rx_peak / 8U);
+	uint32_t target = DRV_SOCKET_RX_CHUNK;
+	uint8_t *buf = NULL;
+	int rcvbuf = 0;
+	int cur = 0;
+	socklen_t len = sizeof(cur);
 
-	if (capacity == 0U)
+	conn->rx_peak = (burst > decayed) ? burst : decayed;
+	while ((target < conn->rx_peak) && (target < DRV_SOCKET_RX_MAX))
 	{
-		capacity = 16U;
+		target <<= 1;
 	}
-
-	if (g_tx_mq != NULL)
+	if ((target <= conn->rx_cap) && ((target * 4U) > conn->rx_cap))
 	{
-		result = COMM_OK;
-		return result;
+		return;
+	}
+	if (target < conn->rx_cap)
+	{
+		target = conn->rx_cap / 2U;
+	}
+	buf = (uint8_t *)realloc(conn->rx_buf, target);
+	if (buf == NULL)
+	{
+		return;     /* keep the old buffer */
 	}
+	conn->rx_buf = buf;
+	conn->rx_cap = target;
 
-	g_tx_mq = osMessageQueueNew(capacity, item_size, NULL);
-	if (g_tx_mq != NULL)
+	/* SO_RCVBUF 只增不减，且不低于内核默认值（内核报告的是设置值的两倍） */
+	rcvbuf = (int)(target * DRV_SOCKET_RCVBUF_BURSTS);
+	if ((rcvbuf > conn->rx_rcvbuf) && (conn->fd >= 0) &&
+	    (getsockopt(conn->fd, SOL_SOCKET, SO_RCVBUF, &cur, &len) == 0) && ((cur / 2) < rcvbuf) &&
+	    (setsockopt(conn->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)) == 0))
 	{
-		result = COMM_OK;
+		conn->rx_rcvbuf = rcvbuf;
 	}
-	return result;
 }
 
-void drv_socket_tx_queue_deinit(void)
+/* 一直读到 EAGAIN，每读到一块立即交给回调；读满 DRV_SOCKET_RX_BUDGET 先停下，
+ * 剩下的数据靠 epoll 水平触发（或下一次 drain）继续读。返回读到的字节数，连接断开返回 -1 */
+static ssize_t drv_socket_conn_rx_drain(drv_socket_conn_t *conn, drv_socket_recv_cb_t on_chunk, void *ctx)
 {
-	if (g_tx_mq != NULL)
+	size_t total = 0U;
+	ssize_t n = 0;
+
+	if ((conn->rx_buf == NULL) || (conn->rx_cap == 0U))
+	{
+		conn->rx_buf = (uint8_t *)malloc(DRV_SOCKET_RX_CHUNK);
+		if (conn->rx_buf == NULL)
+		{
+			return 0;
+		}
+		conn->rx_cap = DRV_SOCKET_RX_CHUNK;
+	}
+	while (total < DRV_SOCKET_RX_BUDGET)
+	{
+		n = recv(conn->fd, conn->rx_buf, conn->rx_cap, MSG_DONTWAIT);
+		if (n > 0)
+		{
+			total += (size_t)n;
+			if (on_chunk != NULL)
+			{
+				on_chunk(ctx, conn->rx_buf, (size_t)n);
+			}
+		}
+		else if ((n < 0) && (errno == EINTR))
+		{
+			continue;
+		}
+		else if ((n < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+		{
+			break;
+		}
+		else
+		{
+			/* 对端关闭或连接出错，已读到的数据已经交出 */
+			return -1;
+		}
+	}
+	if (total > 0U)
 	{
-		(void)osMessageQueueDelete(g_tx_mq);
-		g_tx_mq = NULL;
+		drv_socket_conn_rx_adapt(conn, (uint32_t)total);
 	}
+	return (ssize_t)total;
 }
 
-comm_result_t drv_socket_tx_enqueue(const uint8_t *buf, uint16_t len)
+ssize_t drv_socket_conn_recv_drain(drv_socket_conn_t *conn, drv_socket_recv_cb_t on_chunk, void *ctx)
 {
-	comm_result_t result = COMM_ERROR;
-	drv_tx_item_t item;
+	ssize_t n = 0;
 
-	if ((buf == NULL) || (len == 0U) || (len > (uint16_t)COMM_PROTOCOL_MAX_BUFF_LEN) || (g_tx_mq == NULL))
+	if ((conn == NULL) || (conn->state == DRV_SOCKET_STATE_CLOSED) || (conn->reactor != NULL) ||
+	    (conn->uring != NULL))
 	{
-		return result;
+		return -1;
 	}
-
-	item.len = len;
-	(void)memcpy(item.data, buf, len);
-	if (osMessageQueuePut(g_tx_mq, &item, 0U, 0U) == osOK)
+	if (drv_socket_conn_maintain(conn, 0) == 0)
 	{
-		result = COMM_OK;
+		return 0;  /* connecting or waiting to reconnect, no data */
 	}
-
-	return result;
+	n = drv_socket_conn_rx_drain(conn, on_chunk, ctx);
+	if (n < 0)
+	{
+		drv_socket_conn_lost(conn);
+	}
+	return n;
 }
 
-comm_result_t drv_socket_tx_dequeue(uint8_t *buf, uint16_t bufcap, uint16_t *out_len)
+comm_result_t drv_socket_conn_tx_init(drv_socket_conn_t *conn, uint32_t capacity)
 {
-	comm_result_t result = COMM_ERROR;
-	drv_tx_item_t item;
-
-	if ((buf == NULL) || (out_len == NULL) || (g_tx_mq == NULL))
+	if (conn == NULL)
 	{
-		return result;
+		return COMM_ERROR;
 	}
-
-	if (osMessageQueueGet(g_tx_mq, &item, NULL, 0U) == osOK)
+	if (capacity == 0U)
 	{
-		if (item.len <= bufcap)
-		{
-			(void)memcpy(buf, item.data, item.len);
-			*out_len = item.len;
-			result = COMM_OK;
-		}
-		else
-		{
-			/* Caller buffer too small: push back or drop silently? Here we drop and signal error. */
-			result = COMM_ERROR;
-		}
+		capacity = DRV_SOCKET_TX_QUEUE_SIZE;
 	}
-	else
+	if (conn->tx_mq != NULL)
 	{
-		result = COMM_EMPTY_QUEUE;
+		return COMM_OK;
 	}
 
-	return result;
+	/* items are buffer pointers, the frames themselves are never copied */
+	conn->tx_mq = mpsc_queue_create(capacity, sizeof(comm_buf_t *));
+	return (conn->tx_mq != NULL) ? COMM_OK : COMM_ERROR;
 }
 
-comm_result_t drv_socket_tx_send_one(int timeout_ms)
+void drv_socket_conn_tx_deinit(drv_socket_conn_t *conn)
 {
-	comm_result_t result = COMM_ERROR;
-	uint8_t buf[COMM_PROTOCOL_MAX_BUFF_LEN];
-	uint16_t len = 0U;
+	comm_buf_t *buf = NULL;
 
-	if (g_tx_mq == NULL)
+	if ((conn == NULL) || (conn->tx_mq == NULL))
 	{
-		return result;
+		return;
 	}
+	drv_socket_conn_tx_drop_batch(conn);
+	while (mpsc_queue_get(conn->tx_mq, &buf, 0U) == osOK)
+	{
+		comm_buf_release(buf);
+	}
+	mpsc_queue_delete(conn->tx_mq);
+	conn->tx_mq = NULL;
+}
 
-	result = drv_socket_tx_dequeue(buf, (uint16_t)sizeof(buf), &len);
-	if (result != COMM_OK)
+/* 生产者线程调用：第一次置位时写 eventfd 唤醒 reactor；套接字和 epoll 只由 reactor 线程操作，
+ * 不会碰到另一线程刚关闭、已被复用的描述符 */
+static void drv_socket_conn_arm_tx(drv_socket_conn_t *conn)
+{
+	uint64_t one = 1U;
+	drv_socket_reactor_t *reactor = conn->reactor;
+
+	if ((reactor == NULL) || (__atomic_exchange_n(&conn->tx_armed, 1U, __ATOMIC_SEQ_CST) != 0U))
 	{
-		return result;
+		return;
 	}
+	(void)write(reactor->wake_fd, &one, sizeof(one));
+}
 
-	size_t sent = drv_socket_send(buf, (size_t)len, timeout_ms);
-	if (sent == (size_t)len)
+comm_result_t drv_socket_conn_tx_enqueue_buf(drv_socket_conn_t *conn, comm_buf_t *buf)
+{
+	if (buf == NULL)
 	{
-		result = COMM_OK;
+		return COMM_ERROR;
 	}
-	else
+	if ((conn == NULL) || (buf->len == 0U) || (conn->tx_mq == NULL) ||
+	    (mpsc_queue_put(conn->tx_mq, &buf, 0U) != osOK))
 	{
-		result = COMM_ERROR;
+		comm_buf_release(buf);
+		return COMM_ERROR;
 	}
-
-	return result;
+	if (conn->tx_notify != NULL)
+	{
+		conn->tx_notify(conn);
+	}
+	else
+	{
+		drv_socket_conn_arm_tx(conn);
+	}
+	return COMM_OK;
+}
+
+comm_result_t drv_socket_conn_tx_dequeue_buf(drv_socket_conn_t *conn, comm_buf_t **out_buf)
+{
+	if ((conn == NULL) || (out_buf == NULL) || (conn->tx_mq == NULL))
+	{
+		return COMM_ERROR;
+	}
+	return (mpsc_queue_get(conn->tx_mq, out_buf, 0U) == osOK) ? COMM_OK : COMM_EMPTY_QUEUE;
+}
+
+uint32_t drv_socket_conn_tx_gather(drv_socket_conn_t *conn, struct iovec *iov, uint32_t max_iov)
+{
+	uint32_t i = 0U;
+
+	if ((conn == NULL) || (iov == NULL))
+	{
+		return 0U;
+	}
+	while ((conn->tx_mq != NULL) && (conn->tx_batch_count < DRV_SOCKET_TX_BATCH) &&
+	       (mpsc_queue_get(conn->tx_mq, &conn->tx_batch[conn->tx_batch_count], 0U) == osOK))
+	{
+		conn->tx_batch_count++;
+	}
+	for (i = 0U; (i < conn->tx_batch_count) && (i < max_iov); i++)
+	{
+		iov[i].iov_base = conn->tx_batch[i]->data;
+		iov[i].iov_len = conn->tx_batch[i]->len;
+	}
+	if (i > 0U)
+	{
+		iov[0].iov_base = conn->tx_batch[0]->data + conn->tx_off;
+		iov[0].iov_len = (size_t)(conn->tx_batch[0]->len - conn->tx_off);
+	}
+	return i;
+}
+
+void drv_socket_conn_tx_complete(drv_socket_conn_t *conn, size_t n)
+{
+	size_t left = 0U;
+	uint32_t done = 0U;
+
+	if ((conn == NULL) || (n == 0U))
+	{
+		return;
+	}
+	conn->tx_bytes += (uint32_t)n;
+	conn->tx_writes++;
+	while ((n > 0U) && (done < conn->tx_batch_count))
+	{
+		left = (size_t)(conn->tx_batch[done]->len - conn->tx_off);
+		if (n < left)
+		{
+			/* 帧只写出一部分，下次从 tx_off 继续 */
+			conn->tx_off = (uint16_t)(conn->tx_off + n);
+			break;
+		}
+		n -= left;
+		conn->tx_off = 0U;
+		comm_buf_release(conn->tx_batch[done]);
+		done++;
+	}
+	if (done > 0U)
+	{
+		conn->tx_frames += done;
+		conn->tx_batch_count = (uint8_t)(conn->tx_batch_count - done);
+		(void)memmove(&conn->tx_batch[0], &conn->tx_batch[done], conn->tx_batch_count * sizeof(comm_buf_t *));
+	}
+}
+
+/* 聚合批量帧一次写出；返回写出字节数，对端缓冲区满返回 0，出错返回 -1 */
+static ssize_t drv_socket_conn_tx_write(drv_socket_conn_t *conn, uint32_t *frames)
+{
+	struct iovec iov[DRV_SOCKET_TX_BATCH];
+	struct msghdr msg;
+	ssize_t n = 0;
+
+	(void)memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = iov;
+	msg.msg_iovlen = drv_socket_conn_tx_gather(conn, iov, DRV_SOCKET_TX_BATCH);
+	*frames = (uint32_t)msg.msg_iovlen;
+	if (msg.msg_iovlen == 0U)
+	{
+		return 0;
+	}
+	/* sendmsg rather than writev: MSG_NOSIGNAL */
+	n = sendmsg(conn->fd, &msg, MSG_NOSIGNAL);
+	if (n < 0)
+	{
+		return ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) ? 0 : -1;
+	}
+	drv_socket_conn_tx_complete(conn, (size_t)n);
+	return n;
+}
+
+ssize_t drv_socket_conn_tx_flush(drv_socket_conn_t *conn, int timeout_ms)
+{
+	struct pollfd pfd;
+	ssize_t total = 0;
+	ssize_t n = 0;
+	uint32_t frames = 0U;
+	uint32_t epoch = 0U;
+
+	if ((conn == NULL) || (conn->reactor != NULL) || (conn->uring != NULL))
+	{
+		return -1;
+	}
+	for (;;)
+	{
+		/* the receiving side closes and reconnects; fd_lock keeps the fd written to the one
+		 * checked here, it is dropped while waiting so a lost connection is not held up */
+		(void)pthread_mutex_lock(&conn->fd_lock);
+		if (drv_socket_conn_is_connected(conn) == 0)
+		{
+			(void)pthread_mutex_unlock(&conn->fd_lock);
+			if (total > 0)
+			{
+				return total;
+			}
+			/* the queue is only settled here */
+			if (drv_socket_conn_get_state(conn) == DRV_SOCKET_STATE_BACKOFF)
+			{
+				drv_socket_conn_tx_down(conn);
+			}
+			return (drv_socket_conn_get_state(conn) == DRV_SOCKET_STATE_CLOSED) ? -1 : 0;
+		}
+		epoch = __atomic_load_n(&conn->epoch, __ATOMIC_ACQUIRE);
+		if (conn->tx_epoch != epoch)
+		{
+			/* reconnected since the last write: a partly written frame goes again in full */
+			conn->tx_off = 0U;
+			conn->tx_epoch = epoch;
+		}
+		do
+		{
+			n = drv_socket_conn_tx_write(conn, &frames);
+			total += (n > 0) ? n : 0;
+		} while ((n > 0) && (frames != 0U));
+		pfd.fd = conn->fd;
+		(void)pthread_mutex_unlock(&conn->fd_lock);
+		if (n < 0)
+		{
+			return -1;
+		}
+		if (frames == 0U)
+		{
+			return total;
+		}
+		/* socket buffer full */
+		if (timeout_ms <= 0)
+		{
+			return total;
+		}
+		pfd.events = POLLOUT;
+		if (poll(&pfd, 1, timeout_ms) <= 0)
+		{
+			return total;
+		}
+	}
+}
+
+/* ========== Reactor ========== */
+
+comm_result_t drv_socket_reactor_init(drv_socket_reactor_t *reactor)
+{
+	struct epoll_event ev;
+
+	if (reactor == NULL)
+	{
+		return COMM_ERROR;
+	}
+	(void)memset(reactor, 0, sizeof(drv_socket_reactor_t));
+	(void)pthread_mutex_init(&reactor->req_lock, NULL);
+	(void)pthread_cond_init(&reactor->req_done, NULL);
+	reactor->epfd = epoll_create1(EPOLL_CLOEXEC);
+	reactor->wake_fd = eventfd(0U, EFD_CLOEXEC | EFD_NONBLOCK);
+	/* data.ptr NULL marks the wake-up descriptor */
+	ev.events = EPOLLIN;
+	ev.data.ptr = NULL;
+	if ((reactor->epfd < 0) || (reactor->wake_fd < 0) ||
+	    (epoll_ctl(reactor->epfd, EPOLL_CTL_ADD, reactor->wake_fd, &ev) != 0))
+	{
+		drv_socket_reactor_deinit(reactor);
+		return COMM_ERROR;
+	}
+	return COMM_OK;
+}
+
+void drv_socket_reactor_deinit(drv_socket_reactor_t *reactor)
+{
+	if ((reactor == NULL) || ((reactor->epfd < 0) && (reactor->wake_fd < 0)))
+	{
+		return;
+	}
+	if (reactor->epfd >= 0)
+	{
+		(void)close(reactor->epfd);
+	}
+	if (reactor->wake_fd >= 0)
+	{
+		(void)close(reactor->wake_fd);
+	}
+	reactor->epfd = -1;
+	reactor->wake_fd = -1;
+	(void)pthread_cond_destroy(&reactor->req_done);
+	(void)pthread_mutex_destroy(&reactor->req_lock);
+}
+
+/* 注册到 epoll；同时请求 EPOLLOUT，连接完成和连接前排队的帧都在第一次可写时处理 */
+static comm_result_t drv_socket_reactor_watch(drv_socket_reactor_t *reactor, drv_socket_conn_t *conn)
+{
+	struct epoll_event ev;
+
+	__atomic_store_n(&conn->tx_armed, 1U, __ATOMIC_SEQ_CST);
+	ev.events = EPOLLIN | EPOLLOUT;
+	ev.data.ptr = conn;
+	if (epoll_ctl(reactor->epfd, EPOLL_CTL_ADD, conn->fd, &ev) != 0)
+	{
+		__atomic_store_n(&conn->tx_armed, 0U, __ATOMIC_SEQ_CST);
+		return COMM_ERROR;
+	}
+	conn->tx_out = 1U;
+	return COMM_OK;
+}
+
+/* 以下两个函数只在 reactor 线程（或它开始 poll 之前）执行 */
+static comm_result_t drv_socket_reactor_attach(drv_socket_reactor_t *reactor, drv_socket_conn_t *conn)
+{
+	if ((conn->state != DRV_SOCKET_STATE_BACKOFF) && (drv_socket_reactor_watch(reactor, conn) != COMM_OK))
+	{
+		return COMM_ERROR;
+	}
+	conn->reactor = reactor;
+	conn->conn_next = reactor->conn_head;
+	reactor->conn_head = conn;
+	reactor->conn_count++;
+	if (conn->state == DRV_SOCKET_STATE_BACKOFF)
+	{
+		conn->retry_next = reactor->retry_head;
+		reactor->retry_head = conn;
+		conn->retry_queued = 1U;
+	}
+	return COMM_OK;
+}
+
+static void drv_socket_reactor_detach(drv_socket_reactor_t *reactor, drv_socket_conn_t *conn)
+{
+	drv_socket_conn_t **link = NULL;
+
+	for (link = &reactor->retry_head; *link != NULL; link = &(*link)->retry_next)
+	{
+		if (*link == conn)
+		{
+			*link = conn->retry_next;
+			break;
+		}
+	}
+	conn->retry_next = NULL;
+	conn->retry_queued = 0U;
+	for (link = &reactor->conn_head; *link != NULL; link = &(*link)->conn_next)
+	{
+		if (*link == conn)
+		{
+			*link = conn->conn_next;
+			break;
+		}
+	}
+	conn->conn_next = NULL;
+	if ((conn->fd >= 0) && (conn->state != DRV_SOCKET_STATE_BACKOFF))
+	{
+		(void)epoll_ctl(reactor->epfd, EPOLL_CTL_DEL, conn->fd, NULL);
+	}
+	conn->reactor = NULL;
+	conn->tx_armed = 0U;
+	conn->tx_out = 0U;
+	reactor->conn_count--;
+}
+
+/* 连接表和 epoll 只由 reactor 线程修改：它还没开始 poll 或调用者就是它时直接执行，
+ * 否则把请求交给它并等待完成 */
+static comm_result_t drv_socket_reactor_call(drv_socket_reactor_t *reactor, drv_socket_conn_t *conn, uint8_t remove)
+{
+	drv_socket_reactor_req_t req;
+	comm_result_t result = COMM_OK;
+	uint8_t polling = 0U;
+	uint64_t one = 1U;
+
+	(void)pthread_mutex_lock(&reactor->req_lock);
+	polling = reactor->polling;
+	if ((polling != 0U) && !pthread_equal(reactor->thread, pthread_self()))
+	{
+		(void)memset(&req, 0, sizeof(req));
+		req.conn = conn;
+		req.remove = remove;
+		req.next = reactor->req_head;
+		reactor->req_head = &req;
+		(void)write(reactor->wake_fd, &one, sizeof(one));
+		while (req.done == 0U)
+		{
+			(void)pthread_cond_wait(&reactor->req_done, &reactor->req_lock);
+		}
+		(void)pthread_mutex_unlock(&reactor->req_lock);
+		return req.result;
+	}
+	if (polling != 0U)
+	{
+		/* reactor thread, possibly inside a callback: no lock held while applying */
+		(void)pthread_mutex_unlock(&reactor->req_lock);
+	}
+	if (remove)
+	{
+		drv_socket_reactor_detach(reactor, conn);
+	}
+	else
+	{
+		result = drv_socket_reactor_attach(reactor, conn);
+	}
+	if (polling == 0U)
+	{
+		(void)pthread_mutex_unlock(&reactor->req_lock);
+	}
+	if ((remove == 0U) && (result == COMM_OK) && (conn->state == DRV_SOCKET_STATE_CONNECTED) &&
+	    (conn->on_state != NULL))
+	{
+		conn->on_state(conn->ctx, 1);
+	}
+	return result;
+}
+
+/* reactor 线程：按提交顺序执行其他线程交来的 add/remove 请求 */
+static void drv_socket_reactor_run_requests(drv_socket_reactor_t *reactor)
+{
+	drv_socket_reactor_req_t *list = NULL;
+	drv_socket_reactor_req_t *req = NULL;
+	drv_socket_reactor_req_t *next = NULL;
+
+	(void)pthread_mutex_lock(&reactor->req_lock);
+	for (req = reactor->req_head; req != NULL; req = next)
+	{
+		next = req->next;
+		req->next = list;
+		list = req;
+	}
+	reactor->req_head = NULL;
+	(void)pthread_mutex_unlock(&reactor->req_lock);
+	if (list == NULL)
+	{
+		return;
+	}
+	for (req = list; req != NULL; req = req->next)
+	{
+		if (req->remove)
+		{
+			drv_socket_reactor_detach(reactor, req->conn);
+			req->result = COMM_OK;
+		}
+		else
+		{
+			req->result = drv_socket_reactor_attach(reactor, req->conn);
+			if ((req->result == COMM_OK) && (req->conn->state == DRV_SOCKET_STATE_CONNECTED) &&
+			    (req->conn->on_state != NULL))
+			{
+				req->conn->on_state(req->conn->ctx, 1);
+			}
+		}
+	}
+	/* the requests live on their callers' stacks, untouched once done is set */
+	(void)pthread_mutex_lock(&reactor->req_lock);
+	for (req = list; req != NULL; req = next)
+	{
+		next = req->next;
+		req->done = 1U;
+	}
+	(void)pthread_cond_broadcast(&reactor->req_done);
+	(void)pthread_mutex_unlock(&reactor->req_lock);
 }
 
+comm_result_t drv_socket_reactor_add(drv_socket_reactor_t *reactor, drv_socket_conn_t *conn)
+{
+	if ((reactor == NULL) || (conn == NULL) || (conn->state == DRV_SOCKET_STATE_CLOSED) ||
+	    (conn->reactor != NULL) || (conn->uring != NULL))
+	{
+		return COMM_ERROR;
+	}
+	return drv_socket_reactor_call(reactor, conn, 0U);
+}
+
+void drv_socket_reactor_remove(drv_socket_reactor_t *reactor, drv_socket_conn_t *conn)
+{
+	if ((reactor == NULL) || (conn == NULL) || (conn->reactor != reactor))
+	{
+		return;
+	}
+	(void)drv_socket_reactor_call(reactor, conn, 1U);
+}
+
+/* 按需请求或撤销 EPOLLOUT，状态没变时不调用 epoll_ctl */
+static void drv_socket_conn_want_out(drv_socket_conn_t *conn, uint8_t out)
+{
+	struct epoll_event ev;
+
+	if (conn->tx_out == out)
+	{
+		return;
+	}
+	ev.events = out ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+	ev.data.ptr = conn;
+	(void)epoll_ctl(conn->reactor->epfd, EPOLL_CTL_MOD, conn->fd, &ev);
+	conn->tx_out = out;
+}
+
+/* 非阻塞地把排队的帧聚合写出，套接字写满时请求 EPOLLOUT，写空后撤销；返回 -1 表示连接已断开 */
+static int drv_socket_conn_flush(drv_socket_conn_t *conn)
+{
+	ssize_t n = 0;
+	uint32_t frames = 0U;
+
+	for (;;)
+	{
+		for (;;)
+		{
+			n = drv_socket_conn_tx_write(conn, &frames);
+			if (n < 0)
+			{
+				return -1;
+			}
+			if (frames == 0U)
+			{
+				break;
+			}
+			if (n == 0)
+			{
+				drv_socket_conn_want_out(conn, 1U);    /* socket buffer full */
+				return 0;
+			}
+		}
+		/* queue empty: disarm, then look again for a frame that raced with the disarm */
+		drv_socket_conn_want_out(conn, 0U);
+		__atomic_store_n(&conn->tx_armed, 0U, __ATOMIC_SEQ_CST);
+		if ((mpsc_queue_count(conn->tx_mq) == 0U) ||
+		    (__atomic_exchange_n(&conn->tx_armed, 1U, __ATOMIC_SEQ_CST) != 0U))
+		{
+			return 0;
+		}
+	}
+}
+
+/* 唤醒：执行 add/remove 请求，再写出已请求发送、尚未等待 EPOLLOUT 的连接 */
+static void drv_socket_reactor_wake(drv_socket_reactor_t *reactor)
+{
+	drv_socket_conn_t *conn = NULL;
+	drv_socket_conn_t *next = NULL;
+	uint64_t count = 0U;
+
+	(void)read(reactor->wake_fd, &count, sizeof(count));
+	drv_socket_reactor_run_requests(reactor);
+	for (conn = reactor->conn_head; conn != NULL; conn = next)
+	{
+		next = conn->conn_next;
+		if ((conn->state == DRV_SOCKET_STATE_CONNECTED) && (conn->tx_out == 0U) &&
+		    (__atomic_load_n(&conn->tx_armed, __ATOMIC_SEQ_CST) != 0U) && (drv_socket_conn_flush(conn) != 0))
+		{
+			drv_socket_conn_lost(conn);
+		}
+	}
+}
+
+/* 距最早一次到期重连的毫秒数，用来缩短 epoll_wait 的超时 */
+static int drv_socket_reactor_retry_timeout(const drv_socket_reactor_t *reactor, int timeout_ms)
+{
+	const drv_socket_conn_t *conn = NULL;
+	uint32_t now = osKernelGetTickCount();
+	int32_t left = 0;
+	int ms = 0;
+
+	for (conn = reactor->retry_head; conn != NULL; conn = conn->retry_next)
+	{
+		left = (int32_t)(conn->retry_tick - now);
+		ms = (left > 0) ? (int)(((uint64_t)(uint32_t)left * 1000U + osKernelGetTickFreq() - 1U) / osKernelGetTickFreq()) : 0;
+		if ((timeout_ms < 0) || (ms < timeout_ms))
+		{
+			timeout_ms = ms;
+		}
+	}
+	return timeout_ms;
+}
+
+/* 发起到期的重连 */
+static void drv_socket_reactor_retry(drv_socket_reactor_t *reactor)
+{
+	drv_socket_conn_t **link = &reactor->retry_head;
+	drv_socket_conn_t *conn = NULL;
+	uint32_t now = osKernelGetTickCount();
+
+	while (*link != NULL)
+	{
+		conn = *link;
+		if ((int32_t)(now - conn->retry_tick) < 0)
+		{
+			link = &conn->retry_next;
+			continue;
+		}
+		*link = conn->retry_next;
+		conn->retry_next = NULL;
+		conn->retry_queued = 0U;
+		conn->reconnects++;
+		if ((drv_socket_conn_connect(conn) != 0) || (drv_socket_reactor_watch(reactor, conn) != COMM_OK))
+		{
+			if (conn->fd >= 0)
+			{
+				(void)close(conn->fd);
+				conn->fd = -1;
+			}
+			/* goes back at the head with a later retry_tick, so this pass skips it */
+			drv_socket_conn_schedule(conn);
+			continue;
+		}
+		if ((conn->state == DRV_SOCKET_STATE_CONNECTED) && (conn->on_state != NULL))
+		{
+			conn->on_state(conn->ctx, 1);
+		}
+	}
+}
+
+int drv_socket_reactor_poll(drv_socket_reactor_t *reactor, int timeout_ms)
+{
+	struct epoll_event events[DRV_SOCKET_REACTOR_EVENTS];
+	drv_socket_conn_t *conn = NULL;
+	int count = 0;
+	int served = 0;
+	int woken = 0;
+	int i = 0;
+
+	if ((reactor == NULL) || (reactor->epfd < 0))
+	{
+		return -1;
+	}
+	if (reactor->polling == 0U)
+	{
+		(void)pthread_mutex_lock(&reactor->req_lock);
+		reactor->thread = pthread_self();
+		reactor->polling = 1U;
+		(void)pthread_mutex_unlock(&reactor->req_lock);
+	}
+	count = epoll_wait(reactor->epfd, events, (int)DRV_SOCKET_REACTOR_EVENTS,
+			   drv_socket_reactor_retry_timeout(reactor, timeout_ms));
+	if (count < 0)
+	{
+		return (errno == EINTR) ? 0 : -1;
+	}
+	served = count;
+	for (i = 0; i < count; i++)
+	{
+		conn = (drv_socket_conn_t *)events[i].data.ptr;
+		if (conn == NULL)
+		{
+			woken = 1;
+			served--;
+			continue;
+		}
+		/* went down or was removed earlier in this batch, its events are stale */
+		if ((conn->reactor != reactor) || (conn->fd < 0) ||
+		    ((conn->state != DRV_SOCKET_STATE_CONNECTING) && (conn->state != DRV_SOCKET_STATE_CONNECTED)))
+		{
+			served--;
+			continue;
+		}
+		if (conn->state == DRV_SOCKET_STATE_CONNECTING)
+		{
+			if (drv_socket_conn_finish_connect(conn) != 0)
+			{
+				drv_socket_conn_lost(conn);
+				continue;
+			}
+			if (conn->on_state != NULL)
+			{
+				conn->on_state(conn->ctx, 1);
+			}
+		}
+		if (((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0U) &&
+		    (drv_socket_conn_rx_drain(conn, conn->on_recv, conn->ctx) < 0))
+		{
+			drv_socket_conn_lost(conn);
+			continue;
+		}
+		if (((events[i].events & EPOLLOUT) != 0U) && (drv_socket_conn_flush(conn) != 0))
+		{
+			drv_socket_conn_lost(conn);
+		}
+	}
+	/* after the batch: a removed connection may be freed by its owner as soon as it is released */
+	if (woken)
+	{
+		drv_socket_reactor_wake(reactor);
+	}
+	drv_socket_reactor_retry(reactor);
+	return served;
+}
+
+/* ========== Single-connection API ========== */
+
+void drv_socket_set_reconnect(int enable, uint32_t min_ms, uint32_t max_ms, drv_socket_tx_policy_t policy)
+{
+	drv_socket_conn_set_reconnect(&g_conn, enable, min_ms, max_ms, policy);
+}
+
+int drv_socket_open(const char *host, uint16_t port, int nonblock)
+{
+	return drv_socket_conn_open(&g_conn, host, port, nonblock);
+}
+
+void drv_socket_close(void)
+{
+	drv_socket_conn_close(&g_conn);
+}
+
+int drv_socket_is_connected(void)
+{
+	return g_conn.connected;
+}
+
+size_t drv_socket_send(const uint8_t *buf, size_t len, int timeout_ms)
+{
+	return (size_t)drv_socket_conn_send(&g_conn, buf, len, timeout_ms);
+}
+
+ssize_t drv_socket_recv(uint8_t *buf, size_t len, int timeout_ms)
+{
+	return drv_socket_conn_recv(&g_conn, buf, len, timeout_ms);
+}
+
+ssize_t drv_socket_recv_drain(drv_socket_recv_cb_t on_chunk, void *ctx)
+{
+	return drv_socket_conn_recv_drain(&g_conn, on_chunk, ctx);
+}
+
+comm_result_t drv_socket_tx_queue_init(uint32_t capacity)
+{
+	return drv_socket_conn_tx_init(&g_conn, capacity);
+}
+
+void drv_socket_tx_queue_deinit(void)
+{
+	drv_socket_conn_tx_deinit(&g_conn);
+}
+
+comm_result_t drv_socket_tx_enqueue_buf(comm_buf_t *buf)
+{
+	return drv_socket_conn_tx_enqueue_buf(&g_conn, buf);
+}
+
+comm_result_t drv_socket_tx_dequeue_buf(comm_buf_t **out_buf)
+{
+	return drv_socket_conn_tx_dequeue_buf(&g_conn, out_buf);
+}
+
+comm_result_t drv_socket_tx_enqueue(const uint8_t *buf, uint16_t len)
+{
+	comm_buf_t *item = NULL;
+
+	if ((buf == NULL) || (len == 0U) || (len > (uint16_t)COMM_BUF_DATA_LEN) || (g_conn.tx_mq == NULL))
+	{
+		return COMM_ERROR;
+	}
+
+	item = comm_buf_alloc(comm_buf_default_pool());
+	if (item == NULL)
+	{
+		return COMM_ERROR;
+	}
+	item->len = len;
+	(void)memcpy(item->data, buf, len);
+	return drv_socket_tx_enqueue_buf(item);
+}
+
+comm_result_t drv_socket_tx_dequeue(uint8_t *buf, uint16_t bufcap, uint16_t *out_len)
+{
+	comm_result_t result = COMM_ERROR;
+	comm_buf_t *item = NULL;
+
+	if ((buf == NULL) || (out_len == NULL))
+	{
+		return result;
+	}
+
+	result = drv_socket_tx_dequeue_buf(&item);
+	if (result == COMM_OK)
+	{
+		if (item->len <= bufcap)
+		{
+			(void)memcpy(buf, item->data, item->len);
+			*out_len = item->len;
+		}
+		else
+		{
+			/* Caller buffer too small: the frame is dropped. */
+			result = COMM_ERROR;
+		}
+		comm_buf_release(item);
+	}
+
+	return result;
+}
+
+comm_result_t drv_socket_tx_send_one(int timeout_ms)
+{
+	comm_result_t result = COMM_ERROR;
+	comm_buf_t *item = NULL;
+
+	result = drv_socket_tx_dequeue_buf(&item);
+	if (result != COMM_OK)
+	{
+		return result;
+	}
+
+	ssize_t sent = drv_socket_send(item->data, (size_t)item->len, timeout_ms);
+	result = (sent == (ssize_t)item->len) ? COMM_OK : COMM_ERROR;
+	comm_buf_release(item);
+
+	return result;
+}
+
+ssize_t drv_socket_tx_flush(int timeout_ms)
+{
+	return drv_socket_conn_tx_flush(&g_conn, timeout_ms);
+}
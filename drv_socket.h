@@ -3,13 +3,218 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/uio.h>
 #include "comm_def.h"
+#include "comm_buf.h"
+#include "mpsc_queue.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/* Open TCP connection to host:port (default host 127.0.0.1 if NULL). 
+#define DRV_SOCKET_TX_QUEUE_SIZE    16U     /* default TX queue depth per connection */
+#define DRV_SOCKET_RX_CHUNK         256U    /* smallest receive buffer */
+#define DRV_SOCKET_RX_MAX           16384U  /* largest receive buffer */
+#define DRV_SOCKET_RX_BUDGET        65536U  /* bytes drained from one connection before serving the next */
+#define DRV_SOCKET_RCVBUF_BURSTS    4U      /* SO_RCVBUF holds this many receive buffers */
+#define DRV_SOCKET_REACTOR_EVENTS   64U     /* epoll events taken per reactor poll */
+#define DRV_SOCKET_TX_BATCH         16U     /* frames gathered into one write */
+#define DRV_SOCKET_BACKOFF_MIN_MS   100U    /* first reconnect delay */
+#define DRV_SOCKET_BACKOFF_MAX_MS   30000U  /* reconnect delay cap */
+#define DRV_SOCKET_STABLE_MS        5000U   /* a connection up this long starts the backoff over */
+
+struct drv_socket_reactor;
+struct drv_socket_reactor_req;
+struct drv_uring;
+
+typedef enum {
+	DRV_SOCKET_STATE_CLOSED = 0,    /* no socket, not reconnecting */
+	DRV_SOCKET_STATE_CONNECTING,    /* non-blocking connect() in progress */
+	DRV_SOCKET_STATE_CONNECTED,     /* connect confirmed by SO_ERROR */
+	DRV_SOCKET_STATE_BACKOFF,       /* down, waiting to reconnect */
+} drv_socket_state_t;
+
+/* What happens to frames queued for a connection that went down. */
+typedef enum {
+	DRV_SOCKET_TX_KEEP = 0,         /* send them after reconnecting, a partly written frame again in full */
+	DRV_SOCKET_TX_DROP,             /* release them, counted in tx_dropped */
+} drv_socket_tx_policy_t;
+
+/* Bytes read from a connection, called on the reactor thread (or the draining thread). data is only valid during the call. */
+typedef void (*drv_socket_recv_cb_t)(void *ctx, const uint8_t *data, size_t len);
+/* Connection came up (connected = 1) or went down (connected = 0), called on the reactor thread. */
+typedef void (*drv_socket_state_cb_t)(void *ctx, int connected);
+
+/* One TCP connection. Caller-owned; initialize with drv_socket_conn_init(). */
+typedef struct drv_socket_conn {
+	int fd;
+	int connected;                      /* state == DRV_SOCKET_STATE_CONNECTED */
+	uint8_t state;                      /* drv_socket_state_t */
+	uint8_t nonblock;
+	uint8_t reconnect;                  /* reconnect after going down */
+	uint8_t tx_policy;                  /* drv_socket_tx_policy_t */
+	uint32_t peer_addr;                 /* IPv4 address, network order */
+	uint16_t peer_port;                 /* network order */
+	uint32_t backoff_min_ms;
+	uint32_t backoff_max_ms;
+	uint32_t backoff_ms;                /* last backoff, 0 once a connection stayed up DRV_SOCKET_STABLE_MS */
+	uint32_t up_tick;                   /* kernel tick the connection came up */
+	uint32_t retry_tick;                /* kernel tick of the next connect attempt */
+	uint32_t rand_state;                /* jitter generator */
+	uint32_t reconnects;                /* connect attempts after the first */
+	uint32_t tx_dropped;                /* frames released by DRV_SOCKET_TX_DROP */
+	uint8_t *rx_buf;                    /* receive buffer, sized from recent bursts */
+	uint32_t rx_cap;
+	uint32_t rx_peak;                   /* largest recent burst, decays by 1/8 per drain */
+	int rx_rcvbuf;                      /* SO_RCVBUF set for the bursts seen, 0 for the kernel default */
+	uint32_t epoch;                     /* bumped on every completed connect */
+	uint32_t tx_epoch;                  /* epoch tx_off belongs to, TX thread only */
+	pthread_mutex_t fd_lock;            /* held to close a connected fd, and by the TX thread while it writes */
+	struct drv_socket_conn *retry_next; /* reactor list of connections in backoff */
+	uint8_t retry_queued;               /* on the reactor's retry list */
+	struct drv_socket_conn *conn_next;  /* reactor list of every connection it serves */
+	mpsc_queue_t *tx_mq;                /* comm_buf_t* items, any thread puts, one thread sends */
+	comm_buf_t *tx_batch[DRV_SOCKET_TX_BATCH]; /* frames taken from tx_mq and not fully written, oldest first */
+	uint8_t tx_batch_count;
+	uint16_t tx_off;                    /* bytes of tx_batch[0] already written */
+	uint32_t tx_frames;                 /* frames fully written */
+	uint32_t tx_bytes;                  /* bytes written */
+	uint32_t tx_writes;                 /* write calls that wrote something */
+	uint32_t tx_armed;                  /* 1 once the backend has been asked to send, producers set it */
+	uint8_t tx_out;                     /* EPOLLOUT registered, reactor thread only */
+	struct drv_socket_reactor *reactor; /* reactor serving this connection, NULL if none */
+	struct drv_uring *uring;            /* io_uring serving this connection, NULL if none */
+	void (*tx_notify)(struct drv_socket_conn *conn); /* set by a backend that is woken on enqueue */
+	drv_socket_recv_cb_t on_recv;
+	drv_socket_state_cb_t on_state;
+	void *ctx;                          /* passed to on_recv and on_state */
+} drv_socket_conn_t;
+
+/* One epoll instance serving any number of connections from one thread. Only that thread calls
+ * epoll_ctl() and walks the connection lists; producers write wake_fd and the reactor sends or
+ * requests EPOLLOUT itself, other threads hand add/remove requests over the same way. */
+typedef struct drv_socket_reactor {
+	int epfd;
+	int wake_fd;                        /* eventfd written by producers and by add/remove requests */
+	uint32_t conn_count;
+	drv_socket_conn_t *conn_head;       /* connections served */
+	drv_socket_conn_t *retry_head;      /* connections waiting to reconnect */
+	pthread_mutex_t req_lock;           /* guards req_head, polling and thread */
+	pthread_cond_t req_done;            /* signalled when the reactor has applied requests */
+	struct drv_socket_reactor_req *req_head; /* add/remove requests from other threads */
+	uint8_t polling;                    /* drv_socket_reactor_poll() has run on thread */
+	pthread_t thread;
+} drv_socket_reactor_t;
+
+/* ---- Per-connection API ---- */
+
+/* Reset conn to closed with no TX queue and no callbacks. */
+void drv_socket_conn_init(drv_socket_conn_t *conn);
+
+/* Set the callbacks the reactor uses for conn. Either may be NULL. */
+void drv_socket_conn_set_callbacks(drv_socket_conn_t *conn, drv_socket_recv_cb_t on_recv,
+				   drv_socket_state_cb_t on_state, void *ctx);
+
+/* Reconnect conn after it goes down or a connect attempt fails, waiting a jittered exponential
+ * backoff between min_ms and max_ms (0 for the defaults) before each attempt. policy says what
+ * happens to its queued frames meanwhile. Set before drv_socket_conn_open(). */
+void drv_socket_conn_set_reconnect(drv_socket_conn_t *conn, int enable, uint32_t min_ms, uint32_t max_ms,
+				   drv_socket_tx_policy_t policy);
+
+/* Open TCP connection to host:port (default host 127.0.0.1 if NULL).
+ * nonblock != 0 sets socket O_NONBLOCK; connections served by a reactor must be non-blocking.
+ * A non-blocking connect is left CONNECTING and only counts as connected once SO_ERROR confirms it.
+ * Returns 0 on success or while a reconnect is scheduled, -1 on error. */
+int drv_socket_conn_open(drv_socket_conn_t *conn, const char *host, uint16_t port, int nonblock);
+
+/* Close the socket, stop reconnecting, detach it from its reactor, free the receive buffer and
+ * release the frames taken for writing. Queued frames stay queued.
+ * A connection served by an io_uring is closed with drv_uring_remove() instead. */
+void drv_socket_conn_close(drv_socket_conn_t *conn);
+
+int drv_socket_conn_is_connected(const drv_socket_conn_t *conn);
+drv_socket_state_t drv_socket_conn_get_state(const drv_socket_conn_t *conn);
+
+/* For connections without a reactor: wait up to timeout_ms for a pending connect to complete,
+ * or start the next reconnect once the backoff is over. The connection state only changes on the
+ * receiving thread: recv and recv_drain call it with 0, send and tx_flush never do and only write
+ * to a connection that is up. Returns 1 if connected, 0 otherwise. */
+int drv_socket_conn_maintain(drv_socket_conn_t *conn, int timeout_ms);
+
+/* Send/recv on one connection, see drv_socket_send()/drv_socket_recv(). send may run on another
+ * thread than recv; it fails while the connection is not up. */
+ssize_t drv_socket_conn_send(drv_socket_conn_t *conn, const uint8_t *buf, size_t len, int timeout_ms);
+ssize_t drv_socket_conn_recv(drv_socket_conn_t *conn, uint8_t *buf, size_t len, int timeout_ms);
+
+/* Read everything the socket holds without blocking, handing each chunk to on_chunk as soon as it
+ * is read. The buffer grows and shrinks with the bursts seen, and SO_RCVBUF is raised to hold
+ * DRV_SOCKET_RCVBUF_BURSTS of them. Only for connections without a reactor.
+ * Returns bytes read, 0 if none, -1 if the connection is down. */
+ssize_t drv_socket_conn_recv_drain(drv_socket_conn_t *conn, drv_socket_recv_cb_t on_chunk, void *ctx);
+
+/* TX queue of conn, see the async TX queue APIs below. */
+comm_result_t drv_socket_conn_tx_init(drv_socket_conn_t *conn, uint32_t capacity);
+void drv_socket_conn_tx_deinit(drv_socket_conn_t *conn);
+/* Takes over one reference of buf; safe from any thread. A reactor is woken to send it. */
+comm_result_t drv_socket_conn_tx_enqueue_buf(drv_socket_conn_t *conn, comm_buf_t *buf);
+/* Only for connections without a reactor; the reactor is the one consumer otherwise. */
+comm_result_t drv_socket_conn_tx_dequeue_buf(drv_socket_conn_t *conn, comm_buf_t **out_buf);
+
+/* Write every queued frame with as few sendmsg() calls as possible, DRV_SOCKET_TX_BATCH frames
+ * per call. A short write is resumed mid-frame by the next call. With timeout_ms > 0 a full
+ * socket buffer is waited on, otherwise the rest stays queued. Only for connections without
+ * a reactor. Returns bytes written, or -1 if the connection failed. */
+ssize_t drv_socket_conn_tx_flush(drv_socket_conn_t *conn, int timeout_ms);
+
+/* For transport backends: top the batch up from tx_mq and describe its unwritten bytes in iov.
+ * Returns the number of iov entries used, 0 if nothing is queued. Consumer thread only. */
+uint32_t drv_socket_conn_tx_gather(drv_socket_conn_t *conn, struct iovec *iov, uint32_t max_iov);
+
+/* For transport backends: account n bytes written from the batch and release the frames
+ * they completed. Consumer thread only. */
+void drv_socket_conn_tx_complete(drv_socket_conn_t *conn, size_t n);
+
+/* For transport backends: start a reconnect whose backoff is over and check a pending connect,
+ * without blocking. on_state(1) is called once connected. Returns 1 if connected, 0 otherwise.
+ * Consumer thread only. */
+int drv_socket_conn_retry(drv_socket_conn_t *conn);
+
+/* For transport backends: the socket failed or the peer closed it. Close the socket and schedule
+ * a reconnect, or leave conn closed if it does not reconnect; queued frames follow its TX policy
+ * and on_state(0) is called if it was connected. Consumer thread only. */
+void drv_socket_conn_fail(drv_socket_conn_t *conn);
+
+/* ---- Reactor ---- */
+
+/* Create the epoll instance. Returns COMM_OK/COMM_ERROR. */
+comm_result_t drv_socket_reactor_init(drv_socket_reactor_t *reactor);
+
+/* Close the epoll instance; connections must have been removed or closed. */
+void drv_socket_reactor_deinit(drv_socket_reactor_t *reactor);
+
+/* Serve an opened non-blocking connection from the reactor: connected, connecting or waiting to
+ * reconnect. on_state(1) is called once the connect completes. Safe from any thread: once the
+ * reactor polls, the request is applied on its thread and waited for. Returns COMM_OK/COMM_ERROR. */
+comm_result_t drv_socket_reactor_add(drv_socket_reactor_t *reactor, drv_socket_conn_t *conn);
+
+/* Stop serving conn; the socket stays open and a scheduled reconnect is dropped. Safe from any
+ * thread like drv_socket_reactor_add(); the reactor no longer touches conn once it returns. */
+void drv_socket_reactor_remove(drv_socket_reactor_t *reactor, drv_socket_conn_t *conn);
+
+/* Wait up to timeout_ms (-1 forever) for readiness, then read every readable connection
+ * into on_recv and write queued frames to every writable one, completing pending connects and
+ * starting reconnects that are due. Call from one thread.
+ * Returns the number of connections served, 0 on timeout, -1 on error. */
+int drv_socket_reactor_poll(drv_socket_reactor_t *reactor, int timeout_ms);
+
+/* ---- Single-connection API (process-wide default connection) ---- */
+
+/* See drv_socket_conn_set_reconnect(). */
+void drv_socket_set_reconnect(int enable, uint32_t min_ms, uint32_t max_ms, drv_socket_tx_policy_t policy);
+
+/* Open TCP connection to host:port (default host 127.0.0.1 if NULL).
  * nonblock != 0 sets socket O_NONBLOCK. Returns 0 on success, -1 on error. */
 int drv_socket_open(const char *host, uint16_t port, int nonblock);
 
@@ -23,27 +228,42 @@ int drv_socket_is_connected(void);
 size_t drv_socket_send(const uint8_t *buf, size_t len, int timeout_ms);
 
 /* Receive into buffer with timeout in ms. Returns bytes received or -1 on error/timeout. */
-size_t drv_socket_recv(uint8_t *buf, size_t len, int timeout_ms);
+ssize_t drv_socket_recv(uint8_t *buf, size_t len, int timeout_ms);
+
+/* Read everything pending, see drv_socket_conn_recv_drain(). */
+ssize_t drv_socket_recv_drain(drv_socket_recv_cb_t on_chunk, void *ctx);
 
 /* ---- Async TX queue APIs ---- */
 
-/* Initialize a TX message queue with fixed-size items.
+/* Initialize the TX queue. Items are comm_buf_t references, so a queued frame
+ * stays in the buffer it was encoded into until it is sent.
  * capacity: number of items (use a small power-of-two or 8/16). Returns COMM_OK/COMM_ERROR. */
 comm_result_t drv_socket_tx_queue_init(uint32_t capacity);
 
-/* Deinitialize TX queue and release resources. */
+/* Deinitialize TX queue and release resources, queued buffers included. */
 void drv_socket_tx_queue_deinit(void);
 
-/* Enqueue a frame to TX queue (copies payload). Returns COMM_OK or error.
+/* Enqueue an encoded frame without copying it. Takes over one reference of buf,
+ * which is released when the frame has been sent, or right away on error. */
+comm_result_t drv_socket_tx_enqueue_buf(comm_buf_t *buf);
+
+/* Dequeue one frame. The caller owns the returned reference and releases it
+ * after sending. Returns COMM_OK/COMM_EMPTY_QUEUE/COMM_ERROR. */
+comm_result_t drv_socket_tx_dequeue_buf(comm_buf_t **out_buf);
+
+/* Enqueue a frame to TX queue (copies payload into a pool buffer). Returns COMM_OK or error.
  * len must be <= COMM_PROTOCOL_MAX_BUFF_LEN. */
 comm_result_t drv_socket_tx_enqueue(const uint8_t *buf, uint16_t len);
 
 /* Dequeue one frame from TX queue into caller buffer. Returns COMM_OK/COMM_EMPTY_QUEUE/COMM_ERROR. */
 comm_result_t drv_socket_tx_dequeue(uint8_t *buf, uint16_t bufcap, uint16_t *out_len);
 
-/* Pop one from TX queue and send via socket. Returns COMM_OK on full send, otherwise COMM_ERROR. */
+/* Pop one from TX queue and send it from its buffer. Returns COMM_OK on full send, otherwise COMM_ERROR. */
 comm_result_t drv_socket_tx_send_one(int timeout_ms);
 
+/* Write every queued frame, see drv_socket_conn_tx_flush(). Returns bytes written or -1 on error. */
+ssize_t drv_socket_tx_flush(int timeout_ms);
+
 #ifdef __cplusplus
 }
 #endif
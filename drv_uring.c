@@ -0,0 +1,780 @@
+#include "drv_uring.h"
+#include "cmsis_os2.h"
+#include "comm_buf.h"
+#include <string.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#if defined(__NR_io_uring_setup) && defined(IORING_RECV_MULTISHOT)
+#define DRV_URING_SUPPORTED
+#endif
+#endif
+#endif
+
+#ifdef DRV_URING_SUPPORTED
+
+/* user_data: request kind in the high word, slot index in the low word */
+#define DRV_URING_OP_RECV       1U
+#define DRV_URING_OP_SEND       2U
+#define DRV_URING_OP_WAKE       3U
+#define DRV_URING_OP_CANCEL     4U
+#define DRV_URING_OP_CONNECT    5U
+#define DRV_URING_DATA(op, idx) (((uint64_t)(op) << 32) | (uint64_t)(idx))
+
+#define DRV_URING_DRAIN_MS      1000U   /* drv_uring_deinit() waits this long for cancelled requests */
+
+typedef char drv_uring_buf_count_pow2[((DRV_URING_BUF_COUNT & (DRV_URING_BUF_COUNT - 1U)) == 0U) ? 1 : -1];
+
+static int drv_uring_enter(drv_uring_t *uring, uint32_t min_complete, int timeout_ms)
+{
+	struct io_uring_getevents_arg arg;
+	struct __kernel_timespec ts;
+	int ret = 0;
+
+	/* publish the SQEs filled in since the last call */
+	__atomic_store_n(uring->sq_tail, uring->sq_local_tail, __ATOMIC_RELEASE);
+	if (min_complete == 0U)
+	{
+		ret = (int)syscall(__NR_io_uring_enter, uring->ring_fd, uring->to_submit, 0U, 0U, NULL, 0);
+	}
+	else
+	{
+		(void)memset(&arg, 0, sizeof(arg));
+		if (timeout_ms >= 0)
+		{
+			ts.tv_sec = timeout_ms / 1000;
+			ts.tv_nsec = (long long)(timeout_ms % 1000) * 1000000LL;
+			arg.ts = (uint64_t)(uintptr_t)&ts;
+		}
+		ret = (int)syscall(__NR_io_uring_enter, uring->ring_fd, uring->to_submit, min_complete,
+				   IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+	}
+	uring->to_submit = uring->sq_local_tail - __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE);
+	return ret;
+}
+
+/* 取一个空闲 SQE，提交环满时先把已有的交给内核 */
+static struct io_uring_sqe *drv_uring_get_sqe(drv_uring_t *uring, uint64_t user_data)
+{
+	struct io_uring_sqe *sqe = NULL;
+
+	if ((uring->sq_local_tail - __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE)) > uring->sq_mask)
+	{
+		(void)drv_uring_enter(uring, 0U, 0);
+		if ((uring->sq_local_tail - __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE)) > uring->sq_mask)
+		{
+			return NULL;
+		}
+	}
+	sqe = &((struct io_uring_sqe *)uring->sqes)[uring->sq_local_tail & uring->sq_mask];
+	(void)memset(sqe, 0, sizeof(*sqe));
+	sqe->user_data = user_data;
+	uring->sq_local_tail++;
+	uring->to_submit++;
+	return sqe;
+}
+
+/* 把接收缓冲区放回 provided buffer ring，tail 在一批完成处理后统一发布 */
+static void drv_uring_buf_recycle(drv_uring_t *uring, uint16_t bid)
+{
+	struct io_uring_buf_ring *br = (struct io_uring_buf_ring *)uring->buf_ring;
+	struct io_uring_buf *buf = &br->bufs[uring->buf_tail & (DRV_URING_BUF_COUNT - 1U)];
+
+	buf->addr = (uint64_t)(uintptr_t)(uring->bufs + ((size_t)bid * DRV_URING_BUF_SIZE));
+	buf->len = DRV_URING_BUF_SIZE;
+	buf->bid = bid;
+	uring->buf_tail++;
+}
+
+static void drv_uring_buf_publish(drv_uring_t *uring)
+{
+	struct io_uring_buf_ring *br = (struct io_uring_buf_ring *)uring->buf_ring;
+
+	__atomic_store_n(&br->tail, uring->buf_tail, __ATOMIC_RELEASE);
+}
+
+/* 生产者线程调用：第一次置位时写 eventfd 唤醒可能在等待的 ring 线程 */
+static void drv_uring_conn_notify(drv_socket_conn_t *conn)
+{
+	uint64_t one = 1U;
+	drv_uring_t *uring = conn->uring;
+
+	if ((uring == NULL) || (__atomic_exchange_n(&conn->tx_armed, 1U, __ATOMIC_SEQ_CST) != 0U))
+	{
+		return;
+	}
+	(void)write(uring->wake_fd, &one, sizeof(one));
+}
+
+static void drv_uring_post_wake(drv_uring_t *uring)
+{
+	struct io_uring_sqe *sqe = drv_uring_get_sqe(uring, DRV_URING_DATA(DRV_URING_OP_WAKE, 0U));
+
+	if (sqe == NULL)
+	{
+		return;
+	}
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = uring->wake_fd;
+	sqe->len = IORING_POLL_ADD_MULTI;
+	sqe->poll32_events = POLLIN;
+	uring->wake_posted = 1U;
+}
+
+static void drv_uring_post_recv(drv_uring_t *uring, uint32_t idx)
+{
+	drv_uring_slot_t *slot = &uring->slots[idx];
+	struct io_uring_sqe *sqe = drv_uring_get_sqe(uring, DRV_URING_DATA(DRV_URING_OP_RECV, idx));
+
+	if (sqe == NULL)
+	{
+		return;
+	}
+	sqe->fd = slot->conn->fd;
+	sqe->flags = IOSQE_BUFFER_SELECT;
+	sqe->buf_group = DRV_URING_BUF_GROUP;
+	if (slot->kind == (uint8_t)DRV_URING_FD_SOCKET)
+	{
+		/* stays posted, one completion per received chunk */
+		sqe->opcode = IORING_OP_RECV;
+		sqe->ioprio = IORING_RECV_MULTISHOT;
+	}
+	else
+	{
+		sqe->opcode = IORING_OP_READ;
+		sqe->len = DRV_URING_BUF_SIZE;
+		sqe->off = (uint64_t)-1;    /* current position, the device is not seekable */
+	}
+	slot->recv_posted = 1U;
+}
+
+/* 把连接排队的帧聚合成一个 sendmsg 提交；返回 1 表示有帧正被生产者写入，本轮不应阻塞等待 */
+static int drv_uring_post_send(drv_uring_t *uring, uint32_t idx)
+{
+	drv_uring_slot_t *slot = &uring->slots[idx];
+	drv_socket_conn_t *conn = slot->conn;
+	struct io_uring_sqe *sqe = NULL;
+	uint32_t count = drv_socket_conn_tx_gather(conn, slot->tx_iov, DRV_SOCKET_TX_BATCH);
+
+	if (count == 0U)
+	{
+		/* queue empty: disarm, then look again for a frame that raced with the disarm */
+		__atomic_store_n(&conn->tx_armed, 0U, __ATOMIC_SEQ_CST);
+		if ((mpsc_queue_count(conn->tx_mq) == 0U) ||
+		    (__atomic_exchange_n(&conn->tx_armed, 1U, __ATOMIC_SEQ_CST) != 0U))
+		{
+			return 0;
+		}
+		count = drv_socket_conn_tx_gather(conn, slot->tx_iov, DRV_SOCKET_TX_BATCH);
+		if (count == 0U)
+		{
+			return 1;
+		}
+	}
+	sqe = drv_uring_get_sqe(uring, DRV_URING_DATA(DRV_URING_OP_SEND, idx));
+	if (sqe == NULL)
+	{
+		return 1;
+	}
+	(void)memset(&slot->tx_msg, 0, sizeof(slot->tx_msg));
+	slot->tx_msg.msg_iov = slot->tx_iov;
+	slot->tx_msg.msg_iovlen = count;
+	sqe->opcode = IORING_OP_SENDMSG;
+	sqe->fd = conn->fd;
+	sqe->addr = (uint64_t)(uintptr_t)&slot->tx_msg;
+	sqe->len = 1U;
+	sqe->msg_flags = MSG_NOSIGNAL;
+	slot->send_posted = 1U;
+	return 0;
+}
+
+/* 取消描述符上的全部请求；提交环满时返回 -1，由调用者下次再试 */
+static int drv_uring_post_cancel(drv_uring_t *uring, uint32_t idx, int fd)
+{
+	struct io_uring_sqe *sqe = drv_uring_get_sqe(uring, DRV_URING_DATA(DRV_URING_OP_CANCEL, idx));
+
+	if (sqe == NULL)
+	{
+		return -1;
+	}
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->fd = fd;
+	sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+	return 0;
+}
+
+/* 连接停止服务：取消它的请求，等全部完成后再关闭，期间内核可能仍在用它的缓冲区 */
+static void drv_uring_slot_close(drv_uring_t *uring, uint32_t idx, uint8_t notify)
+{
+	drv_uring_slot_t *slot = &uring->slots[idx];
+
+	if (slot->closing != 0U)
+	{
+		return;
+	}
+	slot->closing = notify ? 2U : 1U;
+	if ((slot->recv_posted == 0U) && (slot->send_posted == 0U) && (slot->connect_posted == 0U))
+	{
+		return;
+	}
+	/* retried by drv_uring_poll() while the submission ring is full */
+	slot->cancel_pending = (drv_uring_post_cancel(uring, idx, slot->conn->fd) != 0) ? 1U : 0U;
+}
+
+/* 最后一个请求完成后释放槽位；断线且要重连的连接保留槽位，由 drv_uring_poll() 按退避重连 */
+static void drv_uring_slot_finish(drv_uring_t *uring, uint32_t idx)
+{
+	drv_uring_slot_t *slot = &uring->slots[idx];
+	drv_socket_conn_t *conn = slot->conn;
+	uint8_t notify = (slot->closing == 2U) ? 1U : 0U;
+
+	if ((slot->closing == 0U) || (slot->recv_posted != 0U) || (slot->send_posted != 0U) ||
+	    (slot->connect_posted != 0U))
+	{
+		return;
+	}
+	if (notify && conn->reconnect && (slot->kind == (uint8_t)DRV_URING_FD_SOCKET))
+	{
+		slot->closing = 0U;
+		drv_socket_conn_fail(conn);
+		return;
+	}
+	conn->connected = 0;
+	conn->uring = NULL;
+	conn->tx_notify = NULL;
+	conn->tx_armed = 0U;
+	drv_socket_conn_close(conn);
+	(void)memset(slot, 0, sizeof(*slot));
+	uring->conn_count--;
+	if (notify && (conn->on_state != NULL))
+	{
+		conn->on_state(conn->ctx, 0);
+	}
+}
+
+static void drv_uring_on_recv(drv_uring_t *uring, uint32_t idx, const struct io_uring_cqe *cqe)
+{
+	drv_uring_slot_t *slot = &uring->slots[idx];
+	drv_socket_conn_t *conn = slot->conn;
+	uint16_t bid = 0U;
+
+	if ((cqe->flags & IORING_CQE_F_MORE) == 0U)
+	{
+		slot->recv_posted = 0U;
+	}
+	if ((cqe->flags & IORING_CQE_F_BUFFER) != 0U)
+	{
+		bid = (uint16_t)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+		if ((cqe->res > 0) && (slot->closing == 0U) && (conn->on_recv != NULL))
+		{
+			conn->on_recv(conn->ctx, uring->bufs + ((size_t)bid * DRV_URING_BUF_SIZE), (size_t)cqe->res);
+		}
+		drv_uring_buf_recycle(uring, bid);
+	}
+	if (slot->closing != 0U)
+	{
+		drv_uring_slot_finish(uring, idx);
+	}
+	else if ((cqe->res == 0) ||
+		 ((cqe->res < 0) && (cqe->res != -ENOBUFS) && (cqe->res != -EAGAIN) && (cqe->res != -EINTR)))
+	{
+		/* peer closed or the descriptor failed; -ENOBUFS only means every buffer was in use */
+		drv_uring_slot_close(uring, idx, 1U);
+		drv_uring_slot_finish(uring, idx);
+	}
+}
+
+static void drv_uring_on_send(drv_uring_t *uring, uint32_t idx, const struct io_uring_cqe *cqe)
+{
+	drv_uring_slot_t *slot = &uring->slots[idx];
+	drv_socket_conn_t *conn = slot->conn;
+
+	slot->send_posted = 0U;
+	if (cqe->res > 0)
+	{
+		/* a short send is resumed mid-frame by the next poll */
+		drv_socket_conn_tx_complete(conn, (size_t)cqe->res);
+	}
+	if (slot->closing != 0U)
+	{
+		drv_uring_slot_finish(uring, idx);
+	}
+	else if ((cqe->res <= 0) && (cqe->res != -EAGAIN) && (cqe->res != -EINTR))
+	{
+		drv_uring_slot_close(uring, idx, 1U);
+		drv_uring_slot_finish(uring, idx);
+	}
+}
+
+/* 连接中的套接字等到可写再由 SO_ERROR 确认 */
+static void drv_uring_post_connect(drv_uring_t *uring, uint32_t idx)
+{
+	drv_uring_slot_t *slot = &uring->slots[idx];
+	struct io_uring_sqe *sqe = drv_uring_get_sqe(uring, DRV_URING_DATA(DRV_URING_OP_CONNECT, idx));
+
+	if (sqe == NULL)
+	{
+		return;
+	}
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = slot->conn->fd;
+	sqe->poll32_events = POLLOUT;
+	slot->connect_posted = 1U;
+}
+
+/* 未连上的连接：退避到期时发起重连，连接中的等可写；返回 1 表示已连上 */
+static int drv_uring_slot_connect(drv_uring_t *uring, uint32_t idx)
+{
+	drv_uring_slot_t *slot = &uring->slots[idx];
+	drv_socket_conn_t *conn = slot->conn;
+
+	if (slot->connect_posted != 0U)
+	{
+		return 0;
+	}
+	if (drv_socket_conn_retry(conn) != 0)
+	{
+		return 1;
+	}
+	if (conn->state == DRV_SOCKET_STATE_CONNECTING)
+	{
+		drv_uring_post_connect(uring, idx);
+	}
+	else if (conn->state == DRV_SOCKET_STATE_CLOSED)
+	{
+		/* a connect failed and conn does not reconnect */
+		drv_uring_slot_close(uring, idx, 0U);
+		drv_uring_slot_finish(uring, idx);
+	}
+	return 0;
+}
+
+static void drv_uring_on_connect(drv_uring_t *uring, uint32_t idx)
+{
+	drv_uring_slot_t *slot = &uring->slots[idx];
+
+	slot->connect_posted = 0U;
+	if (slot->closing != 0U)
+	{
+		drv_uring_slot_finish(uring, idx);
+	}
+	else
+	{
+		(void)drv_uring_slot_connect(uring, idx);
+	}
+}
+
+/* 距最早一次到期重连的毫秒数，用来缩短等待 */
+static int drv_uring_retry_timeout(const drv_uring_t *uring, int timeout_ms)
+{
+	const drv_socket_conn_t *conn = NULL;
+	uint32_t now = osKernelGetTickCount();
+	uint32_t idx = 0U;
+	int32_t left = 0;
+	int ms = 0;
+
+	for (idx = 0U; idx < DRV_URING_MAX_CONNS; idx++)
+	{
+		conn = uring->slots[idx].conn;
+		if ((conn == NULL) || (uring->slots[idx].closing != 0U) || (conn->state != DRV_SOCKET_STATE_BACKOFF))
+		{
+			continue;
+		}
+		left = (int32_t)(conn->retry_tick - now);
+		ms = (left > 0) ? (int)(((uint64_t)(uint32_t)left * 1000U + osKernelGetTickFreq() - 1U) / osKernelGetTickFreq()) : 0;
+		if ((timeout_ms < 0) || (ms < timeout_ms))
+		{
+			timeout_ms = ms;
+		}
+	}
+	return timeout_ms;
+}
+
+static int drv_uring_reap(drv_uring_t *uring)
+{
+	struct io_uring_cqe *cqes = (struct io_uring_cqe *)uring->cqes;
+	struct io_uring_cqe *cqe = NULL;
+	uint32_t head = *uring->cq_head;
+	uint32_t tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+	uint64_t count = 0U;
+	uint32_t idx = 0U;
+	int handled = 0;
+
+	while (head != tail)
+	{
+		cqe = &cqes[head & uring->cq_mask];
+		idx = (uint32_t)(cqe->user_data & 0xFFFFFFFFU);
+		switch ((uint32_t)(cqe->user_data >> 32))
+		{
+		case DRV_URING_OP_RECV:
+			drv_uring_on_recv(uring, idx, cqe);
+			break;
+		case DRV_URING_OP_SEND:
+			drv_uring_on_send(uring, idx, cqe);
+			break;
+		case DRV_URING_OP_CONNECT:
+			drv_uring_on_connect(uring, idx);
+			break;
+		case DRV_URING_OP_WAKE:
+			(void)read(uring->wake_fd, &count, sizeof(count));
+			if ((cqe->flags & IORING_CQE_F_MORE) == 0U)
+			{
+				uring->wake_posted = 0U;
+			}
+			break;
+		default:
+			break;
+		}
+		head++;
+		handled++;
+		/* the handlers above may have filled SQEs, but never wait, so tail only grows */
+		if (head == tail)
+		{
+			tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+		}
+	}
+	__atomic_store_n(uring->cq_head, head, __ATOMIC_RELEASE);
+	drv_uring_buf_publish(uring);
+	return handled;
+}
+
+static void drv_uring_unmap(drv_uring_t *uring)
+{
+	if (uring->sqes != NULL)
+	{
+		(void)munmap(uring->sqes, uring->sqes_len);
+	}
+	if (uring->sq_map != NULL)
+	{
+		(void)munmap(uring->sq_map, uring->sq_map_len);
+	}
+	if (uring->ring_fd >= 0)
+	{
+		(void)close(uring->ring_fd);
+	}
+	if (uring->wake_fd >= 0)
+	{
+		(void)close(uring->wake_fd);
+	}
+	free(uring->buf_ring);
+	free(uring->bufs);
+	(void)memset(uring, 0, sizeof(drv_uring_t));
+	uring->ring_fd = -1;
+	uring->wake_fd = -1;
+}
+
+comm_result_t drv_uring_init(drv_uring_t *uring)
+{
+	struct io_uring_params params;
+	struct io_uring_buf_reg reg;
+	uint8_t *map = NULL;
+	uint32_t i = 0U;
+
+	if (uring == NULL)
+	{
+		return COMM_ERROR;
+	}
+	(void)memset(uring, 0, sizeof(drv_uring_t));
+	uring->wake_fd = -1;
+	(void)memset(&params, 0, sizeof(params));
+	uring->ring_fd = (int)syscall(__NR_io_uring_setup, DRV_URING_ENTRIES, &params);
+	if ((uring->ring_fd < 0) || ((params.features & IORING_FEAT_SINGLE_MMAP) == 0U) ||
+	    ((params.features & IORING_FEAT_EXT_ARG) == 0U))
+	{
+		drv_uring_unmap(uring);
+		return COMM_ERROR;
+	}
+
+	/* SQ and CQ rings share one mapping */
+	uring->sq_map_len = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	if (uring->sq_map_len < (params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe)))
+	{
+		uring->sq_map_len = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	}
+	map = mmap(NULL, uring->sq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+		   uring->ring_fd, IORING_OFF_SQ_RING);
+	if (map == MAP_FAILED)
+	{
+		uring->sq_map = NULL;
+		drv_uring_unmap(uring);
+		return COMM_ERROR;
+	}
+	uring->sq_map = map;
+	uring->sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+	uring->sqes = mmap(NULL, uring->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			   uring->ring_fd, IORING_OFF_SQES);
+	if (uring->sqes == MAP_FAILED)
+	{
+		uring->sqes = NULL;
+		drv_uring_unmap(uring);
+		return COMM_ERROR;
+	}
+	uring->sq_head = (uint32_t *)(map + params.sq_off.head);
+	uring->sq_tail = (uint32_t *)(map + params.sq_off.tail);
+	uring->sq_mask = *(uint32_t *)(map + params.sq_off.ring_mask);
+	uring->sq_array = (uint32_t *)(map + params.sq_off.array);
+	uring->sq_local_tail = *uring->sq_tail;
+	for (i = 0U; i < params.sq_entries; i++)
+	{
+		uring->sq_array[i] = i;
+	}
+	uring->cq_head = (uint32_t *)(map + params.cq_off.head);
+	uring->cq_tail = (uint32_t *)(map + params.cq_off.tail);
+	uring->cq_mask = *(uint32_t *)(map + params.cq_off.ring_mask);
+	uring->cqes = map + params.cq_off.cqes;
+
+	/* provided buffer ring: multishot receives take their buffers from here */
+	if ((posix_memalign(&uring->buf_ring, (size_t)sysconf(_SC_PAGESIZE),
+			    DRV_URING_BUF_COUNT * sizeof(struct io_uring_buf)) != 0) ||
+	    ((uring->bufs = (uint8_t *)malloc((size_t)DRV_URING_BUF_COUNT * DRV_URING_BUF_SIZE)) == NULL))
+	{
+		drv_uring_unmap(uring);
+		return COMM_ERROR;
+	}
+	(void)memset(uring->buf_ring, 0, DRV_URING_BUF_COUNT * sizeof(struct io_uring_buf));
+	(void)memset(&reg, 0, sizeof(reg));
+	reg.ring_addr = (uint64_t)(uintptr_t)uring->buf_ring;
+	reg.ring_entries = DRV_URING_BUF_COUNT;
+	reg.bgid = DRV_URING_BUF_GROUP;
+	if (syscall(__NR_io_uring_register, uring->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0)
+	{
+		drv_uring_unmap(uring);
+		return COMM_ERROR;
+	}
+	for (i = 0U; i < DRV_URING_BUF_COUNT; i++)
+	{
+		drv_uring_buf_recycle(uring, (uint16_t)i);
+	}
+	drv_uring_buf_publish(uring);
+
+	uring->wake_fd = eventfd(0U, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (uring->wake_fd < 0)
+	{
+		drv_uring_unmap(uring);
+		return COMM_ERROR;
+	}
+	return COMM_OK;
+}
+
+void drv_uring_deinit(drv_uring_t *uring)
+{
+	uint32_t start = 0U;
+	uint32_t limit = (uint32_t)(((uint64_t)DRV_URING_DRAIN_MS * osKernelGetTickFreq()) / 1000U);
+	uint32_t idx = 0U;
+	uint32_t busy = 0U;
+	uint8_t wake_cancel = 0U;
+
+	if ((uring == NULL) || (uring->ring_fd < 0))
+	{
+		return;
+	}
+	/* 先取消全部请求并等它们完成，内核不再写接收缓冲区后才释放 */
+	for (idx = 0U; idx < DRV_URING_MAX_CONNS; idx++)
+	{
+		if (uring->slots[idx].conn != NULL)
+		{
+			if (uring->slots[idx].closing == 2U)
+			{
+				uring->slots[idx].closing = 1U;    /* lost: neither reconnected nor notified now */
+			}
+			drv_uring_slot_close(uring, idx, 0U);
+			drv_uring_slot_finish(uring, idx);
+		}
+	}
+	start = osKernelGetTickCount();
+	while ((uring->conn_count != 0U) || (uring->wake_posted != 0U))
+	{
+		if ((osKernelGetTickCount() - start) >= limit)
+		{
+			break;
+		}
+		busy = 0U;
+		for (idx = 0U; idx < DRV_URING_MAX_CONNS; idx++)
+		{
+			if ((uring->slots[idx].cancel_pending != 0U) &&
+			    (drv_uring_post_cancel(uring, idx, uring->slots[idx].conn->fd) == 0))
+			{
+				uring->slots[idx].cancel_pending = 0U;
+			}
+			busy |= uring->slots[idx].cancel_pending;
+		}
+		if ((uring->wake_posted != 0U) && (wake_cancel == 0U) &&
+		    (drv_uring_post_cancel(uring, DRV_URING_MAX_CONNS, uring->wake_fd) == 0))
+		{
+			wake_cancel = 1U;
+		}
+		(void)drv_uring_enter(uring, (busy != 0U) ? 0U : 1U, 100);
+		(void)drv_uring_reap(uring);
+	}
+	drv_uring_unmap(uring);
+}
+
+comm_result_t drv_uring_add(drv_uring_t *uring, drv_socket_conn_t *conn, drv_uring_fd_kind_t kind)
+{
+	uint32_t idx = 0U;
+
+	if ((uring == NULL) || (uring->ring_fd < 0) || (conn == NULL) ||
+	    ((conn->fd < 0) && (conn->state != DRV_SOCKET_STATE_BACKOFF)) ||
+	    (conn->reactor != NULL) || (conn->uring != NULL))
+	{
+		return COMM_ERROR;
+	}
+	if (kind == DRV_URING_FD_FILE)
+	{
+		conn->state = DRV_SOCKET_STATE_CONNECTED;
+		conn->connected = 1;
+	}
+	else if ((conn->state == DRV_SOCKET_STATE_CLOSED) ||
+		 ((conn->state != DRV_SOCKET_STATE_CONNECTED) && (conn->nonblock == 0U)))
+	{
+		return COMM_ERROR;  /* the ring connects without blocking */
+	}
+	while ((idx < DRV_URING_MAX_CONNS) && (uring->slots[idx].conn != NULL))
+	{
+		idx++;
+	}
+	if (idx == DRV_URING_MAX_CONNS)
+	{
+		return COMM_ERROR;
+	}
+	uring->slots[idx].conn = conn;
+	uring->slots[idx].kind = (uint8_t)kind;
+	uring->conn_count++;
+	conn->uring = uring;
+	conn->tx_notify = drv_uring_conn_notify;
+	/* frames queued before the connection joined go out on the first poll */
+	__atomic_store_n(&conn->tx_armed, 1U, __ATOMIC_SEQ_CST);
+	if (conn->connected && (conn->on_state != NULL))
+	{
+		conn->on_state(conn->ctx, 1);
+	}
+	return COMM_OK;
+}
+
+void drv_uring_remove(drv_uring_t *uring, drv_socket_conn_t *conn)
+{
+	uint32_t idx = 0U;
+
+	if ((uring == NULL) || (conn == NULL) || (conn->uring != uring))
+	{
+		return;
+	}
+	for (idx = 0U; idx < DRV_URING_MAX_CONNS; idx++)
+	{
+		if (uring->slots[idx].conn == conn)
+		{
+			drv_uring_slot_close(uring, idx, 0U);
+			drv_uring_slot_finish(uring, idx);
+			return;
+		}
+	}
+}
+
+int drv_uring_poll(drv_uring_t *uring, int timeout_ms)
+{
+	drv_uring_slot_t *slot = NULL;
+	uint32_t idx = 0U;
+	uint32_t wait = 1U;
+	int ret = 0;
+
+	if ((uring == NULL) || (uring->ring_fd < 0))
+	{
+		return -1;
+	}
+	if (uring->wake_posted == 0U)
+	{
+		drv_uring_post_wake(uring);
+	}
+	/* queue a receive and the next send of every connection, all go in with one syscall */
+	for (idx = 0U; idx < DRV_URING_MAX_CONNS; idx++)
+	{
+		slot = &uring->slots[idx];
+		if ((slot->conn != NULL) && (slot->cancel_pending != 0U) &&
+		    (drv_uring_post_cancel(uring, idx, slot->conn->fd) == 0))
+		{
+			slot->cancel_pending = 0U;
+		}
+		if ((slot->conn == NULL) || (slot->closing != 0U))
+		{
+			continue;
+		}
+		if ((slot->conn->state != DRV_SOCKET_STATE_CONNECTED) && (drv_uring_slot_connect(uring, idx) == 0))
+		{
+			continue;
+		}
+		if (slot->recv_posted == 0U)
+		{
+			drv_uring_post_recv(uring, idx);
+		}
+		if ((slot->send_posted == 0U) && (slot->conn->tx_mq != NULL) &&
+		    (__atomic_load_n(&slot->conn->tx_armed, __ATOMIC_SEQ_CST) != 0U) &&
+		    (drv_uring_post_send(uring, idx) != 0))
+		{
+			wait = 0U;
+		}
+	}
+	/* completions already waiting are reaped without entering the kernel */
+	if (*uring->cq_head != __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE))
+	{
+		wait = 0U;
+	}
+	if ((wait != 0U) || (uring->to_submit != 0U))
+	{
+		ret = drv_uring_enter(uring, wait, drv_uring_retry_timeout(uring, timeout_ms));
+		if ((ret < 0) && (errno != ETIME) && (errno != EINTR) && (errno != EBUSY) && (errno != EAGAIN))
+		{
+			return -1;
+		}
+	}
+	return drv_uring_reap(uring);
+}
+
+#else /* !DRV_URING_SUPPORTED */
+
+comm_result_t drv_uring_init(drv_uring_t *uring)
+{
+	if (uring != NULL)
+	{
+		(void)memset(uring, 0, sizeof(drv_uring_t));
+		uring->ring_fd = -1;
+		uring->wake_fd = -1;
+	}
+	return COMM_ERROR;
+}
+
+void drv_uring_deinit(drv_uring_t *uring)
+{
+	(void)uring;
+}
+
+comm_result_t drv_uring_add(drv_uring_t *uring, drv_socket_conn_t *conn, drv_uring_fd_kind_t kind)
+{
+	(void)uring;
+	(void)conn;
+	(void)kind;
+	return COMM_ERROR;
+}
+
+void drv_uring_remove(drv_uring_t *uring, drv_socket_conn_t *conn)
+{
+	(void)uring;
+	(void)conn;
+}
+
+int drv_uring_poll(drv_uring_t *uring, int timeout_ms)
+{
+	(void)uring;
+	(void)timeout_ms;
+	return -1;
+}
+
+#endif /* DRV_URING_SUPPORTED */
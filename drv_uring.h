@@ -0,0 +1,114 @@
+#ifndef DRV_URING_H
+#define DRV_URING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include "comm_def.h"
+#include "drv_socket.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * io_uring transport backend, an alternative to drv_socket_reactor_t on kernels that have it.
+ *
+ * Every socket keeps one multishot receive posted that picks its buffers from a ring of
+ * provided buffers, so data arriving costs no syscall at all until the ring thread reaps it.
+ * Serial ports and other character devices have no multishot read; they keep one buffer-select
+ * read posted that is re-armed from its own completion. Sends for all connections are queued
+ * as SQEs and submitted together with the wait for completions in a single io_uring_enter()
+ * per poll, each one a sendmsg of every frame the connection has queued, and completions
+ * are reaped straight from the mapped completion ring.
+ *
+ * Needs Linux 6.0 or later (multishot receive and provided buffer rings). drv_uring_init()
+ * fails on older kernels, so callers probe with it and fall back to the epoll reactor.
+ */
+
+#define DRV_URING_ENTRIES       256U    /* submission queue entries */
+#define DRV_URING_BUF_COUNT     64U     /* provided receive buffers, a power of two */
+#define DRV_URING_BUF_SIZE      DRV_SOCKET_RX_CHUNK
+#define DRV_URING_MAX_CONNS     64U     /* connections served by one ring */
+#define DRV_URING_BUF_GROUP     0U      /* buffer group id of the provided buffer ring */
+
+/* How the descriptor of a connection is read. */
+typedef enum {
+	DRV_URING_FD_SOCKET = 0,    /* stream socket, multishot receive */
+	DRV_URING_FD_FILE,          /* serial port or other character device, re-armed read */
+} drv_uring_fd_kind_t;
+
+typedef struct drv_uring_slot {
+	drv_socket_conn_t *conn;    /* NULL if the slot is free */
+	uint8_t kind;               /* drv_uring_fd_kind_t */
+	uint8_t recv_posted;        /* a receive is in flight */
+	uint8_t send_posted;        /* a send of the frames in tx_iov is in flight */
+	uint8_t connect_posted;     /* waiting for a connect to complete */
+	uint8_t closing;            /* going down, waiting for its requests to finish */
+	uint8_t cancel_pending;     /* the cancel found the submission ring full, retried next poll */
+	struct msghdr tx_msg;       /* read by the kernel until the send completes */
+	struct iovec tx_iov[DRV_SOCKET_TX_BATCH];
+} drv_uring_slot_t;
+
+/* One io_uring instance serving any number of connections from one thread. */
+typedef struct drv_uring {
+	int ring_fd;
+	int wake_fd;                /* eventfd written by producers to end a wait */
+	uint8_t wake_posted;
+	/* submission ring */
+	uint32_t *sq_head;
+	uint32_t *sq_tail;
+	uint32_t *sq_array;
+	uint32_t sq_mask;
+	uint32_t sq_local_tail;     /* SQEs filled in, not yet published */
+	uint32_t to_submit;
+	void *sqes;
+	/* completion ring */
+	uint32_t *cq_head;
+	uint32_t *cq_tail;
+	uint32_t cq_mask;
+	void *cqes;
+	/* mappings */
+	void *sq_map;
+	size_t sq_map_len;
+	void *cq_map;
+	size_t cq_map_len;
+	size_t sqes_len;
+	/* provided receive buffers */
+	void *buf_ring;
+	uint8_t *bufs;
+	uint16_t buf_tail;
+	uint32_t conn_count;
+	drv_uring_slot_t slots[DRV_URING_MAX_CONNS];
+} drv_uring_t;
+
+/* Set up the ring and its provided buffers.
+ * Returns COMM_OK, or COMM_ERROR if the kernel lacks io_uring or one of the features above. */
+comm_result_t drv_uring_init(drv_uring_t *uring);
+
+/* Cancel what is still in flight, wait for it to complete (up to a second), then close the
+ * ring and free its buffers. Connections still on the ring are closed without on_state(0). */
+void drv_uring_deinit(drv_uring_t *uring);
+
+/* Serve an opened socket from the ring, or with DRV_URING_FD_FILE a serial port the caller
+ * opened into conn->fd. A socket that is still connecting or waiting to reconnect must be
+ * non-blocking; the ring completes the connect and calls on_state(1). A socket set to reconnect
+ * (drv_socket_conn_set_reconnect()) keeps its slot when it goes down and is reconnected by the
+ * ring after the backoff; otherwise, and for a serial port, conn leaves the ring once on_state(0)
+ * has been called and the caller may open and add it again. Returns COMM_OK/COMM_ERROR. */
+comm_result_t drv_uring_add(drv_uring_t *uring, drv_socket_conn_t *conn, drv_uring_fd_kind_t kind);
+
+/* Stop serving conn and close it once the ring has let go of its buffers.
+ * Ring thread only; use this instead of drv_socket_conn_close() while conn is on the ring. */
+void drv_uring_remove(drv_uring_t *uring, drv_socket_conn_t *conn);
+
+/* Submit queued sends and wait up to timeout_ms (-1 forever) for completions, then hand
+ * received data to on_recv. Call from one thread.
+ * Returns the number of completions handled, 0 on timeout, -1 on error. */
+int drv_uring_poll(drv_uring_t *uring, int timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DRV_URING_H */
@@ -43,12 +43,134 @@ void fsm_init(fsm_t *fsm, const struct fsm_transition *table, size_t table_sz, s
 
     fsm->table = table;
     fsm->table_sz = table_sz;
+    fsm->jump = NULL;
+    fsm->trace = NULL;
     fsm->state = initial_state;
     fsm->ctx = ctx;
     fsm->event_queue = NULL;
+    fsm->event_ring = NULL;
+    fsm->local_events = NULL;
+    fsm->local_size = 0u;
+    fsm->local_head = 0u;
+    fsm->local_count = 0u;
+    fsm->coalesce_mask = 0u;
+    fsm->pending_mask = 0u;
+    fsm->coalesced = 0u;
+    fsm->dropped = 0u;
 }
 
 
+/**
+ * @brief Compile a transition table into a dense jump table (implementation)
+ *
+ * Every slot is cleared first, then each transition is written to the slot
+ * of its (state, event) pair. A slot that is already in use means the pair
+ * was listed before; with the linear scan the earlier entry would always
+ * win and the later one would be dead code, so it is reported instead.
+ *
+ * @param[out] jump Jump table descriptor to fill.
+ * @param[in] table Transition table.
+ * @param[in] table_sz Number of entries in @p table.
+ * @param[out] cells Storage for state_count * event_count slots.
+ * @param[in] state_count Number of states.
+ * @param[in] event_count Number of events.
+ * @param[out] bad_index Index of the offending entry on failure, may be NULL.
+ * @return fsm_compile_result_t FSM_COMPILE_OK or the first problem found.
+ */
+fsm_compile_result_t fsm_compile(fsm_jump_t *jump, const struct fsm_transition *table, size_t table_sz,
+                                 struct fsm_cell *cells, uint8_t state_count, uint8_t event_count,
+                                 size_t *bad_index)
+{
+    struct fsm_cell *cell = NULL;
+    size_t i = 0u;
+
+    if ((jump == NULL) || (cells == NULL) || ((table == NULL) && (table_sz != 0u)) ||
+        (state_count == 0u) || (event_count == 0u)) {
+        return FSM_COMPILE_INVALID;
+    }
+
+    jump->cells = NULL;
+    for (i = 0u; i < ((size_t)state_count * event_count); ++i) {
+        cells[i].action = NULL;
+        cells[i].next_state = 0u;
+        cells[i].used = 0u;
+    }
+
+    for (i = 0u; i < table_sz; ++i) {
+        const struct fsm_transition *t = &table[i];
+
+        if (bad_index != NULL) {
+            *bad_index = i;
+        }
+        if ((t->state >= state_count) || (t->next_state >= state_count) || (t->event >= event_count)) {
+            return FSM_COMPILE_RANGE;
+        }
+        cell = &cells[((size_t)t->state * event_count) + t->event];
+        if (cell->used != 0u) {
+            return ((cell->next_state == t->next_state) && (cell->action == t->action)) ?
+                   FSM_COMPILE_DUPLICATE : FSM_COMPILE_CONFLICT;
+        }
+        cell->action = t->action;
+        cell->next_state = t->next_state;
+        cell->used = 1u;
+    }
+
+    jump->cells = cells;
+    jump->state_count = state_count;
+    jump->event_count = event_count;
+    return FSM_COMPILE_OK;
+}
+
+/**
+ * @brief Dispatch events through a compiled jump table (implementation)
+ *
+ * @param[in,out] fsm Pointer to the FSM instance. If NULL, no action is taken.
+ * @param[in] jump Compiled table, or NULL for the linear scan.
+ */
+void fsm_use_jump_table(fsm_t *fsm, const fsm_jump_t *jump)
+{
+    if (fsm == NULL) {
+        return;
+    }
+    fsm->jump = ((jump != NULL) && (jump->cells != NULL)) ? jump : NULL;
+}
+
+/* 执行动作并切换状态；挂接了跟踪环时记录本次跳转及动作耗时 */
+static void fsm_take_transition(fsm_t *fsm, event_t event, action_fn_t action, state_t next_state)
+{
+    fsm_trace_t *trace = fsm->trace;
+    fsm_trace_rec_t *rec = NULL;
+    uint32_t start = 0u;
+
+    if (trace == NULL) {
+        if (action != NULL) {
+            action(fsm->ctx);
+        }
+        fsm->state = next_state;
+        return;
+    }
+
+    /* claim the slot before the action runs, in case it feeds the FSM itself */
+    rec = &trace->recs[trace->head];
+    trace->head = (uint16_t)((trace->head + 1u) % trace->size);
+    if (trace->count < trace->size) {
+        trace->count++;
+    }
+    trace->total++;
+
+    rec->tick = osKernelGetTickCount();
+    rec->state = fsm->state;
+    rec->event = event;
+    rec->next_state = next_state;
+    rec->cycles = 0u;
+    start = osKernelGetSysTimerCount();
+    if (action != NULL) {
+        action(fsm->ctx);
+    }
+    rec->cycles = osKernelGetSysTimerCount() - start;
+    fsm->state = next_state;
+}
+
 /**
  * @brief Process a single event through the FSM (implementation)
  *
@@ -59,9 +181,8 @@ void fsm_init(fsm_t *fsm, const struct fsm_transition *table, size_t table_sz, s
  * Behavior notes:
  * - If @p fsm is NULL or its table is NULL the function returns 0 and has
  *   no side effects.
- * - The search is linear; if performance for large tables is required the
- *   caller should consider organizing the table (for example by current
- *   state) or using a different engine.
+ * - Without a jump table the search is linear; `fsm_compile()` and
+ *   `fsm_use_jump_table()` turn it into a single indexed load.
  *
  * @param[in,out] fsm Pointer to an initialized fsm instance.
  * @param[in] event The event to process.
@@ -70,25 +191,34 @@ void fsm_init(fsm_t *fsm, const struct fsm_transition *table, size_t table_sz, s
  */
 uint8_t fsm_process_event(fsm_t *fsm, event_t event)
 {
-    uint8_t result = 0u;
+    const struct fsm_cell *cell = NULL;
+    const struct fsm_transition *t = NULL;
+    size_t i = 0u;
 
     if ((fsm == NULL) || (fsm->table == NULL)) {
         return 0u;
     }
 
-    for (size_t i = 0u; i < fsm->table_sz; ++i) {
-        const struct fsm_transition *t = &fsm->table[i];
-        if ((t->state == fsm->state) && (t->event == event)) {
-            if (t->action != NULL) {
-                t->action(fsm->ctx);
-            }
+    if (fsm->jump != NULL) {
+        if ((fsm->state >= fsm->jump->state_count) || (event >= fsm->jump->event_count)) {
+            return 0u;
+        }
+        cell = &fsm->jump->cells[((size_t)fsm->state * fsm->jump->event_count) + event];
+        if (cell->used == 0u) {
+            return 0u;
+        }
+        fsm_take_transition(fsm, event, cell->action, cell->next_state);
+        return 1u;
+    }
 
-            fsm->state = t->next_state;
-            result = 1u;
-            break;
+    for (i = 0u; i < fsm->table_sz; ++i) {
+        t = &fsm->table[i];
+        if ((t->state == fsm->state) && (t->event == event)) {
+            fsm_take_transition(fsm, event, t->action, t->next_state);
+            return 1u;
         }
     }
-    return result;
+    return 0u;
 }
 
 /**
@@ -140,6 +270,53 @@ void fsm_create_event_queue(fsm_t *fsm, uint32_t msg_count)
     fsm->event_queue = osMessageQueueNew(msg_count, sizeof(event_t), NULL);
 }
 
+/**
+ * @brief Create a lock-free event queue for asynchronous FSM event handling
+ *
+ * Senders claim a slot with one compare-and-swap and never wait on each
+ * other; fsm_poll() takes events without any atomic read-modify-write.
+ *
+ * @param[in,out] fsm Pointer to the FSM instance. If NULL, no action is taken.
+ * @param[in] msg_count Minimum number of events the queue can hold.
+ *
+ * @note The queue is not deleted by the FSM engine.
+ *
+ * @see fsm_send_event(), fsm_poll()
+ */
+void fsm_create_mpsc_event_queue(fsm_t *fsm, uint32_t msg_count)
+{
+    if (fsm == NULL)
+    {
+        return;
+    }
+    fsm->event_ring = mpsc_queue_create(msg_count, sizeof(event_t));
+}
+
+/**
+ * @brief Attach a caller-owned event ring for single-threaded FSM use
+ *
+ * The ring is a plain circular buffer without locking. It is intended for
+ * FSMs driven by a worker thread that both posts and polls events, so no
+ * RTOS queue has to be created per instance.
+ *
+ * @param[in,out] fsm Pointer to the FSM instance. If NULL, no action is taken.
+ * @param[in] buf Storage for pending events (must outlive the FSM).
+ * @param[in] size Capacity of @p buf.
+ *
+ * @see fsm_send_event(), fsm_poll()
+ */
+void fsm_attach_local_event_ring(fsm_t *fsm, event_t *buf, uint8_t size)
+{
+    if (fsm == NULL)
+    {
+        return;
+    }
+    fsm->local_events = buf;
+    fsm->local_size = (buf != NULL) ? size : 0u;
+    fsm->local_head = 0u;
+    fsm->local_count = 0u;
+}
+
 /**
  * @brief Send an event to the FSM's event queue
  *
@@ -153,19 +330,59 @@ void fsm_create_event_queue(fsm_t *fsm, uint32_t msg_count)
  *                    queue is NULL, no action is taken.
  * @param[in] event The event to enqueue.
  *
- * @note This function uses a timeout of 0 (no wait), so if the queue is full
- *       the event will be dropped silently.
+ * @note This function uses a timeout of 0 (no wait). An event that finds the
+ *       queue full is dropped and counted in `dropped`; an idempotent event
+ *       (fsm_set_coalesce()) that is already pending is merged and counted in
+ *       `coalesced`. Read both with fsm_get_event_counters(). Neither shows up
+ *       in the transition trace, which only records events that were processed.
  * @note The event queue must be created first using fsm_create_event_queue().
  *
  * @see fsm_create_event_queue(), fsm_poll()
  */
 void fsm_send_event(fsm_t *fsm, event_t event)
 {
-    if (fsm == NULL || fsm->event_queue == NULL) 
+    uint32_t bit = 0u;
+    uint8_t queued = 0u;
+
+    if (fsm == NULL)
     {
         return;
     }
-    osMessageQueuePut(fsm->event_queue, &event, 0U, 0U);
+    if ((event < 32u) && ((fsm->coalesce_mask & (1UL << event)) != 0u))
+    {
+        bit = 1UL << event;
+        /* 已有同一事件在队列中等待，合并为一次 */
+        if ((__atomic_fetch_or(&fsm->pending_mask, bit, __ATOMIC_ACQ_REL) & bit) != 0u)
+        {
+            __atomic_fetch_add(&fsm->coalesced, 1u, __ATOMIC_RELAXED);
+            return;
+        }
+    }
+    if (fsm->event_queue != NULL)
+    {
+        queued = (osMessageQueuePut(fsm->event_queue, &event, 0U, 0U) == osOK) ? 1u : 0u;
+    }
+    else if (fsm->event_ring != NULL)
+    {
+        queued = (mpsc_queue_put(fsm->event_ring, &event, 0U) == osOK) ? 1u : 0u;
+    }
+    else if ((fsm->local_events != NULL) && (fsm->local_count < fsm->local_size))
+    {
+        fsm->local_events[(fsm->local_head + fsm->local_count) % fsm->local_size] = event;
+        fsm->local_count++;
+        queued = 1u;
+    }
+    if (queued == 0u)
+    {
+        if (bit != 0u)
+        {
+            __atomic_fetch_and(&fsm->pending_mask, ~bit, __ATOMIC_ACQ_REL);
+        }
+        if ((fsm->event_queue != NULL) || (fsm->event_ring != NULL) || (fsm->local_events != NULL))
+        {
+            __atomic_fetch_add(&fsm->dropped, 1u, __ATOMIC_RELAXED);
+        }
+    }
 }
 
 /**
@@ -183,24 +400,189 @@ void fsm_send_event(fsm_t *fsm, event_t event)
  *                    queue is NULL, no action is taken.
  *
  * @note The function processes all events present in the queue at the time
- *       of the call. Events added during processing will be handled in the
- *       next call.
+ *       of the call, and the events the actions send while it runs.
  * @note This is a non-blocking function; it returns immediately after
  *       processing all queued events.
  *
  * @see fsm_send_event(), fsm_create_event_queue(), fsm_process_event()
  */
 void fsm_poll(fsm_t *fsm)
+{
+    (void)fsm_poll_batch(fsm, UINT32_MAX);
+}
+
+/* 取出一个待处理事件；可合并事件在处理前清除挂起位，处理期间再次发送仍会入队 */
+static uint8_t fsm_take_event(fsm_t *fsm, event_t *event)
+{
+    if (fsm->event_queue != NULL)
+    {
+        if (osMessageQueueGet(fsm->event_queue, event, NULL, 0U) != osOK)
+        {
+            return 0u;
+        }
+    }
+    else if (fsm->event_ring != NULL)
+    {
+        if (mpsc_queue_get(fsm->event_ring, event, 0U) != osOK)
+        {
+            return 0u;
+        }
+    }
+    else
+    {
+        if (fsm->local_count == 0u)
+        {
+            return 0u;
+        }
+        *event = fsm->local_events[fsm->local_head];
+        fsm->local_head = (uint8_t)((fsm->local_head + 1u) % fsm->local_size);
+        fsm->local_count--;
+    }
+    if ((*event < 32u) && ((fsm->coalesce_mask & (1UL << *event)) != 0u))
+    {
+        __atomic_fetch_and(&fsm->pending_mask, ~(1UL << *event), __ATOMIC_ACQ_REL);
+    }
+    return 1u;
+}
+
+/**
+ * @brief Process at most @p max pending events
+ *
+ * Events are taken in FIFO order. Events sent by the actions that run
+ * here are picked up by the same call as long as @p max allows.
+ *
+ * @param[in,out] fsm Pointer to the FSM instance. If NULL, nothing happens.
+ * @param[in] max Largest number of events to process.
+ * @return uint32_t Number of events processed.
+ */
+uint32_t fsm_poll_batch(fsm_t *fsm, uint32_t max)
 {
     event_t event = 0u;
+    uint32_t count = 0u;
 
-    if (fsm == NULL || fsm->event_queue == NULL) 
+    if (fsm == NULL)
     {
-        return;
+        return 0u;
     }
-    
-    while(osMessageQueueGet(fsm->event_queue, &event, NULL, 0U) == osOK)
+    while ((count < max) && (fsm_take_event(fsm, &event) != 0u))
     {
         fsm_process_event(fsm, event);
+        count++;
     }
-}
\ No newline at end of file
+    return count;
+}
+
+/**
+ * @brief Merge pending duplicates of idempotent events (implementation)
+ *
+ * @param[in,out] fsm Pointer to the FSM instance. If NULL, no action is taken.
+ * @param[in] event_mask Bit per idempotent event.
+ */
+void fsm_set_coalesce(fsm_t *fsm, uint32_t event_mask)
+{
+    if (fsm == NULL)
+    {
+        return;
+    }
+    fsm->coalesce_mask = event_mask;
+}
+
+/**
+ * @brief Read the event queue counters (implementation)
+ *
+ * @param[in] fsm Pointer to the FSM instance.
+ * @param[out] coalesced Events merged into a pending copy, may be NULL.
+ * @param[out] dropped Events lost to a full queue, may be NULL.
+ */
+void fsm_get_event_counters(const fsm_t *fsm, uint32_t *coalesced, uint32_t *dropped)
+{
+    if (coalesced != NULL)
+    {
+        *coalesced = (fsm != NULL) ? __atomic_load_n(&fsm->coalesced, __ATOMIC_RELAXED) : 0u;
+    }
+    if (dropped != NULL)
+    {
+        *dropped = (fsm != NULL) ? __atomic_load_n(&fsm->dropped, __ATOMIC_RELAXED) : 0u;
+    }
+}
+
+/**
+ * @brief Initialize a transition trace ring (implementation)
+ *
+ * @param[out] trace Trace to initialize. If NULL, no action is taken.
+ * @param[in] buf Storage for @p size records.
+ * @param[in] size Capacity of @p buf.
+ */
+void fsm_trace_init(fsm_trace_t *trace, fsm_trace_rec_t *buf, uint16_t size)
+{
+    if (trace == NULL)
+    {
+        return;
+    }
+    trace->recs = buf;
+    trace->size = (buf != NULL) ? size : 0u;
+    trace->head = 0u;
+    trace->count = 0u;
+    trace->total = 0u;
+}
+
+/**
+ * @brief Record every transition of an FSM in a trace ring (implementation)
+ *
+ * @param[in,out] fsm Pointer to the FSM instance. If NULL, no action is taken.
+ * @param[in] trace Initialized trace, or NULL to stop tracing.
+ */
+void fsm_attach_trace(fsm_t *fsm, fsm_trace_t *trace)
+{
+    if (fsm == NULL)
+    {
+        return;
+    }
+    fsm->trace = ((trace != NULL) && (trace->size != 0u)) ? trace : NULL;
+}
+
+/**
+ * @brief Get the slowest transitions still held in a trace ring (implementation)
+ *
+ * Insertion into a short sorted output list, O(count * max); meant for a
+ * diagnostic query, not for the event path.
+ *
+ * @param[in] trace Trace to query.
+ * @param[out] out Receives up to @p max records, slowest first.
+ * @param[in] max Capacity of @p out.
+ * @return uint16_t Number of records written to @p out.
+ */
+uint16_t fsm_trace_slowest(const fsm_trace_t *trace, fsm_trace_rec_t *out, uint16_t max)
+{
+    uint16_t found = 0u;
+    uint16_t i = 0u;
+    uint16_t pos = 0u;
+
+    if ((trace == NULL) || (out == NULL) || (max == 0u))
+    {
+        return 0u;
+    }
+    for (i = 0u; i < trace->count; i++)
+    {
+        const fsm_trace_rec_t *rec = &trace->recs[i];
+
+        pos = found;
+        while ((pos > 0u) && (out[pos - 1u].cycles < rec->cycles))
+        {
+            if (pos < max)
+            {
+                out[pos] = out[pos - 1u];
+            }
+            pos--;
+        }
+        if (pos < max)
+        {
+            out[pos] = *rec;
+            if (found < max)
+            {
+                found++;
+            }
+        }
+    }
+    return found;
+}
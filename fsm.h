@@ -22,6 +22,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "cmsis_os2.h"
+#include "mpsc_queue.h"
 /**
  * @typedef state_t
  * @brief Opaque integer type used to represent FSM states
@@ -71,6 +72,73 @@ struct fsm_transition {
     action_fn_t action; /**< optional action to execute (may be NULL) */
 };
 
+/**
+ * @struct fsm_cell
+ * @brief One slot of a compiled jump table
+ *
+ * Holds the outcome of the (state, event) pair the slot stands for. Slots
+ * without a transition have `used` cleared.
+ */
+struct fsm_cell {
+    action_fn_t action; /**< action copied from the transition (may be NULL) */
+    state_t next_state; /**< next state copied from the transition */
+    uint8_t used;       /**< 1 if a transition exists for this pair */
+};
+
+/**
+ * @struct fsm_jump
+ * @brief Dense [state][event] jump table compiled from a transition table
+ *
+ * Built once by `fsm_compile()` and shared read-only by every FSM instance
+ * that runs the same transition table.
+ */
+typedef struct fsm_jump {
+    const struct fsm_cell *cells;   /**< state_count * event_count slots, row per state */
+    uint8_t state_count;            /**< states 0 .. state_count - 1 */
+    uint8_t event_count;            /**< events 0 .. event_count - 1 */
+} fsm_jump_t;
+
+/**
+ * @enum fsm_compile_result_t
+ * @brief Outcome of `fsm_compile()`
+ */
+typedef enum {
+    FSM_COMPILE_OK = 0,         /**< table compiled */
+    FSM_COMPILE_INVALID,        /**< bad arguments */
+    FSM_COMPILE_RANGE,          /**< a state or event does not fit the jump table */
+    FSM_COMPILE_DUPLICATE,      /**< the same (state, event) pair is listed twice */
+    FSM_COMPILE_CONFLICT,       /**< a (state, event) pair has two different outcomes */
+} fsm_compile_result_t;
+
+/**
+ * @struct fsm_trace_rec
+ * @brief One traced transition
+ */
+typedef struct fsm_trace_rec {
+    uint32_t tick;      /**< osKernelGetTickCount() when the transition was taken */
+    uint32_t cycles;    /**< kernel system timer cycles spent in the action */
+    state_t state;      /**< state the event arrived in */
+    event_t event;      /**< event that triggered the transition */
+    state_t next_state; /**< state after the transition */
+} fsm_trace_rec_t;
+
+/**
+ * @struct fsm_trace
+ * @brief Fixed-size ring of the most recent transitions
+ *
+ * Filled by `fsm_process_event()` when attached with `fsm_attach_trace()`.
+ * The ring is written without locking by the thread that drives the FSM;
+ * read it (`fsm_trace_slowest()`) from that thread too, or accept that a
+ * record being written may be seen half updated.
+ */
+typedef struct fsm_trace {
+    fsm_trace_rec_t *recs;  /**< caller storage for size records */
+    uint16_t size;          /**< capacity of recs */
+    uint16_t head;          /**< next record to write */
+    uint16_t count;         /**< valid records, at most size */
+    uint32_t total;         /**< transitions traced since init */
+} fsm_trace_t;
+
 /**
  * @struct fsm
  * @brief Runtime object that encapsulates a transition table and current state
@@ -84,9 +152,20 @@ struct fsm_transition {
 typedef struct fsm {
     const struct fsm_transition *table; /**< read-only transition table */
     size_t table_sz;                    /**< number of entries in table */
+    const fsm_jump_t *jump;             /**< optional compiled table, NULL = linear scan */
+    fsm_trace_t *trace;                 /**< optional transition trace, NULL = off */
     state_t state;                      /**< current state */
     void* ctx;                          /**< optional user context pointer */
     osMessageQueueId_t event_queue;       /**< optional event queue */
+    mpsc_queue_t *event_ring;           /**< optional lock-free event queue, single poller */
+    event_t *local_events;              /**< optional single-thread event ring */
+    uint8_t local_size;                 /**< capacity of local_events */
+    uint8_t local_head;                 /**< index of the oldest pending event */
+    uint8_t local_count;                /**< number of pending events */
+    uint32_t coalesce_mask;             /**< events 0..31 that merge with a pending copy */
+    uint32_t pending_mask;              /**< coalescing events currently queued */
+    uint32_t coalesced;                 /**< events merged into a pending copy */
+    uint32_t dropped;                   /**< events lost because the queue was full */
     /* optional: const char *name; void *user_ctx; mutex_t *lock; */
 } fsm_t;
 
@@ -108,10 +187,87 @@ typedef struct fsm {
 void fsm_init(fsm_t *fsm, const struct fsm_transition *table, size_t table_sz, state_t initial_state, void* ctx);
 
 
+/**
+ * @brief Compile a transition table into a dense jump table
+ *
+ * Fills @p cells, an array of @p state_count * @p event_count slots laid out
+ * row per state, so that the transition for (state, event) is the slot
+ * `cells[state * event_count + event]`. The table is checked on the way: a
+ * state, next state or event outside the jump table, and a (state, event)
+ * pair listed more than once, are reported and the index of the offending
+ * entry is stored in @p bad_index. A pair listed twice with the same outcome
+ * is a DUPLICATE, with a different next state or action a CONFLICT.
+ *
+ * Compile once at start-up and attach the result to every FSM instance that
+ * uses the same transition table with `fsm_use_jump_table()`.
+ *
+ * @param[out] jump Jump table descriptor to fill.
+ * @param[in] table Transition table.
+ * @param[in] table_sz Number of entries in @p table.
+ * @param[out] cells Storage for state_count * event_count slots; must outlive
+ *                   every FSM using @p jump.
+ * @param[in] state_count Number of states (largest state + 1).
+ * @param[in] event_count Number of events (largest event + 1).
+ * @param[out] bad_index Index of the offending entry on failure, may be NULL.
+ * @return fsm_compile_result_t FSM_COMPILE_OK, or the first problem found. The
+ *         jump table must not be used unless the result is FSM_COMPILE_OK.
+ */
+fsm_compile_result_t fsm_compile(fsm_jump_t *jump, const struct fsm_transition *table, size_t table_sz,
+                                 struct fsm_cell *cells, uint8_t state_count, uint8_t event_count,
+                                 size_t *bad_index);
+
+/**
+ * @brief Dispatch events through a compiled jump table
+ *
+ * After this call `fsm_process_event()` does a single indexed load instead
+ * of scanning the transition table. Behaviour is unchanged: the jump table
+ * holds exactly the transitions of the table it was compiled from.
+ *
+ * @param[in,out] fsm Pointer to the FSM instance. If NULL, no action is taken.
+ * @param[in] jump Table compiled from the FSM's transition table, or NULL to
+ *                 go back to the linear scan.
+ */
+void fsm_use_jump_table(fsm_t *fsm, const fsm_jump_t *jump);
+
+/**
+ * @brief Initialize a transition trace ring
+ *
+ * @param[out] trace Trace to initialize. If NULL, no action is taken.
+ * @param[in] buf Storage for @p size records; must outlive the trace.
+ * @param[in] size Capacity of @p buf.
+ */
+void fsm_trace_init(fsm_trace_t *trace, fsm_trace_rec_t *buf, uint16_t size);
+
+/**
+ * @brief Record every transition of an FSM in a trace ring
+ *
+ * Each taken transition is stored with its tick, state, event, next state
+ * and the kernel system timer cycles (osKernelGetSysTimerCount()) spent in
+ * its action, so slow actions show up in `fsm_trace_slowest()`. The oldest
+ * record is overwritten when the ring is full. Tracing costs two timer
+ * reads per transition and nothing when no trace is attached.
+ *
+ * @param[in,out] fsm Pointer to the FSM instance. If NULL, no action is taken.
+ * @param[in] trace Initialized trace, or NULL to stop tracing.
+ */
+void fsm_attach_trace(fsm_t *fsm, fsm_trace_t *trace);
+
+/**
+ * @brief Get the slowest transitions still held in a trace ring
+ *
+ * @param[in] trace Trace to query.
+ * @param[out] out Receives up to @p max records, slowest first.
+ * @param[in] max Capacity of @p out.
+ * @return uint16_t Number of records written to @p out.
+ */
+uint16_t fsm_trace_slowest(const fsm_trace_t *trace, fsm_trace_rec_t *out, uint16_t max);
+
 /**
  * @brief Process a single event through the FSM
  *
- * The engine scans the transition table sequentially for the first entry
+ * With a jump table attached the transition is looked up directly by
+ * (current state, event). Otherwise the engine scans the transition table
+ * sequentially for the first entry
  * whose `state` equals the FSM's current state and whose `event` equals the
  * provided @p event. If a matching transition is found the optional action
  * callback is invoked (if non-NULL) and the FSM's current state is updated
@@ -156,6 +312,75 @@ event_t fsm_get_current_state(fsm_t *fsm);
  */
 void fsm_create_event_queue(fsm_t *fsm, uint32_t msg_count);
 
+/**
+ * @brief Create a lock-free event queue for asynchronous FSM event handling
+ *
+ * Alternative to fsm_create_event_queue() for FSMs that are polled by a
+ * single thread but fed from several: fsm_send_event() posts into a
+ * lock-free ring (see mpsc_queue.h) instead of an osMessageQueue, so the
+ * receive thread, timer callbacks and application threads posting to one
+ * FSM do not serialise on the queue mutex.
+ *
+ * @param[in,out] fsm Pointer to the FSM instance. If NULL, no action is taken.
+ * @param[in] msg_count Minimum number of events the queue can hold, rounded
+ *                      up to a power of two.
+ *
+ * @note fsm_poll() and fsm_poll_batch() must always run on the same thread.
+ * @note If creation fails, fsm->event_ring will be NULL. An RTOS event queue
+ *       takes precedence if both are present.
+ *
+ * @see fsm_send_event(), fsm_poll()
+ */
+void fsm_create_mpsc_event_queue(fsm_t *fsm, uint32_t msg_count);
+
+/**
+ * @brief Attach a caller-owned event ring for single-threaded FSM use
+ *
+ * Alternative to fsm_create_event_queue() for FSMs whose events are both
+ * posted and polled from the same thread. The ring lives in caller memory
+ * and does not allocate an RTOS object, which keeps the per-instance cost
+ * down when many FSMs are serviced by one thread.
+ *
+ * @param[in,out] fsm Pointer to the FSM instance. If NULL, no action is taken.
+ * @param[in] buf Storage for @p size pending events.
+ * @param[in] size Capacity of @p buf.
+ *
+ * @note Not thread-safe: fsm_send_event() and fsm_poll() must run on the
+ *       same thread. If an RTOS event queue is also present it takes
+ *       precedence.
+ *
+ * @see fsm_send_event(), fsm_poll()
+ */
+void fsm_attach_local_event_ring(fsm_t *fsm, event_t *buf, uint8_t size);
+
+/**
+ * @brief Merge pending duplicates of idempotent events
+ *
+ * Bit n of @p event_mask marks event n (n < 32) as idempotent: handling it
+ * twice in a row has the same effect as handling it once, as with a
+ * periodic tick. While such an event is queued and not yet taken by
+ * fsm_poll(), sending it again only counts it in `coalesced`, so stale
+ * copies cannot fill the queue and push out other events. Events not in
+ * the mask are queued one by one and keep their order.
+ *
+ * Set the mask before events are sent.
+ *
+ * @param[in,out] fsm Pointer to the FSM instance. If NULL, no action is taken.
+ * @param[in] event_mask Bit per idempotent event, 0 to disable coalescing.
+ *
+ * @see fsm_send_event(), fsm_get_event_counters()
+ */
+void fsm_set_coalesce(fsm_t *fsm, uint32_t event_mask);
+
+/**
+ * @brief Read the event queue counters
+ *
+ * @param[in] fsm Pointer to the FSM instance.
+ * @param[out] coalesced Events merged into a pending copy, may be NULL.
+ * @param[out] dropped Events lost to a full queue, may be NULL.
+ */
+void fsm_get_event_counters(const fsm_t *fsm, uint32_t *coalesced, uint32_t *dropped);
+
 /**
  * @brief Send an event to the FSM's event queue
  *
@@ -167,8 +392,11 @@ void fsm_create_event_queue(fsm_t *fsm, uint32_t msg_count);
  *                    created via fsm_create_event_queue().
  * @param[in] event The event to enqueue.
  *
- * @note Uses timeout of 0 (no wait). If queue is full, event is dropped.
- * @note Does nothing if fsm or fsm->event_queue is NULL.
+ * @note Uses timeout of 0 (no wait). If queue is full, event is dropped and
+ *       counted in `dropped`. Idempotent events (fsm_set_coalesce()) that
+ *       are already pending are merged instead of queued and counted in
+ *       `coalesced`; see fsm_get_event_counters().
+ * @note Does nothing if fsm is NULL or has no event queue or local ring.
  *
  * @see fsm_create_event_queue(), fsm_poll()
  */
@@ -188,11 +416,26 @@ void fsm_send_event(fsm_t *fsm, event_t event);
  *                    created via fsm_create_event_queue().
  *
  * @note Non-blocking: processes all events present at call time and returns.
- * @note Events added during processing will be handled in the next call.
- * @note Does nothing if fsm or fsm->event_queue is NULL.
+ * @note Events sent by the actions it runs are handled by the same call.
+ * @note Does nothing if fsm is NULL or has no event queue or local ring.
  *
  * @see fsm_send_event(), fsm_create_event_queue()
  */
 void fsm_poll(fsm_t *fsm);
 
+/**
+ * @brief Process at most @p max pending events
+ *
+ * Like fsm_poll() but stops after @p max events, so one busy FSM cannot
+ * hold its thread for long when many instances share it. Events left over
+ * stay queued for the next call.
+ *
+ * @param[in,out] fsm Pointer to the FSM instance.
+ * @param[in] max Largest number of events to process.
+ * @return uint32_t Number of events processed.
+ *
+ * @see fsm_poll()
+ */
+uint32_t fsm_poll_batch(fsm_t *fsm, uint32_t max);
+
 #endif /* STATE_MACHINE_H */
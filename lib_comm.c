@@ -2,55 +2,137 @@
 #include "comm_ctrl.h"
 #include "comm_protocol.h"
 #include "drv_socket.h"
+#include "comm_capture.h"
+#include "comm_cmd_ap3.h"
+#include <stdio.h>
 
 /* ========== 硬件抽象层 - 简化版 ========== */
 
-/* 硬件发送函数 - 换硬件时修改这里 */
-static ssize_t lib_comm_hw_send(const uint8_t *buf, size_t len)
+/* 硬件接收函数：读空接收缓冲，每块数据到达即回调 - 换硬件时修改这里 */
+static ssize_t lib_comm_hw_recv_drain(void (*on_chunk)(void *ctx, const uint8_t *data, size_t len), void *ctx)
 {
-    return drv_socket_send(buf, len, 0);
-    // 换串口: return drv_uart_send(buf, len);
+    return drv_socket_recv_drain(on_chunk, ctx);
+    // 换串口: return drv_uart_recv_drain(on_chunk, ctx);
 }
 
-/* 硬件接收函数 - 换硬件时修改这里 */
-static ssize_t lib_comm_hw_recv(uint8_t *buf, size_t len)
+/* 发送队列入队（接管 buf 的一个引用）- 换硬件时修改这里 */
+static comm_result_t lib_comm_hw_tx_enqueue(comm_buf_t *buf)
 {
-    return drv_socket_recv(buf, len, 0);
-    // 换串口: return drv_uart_recv(buf, len);
+    return drv_socket_tx_enqueue_buf(buf);
+    // 换串口: return drv_uart_tx_enqueue_buf(buf);
 }
 
-/* 发送队列入队 - 换硬件时修改这里 */
-static comm_result_t lib_comm_hw_tx_enqueue(const uint8_t *buf, uint16_t len)
+/* 发送队列全部写出（一次系统调用聚合多帧）- 换硬件时修改这里 */
+static ssize_t lib_comm_hw_tx_flush(void)
 {
-    return drv_socket_tx_enqueue(buf, len);
-    // 换串口: return drv_uart_tx_enqueue(buf, len);
+    return drv_socket_tx_flush(0);
+    // 换串口: return drv_uart_tx_flush();
 }
 
-/* 发送队列出队 - 换硬件时修改这里 */
-static comm_result_t lib_comm_hw_tx_dequeue(uint8_t *buf, uint16_t bufcap, uint16_t *out_len)
+/* ========== 全局变量 ========== */
+comm_ctrl_t global_comm_ctrl;
+static lib_comm_link_t global_link;
+static comm_stats_t global_stats;               /* 默认链路的命令统计，comm_ctrl_get_stats() 读取 */
+static comm_capture_t *global_capture = NULL;   /* 抓包记录器，NULL 为关闭 */
+
+static void lib_comm_send_func(void *ctx, comm_buf_t *buf);
+static uint8_t *lib_comm_recv_loan(void *user_data, uint16_t *capacity);
+static void lib_comm_recv_callback(void *user_data, uint8_t *payload, uint16_t payload_len);
+
+void lib_comm_link_init(lib_comm_link_t *link, comm_ctrl_t *ctrl)
 {
-    return drv_socket_tx_dequeue(buf, bufcap, out_len);
-    // 换串口: return drv_uart_tx_dequeue(buf, bufcap, out_len);
+    if (link == NULL || ctrl == NULL)
+    {
+        return;
+    }
+    link->ctrl = ctrl;
+    link->conn = NULL;
+    comm_protocol_decoder_init(&link->decoder);
+    /* 解码器直接写入控制器的接收缓冲 */
+    comm_protocol_decoder_set_loan(&link->decoder, lib_comm_recv_loan, lib_comm_recv_callback, link);
+    comm_ctrl_set_send_buf_func(ctrl, lib_comm_send_func, link);
 }
 
-/* ========== 全局变量 ========== */
-protocol_decoder_t global_decoder;
-comm_ctrl_t global_comm_ctrl;
+void lib_comm_link_recv(lib_comm_link_t *link, uint8_t *buf, uint16_t len)
+{
+    if (link == NULL || buf == NULL || len == 0U)
+    {
+        return;
+    }
+    comm_protocol_decoder_process(&link->decoder, buf, len);
+}
+
+/* reactor 线程回调：一块接收数据直接进入该链路的解码器 */
+static void lib_comm_link_socket_recv(void *ctx, const uint8_t *data, size_t len)
+{
+    lib_comm_link_t *link = (lib_comm_link_t *)ctx;
+
+    while (len > 0U)
+    {
+        uint16_t chunk = (len > 0xFFFFU) ? 0xFFFFU : (uint16_t)len;
+        comm_capture_record(global_capture, link->ctrl->link_id, COMM_CAPTURE_DIR_RX, data, chunk);
+        lib_comm_link_recv(link, (uint8_t *)data, chunk);
+        data += chunk;
+        len -= chunk;
+    }
+}
+
+/* reactor 线程回调：断线后丢弃解码器中的半帧，重连后从新帧头开始 */
+static void lib_comm_link_socket_state(void *ctx, int connected)
+{
+    lib_comm_link_t *link = (lib_comm_link_t *)ctx;
+
+    if (!connected)
+    {
+        link->decoder.state = PROTOCOL_DECODE_STATE_IDLE;
+        link->decoder.data_len = 0U;
+    }
+}
+
+void lib_comm_link_attach_socket(lib_comm_link_t *link, drv_socket_conn_t *conn)
+{
+    if (link == NULL || conn == NULL)
+    {
+        return;
+    }
+    link->conn = conn;
+    drv_socket_conn_set_callbacks(conn, lib_comm_link_socket_recv, lib_comm_link_socket_state, link);
+}
+
+void lib_comm_set_capture(comm_capture_t *capture)
+{
+    global_capture = capture;
+}
+
+static void lib_comm_replay_cb(void *ctx, const comm_capture_rec_t *rec, const uint8_t *data)
+{
+    lib_comm_link_t *link = (lib_comm_link_t *)ctx;
+
+    /* 只回放接收方向，发送方向由控制器重新产生 */
+    if (rec->dir == COMM_CAPTURE_DIR_RX && rec->len != 0U)
+    {
+        lib_comm_link_recv(link, (uint8_t *)data, rec->len);
+    }
+}
+
+uint32_t lib_comm_replay(lib_comm_link_t *link, comm_replay_t *replay, bool realtime)
+{
+    if (link == NULL)
+    {
+        link = &global_link;
+    }
+    return comm_replay_run(replay, realtime, lib_comm_replay_cb, link);
+}
 
-static void lib_comm_send_func(uint8_t *data, uint16_t len);
 void lib_comm_ctrl_init(void)
 {
     comm_data_t cmd;
-    cmd.comm_id = 0xf0;
-    cmd.comm_len = 6;
-    cmd.comm_data[0] = 0x10;
-    cmd.comm_data[1] = 0x70;
-    cmd.comm_data[2] = 0x0F;        
-    cmd.comm_data[3] = 0xAA;
-    cmd.comm_data[4] = 0x31;
-    cmd.comm_data[5] = 0xF4;
+    const comm_ap3_user_operation_cmd_t op = {{0x10, 0x70, 0x0F, 0xAA, 0x31, 0xF4}};
+
+    comm_ap3_user_operation_encode(&cmd, &op);
     comm_ctrl_init(&global_comm_ctrl);
-    comm_ctrl_set_send_func(&global_comm_ctrl, lib_comm_send_func);
+    comm_ctrl_set_stats(&global_comm_ctrl, &global_stats);
+    lib_comm_link_init(&global_link, &global_comm_ctrl);
     comm_ctrl_send_single_command(&global_comm_ctrl, &cmd);
     comm_ctrl_send_period_command(&global_comm_ctrl, &cmd);
     comm_ctrl_start(&global_comm_ctrl);
@@ -58,79 +140,106 @@ void lib_comm_ctrl_init(void)
 
 void lib_comm_process(void)
 {
-    comm_data_t recv_data;
+    comm_data_t *recv_data = NULL;
     comm_ctrl_process(&global_comm_ctrl, 0U);
 
-    if(comm_ctrl_get_recv_data(&global_comm_ctrl, &recv_data) == COMM_OK)
+    recv_data = comm_ctrl_recv_take(&global_comm_ctrl);
+    if(recv_data != NULL)
     {
-        printf("got recv data id : 0x%02X len : %u\n", recv_data.comm_id, recv_data.comm_len);
+        printf("got recv data id : 0x%02X len : %u\n", recv_data->comm_id, recv_data->comm_len);
         // for(uint8_t i = 0; i < recv_data.comm_len; i++)
         // {
-        //     printf("%02X ", recv_data.comm_data[i]);    
+        //     printf("%02X ", recv_data->comm_data[i]);    
         // }
         // printf("\n");
+        comm_ctrl_recv_return(&global_comm_ctrl, recv_data);
     }
 
 }
 
 
+static uint8_t *lib_comm_recv_loan(void *user_data, uint16_t *capacity)
+{
+    lib_comm_link_t *link = (lib_comm_link_t *)user_data;
+    comm_data_t *buf = comm_ctrl_recv_loan(link->ctrl);
+
+    if (buf == NULL)
+    {
+        return NULL;
+    }
+    *capacity = COMM_DATA_PAYLOAD_CAP;
+    return COMM_DATA_PAYLOAD(buf);
+}
+
+/* payload 就是借出的缓冲（comm_id 为 comm_data_t 的首成员） */
 static void lib_comm_recv_callback(void *user_data, uint8_t *payload, uint16_t payload_len)
 {
+    lib_comm_link_t *link = (lib_comm_link_t *)user_data;
     printf("save recv data len : %u\n", payload_len);
-    comm_ctrl_save_recv_data(&global_comm_ctrl, payload, payload_len);
+    comm_ctrl_recv_commit(link->ctrl, (comm_data_t *)payload, payload_len);
 }
 
 void lib_comm_recv_init(void)
 {
-    comm_protocol_decoder_init(&global_decoder);
-    comm_protocol_decoder_set_callback(&global_decoder, lib_comm_recv_callback, NULL);
+    /* 解码器在 lib_comm_link_init() 中与链路一起初始化 */
 }
 
-void lib_comm_recv_process(void)
+/* 接收线程回调：每块数据直接进入全局链路的解码器 */
+static void lib_comm_recv_chunk(void *ctx, const uint8_t *data, size_t len)
 {
-    uint8_t buf[256] = {0};
-    ssize_t len = 0;
-    
-    len = lib_comm_hw_recv(buf, sizeof(buf));
-    if(len > 0)
+    lib_comm_link_t *link = (lib_comm_link_t *)ctx;
+    uint16_t chunk = 0;
+
+    while (len > 0U)
     {
-        printf("recv data len : %zd\n", len);
-        for(ssize_t i = 0; i < len; i++)
+        chunk = (len > 0xFFFFU) ? 0xFFFFU : (uint16_t)len;
+        comm_capture_record(global_capture, global_comm_ctrl.link_id, COMM_CAPTURE_DIR_RX, data, chunk);
+        printf("recv data len : %u\n", chunk);
+        for(uint16_t i = 0; i < chunk; i++)
         {
-            printf("%02X ", buf[i]);    
+            printf("%02X ", data[i]);
         }
         printf("\n");
-        comm_protocol_decoder_process(&global_decoder, buf, (uint16_t)len);
+        lib_comm_link_recv(link, (uint8_t *)data, chunk);
+        data += chunk;
+        len -= chunk;
     }
 }
 
+void lib_comm_recv_process(void)
+{
+    (void)lib_comm_hw_recv_drain(lib_comm_recv_chunk, &global_link);
+}
+
 
 
 
 void lib_comm_send_init(void)
 {
-
+    drv_socket_tx_queue_init(0U);
 }
 
 void lib_comm_send_process(void)
 {
-    uint8_t buf[256] = {0};
-    uint16_t len;
-    
-    if(lib_comm_hw_tx_dequeue(buf, sizeof(buf), &len) == COMM_OK)
-    {
-        lib_comm_hw_send(buf, len);
-    }
+    (void)lib_comm_hw_tx_flush();
 }
 
 
 
-static void lib_comm_send_func(uint8_t *data, uint16_t len)
+/* 帧已由控制器编码在 buf 中，这里只转交发送队列 */
+static void lib_comm_send_func(void *ctx, comm_buf_t *buf)
 {
-    protocol_encoder_t encoder;
-    comm_protocol_encoder_init(&encoder);
-    comm_protocol_encode(&encoder, data, len);
-    printf("send data len : %u  %u\n", len, encoder.data_len);
-    
-    lib_comm_hw_tx_enqueue(encoder.data, encoder.data_len);
+    lib_comm_link_t *link = (lib_comm_link_t *)ctx;
+
+    if (link != NULL && link->conn != NULL)
+    {
+        /* reactor 线程发送，抓包在入队时记录 */
+        comm_capture_record(global_capture, link->ctrl->link_id, COMM_CAPTURE_DIR_TX, buf->data, buf->len);
+        (void)drv_socket_conn_tx_enqueue_buf(link->conn, buf);
+        return;
+    }
+    printf("send data len : %u\n", buf->len);
+    /* 发送线程一次写出多帧，抓包在入队时按帧记录 */
+    comm_capture_record(global_capture, global_comm_ctrl.link_id, COMM_CAPTURE_DIR_TX, buf->data, buf->len);
+    lib_comm_hw_tx_enqueue(buf);
 }
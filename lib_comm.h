@@ -3,12 +3,36 @@
 
 #include "cmsis_os2.h"
 #include "comm_def.h"
+#include "comm_ctrl.h"
+#include "comm_protocol.h"
+#include "comm_capture.h"
+#include "drv_socket.h"
 #include <stdint.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* 一条链路 = 一个控制器 + 一个解码器，回调通过上下文找到所属链路 */
+typedef struct {
+    comm_ctrl_t *ctrl;
+    protocol_decoder_t decoder;
+    drv_socket_conn_t *conn;    /* 独立连接，NULL 时走默认硬件接口 */
+} lib_comm_link_t;
+
+/* 绑定链路的发送函数与解码回调，ctrl 需已初始化（独立或 comm_mgr 共享模式） */
+void lib_comm_link_init(lib_comm_link_t *link, comm_ctrl_t *ctrl);
+void lib_comm_link_recv(lib_comm_link_t *link, uint8_t *buf, uint16_t len);
+/* 链路改用一条独立的套接字连接：发送进入 conn 的发送队列，reactor 读到的数据直接送入解码器；
+ * conn 需已初始化发送队列，之后再加入 reactor */
+void lib_comm_link_attach_socket(lib_comm_link_t *link, drv_socket_conn_t *conn);
+
+/* 记录收发线程经过硬件接口的每一块数据，传 NULL 停止记录 */
+void lib_comm_set_capture(comm_capture_t *capture);
+/* 把抓包中的接收数据送入链路的解码器与控制器，link 为 NULL 时使用默认链路；返回回放的记录数 */
+uint32_t lib_comm_replay(lib_comm_link_t *link, comm_replay_t *replay, bool realtime);
+
 /* 通信库接口 */
 void lib_comm_ctrl_init(void);
 void lib_comm_process(void);
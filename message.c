@@ -13,7 +13,32 @@
  */
 
 #include "message.h"
+#include <stdlib.h>
 #include "usart/cmsis_os2.h"
+#include "mpsc_queue.h"
+
+/**
+ * @brief Queue handle: the backend and the object that stores the messages
+ */
+struct message_queue {
+    msg_backend_t backend;
+    osMessageQueueId_t os_queue;    ///< MSG_BACKEND_RTOS
+    mpsc_queue_t *ring;             ///< MSG_BACKEND_MPSC
+};
+
+#define MSG_ARENA_FULL_MAP  (0xFFFFFFFFUL >> (32U - MSG_ARENA_BLOCKS))
+
+static const uint16_t message_arena_class_size[MSG_ARENA_CLASS_COUNT] = {
+    MSG_ARENA_SMALL_SIZE, MSG_ARENA_MEDIUM_SIZE, MSG_ARENA_LARGE_SIZE,
+};
+
+/* 默认内存池静态初始化为全部空闲，无需初始化调用，也就没有首次使用的竞争 */
+static message_arena_t message_arena_global = {
+    .free_map = {MSG_ARENA_FULL_MAP, MSG_ARENA_FULL_MAP, MSG_ARENA_FULL_MAP},
+};
+typedef char message_arena_map_check[(MSG_ARENA_BLOCKS >= 1U && MSG_ARENA_BLOCKS <= 32U && MSG_ARENA_CLASS_COUNT == 3U) ? 1 : -1];
+
+static void message_queue_drain(message_queue_t queue_id);
 
 /**
  * @brief Convert CMSIS-RTOS2 status to custom message status
@@ -68,12 +93,46 @@ static msg_status_t os_status_to_msg_status(osStatus_t os_status)
  * @see message_queue_delete()
  */
 message_queue_t mesasge_queue_create(uint8_t msg_count)
+{
+    return message_queue_create_backend(msg_count, MSG_BACKEND_RTOS);
+}
+
+/**
+ * @brief Create a message queue on a chosen backend
+ * 
+ * Allocates the handle and the backend object; on any failure nothing is
+ * left allocated.
+ * 
+ * @param msg_count Maximum number of messages the queue can hold (must be > 0)
+ * @param backend Queue storage
+ * @return message_queue_t Queue handle on success, NULL on failure
+ */
+message_queue_t message_queue_create_backend(uint8_t msg_count, msg_backend_t backend)
 {
     message_queue_t queue = NULL;
     
-    if (msg_count != 0)
+    if (msg_count == 0 || (backend != MSG_BACKEND_RTOS && backend != MSG_BACKEND_MPSC))
+    {
+        return NULL;
+    }
+    queue = (message_queue_t)calloc(1U, sizeof(struct message_queue));
+    if (queue == NULL)
+    {
+        return NULL;
+    }
+    queue->backend = backend;
+    if (backend == MSG_BACKEND_MPSC)
     {
-        queue = osMessageQueueNew(msg_count, sizeof(message_t), NULL);
+        queue->ring = mpsc_queue_create(msg_count, sizeof(message_t));
+    }
+    else
+    {
+        queue->os_queue = osMessageQueueNew(msg_count, sizeof(message_t), NULL);
+    }
+    if (queue->ring == NULL && queue->os_queue == NULL)
+    {
+        free(queue);
+        queue = NULL;
     }
     
     return queue;
@@ -89,7 +148,20 @@ message_queue_t mesasge_queue_create(uint8_t msg_count)
  */
 void message_queue_delete(message_queue_t queue_id)
 {
-    osMessageQueueDelete(queue_id);
+    if (queue_id == NULL)
+    {
+        return;
+    }
+    message_queue_drain(queue_id);
+    if (queue_id->backend == MSG_BACKEND_MPSC)
+    {
+        mpsc_queue_delete(queue_id->ring);
+    }
+    else
+    {
+        (void)osMessageQueueDelete(queue_id->os_queue);
+    }
+    free(queue_id);
 }
 
 /**
@@ -103,20 +175,73 @@ void message_queue_delete(message_queue_t queue_id)
  * @param timeout Timeout value in OS ticks
  * @return msg_status_t Operation status
  */
+static msg_status_t message_queue_put(message_queue_t queue_id, const message_t *msg, uint32_t timeout)
+{
+    osStatus_t status = osError;
+
+    if (queue_id->backend == MSG_BACKEND_MPSC)
+    {
+        status = mpsc_queue_put(queue_id->ring, msg, timeout);
+    }
+    else
+    {
+        status = osMessageQueuePut(queue_id->os_queue, msg, 0U, timeout);
+    }
+    return os_status_to_msg_status(status);
+}
+
 msg_status_t message_queue_send(message_queue_t queue_id, const message_t *msg, uint32_t timeout)
 {
     msg_status_t result = MSG_ERROR_PARAMETER;
-    osStatus_t status = osError;
+    message_t local;
     
     if (queue_id != NULL && msg != NULL)
     {
-        status = osMessageQueuePut(queue_id, msg, 0U, timeout);
-        result = os_status_to_msg_status(status);
+        /* the sender keeps msg_data, whatever msg_arena held */
+        local = *msg;
+        local.msg_arena = NULL;
+        result = message_queue_put(queue_id, &local, timeout);
     }
     
     return result;
 }
 
+/**
+ * @brief Send a message whose payload moves to the receiver
+ * 
+ * The queued copy names @p arena as the owner of msg_data. If the message
+ * cannot be queued the payload is freed here, so it is never leaked and
+ * never freed twice.
+ * 
+ * @param queue_id Queue handle
+ * @param msg Pointer to message to send
+ * @param arena Arena the payload was allocated from
+ * @param timeout Timeout value in OS ticks
+ * @return msg_status_t Operation status
+ */
+msg_status_t message_queue_send_owned(message_queue_t queue_id, const message_t *msg,
+                                      message_arena_t *arena, uint32_t timeout)
+{
+    msg_status_t result = MSG_ERROR_PARAMETER;
+    message_t local;
+
+    if (msg == NULL)
+    {
+        return result;
+    }
+    if (queue_id != NULL && arena != NULL)
+    {
+        local = *msg;
+        local.msg_arena = arena;
+        result = message_queue_put(queue_id, &local, timeout);
+    }
+    if (result != MSG_OK)
+    {
+        message_payload_free(arena, msg->msg_data);
+    }
+    return result;
+}
+
 /**
  * @brief Receive a message from the queue
  * 
@@ -135,7 +260,14 @@ msg_status_t message_queue_receive(message_queue_t queue_id, message_t *msg, uin
     
     if (queue_id != NULL && msg != NULL)
     {
-        status = osMessageQueueGet(queue_id, msg, NULL, timeout);
+        if (queue_id->backend == MSG_BACKEND_MPSC)
+        {
+            status = mpsc_queue_get(queue_id->ring, msg, timeout);
+        }
+        else
+        {
+            status = osMessageQueueGet(queue_id->os_queue, msg, NULL, timeout);
+        }
         result = os_status_to_msg_status(status);
     }
     
@@ -157,7 +289,9 @@ uint32_t message_queue_get_size(message_queue_t queue_id)
     
     if (queue_id != NULL)
     {
-        capacity = osMessageQueueGetCapacity(queue_id);
+        capacity = (queue_id->backend == MSG_BACKEND_MPSC) ?
+                   mpsc_queue_capacity(queue_id->ring) :
+                   osMessageQueueGetCapacity(queue_id->os_queue);
     }
     
     return capacity;
@@ -178,7 +312,9 @@ uint32_t message_queue_get_used(message_queue_t queue_id)
     
     if (queue_id != NULL)
     {
-        count = osMessageQueueGetCount(queue_id);
+        count = (queue_id->backend == MSG_BACKEND_MPSC) ?
+                mpsc_queue_count(queue_id->ring) :
+                osMessageQueueGetCount(queue_id->os_queue);
     }
     
     return count;
@@ -199,7 +335,9 @@ uint32_t message_queue_get_free(message_queue_t queue_id)
     
     if (queue_id != NULL)
     {
-        space = osMessageQueueGetSpace(queue_id);
+        space = (queue_id->backend == MSG_BACKEND_MPSC) ?
+                (mpsc_queue_capacity(queue_id->ring) - mpsc_queue_count(queue_id->ring)) :
+                osMessageQueueGetSpace(queue_id->os_queue);
     }
     
     return space;
@@ -221,7 +359,16 @@ msg_status_t message_queue_reset(message_queue_t queue_id)
     
     if (queue_id != NULL)
     {
-        status = osMessageQueueReset(queue_id);
+        message_queue_drain(queue_id);
+        if (queue_id->backend == MSG_BACKEND_MPSC)
+        {
+            mpsc_queue_reset(queue_id->ring);
+            status = osOK;
+        }
+        else
+        {
+            status = osMessageQueueReset(queue_id->os_queue);
+        }
         result = os_status_to_msg_status(status);
     }
     
@@ -263,4 +410,287 @@ void message_table_proccess(const msg_table_t *table,uint16_t table_size, messag
             break;
         }
     }
-}
\ No newline at end of file
+}
+/**
+ * @brief Compile a message dispatch table into a directly indexed table
+ * 
+ * The first pass finds the id range and rejects an id listed twice, the
+ * second clears the slots and fills them. Both run once at start-up, so
+ * the quadratic duplicate check does not matter.
+ * 
+ * @param dispatch Table descriptor to fill
+ * @param table Message dispatch table
+ * @param table_size Number of entries in @p table
+ * @param slots Caller storage for the compiled slots
+ * @param slot_count Capacity of @p slots
+ * @return msg_status_t Operation status
+ */
+msg_status_t message_dispatch_build(msg_dispatch_t *dispatch, const msg_table_t *table, uint16_t table_size,
+                                    msg_callback *slots, uint32_t slot_count)
+{
+    uint32_t lo = 0U;
+    uint32_t hi = 0U;
+    uint32_t i = 0U;
+    uint32_t j = 0U;
+
+    if (dispatch == NULL || table == NULL || table_size == 0U || slots == NULL)
+    {
+        return MSG_ERROR_PARAMETER;
+    }
+    lo = table[0].msg_id;
+    hi = table[0].msg_id;
+    for (i = 1U; i < table_size; i++)
+    {
+        lo = (table[i].msg_id < lo) ? table[i].msg_id : lo;
+        hi = (table[i].msg_id > hi) ? table[i].msg_id : hi;
+        for (j = 0U; j < i; j++)
+        {
+            if (table[j].msg_id == table[i].msg_id)
+            {
+                return MSG_ERROR_PARAMETER;
+            }
+        }
+    }
+    if ((hi - lo) >= slot_count)
+    {
+        return MSG_ERROR_NO_MEMORY;
+    }
+    for (i = 0U; i <= (hi - lo); i++)
+    {
+        slots[i] = NULL;
+    }
+    for (i = 0U; i < table_size; i++)
+    {
+        slots[table[i].msg_id - lo] = table[i].msg_cb;
+    }
+    dispatch->slots = slots;
+    dispatch->base = lo;
+    dispatch->count = hi - lo + 1U;
+    return MSG_OK;
+}
+
+/**
+ * @brief Dispatch one message through a compiled table
+ * 
+ * The unsigned subtraction folds the lower bound into the upper one, so
+ * one compare checks both.
+ * 
+ * @param dispatch Compiled table
+ * @param msg Message to process
+ * @param ctx Optional context passed to the callback
+ * @return msg_status_t Operation status
+ */
+msg_status_t message_dispatch(const msg_dispatch_t *dispatch, message_t *msg, void *ctx)
+{
+    uint32_t idx = 0U;
+
+    if (dispatch == NULL || msg == NULL)
+    {
+        return MSG_ERROR_PARAMETER;
+    }
+    idx = msg->msg_id - dispatch->base;
+    if (idx >= dispatch->count || dispatch->slots[idx] == NULL)
+    {
+        return MSG_ERROR_PARAMETER;
+    }
+    dispatch->slots[idx](ctx, msg);
+    return MSG_OK;
+}
+
+/**
+ * @brief Receive up to @p max messages in one call
+ * 
+ * @param queue_id Queue handle
+ * @param msgs Storage for @p max messages
+ * @param max Capacity of @p msgs
+ * @param timeout Timeout for the first message in OS ticks
+ * @return uint32_t Number of messages stored in @p msgs
+ */
+uint32_t message_queue_receive_batch(message_queue_t queue_id, message_t *msgs, uint32_t max, uint32_t timeout)
+{
+    uint32_t count = 0U;
+
+    if (queue_id == NULL || msgs == NULL || max == 0U)
+    {
+        return 0U;
+    }
+    if (message_queue_receive(queue_id, &msgs[0], timeout) != MSG_OK)
+    {
+        return 0U;
+    }
+    count = 1U;
+    while (count < max && message_queue_receive(queue_id, &msgs[count], 0U) == MSG_OK)
+    {
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Receive and dispatch up to @p max messages in one call
+ * 
+ * @param queue_id Queue handle
+ * @param dispatch Compiled table
+ * @param ctx Optional context passed to every callback
+ * @param max Largest number of messages to handle
+ * @param timeout Timeout for the first message in OS ticks
+ * @return uint32_t Number of messages received
+ */
+uint32_t message_queue_dispatch_batch(message_queue_t queue_id, const msg_dispatch_t *dispatch, void *ctx,
+                                      uint32_t max, uint32_t timeout)
+{
+    message_t msgs[MSG_DISPATCH_BATCH_MAX];
+    uint32_t count = 0U;
+    uint32_t i = 0U;
+
+    if (dispatch == NULL)
+    {
+        return 0U;
+    }
+    if (max > MSG_DISPATCH_BATCH_MAX)
+    {
+        max = MSG_DISPATCH_BATCH_MAX;
+    }
+    count = message_queue_receive_batch(queue_id, msgs, max, timeout);
+    for (i = 0U; i < count; i++)
+    {
+        (void)message_dispatch(dispatch, &msgs[i], ctx);
+        message_release(&msgs[i]);
+    }
+    return count;
+}
+
+/* 丢弃队列中的消息并释放其持有的负载 */
+static void message_queue_drain(message_queue_t queue_id)
+{
+    message_t msg;
+
+    while (message_queue_receive(queue_id, &msg, 0U) == MSG_OK)
+    {
+        message_release(&msg);
+    }
+}
+
+/**
+ * @brief Initialize an arena, every block starts free
+ * 
+ * @param arena Arena to initialize
+ */
+void message_arena_init(message_arena_t *arena)
+{
+    uint8_t c = 0U;
+
+    if (arena == NULL)
+    {
+        return;
+    }
+    for (c = 0U; c < MSG_ARENA_CLASS_COUNT; c++)
+    {
+        arena->free_map[c] = MSG_ARENA_FULL_MAP;
+    }
+    arena->alloc_fail = 0U;
+}
+
+/**
+ * @brief Process-wide arena, ready without initialization
+ * 
+ * @return message_arena_t* The default arena
+ */
+message_arena_t *message_arena_default(void)
+{
+    return &message_arena_global;
+}
+
+/**
+ * @brief Allocate a payload block, safe from any thread
+ * 
+ * Takes the lowest free block of the smallest class that fits; the
+ * compare-and-swap retries only when another thread changed the same map.
+ * 
+ * @param arena Arena to allocate from
+ * @param len Bytes needed
+ * @return void* Block, or NULL
+ */
+void *message_payload_alloc(message_arena_t *arena, uint32_t len)
+{
+    uint32_t offset = 0U;
+    uint32_t map = 0U;
+    uint32_t bit = 0U;
+    uint8_t c = 0U;
+
+    if (arena == NULL || len == 0U || len > MSG_ARENA_LARGE_SIZE)
+    {
+        return NULL;
+    }
+    for (c = 0U; c < MSG_ARENA_CLASS_COUNT; c++)
+    {
+        if (len <= message_arena_class_size[c])
+        {
+            map = __atomic_load_n(&arena->free_map[c], __ATOMIC_RELAXED);
+            while (map != 0U)
+            {
+                bit = (uint32_t)__builtin_ctz(map);
+                if (__atomic_compare_exchange_n(&arena->free_map[c], &map, map & ~(1UL << bit), true,
+                                                __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+                {
+                    return &arena->storage[offset + (bit * message_arena_class_size[c])];
+                }
+            }
+        }
+        offset += MSG_ARENA_BLOCKS * message_arena_class_size[c];
+    }
+    __atomic_fetch_add(&arena->alloc_fail, 1U, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+/**
+ * @brief Return a payload block to its arena, safe from any thread
+ * 
+ * The class and block follow from the offset into the storage, so a block
+ * needs no header.
+ * 
+ * @param arena Arena the block came from
+ * @param data Block to free
+ */
+void message_payload_free(message_arena_t *arena, void *data)
+{
+    uintptr_t offset = 0U;
+    uint32_t start = 0U;
+    uint32_t size = 0U;
+    uint8_t c = 0U;
+
+    if (arena == NULL || data == NULL || (uint8_t *)data < arena->storage ||
+        (uint8_t *)data >= &arena->storage[MSG_ARENA_STORAGE_SIZE])
+    {
+        return;
+    }
+    offset = (uintptr_t)((uint8_t *)data - arena->storage);
+    for (c = 0U; c < MSG_ARENA_CLASS_COUNT; c++)
+    {
+        size = message_arena_class_size[c];
+        if (offset < start + (MSG_ARENA_BLOCKS * size))
+        {
+            if (((offset - start) % size) == 0U)
+            {
+                __atomic_fetch_or(&arena->free_map[c], 1UL << ((offset - start) / size), __ATOMIC_RELEASE);
+            }
+            return;
+        }
+        start += MSG_ARENA_BLOCKS * size;
+    }
+}
+
+/**
+ * @brief Free the payload of a handled message if it owns one
+ * 
+ * @param msg Received message
+ */
+void message_release(message_t *msg)
+{
+    if (msg != NULL && msg->msg_arena != NULL)
+    {
+        message_payload_free(msg->msg_arena, msg->msg_data);
+        msg->msg_data = NULL;
+        msg->msg_arena = NULL;
+    }
+}
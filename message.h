@@ -18,9 +18,23 @@
 #include <stdint.h>
 #include "usart/cmsis_os2.h"
 
-typedef osMessageQueueId_t message_queue_t;
+typedef struct message_queue *message_queue_t;
 #define MSG_TIMEOUT_FOREVER osWaitForever
 
+/**
+ * @brief Storage behind a message queue
+ *
+ * MSG_BACKEND_RTOS is osMessageQueue: any number of senders and receivers,
+ * but on the POSIX port every send and receive takes a mutex and a
+ * condition variable. MSG_BACKEND_MPSC is a lock-free ring (mpsc_queue.h)
+ * for queues with a single receiving thread: senders never block each
+ * other and the receiver is only woken when it is actually waiting.
+ */
+typedef enum {
+    MSG_BACKEND_RTOS = 0,   ///< osMessageQueue, any number of receivers
+    MSG_BACKEND_MPSC,       ///< lock-free ring, exactly one receiving thread
+} msg_backend_t;
+
 /**
  * @brief Message queue operation status codes
  */
@@ -33,15 +47,46 @@ typedef enum {
     MSG_ERROR_NO_MEMORY  = -5,    ///< Insufficient memory
 } msg_status_t;
 
+struct message_arena;
+
 /**
  * @brief Message structure for queue operations
+ *
+ * By default msg_data stays owned by the sender, which must keep it valid
+ * until the message has been handled. A message sent with
+ * message_queue_send_owned() carries a payload block from a message arena
+ * instead; the receiver frees it with message_release() once the message
+ * has been dispatched.
  */
 typedef struct{
     uint32_t msg_id;      ///< Message identifier
     uint8_t *msg_data;    ///< Pointer to message data
     uint32_t msg_len;     ///< Length of message data in bytes
+    struct message_arena *msg_arena;  ///< Arena owning msg_data, NULL if the sender keeps it (set by the send call)
 }message_t;
 
+#define MSG_ARENA_CLASS_COUNT   3U      ///< size classes per arena
+#define MSG_ARENA_BLOCKS        32U     ///< blocks per size class, one bit each in the free map
+#define MSG_ARENA_SMALL_SIZE    16U
+#define MSG_ARENA_MEDIUM_SIZE   64U
+#define MSG_ARENA_LARGE_SIZE    256U
+#define MSG_ARENA_STORAGE_SIZE  (MSG_ARENA_BLOCKS * (MSG_ARENA_SMALL_SIZE + MSG_ARENA_MEDIUM_SIZE + MSG_ARENA_LARGE_SIZE))
+
+/**
+ * @brief Fixed-size payload blocks for messages, no malloc
+ *
+ * Every size class is a run of MSG_ARENA_BLOCKS blocks with a bitmap of
+ * free blocks. Allocating clears a bit with compare-and-swap and freeing
+ * sets it again, so payloads can be allocated and freed from any thread
+ * or timer callback without a lock. An allocation takes the smallest class
+ * that fits and moves up a class when that one is exhausted.
+ */
+typedef struct message_arena{
+    uint8_t storage[MSG_ARENA_STORAGE_SIZE];    ///< small blocks, then medium, then large
+    uint32_t free_map[MSG_ARENA_CLASS_COUNT];   ///< bit n set = block n of the class is free
+    uint32_t alloc_fail;                        ///< allocations that found no block
+}message_arena_t;
+
 typedef void(*msg_callback)(void* ctx, message_t* msg);
 
 typedef struct{
@@ -49,6 +94,20 @@ typedef struct{
     msg_callback msg_cb;
 }msg_table_t;
 
+/**
+ * @brief Dispatch table compiled from a msg_table_t array
+ *
+ * slots[msg_id - base] holds the callback of msg_id, so a dispatch is a
+ * bounds check and an indexed call. Built once by message_dispatch_build()
+ * into caller storage; read-only afterwards, so one table can serve any
+ * number of threads.
+ */
+typedef struct{
+    msg_callback *slots;    ///< caller storage, one slot per id in [base, base + count)
+    uint32_t base;          ///< lowest msg_id in the table
+    uint32_t count;         ///< slots in use
+}msg_dispatch_t;
+
 /**
  * @brief Create a new message queue
  * 
@@ -68,6 +127,21 @@ typedef struct{
  */
 message_queue_t mesasge_queue_create(uint8_t msg_count);
 
+/**
+ * @brief Create a message queue on a chosen backend
+ * 
+ * Same as mesasge_queue_create() but selects the storage. With
+ * MSG_BACKEND_MPSC the capacity is rounded up to a power of two, and
+ * message_queue_receive() and message_queue_reset() must only ever be
+ * called from one thread; message_queue_send() stays safe from any thread
+ * and from timer callbacks.
+ * 
+ * @param msg_count Maximum number of messages the queue can hold (must be > 0)
+ * @param backend Queue storage
+ * @return message_queue_t Queue handle on success, NULL on failure
+ */
+message_queue_t message_queue_create_backend(uint8_t msg_count, msg_backend_t backend);
+
 /**
  * @brief Delete a message queue
  * 
@@ -104,6 +178,23 @@ void message_queue_delete(message_queue_t queue_id);
  */
 msg_status_t message_queue_send(message_queue_t queue_id, const message_t *msg, uint32_t timeout);
 
+/**
+ * @brief Send a message whose payload moves to the receiver
+ * 
+ * @p msg->msg_data must come from message_payload_alloc() on @p arena, or
+ * be NULL. Ownership passes with the call: on success the receiver frees
+ * the payload with message_release() after handling the message, and on
+ * failure this function frees it, so the sender never touches it again.
+ * 
+ * @param queue_id Queue handle
+ * @param msg Message to send (must not be NULL)
+ * @param arena Arena the payload was allocated from (must not be NULL)
+ * @param timeout Timeout value in OS ticks
+ * @return msg_status_t Same as message_queue_send()
+ */
+msg_status_t message_queue_send_owned(message_queue_t queue_id, const message_t *msg,
+                                      message_arena_t *arena, uint32_t timeout);
+
 /**
  * @brief Receive a message from the queue
  * 
@@ -171,7 +262,8 @@ uint32_t message_queue_get_free(message_queue_t queue_id);
  *         - MSG_OK: Queue reset successfully
  *         - MSG_ERROR_PARAMETER: Invalid queue handle
  * 
- * @warning All pending messages in the queue will be lost
+ * @warning All pending messages in the queue will be lost; owned payloads
+ *          among them are released
  */
 msg_status_t message_queue_reset(message_queue_t queue_id);
 
@@ -193,7 +285,117 @@ msg_status_t message_queue_reset(message_queue_t queue_id);
  * 
  * @note If no matching message ID is found, the function returns silently
  * @note The callback function is only invoked if it's not NULL
- * @note The function performs linear search, so for large tables consider optimization
+ * @note The function performs linear search; message_dispatch_build() compiles
+ *       the table for an indexed dispatch
  */
 void message_table_proccess(const msg_table_t *table,uint16_t table_size, message_t* msg, void *ctx);
+
+/**
+ * @brief Compile a message dispatch table into a directly indexed table
+ * 
+ * The ids of @p table may start anywhere but must be dense enough that
+ * highest - lowest + 1 fits in @p slot_count. Ids without an entry, and
+ * entries with a NULL callback, dispatch to nothing, like a miss in
+ * message_table_proccess().
+ * 
+ * @param dispatch Table descriptor to fill
+ * @param table Message dispatch table (must not be NULL)
+ * @param table_size Number of entries in @p table (must be > 0)
+ * @param slots Caller storage for the compiled slots, must outlive @p dispatch
+ * @param slot_count Capacity of @p slots
+ * @return msg_status_t Operation status:
+ *         - MSG_OK: Table compiled
+ *         - MSG_ERROR_PARAMETER: Invalid argument, or an id listed twice
+ *           (the later entry would never be reached by the linear scan)
+ *         - MSG_ERROR_NO_MEMORY: The id range does not fit in @p slot_count
+ */
+msg_status_t message_dispatch_build(msg_dispatch_t *dispatch, const msg_table_t *table, uint16_t table_size,
+                                    msg_callback *slots, uint32_t slot_count);
+
+/**
+ * @brief Dispatch one message through a compiled table
+ * 
+ * @param dispatch Compiled table (must not be NULL)
+ * @param msg Message to process (must not be NULL)
+ * @param ctx Optional context passed to the callback
+ * @return msg_status_t MSG_OK if a callback ran, MSG_ERROR_PARAMETER for an
+ *         id outside the table or without a callback
+ */
+msg_status_t message_dispatch(const msg_dispatch_t *dispatch, message_t *msg, void *ctx);
+
+/**
+ * @brief Receive up to @p max messages in one call
+ * 
+ * Waits up to @p timeout for the first message, then takes whatever else
+ * is already queued without waiting, so a burst is drained with one
+ * wake-up of the receiving thread.
+ * 
+ * @param queue_id Queue handle
+ * @param msgs Storage for @p max messages
+ * @param max Capacity of @p msgs
+ * @param timeout Timeout for the first message in OS ticks
+ * @return uint32_t Number of messages stored in @p msgs
+ */
+uint32_t message_queue_receive_batch(message_queue_t queue_id, message_t *msgs, uint32_t max, uint32_t timeout);
+
+#define MSG_DISPATCH_BATCH_MAX  16U
+
+/**
+ * @brief Receive and dispatch up to @p max messages in one call
+ * 
+ * message_queue_receive_batch() followed by message_dispatch() and
+ * message_release() of every message received, in queue order.
+ * 
+ * @param queue_id Queue handle
+ * @param dispatch Compiled table
+ * @param ctx Optional context passed to every callback
+ * @param max Largest number of messages to handle, at most MSG_DISPATCH_BATCH_MAX
+ * @param timeout Timeout for the first message in OS ticks
+ * @return uint32_t Number of messages received
+ */
+uint32_t message_queue_dispatch_batch(message_queue_t queue_id, const msg_dispatch_t *dispatch, void *ctx,
+                                      uint32_t max, uint32_t timeout);
+
+/**
+ * @brief Initialize an arena, every block starts free
+ * 
+ * @param arena Arena to initialize (NULL is ignored)
+ */
+void message_arena_init(message_arena_t *arena);
+
+/**
+ * @brief Process-wide arena, ready without initialization
+ * 
+ * @return message_arena_t* The default arena
+ */
+message_arena_t *message_arena_default(void);
+
+/**
+ * @brief Allocate a payload block, safe from any thread
+ * 
+ * @param arena Arena to allocate from
+ * @param len Bytes needed, at most MSG_ARENA_LARGE_SIZE
+ * @return void* Block of at least @p len bytes, NULL if @p len is 0 or too
+ *         large, or if no class that fits has a free block
+ */
+void *message_payload_alloc(message_arena_t *arena, uint32_t len);
+
+/**
+ * @brief Return a payload block to its arena, safe from any thread
+ * 
+ * @param arena Arena the block came from
+ * @param data Block from message_payload_alloc(); NULL, or a pointer that
+ *             is not the start of a block of @p arena, is ignored
+ */
+void message_payload_free(message_arena_t *arena, void *data);
+
+/**
+ * @brief Free the payload of a handled message if it owns one
+ * 
+ * Call once a received message has been dispatched. Messages sent with
+ * message_queue_send() own nothing and are left alone.
+ * 
+ * @param msg Received message (NULL is ignored)
+ */
+void message_release(message_t *msg);
  #endif
\ No newline at end of file
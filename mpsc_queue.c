@@ -0,0 +1,332 @@
+/**
+ * @file mpsc_queue.c
+ * @brief Bounded lock-free multi-producer / single-consumer queue implementation
+ *
+ * Slot i of lap n is free for the producer of position p = n * capacity + i
+ * while its sequence equals p, holds that producer's element once the
+ * sequence is p + 1, and is handed back to the next lap by the consumer
+ * setting it to p + capacity.
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#include "mpsc_queue.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+#define MPSC_QUEUE_CACHE_LINE   64U
+
+struct mpsc_queue {
+    uint32_t tail;              /* next position to claim, producers */
+    uint32_t put_waiting;       /* producers that may be asleep on a full queue */
+    uint32_t space;             /* futex word, bumped to wake those producers */
+    uint8_t pad0[MPSC_QUEUE_CACHE_LINE - 3U * sizeof(uint32_t)];
+    uint32_t head;              /* next position to take, consumer */
+    uint32_t waiting;           /* 1 while the consumer may be asleep */
+    uint32_t wake;              /* futex word, bumped to wake the consumer */
+    uint8_t pad1[MPSC_QUEUE_CACHE_LINE - 3U * sizeof(uint32_t)];
+    uint32_t mask;              /* capacity - 1 */
+    uint32_t elem_size;
+    uint32_t *seq;              /* per-slot sequence */
+    uint8_t *data;              /* capacity * elem_size bytes */
+};
+
+#ifdef __linux__
+static void mpsc_queue_futex_wait(uint32_t *word, uint32_t val, uint32_t ticks)
+{
+    struct timespec ts;
+    uint64_t ns = 0U;
+
+    if (ticks == osWaitForever)
+    {
+        (void)syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+        return;
+    }
+    ns = ((uint64_t)ticks * 1000000000ULL) / osKernelGetTickFreq();
+    ts.tv_sec = (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    (void)syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, val, &ts, NULL, 0);
+}
+
+static void mpsc_queue_futex_wake(uint32_t *word, int count)
+{
+    (void)syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+#endif
+
+/* 消费者释放了槽位：唤醒等待空位的生产者，它们重新竞争 */
+static void mpsc_queue_wake_producers(mpsc_queue_t *q)
+{
+#ifdef __linux__
+    /* pairs with the fence in mpsc_queue_put() like the consumer side does */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&q->put_waiting, __ATOMIC_RELAXED) != 0U)
+    {
+        __atomic_fetch_add(&q->space, 1U, __ATOMIC_RELEASE);
+        mpsc_queue_futex_wake(&q->space, 0x7FFFFFFF);
+    }
+#else
+    (void)q;
+#endif
+}
+
+/* 剩余等待时间（tick），超时返回 0 */
+static uint32_t mpsc_queue_remaining(uint32_t start, uint32_t timeout)
+{
+    uint32_t elapsed = 0U;
+
+    if (timeout == osWaitForever)
+    {
+        return osWaitForever;
+    }
+    elapsed = osKernelGetTickCount() - start;
+    return (elapsed < timeout) ? (timeout - elapsed) : 0U;
+}
+
+mpsc_queue_t *mpsc_queue_create(uint32_t count, uint32_t elem_size)
+{
+    mpsc_queue_t *q = NULL;
+    uint32_t capacity = 2U;
+    uint32_t i = 0U;
+
+    if (elem_size == 0U || count > 0x80000000UL)
+    {
+        return NULL;
+    }
+    while (capacity < count)
+    {
+        capacity <<= 1;
+    }
+    q = (mpsc_queue_t *)calloc(1U, sizeof(mpsc_queue_t));
+    if (q == NULL)
+    {
+        return NULL;
+    }
+    q->seq = (uint32_t *)malloc((size_t)capacity * sizeof(uint32_t));
+    q->data = (uint8_t *)malloc((size_t)capacity * elem_size);
+    if (q->seq == NULL || q->data == NULL)
+    {
+        mpsc_queue_delete(q);
+        return NULL;
+    }
+    for (i = 0U; i < capacity; i++)
+    {
+        q->seq[i] = i;
+    }
+    q->mask = capacity - 1U;
+    q->elem_size = elem_size;
+    return q;
+}
+
+void mpsc_queue_delete(mpsc_queue_t *q)
+{
+    if (q == NULL)
+    {
+        return;
+    }
+    free(q->seq);
+    free(q->data);
+    free(q);
+}
+
+/* 抢占一个槽位并发布元素，队列满时返回 false */
+static bool mpsc_queue_try_put(mpsc_queue_t *q, const void *elem)
+{
+    uint32_t pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    uint32_t idx = 0U;
+    int32_t diff = 0;
+
+    for (;;)
+    {
+        idx = pos & q->mask;
+        diff = (int32_t)(__atomic_load_n(&q->seq[idx], __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(&q->tail, &pos, pos + 1U, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false;   /* the consumer has not freed this slot yet */
+        }
+        else
+        {
+            pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+        }
+    }
+    memcpy(&q->data[(size_t)idx * q->elem_size], elem, q->elem_size);
+    __atomic_store_n(&q->seq[idx], pos + 1U, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool mpsc_queue_try_get(mpsc_queue_t *q, void *elem)
+{
+    uint32_t pos = q->head;
+    uint32_t idx = pos & q->mask;
+
+    if (__atomic_load_n(&q->seq[idx], __ATOMIC_ACQUIRE) != pos + 1U)
+    {
+        return false;   /* empty, or the producer of this slot is still copying */
+    }
+    memcpy(elem, &q->data[(size_t)idx * q->elem_size], q->elem_size);
+    __atomic_store_n(&q->seq[idx], pos + q->mask + 1U, __ATOMIC_RELEASE);
+    __atomic_store_n(&q->head, pos + 1U, __ATOMIC_RELAXED);
+    return true;
+}
+
+osStatus_t mpsc_queue_put(mpsc_queue_t *q, const void *elem, uint32_t timeout)
+{
+    uint32_t start = 0U;
+    uint32_t left = 0U;
+#ifdef __linux__
+    uint32_t space = 0U;
+    bool done = false;
+#endif
+
+    if (q == NULL || elem == NULL)
+    {
+        return osErrorParameter;
+    }
+    start = osKernelGetTickCount();
+    while (!mpsc_queue_try_put(q, elem))
+    {
+        if (timeout == 0U)
+        {
+            return osErrorResource;
+        }
+        left = mpsc_queue_remaining(start, timeout);
+        if (left == 0U)
+        {
+            return osErrorTimeout;
+        }
+#ifdef __linux__
+        /* same handshake as the consumer: announce, fence, re-check, sleep */
+        __atomic_fetch_add(&q->put_waiting, 1U, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        space = __atomic_load_n(&q->space, __ATOMIC_ACQUIRE);
+        done = mpsc_queue_try_put(q, elem);
+        if (!done)
+        {
+            mpsc_queue_futex_wait(&q->space, space, left);
+        }
+        __atomic_fetch_sub(&q->put_waiting, 1U, __ATOMIC_RELAXED);
+        if (done)
+        {
+            break;
+        }
+#else
+        osDelay(1U);
+#endif
+    }
+#ifdef __linux__
+    /* pairs with the fence in mpsc_queue_get(): either the consumer sees the
+     * element on its re-check, or we see it waiting and wake it */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&q->waiting, __ATOMIC_RELAXED) != 0U)
+    {
+        __atomic_fetch_add(&q->wake, 1U, __ATOMIC_RELEASE);
+        mpsc_queue_futex_wake(&q->wake, 1);
+    }
+#endif
+    return osOK;
+}
+
+osStatus_t mpsc_queue_get(mpsc_queue_t *q, void *elem, uint32_t timeout)
+{
+    uint32_t start = 0U;
+    uint32_t left = 0U;
+#ifdef __linux__
+    uint32_t wake = 0U;
+#endif
+
+    if (q == NULL || elem == NULL)
+    {
+        return osErrorParameter;
+    }
+    if (mpsc_queue_try_get(q, elem))
+    {
+        mpsc_queue_wake_producers(q);
+        return osOK;
+    }
+    if (timeout == 0U)
+    {
+        return osErrorResource;
+    }
+    start = osKernelGetTickCount();
+    for (;;)
+    {
+        left = mpsc_queue_remaining(start, timeout);
+        if (left == 0U)
+        {
+            return osErrorTimeout;
+        }
+#ifdef __linux__
+        __atomic_store_n(&q->waiting, 1U, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        wake = __atomic_load_n(&q->wake, __ATOMIC_ACQUIRE);
+        if (mpsc_queue_try_get(q, elem))
+        {
+            __atomic_store_n(&q->waiting, 0U, __ATOMIC_RELAXED);
+            mpsc_queue_wake_producers(q);
+            return osOK;
+        }
+        mpsc_queue_futex_wait(&q->wake, wake, left);
+        __atomic_store_n(&q->waiting, 0U, __ATOMIC_RELAXED);
+#else
+        osDelay(1U);
+#endif
+        if (mpsc_queue_try_get(q, elem))
+        {
+            mpsc_queue_wake_producers(q);
+            return osOK;
+        }
+    }
+}
+
+void mpsc_queue_reset(mpsc_queue_t *q)
+{
+    uint32_t idx = 0U;
+
+    if (q == NULL)
+    {
+        return;
+    }
+    /* drop what is published; a slot still being copied is taken later */
+    while (__atomic_load_n(&q->seq[q->head & q->mask], __ATOMIC_ACQUIRE) == q->head + 1U)
+    {
+        idx = q->head & q->mask;
+        __atomic_store_n(&q->seq[idx], q->head + q->mask + 1U, __ATOMIC_RELEASE);
+        __atomic_store_n(&q->head, q->head + 1U, __ATOMIC_RELAXED);
+    }
+    mpsc_queue_wake_producers(q);
+}
+
+uint32_t mpsc_queue_capacity(const mpsc_queue_t *q)
+{
+    return (q != NULL) ? (q->mask + 1U) : 0U;
+}
+
+uint32_t mpsc_queue_count(const mpsc_queue_t *q)
+{
+    uint32_t head = 0U;
+    uint32_t tail = 0U;
+
+    if (q == NULL)
+    {
+        return 0U;
+    }
+    head = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    tail = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    return ((tail - head) > q->mask) ? (q->mask + 1U) : (tail - head);
+}
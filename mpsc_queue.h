@@ -0,0 +1,84 @@
+/**
+ * @file mpsc_queue.h
+ * @brief Bounded lock-free multi-producer / single-consumer queue
+ *
+ * Fixed-size elements are copied into a power-of-two ring of slots. Every
+ * slot carries a sequence number that tells whether it is free for the
+ * producer of a given lap or holds an element for the consumer, so a post
+ * is one compare-and-swap on the tail plus a copy, and taking an element
+ * needs no atomic read-modify-write at all. No mutex is taken on either
+ * side, which keeps timer callbacks and the receive thread from queueing
+ * up behind each other when they post to the same controller.
+ *
+ * The consumer may block in mpsc_queue_get() and a producer in
+ * mpsc_queue_put() with a timeout. On Linux each side sleeps on a futex
+ * that the other side only touches when someone is actually asleep, so
+ * neither a post to a busy consumer nor a take from a queue with room
+ * costs a system call. Other ports fall back to polling with osDelay(1).
+ *
+ * Exactly one thread may call mpsc_queue_get() and mpsc_queue_reset();
+ * any number of threads and timer callbacks may call mpsc_queue_put().
+ *
+ * @author TOPBAND Team
+ * @date 2026-10-18
+ * @version 1.0
+ */
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cmsis_os2.h"
+
+typedef struct mpsc_queue mpsc_queue_t;
+
+/**
+ * @brief Create a queue
+ * @param count Elements the queue must hold, rounded up to a power of two (at least 2)
+ * @param elem_size Size of one element in bytes
+ * @return Queue, or NULL if @p elem_size is 0 or memory is short
+ */
+mpsc_queue_t *mpsc_queue_create(uint32_t count, uint32_t elem_size);
+
+/**
+ * @brief Free a queue, no thread may be using it any more
+ */
+void mpsc_queue_delete(mpsc_queue_t *q);
+
+/**
+ * @brief Post one element, safe from any thread
+ * @param q Queue
+ * @param elem Element to copy in
+ * @param timeout Ticks to wait for a free slot, 0 to fail at once, osWaitForever
+ * @return osOK, osErrorResource if full with timeout 0, osErrorTimeout, osErrorParameter
+ */
+osStatus_t mpsc_queue_put(mpsc_queue_t *q, const void *elem, uint32_t timeout);
+
+/**
+ * @brief Take the oldest element, consumer thread only
+ * @param q Queue
+ * @param elem Storage for one element
+ * @param timeout Ticks to wait for an element, 0 to fail at once, osWaitForever
+ * @return osOK, osErrorResource if empty with timeout 0, osErrorTimeout, osErrorParameter
+ */
+osStatus_t mpsc_queue_get(mpsc_queue_t *q, void *elem, uint32_t timeout);
+
+/**
+ * @brief Discard pending elements, consumer thread only
+ */
+void mpsc_queue_reset(mpsc_queue_t *q);
+
+/**
+ * @brief Slots in the ring (after rounding)
+ */
+uint32_t mpsc_queue_capacity(const mpsc_queue_t *q);
+
+/**
+ * @brief Elements claimed by producers and not yet taken
+ *
+ * A snapshot only: it may already be stale when it returns.
+ */
+uint32_t mpsc_queue_count(const mpsc_queue_t *q);
+
+#endif // MPSC_QUEUE_H
@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "comm_bulk.h"
+
+#define TEST_IMAGE_SIZE     4096U
+#define TEST_ACK_DROP       10U     /* 每 10 个应答丢 1 个 */
+
+comm_ctrl_t comm_ctrl_instance;
+comm_bulk_t comm_bulk_instance;
+uint8_t tx_image[TEST_IMAGE_SIZE];
+uint8_t rx_image[TEST_IMAGE_SIZE];
+uint32_t ack_count;
+
+/* 回环从机：保存升级分块并应答，周期命令以 id + 1 应答 */
+static void loopback_send_func(void *ctx, uint8_t *data, uint16_t len)
+{
+    comm_ctrl_t *ctrl = (comm_ctrl_t *)ctx;
+    uint8_t resp[4] = {0};
+    uint32_t seq = 0U;
+
+    if (data[0] == COMM_BULK_CMD_ID)
+    {
+        seq = ((uint32_t)data[1] << 8U) | data[2];
+        memcpy(&rx_image[seq * COMM_BULK_CHUNK_MAX], &data[3], len - 3U);
+        if ((++ack_count % TEST_ACK_DROP) == 0U)
+        {
+            return;
+        }
+        resp[0] = COMM_BULK_CMD_ID + 1U;
+        resp[1] = data[1];
+        resp[2] = data[2];
+        resp[3] = COMM_BULK_STATUS_OK;
+        comm_ctrl_save_recv_data(ctrl, resp, 4U);
+    }
+    else
+    {
+        resp[0] = (uint8_t)(data[0] + 1U);
+        resp[1] = (uint8_t)len;
+        comm_ctrl_save_recv_data(ctrl, resp, 2U);
+    }
+}
+
+static void drain_recv(uint32_t ms)
+{
+    comm_data_t recv;
+    uint32_t end = osKernelGetTickCount() + ms;
+
+    while ((int32_t)(end - osKernelGetTickCount()) > 0)
+    {
+        while (comm_ctrl_get_recv_data(&comm_ctrl_instance, &recv) == COMM_OK)
+        {
+        }
+        osDelay(1);
+    }
+}
+
+static void bulk_progress(void *ctx, const comm_bulk_progress_t *progress)
+{
+    (void)ctx;
+    if (progress->state != COMM_BULK_STATE_RUNNING || (progress->checkpoint % 32U) == 0U)
+    {
+        printf("bulk state %d: %u/%u bytes, checkpoint %u, %u B/s, retransmits %u\n",
+               progress->state, progress->acked_bytes, progress->total_bytes,
+               progress->checkpoint, progress->bytes_per_sec, progress->retransmits);
+    }
+}
+
+void ctrl_thread(void *argument)
+{
+    while(1)
+    {
+        comm_ctrl_process(&comm_ctrl_instance, 100);
+    }
+}
+
+void app_thread(void *argument)
+{
+    comm_bulk_config_t cfg = {0};
+    comm_bulk_progress_t progress;
+    uint32_t i = 0U;
+
+    for (i = 0U; i < TEST_IMAGE_SIZE; i++)
+    {
+        tx_image[i] = (uint8_t)(i * 7U + 3U);
+    }
+    cfg.timeout_ms = 100U;
+    cfg.progress_cb = bulk_progress;
+
+    comm_ctrl_init(&comm_ctrl_instance);
+    comm_ctrl_set_send_func(&comm_ctrl_instance, loopback_send_func, &comm_ctrl_instance);
+    comm_bulk_init(&comm_bulk_instance, &cfg);
+    comm_ctrl_start(&comm_ctrl_instance);
+    osThreadNew(ctrl_thread, NULL, NULL);
+
+    comm_bulk_start(&comm_bulk_instance, &comm_ctrl_instance, tx_image, TEST_IMAGE_SIZE);
+    drain_recv(200U);
+    /* 模拟断线：暂停后从断点续传 */
+    comm_bulk_stop(&comm_bulk_instance);
+    drain_recv(50U);
+    comm_bulk_get_progress(&comm_bulk_instance, &progress);
+    printf("paused at checkpoint %u\n", progress.checkpoint);
+    comm_bulk_resume(&comm_bulk_instance, progress.checkpoint);
+
+    while(1)
+    {
+        drain_recv(1U);
+        comm_bulk_get_progress(&comm_bulk_instance, &progress);
+        if (progress.state == COMM_BULK_STATE_DONE || progress.state == COMM_BULK_STATE_FAILED)
+        {
+            printf("bulk finished, state %d, image %s\n", progress.state,
+                   (memcmp(tx_image, rx_image, TEST_IMAGE_SIZE) == 0) ? "match" : "MISMATCH");
+            break;
+        }
+    }
+    while(1)
+    {
+        drain_recv(1000U);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    osKernelInitialize();
+    
+    osThreadNew(app_thread, NULL, NULL);
+    
+    osKernelStart();  // 启动RTOS调度器,不会返回
+    
+    return 0;
+}
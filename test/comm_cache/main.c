@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "comm_cache.h"
+
+#define TEST_CMD_ID         0xF2U
+#define TEST_RESP_ID        0xF3U
+
+static comm_cache_t cache;
+static uint32_t failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-48s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+/* 请求负载为 1 字节 key，应答负载为 key 的反码 */
+static comm_result_t store_key(uint8_t key, uint32_t ttl_ms)
+{
+    uint8_t resp = (uint8_t)~key;
+
+    return comm_cache_store(&cache, TEST_CMD_ID, &key, 1U, TEST_RESP_ID, &resp, 1U, ttl_ms);
+}
+
+static bool lookup_key(uint8_t key)
+{
+    uint8_t resp_id = 0U;
+    uint8_t resp[COMM_DATA_MAX_LEN] = {0};
+    uint8_t resp_len = 0U;
+    uint8_t expect = (uint8_t)(~key & 0xFFU);
+
+    if (!comm_cache_lookup(&cache, TEST_CMD_ID, &key, 1U, &resp_id, resp, &resp_len))
+    {
+        return false;
+    }
+    return (resp_id == TEST_RESP_ID) && (resp_len == 1U) && (resp[0] == expect);
+}
+
+static void test_hit(void)
+{
+    comm_cache_invalidate_all(&cache);
+    check(store_key(1U, 1000U) == COMM_OK, "store");
+    check(lookup_key(1U), "hit returns the stored response");
+    check(!lookup_key(2U), "other request payload misses");
+    check(store_key(3U, 0U) != COMM_OK && !lookup_key(3U), "ttl 0 stores nothing");
+    comm_cache_invalidate(&cache, TEST_CMD_ID);
+    check(!lookup_key(1U), "invalidated entry misses");
+}
+
+static void test_expiry(void)
+{
+    comm_cache_invalidate_all(&cache);
+    (void)store_key(1U, 20U);
+    (void)store_key(2U, 1000U);
+    check(lookup_key(1U), "short ttl entry hits before expiry");
+    osDelay(40U);
+    check(!lookup_key(1U), "short ttl entry misses after expiry");
+    check(lookup_key(2U), "long ttl entry still hits");
+}
+
+static void test_eviction(void)
+{
+    uint8_t i = 0U;
+    bool all = true;
+
+    comm_cache_invalidate_all(&cache);
+    /* 填满缓存，key 0 最早到期 */
+    for (i = 0U; i < COMM_CACHE_ENTRY_NUM; i++)
+    {
+        (void)store_key(i, 1000U + (100U * i));
+    }
+    (void)store_key(0xA0U, 5000U);
+    check(!lookup_key(0U), "full cache evicts the entry closest to expiry");
+    for (i = 1U; i < COMM_CACHE_ENTRY_NUM; i++)
+    {
+        all = all && lookup_key(i);
+    }
+    check(all && lookup_key(0xA0U), "other entries and the new one survive");
+
+    /* 过期条目先于存活条目被复用 */
+    comm_cache_invalidate_all(&cache);
+    (void)store_key(0U, 20U);
+    for (i = 1U; i < COMM_CACHE_ENTRY_NUM; i++)
+    {
+        (void)store_key(i, 1000U);
+    }
+    osDelay(40U);
+    (void)store_key(0xA1U, 1000U);
+    all = true;
+    for (i = 1U; i < COMM_CACHE_ENTRY_NUM; i++)
+    {
+        all = all && lookup_key(i);
+    }
+    check(all && lookup_key(0xA1U), "expired entry is reused before a live one");
+
+    /* 同一请求覆盖原条目，不占新位置 */
+    (void)store_key(1U, 3000U);
+    all = true;
+    for (i = 2U; i < COMM_CACHE_ENTRY_NUM; i++)
+    {
+        all = all && lookup_key(i);
+    }
+    check(all && lookup_key(1U) && lookup_key(0xA1U), "same request replaces its entry");
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t hits = 0U;
+
+    (void)argc;
+    (void)argv;
+    osKernelInitialize();
+    if (comm_cache_init(&cache) != COMM_OK)
+    {
+        printf("init failed\n");
+        return 1;
+    }
+    test_hit();
+    hits = cache.hits;
+    test_expiry();
+    check(cache.hits == hits + 2U, "hit counter follows lookups");
+    test_eviction();
+    printf("hits %u, misses %u\n", cache.hits, cache.misses);
+    printf("%s\n", (failures == 0U) ? "PASS" : "FAIL");
+    return (failures == 0U) ? 0 : 1;
+}
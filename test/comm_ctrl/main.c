@@ -7,9 +7,25 @@
 
 
 comm_ctrl_t comm_ctrl_instance;
+static fsm_trace_rec_t trace_recs[64];
+static fsm_trace_t trace;
+
+/* 打印跟踪环中最慢的几次状态跳转 */
+static void print_slowest(void)
+{
+    fsm_trace_rec_t slow[3];
+    uint16_t n = fsm_trace_slowest(&trace, slow, 3U);
+
+    for (uint16_t i = 0; i < n; i++)
+    {
+        printf("slow #%u: state %u event %u -> %u, %lu cycles at tick %lu\n", i, slow[i].state, slow[i].event,
+               slow[i].next_state, (unsigned long)slow[i].cycles, (unsigned long)slow[i].tick);
+    }
+}
 
 void app_thread(void *argument)
 {
+    uint32_t loops = 0;
     comm_data_t cmd;
     cmd.comm_id = 0x01;
     cmd.comm_len = 6;
@@ -21,12 +37,23 @@ void app_thread(void *argument)
     cmd.comm_data[5] = 0xF4;
 
     comm_ctrl_init(&comm_ctrl_instance);
+    fsm_trace_init(&trace, trace_recs, 64U);
+    comm_ctrl_set_trace(&comm_ctrl_instance, &trace);
     comm_ctrl_send_single_command(&comm_ctrl_instance, &cmd);
     comm_ctrl_start(&comm_ctrl_instance);
     while(1)
     {
         comm_ctrl_process(&comm_ctrl_instance, 100);
         osDelay(10);
+        if (loops == 20U)
+        {
+            /* 运行中更新周期命令：命令经消息内存池交给控制器线程 */
+            comm_ctrl_send_period_command(&comm_ctrl_instance, &cmd);
+        }
+        if (++loops % 100U == 0U)
+        {
+            print_slowest();
+        }
     }
 }
 
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "comm_mgr.h"
+#include "comm_table.h"
+
+/* comm_mgr 管理的链路，worker 由本线程驱动，检查每条应答的处理 */
+#define TEST_PERIOD_CMD     0x8EU       /* MACHINE_TYPE_GET，内置表应答 0x8F 带 2 字节 */
+#define TEST_POLL_MS        5U
+#define TEST_UPDATES        200U        /* 超过 worker 队列深度，后面的更新走直接写入 */
+
+static comm_mgr_t mgr;
+static comm_ctrl_t link0;
+static comm_stats_t link0_stats;
+static volatile int8_t resp_len_delta;      /* 从机应答比命令表多出的字节数 */
+static uint32_t sent_count;
+static uint8_t sent_data;                   /* 最后一次发出的第一个数据字节 */
+static uint32_t recv_count;
+static uint32_t failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-52s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+/* 回环从机：在 worker 发送时立即按内置表应答 */
+static void loopback_send_func(void *ctx, uint8_t *data, uint16_t len)
+{
+    comm_ctrl_t *ctrl = (comm_ctrl_t *)ctx;
+    const comm_cmd_table_t *entry = comm_table_find_by_send(data[0]);
+    uint8_t resp[COMM_DATA_MAX_LEN] = {0};
+
+    sent_count++;
+    sent_data = (len > 1U) ? data[1] : 0U;
+    if (entry == NULL)
+    {
+        return;
+    }
+    resp[0] = entry->resp_cmd_id;
+    (void)comm_ctrl_save_recv_data(ctrl, resp, (uint16_t)(entry->resp_data_len + 1 + resp_len_delta));
+}
+
+/* 在本线程上运行 worker 0，应用取走应答 */
+static void run_worker(uint32_t ms)
+{
+    comm_data_t recv;
+    uint32_t end = osKernelGetTickCount() + ms;
+
+    do
+    {
+        (void)comm_mgr_process(&mgr, 0U, 1U);
+        while (comm_ctrl_get_recv_data(&link0, &recv) == COMM_OK)
+        {
+            recv_count++;
+        }
+    } while ((int32_t)(end - osKernelGetTickCount()) > 0);
+    /* 最后一次发送的应答已在队列中，返回前处理掉 */
+    (void)comm_mgr_process(&mgr, 0U, 0U);
+    while (comm_ctrl_get_recv_data(&link0, &recv) == COMM_OK)
+    {
+        recv_count++;
+    }
+}
+
+static uint32_t rejected(void)
+{
+    comm_stats_t stats;
+
+    (void)comm_ctrl_get_stats(&link0, &stats);
+    return stats.rejected;
+}
+
+/* comm_mgr 的链路和独立控制器一样用编译好的状态机跳转表和消息分发表 */
+static void test_compiled_tables(void)
+{
+    check(link0.fsm.jump != NULL, "a comm_mgr link uses the compiled fsm table");
+    check(link0.msg_dispatch != NULL && link0.msg_dispatch->slots != NULL,
+          "a comm_mgr link dispatches through the compiled table");
+}
+
+/* 未设置命令表的链路按内置表检查应答 ID 和长度，每帧只检查一次 */
+static void test_recv_check(void)
+{
+    uint8_t unknown[3] = {0x07U, 0x00U, 0x00U};
+    uint32_t sent = 0U;
+
+    run_worker(50U);
+    check(sent_count > 0U && recv_count == sent_count && rejected() == 0U,
+          "responses of the table's length are delivered");
+
+    resp_len_delta = 1;
+    sent = sent_count;
+    recv_count = 0U;
+    run_worker(50U);
+    sent = sent_count - sent;
+    check(sent > 0U && recv_count == 0U, "a wrong-length response is not delivered");
+    check(rejected() == sent, "a wrong-length response is rejected once");
+
+    resp_len_delta = 0;
+    check(comm_ctrl_save_recv_data(&link0, unknown, sizeof(unknown)) == COMM_ERROR && rejected() == sent + 1U,
+          "a response id missing from the table is rejected");
+}
+
+/* 队列满时直接写入的更新不会被队列中滞后的旧更新覆盖，最后一次调用生效 */
+static void test_period_update_order(void)
+{
+    comm_data_t cmd;
+    uint32_t i = 0U;
+
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.comm_id = TEST_PERIOD_CMD;
+    cmd.comm_len = 1U;
+    run_worker(20U);    /* 控制器已运行，更新先走队列 */
+    for (i = 0U; i < TEST_UPDATES; i++)
+    {
+        cmd.comm_data[0] = (uint8_t)i;
+        (void)comm_ctrl_send_period_command(&link0, &cmd);
+    }
+    run_worker(50U);
+    check(link0.period_cmd.comm_data[0] == (uint8_t)(TEST_UPDATES - 1U) &&
+          sent_data == (uint8_t)(TEST_UPDATES - 1U), "the last period command update wins");
+}
+
+void app_thread(void *argument)
+{
+    comm_data_t cmd;
+
+    (void)argument;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.comm_id = TEST_PERIOD_CMD;
+    comm_mgr_init(&mgr, 1U, 0U);
+    comm_mgr_add_link(&mgr, &link0, NULL);
+    comm_ctrl_set_stats(&link0, &link0_stats);
+    comm_ctrl_set_send_func(&link0, loopback_send_func, &link0);
+    comm_ctrl_set_poll_mode(&link0, COMM_POLL_MODE_FIXED, TEST_POLL_MS);
+    comm_ctrl_send_period_command(&link0, &cmd);
+    comm_ctrl_start(&link0);
+
+    test_compiled_tables();
+    test_period_update_order();
+    test_recv_check();
+
+    printf("%s\n", (failures == 0U) ? "PASS" : "FAIL");
+    exit((failures == 0U) ? 0 : 1);
+}
+
+int main(int argc, char *argv[])
+{
+    osKernelInitialize();
+
+    osThreadNew(app_thread, NULL, NULL);
+
+    osKernelStart();  // 启动RTOS调度器,不会返回
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "comm_mgr.h"
+
+#define TEST_LINK_NUM       200U
+#define TEST_WORKER_NUM     4U
+#define TEST_B2B_GAP_MS     2U      /* the app drains every 1 ms, keep back-to-back links below that rate */
+#define TEST_REPORT_MS      1000U
+
+comm_mgr_t comm_mgr_instance;
+comm_ctrl_t comm_links[TEST_LINK_NUM];
+uint32_t resp_count[TEST_LINK_NUM];
+comm_stats_t link0_stats;     /* only link 0 is watched, the others run without a stats block */
+
+/* 回环从机：收到命令后立即以 id + 1 应答 */
+static void loopback_send_func(void *ctx, uint8_t *data, uint16_t len)
+{
+    comm_ctrl_t *ctrl = (comm_ctrl_t *)ctx;
+    uint8_t resp[COMM_DATA_MAX_LEN] = {0};
+
+    resp[0] = (uint8_t)(data[0] + 1U);
+    resp[1] = (uint8_t)len;
+    comm_ctrl_save_recv_data(ctrl, resp, 2U);
+}
+
+static void print_link_stats(uint16_t link)
+{
+    comm_stats_t stats;
+    const comm_stats_cmd_t *entry = NULL;
+
+    if (comm_ctrl_get_stats(&comm_links[link], &stats) != COMM_OK)
+    {
+        return;
+    }
+    entry = comm_stats_find(&stats, 0xf0);
+    if (entry != NULL)
+    {
+        printf("  link%u cmd 0xf0: sent %u, matched %u, timeouts %u, p50 %u, p99 %u, max %u ticks\n",
+               link, entry->sent, entry->matched, entry->timeouts,
+               comm_stats_percentile(entry, 500U), comm_stats_percentile(entry, 990U), entry->latency_max);
+    }
+}
+
+void app_thread(void *argument)
+{
+    comm_data_t cmd;
+    comm_data_t recv;
+    uint32_t total = 0U;
+    uint32_t next_report = 0U;
+    uint16_t i = 0U;
+
+    cmd.comm_id = 0xf0;
+    cmd.comm_len = 2;
+    cmd.comm_data[0] = 0x10;
+    cmd.comm_data[1] = 0x70;
+
+    comm_mgr_init(&comm_mgr_instance, TEST_WORKER_NUM, 0U);
+    for (i = 0U; i < TEST_LINK_NUM; i++)
+    {
+        comm_mgr_add_link(&comm_mgr_instance, &comm_links[i], NULL);
+        comm_ctrl_set_send_func(&comm_links[i], loopback_send_func, &comm_links[i]);
+        if (i == 0U)
+        {
+            comm_ctrl_set_stats(&comm_links[i], &link0_stats);
+        }
+        comm_ctrl_send_period_command(&comm_links[i], &cmd);
+        if ((i % 2U) != 0U)
+        {
+            /* 奇数链路：收到应答后等待 TEST_B2B_GAP_MS 再发送下一条 */
+            comm_ctrl_set_poll_mode(&comm_links[i], COMM_POLL_MODE_BACK_TO_BACK, TEST_B2B_GAP_MS);
+        }
+        comm_ctrl_start(&comm_links[i]);
+    }
+    comm_mgr_start(&comm_mgr_instance);
+    next_report = osKernelGetTickCount() + TEST_REPORT_MS;
+    printf("links: %u, workers: %u, bytes per link: %zu\n",
+           TEST_LINK_NUM, TEST_WORKER_NUM, sizeof(comm_ctrl_t));
+
+    while(1)
+    {
+        for (i = 0U; i < TEST_LINK_NUM; i++)
+        {
+            while (comm_ctrl_get_recv_data(&comm_links[i], &recv) == COMM_OK)
+            {
+                resp_count[i]++;
+                total++;
+            }
+        }
+        if ((int32_t)(osKernelGetTickCount() - next_report) >= 0)
+        {
+            next_report += TEST_REPORT_MS;
+            printf("total responses: %u, fixed link0: %u, back-to-back link%u: %u\n",
+                   total, resp_count[0], TEST_LINK_NUM - 1U, resp_count[TEST_LINK_NUM - 1U]);
+            print_link_stats(0U);
+        }
+        osDelay(1);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    osKernelInitialize();
+    
+    osThreadNew(app_thread, NULL, NULL);
+    
+    osKernelStart();  // 启动RTOS调度器,不会返回
+    
+    return 0;
+}
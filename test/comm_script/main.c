@@ -0,0 +1,336 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "comm_script.h"
+#include "comm_table.h"
+
+#define TEST_ENTER_SETTING  0x20U
+#define TEST_EXIT_SETTING   0x22U
+#define TEST_FC_SET         0x04U
+#define TEST_PERIOD_CMD     0xF0U
+#define TEST_LOG_SIZE       64U
+
+comm_ctrl_t comm_ctrl_instance;
+static comm_script_t scripts[2];
+static volatile comm_script_state_t done_state[2];
+static volatile uint32_t done_count[2];
+static volatile uint8_t wrong_resp_id;     /* 从机对该命令回另一条命令的应答 */
+static volatile bool submit_second;         /* 第一步发出时再提交 scripts[1] */
+static uint8_t sent_log[TEST_LOG_SIZE];
+static volatile uint32_t sent_count;
+static uint32_t failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-52s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+/* 长度相同的另一条命令的应答：能通过接收检查，但不是本步等待的应答 */
+static uint8_t wrong_resp_of(const comm_cmd_table_t *entry)
+{
+    const comm_table_t *table = comm_table_default();
+    uint8_t i = 0U;
+
+    for (i = 0U; i < table->count; i++)
+    {
+        if (table->entries[i].resp_cmd_id != entry->resp_cmd_id &&
+            table->entries[i].resp_data_len == entry->resp_data_len)
+        {
+            return table->entries[i].resp_cmd_id;
+        }
+    }
+    return entry->resp_cmd_id;
+}
+
+/* 回环从机：按命令表的应答 ID 和长度应答，并记录发送顺序 */
+static void loopback_send_func(void *ctx, uint8_t *data, uint16_t len)
+{
+    comm_ctrl_t *ctrl = (comm_ctrl_t *)ctx;
+    const comm_cmd_table_t *entry = comm_table_find_by_send(data[0]);
+    uint8_t resp[COMM_DATA_MAX_LEN] = {0};
+    uint16_t resp_len = 2U;
+
+    (void)len;
+    if (sent_count < TEST_LOG_SIZE)
+    {
+        sent_log[sent_count] = data[0];
+    }
+    sent_count++;
+    if (entry == NULL)
+    {
+        return;
+    }
+    resp[0] = entry->resp_cmd_id;
+    if (entry->resp_data_len != 0U)
+    {
+        resp_len = (uint16_t)(entry->resp_data_len + 1U);
+    }
+    if (submit_second && data[0] == TEST_ENTER_SETTING)
+    {
+        /* 此时 scripts[0] 仍在运行，提交消息排在本步应答之前 */
+        submit_second = false;
+        (void)comm_ctrl_run_script(ctrl, &scripts[1]);
+    }
+    if (data[0] == wrong_resp_id)
+    {
+        resp[0] = wrong_resp_of(entry);
+    }
+    comm_ctrl_save_recv_data(ctrl, resp, resp_len);
+}
+
+static void script_done(void *ctx, comm_script_t *script)
+{
+    uint32_t idx = (uint32_t)(uintptr_t)ctx;
+
+    done_state[idx] = script->state;
+    done_count[idx]++;
+}
+
+static void make_cmd(comm_data_t *cmd, uint8_t id, uint8_t value)
+{
+    memset(cmd, 0, sizeof(comm_data_t));
+    cmd->comm_id = id;
+    cmd->comm_len = 1U;
+    cmd->comm_data[0] = value;
+}
+
+/* ENTER_SETTING, FC_SET, EXIT_SETTING，应答 ID 取自命令表 */
+static void build_setting_script(comm_script_t *script, uint32_t idx)
+{
+    comm_data_t cmd;
+
+    comm_script_init(script, script_done, (void *)(uintptr_t)idx);
+    make_cmd(&cmd, TEST_ENTER_SETTING, 0U);
+    (void)comm_script_add(script, &cmd, 0U);
+    make_cmd(&cmd, TEST_FC_SET, 3U);
+    (void)comm_script_add(script, &cmd, 0U);
+    make_cmd(&cmd, TEST_EXIT_SETTING, 0U);
+    (void)comm_script_add(script, &cmd, 0U);
+}
+
+static comm_data_t resp_of(const comm_script_t *script, uint8_t step, int8_t id_offset)
+{
+    comm_data_t resp;
+
+    memset(&resp, 0, sizeof(resp));
+    resp.comm_id = (uint8_t)(script->steps[step].expect_resp_id + id_offset);
+    return resp;
+}
+
+/* 控制器钩子按步推进，时间由测试给定 */
+static void test_stepping(void)
+{
+    comm_script_t *script = &scripts[0];
+    comm_data_t resp;
+    uint8_t i = 0U;
+    bool ok = true;
+
+    build_setting_script(script, 0U);
+    comm_script_begin(script, NULL, 100U);
+    check(script->step_count == 3U && script->steps[1].expect_resp_id == 0x05U, "steps take response ids from the table");
+    for (i = 0U; i < 3U; i++)
+    {
+        ok = ok && (comm_script_current(script) == &script->steps[i]);
+        comm_script_on_sent(script, 100U + (10U * i));
+        resp = resp_of(script, i, 0);
+        ok = ok && (comm_script_on_resp(script, &resp, 104U + (10U * i)) ==
+                    ((i < 2U) ? COMM_SCRIPT_STATE_RUNNING : COMM_SCRIPT_STATE_DONE));
+        ok = ok && (script->steps[i].result == COMM_OK) && (script->steps[i].elapsed_ms == 4U);
+    }
+    check(ok, "steps run in order with per-step timing");
+    check(comm_script_current(script) == NULL && script->elapsed_ms == 24U, "done script has no current step");
+    check(comm_script_add(script, &script->steps[0].cmd, 0U) == COMM_OK, "idle script takes more steps");
+}
+
+/* 超时后同一步骤循环重发，直到重试次数用尽 */
+static void test_retry_loop(void)
+{
+    comm_script_t *script = &scripts[0];
+    comm_script_step_t *step = NULL;
+    comm_data_t resp;
+    uint16_t i = 0U;
+    bool ok = true;
+
+    build_setting_script(script, 0U);
+    comm_script_begin(script, NULL, 0U);
+    step = comm_script_current(script);
+    for (i = 0U; i < step->retry; i++)
+    {
+        comm_script_on_sent(script, 10U * i);
+        ok = ok && (comm_script_on_timeout(script, (10U * i) + 5U) == COMM_SCRIPT_STATE_RUNNING);
+        ok = ok && (comm_script_current(script) == step);
+    }
+    comm_script_on_sent(script, 10U * i);
+    resp = resp_of(script, 0U, 0);
+    (void)comm_script_on_resp(script, &resp, (10U * i) + 2U);
+    check(ok && step->attempts == step->retry + 1U, "timed out step is resent until the last retry");
+    check(step->result == COMM_OK && step->elapsed_ms == (10U * i) + 2U, "step time counts from the first send");
+
+    /* 下一步一直超时，整个脚本失败 */
+    step = comm_script_current(script);
+    for (i = 0U; i <= step->retry; i++)
+    {
+        comm_script_on_sent(script, 100U + i);
+        (void)comm_script_on_timeout(script, 100U + i);
+    }
+    check(script->state == COMM_SCRIPT_STATE_FAILED && step->result == COMM_RETRY_EXHAUSTED &&
+          script->current == 1U, "exhausted retries fail the script at that step");
+}
+
+/* 应答 ID、超时与重发次数取自运行脚本的控制器的命令表，而不是内置表 */
+static void test_device_table(void)
+{
+    static const comm_cmd_table_t entries[] = {
+        {TEST_ENTER_SETTING, 0x21U, 7U, 1U, 0U, 0U},
+        {TEST_FC_SET,        0x45U, 9U, 2U, 0U, 0U},
+        {TEST_EXIT_SETTING,  0x23U, 11U, 0U, 0U, 0U},
+    };
+    static comm_table_t table;
+    comm_script_t *script = &scripts[0];
+
+    (void)comm_table_build(&table, entries, 3U);
+    build_setting_script(script, 0U);
+    comm_script_begin(script, &table, 0U);
+    check(script->state == COMM_SCRIPT_STATE_RUNNING && script->steps[1].expect_resp_id == 0x45U &&
+          script->steps[1].timeout_ms == 9U && script->steps[1].retry == 2U, "steps resolve against the given table");
+
+    (void)comm_table_build(&table, entries, 2U);
+    build_setting_script(script, 0U);
+    comm_script_begin(script, &table, 0U);
+    check(script->state == COMM_SCRIPT_STATE_IDLE, "step missing from the table does not start");
+}
+
+/* 错误应答立即终止，其后的步骤不再发送；重新开始时步骤被复位 */
+static void test_abort(void)
+{
+    comm_script_t *script = &scripts[0];
+    comm_data_t resp;
+
+    build_setting_script(script, 0U);
+    comm_script_begin(script, NULL, 0U);
+    comm_script_on_sent(script, 0U);
+    resp = resp_of(script, 0U, 0);
+    (void)comm_script_on_resp(script, &resp, 1U);
+    comm_script_on_sent(script, 1U);
+    resp = resp_of(script, 1U, 2);
+    check(comm_script_on_resp(script, &resp, 2U) == COMM_SCRIPT_STATE_FAILED &&
+          script->steps[1].result == COMM_ERROR && script->current == 1U, "wrong response aborts the script");
+    check(script->steps[2].attempts == 0U && script->steps[2].result == COMM_INCOMPLETE, "later steps are never sent");
+    check(comm_script_current(script) == NULL, "aborted script has no current step");
+
+    comm_script_begin(script, NULL, 10U);
+    check(script->state == COMM_SCRIPT_STATE_RUNNING && script->current == 0U &&
+          script->steps[1].attempts == 0U && script->steps[1].result == COMM_INCOMPLETE, "restart resets every step");
+    check(comm_script_add(script, &script->steps[0].cmd, 0U) != COMM_OK, "running script takes no steps");
+}
+
+/* 应用取走周期命令的应答 */
+static void drain_recv(uint32_t ms)
+{
+    comm_data_t recv;
+    uint32_t end = osKernelGetTickCount() + ms;
+
+    do
+    {
+        while (comm_ctrl_get_recv_data(&comm_ctrl_instance, &recv) == COMM_OK)
+        {
+        }
+        osDelay(1);
+    } while ((int32_t)(end - osKernelGetTickCount()) > 0);
+}
+
+static bool wait_done(uint32_t idx, uint32_t count, uint32_t ms)
+{
+    uint32_t end = osKernelGetTickCount() + ms;
+
+    while (done_count[idx] < count && (int32_t)(end - osKernelGetTickCount()) > 0)
+    {
+        drain_recv(1U);
+    }
+    return done_count[idx] >= count;
+}
+
+/* 在控制器上运行：步骤之间不插入周期命令 */
+static void test_controller(void)
+{
+    comm_data_t cmd;
+    uint32_t first = 0U;
+    uint32_t i = 0U;
+
+    make_cmd(&cmd, TEST_PERIOD_CMD, 0U);
+    comm_ctrl_send_period_command(&comm_ctrl_instance, &cmd);
+    comm_ctrl_set_poll_mode(&comm_ctrl_instance, COMM_POLL_MODE_FIXED, 5U);
+    comm_ctrl_start(&comm_ctrl_instance);
+    drain_recv(30U);
+
+    build_setting_script(&scripts[0], 0U);
+    build_setting_script(&scripts[1], 1U);
+    first = sent_count;
+    submit_second = true;
+    check(comm_ctrl_run_script(&comm_ctrl_instance, &scripts[0]) == COMM_OK, "script submitted");
+    check(wait_done(0U, 1U, 1000U) && done_state[0] == COMM_SCRIPT_STATE_DONE, "script completes on the controller");
+    check(wait_done(1U, 1U, 1000U) && done_state[1] == COMM_SCRIPT_STATE_FAILED, "script submitted while one runs is refused");
+    for (i = first; (i < sent_count) && (i < TEST_LOG_SIZE) && (sent_log[i] != TEST_ENTER_SETTING); i++)
+    {
+    }
+    check((i + 2U < TEST_LOG_SIZE) && sent_log[i + 1U] == TEST_FC_SET && sent_log[i + 2U] == TEST_EXIT_SETTING,
+          "steps go out back to back");
+
+    /* 从机对 FC_SET 回错误应答：脚本停在该步，EXIT_SETTING 不发送 */
+    wrong_resp_id = TEST_FC_SET;
+    build_setting_script(&scripts[0], 0U);
+    first = sent_count;
+    (void)comm_ctrl_run_script(&comm_ctrl_instance, &scripts[0]);
+    check(wait_done(0U, 2U, 1000U) && done_state[0] == COMM_SCRIPT_STATE_FAILED && scripts[0].current == 1U,
+          "wrong response stops the script on the controller");
+    drain_recv(30U);
+    for (i = first; (i < sent_count) && (i < TEST_LOG_SIZE); i++)
+    {
+        if (sent_log[i] == TEST_EXIT_SETTING)
+        {
+            break;
+        }
+    }
+    check(i >= sent_count || i >= TEST_LOG_SIZE, "steps after the failure are not sent");
+    check(scripts[0].steps[1].attempts == 1U, "failed step was sent once");
+}
+
+void ctrl_thread(void *argument)
+{
+    while(1)
+    {
+        comm_ctrl_process(&comm_ctrl_instance, 100);
+    }
+}
+
+void app_thread(void *argument)
+{
+    test_stepping();
+    test_retry_loop();
+    test_abort();
+    test_device_table();
+
+    comm_ctrl_init(&comm_ctrl_instance);
+    comm_ctrl_set_send_func(&comm_ctrl_instance, loopback_send_func, &comm_ctrl_instance);
+    osThreadNew(ctrl_thread, NULL, NULL);
+    test_controller();
+
+    printf("%s\n", (failures == 0U) ? "PASS" : "FAIL");
+    exit((failures == 0U) ? 0 : 1);
+}
+
+int main(int argc, char *argv[])
+{
+    osKernelInitialize();
+    
+    osThreadNew(app_thread, NULL, NULL);
+    
+    osKernelStart();  // 启动RTOS调度器,不会返回
+    
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include "comm_table.h"
+#include "comm_table_json.h"
+
+#define TEST_LOOKUP_NUM     10000000U
+
+static comm_table_t x7_table;
+static comm_table_t ap3_table;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/* 每个表项都能按发送 ID 和应答 ID 互相找到 */
+static uint32_t check_table(const char *name, const comm_table_t *table)
+{
+    const comm_cmd_table_t *entry = NULL;
+    uint32_t bad = 0U;
+    uint8_t i = 0U;
+
+    for (i = 0U; i < table->count; i++)
+    {
+        entry = comm_table_lookup_send(table, table->entries[i].send_cmd_id);
+        if (entry == NULL || entry->resp_cmd_id != table->entries[i].resp_cmd_id)
+        {
+            bad++;
+        }
+        entry = comm_table_lookup_resp(table, table->entries[i].resp_cmd_id);
+        if (entry == NULL || entry->send_cmd_id != table->entries[i].send_cmd_id)
+        {
+            bad++;
+        }
+    }
+    printf("%s: %u commands, %u bad lookups\n", name, table->count, bad);
+    return bad;
+}
+
+int main(int argc, char *argv[])
+{
+    const comm_cmd_table_t *entry = NULL;
+    const char *bad_json = "{\"commands\": [{\"cmd_id\": \"F0\", \"resp_id\": \"XYZ\"}]}";
+    const char *big_json = "{\"commands\": [\n"
+                           "  {\"cmd_id\": \"F0\", \"resp_id\": \"F1\", \"resp_data_len\": 13},\n"
+                           "  {\"cmd_id\": \"20\", \"resp_id\": \"21\", \"timeout\": 65536}\n"
+                           "]}";
+    comm_table_json_error_t err;
+    volatile uint32_t sink = 0U;
+    uint64_t start = 0U;
+    uint32_t bad = 0U;
+    uint32_t i = 0U;
+
+    (void)argc;
+    (void)argv;
+    if (comm_table_load_json(&x7_table, SLAVE_DIR "/x7_cmd.json", NULL) != COMM_OK ||
+        comm_table_load_json(&ap3_table, SLAVE_DIR "/ap3_cmd.json", NULL) != COMM_OK)
+    {
+        printf("load failed\n");
+        return 1;
+    }
+    bad += check_table("builtin", comm_table_default());
+    bad += check_table("x7", &x7_table);
+    bad += check_table("ap3", &ap3_table);
+
+    /* 0x54 在 X7 上是 CLM_START，AP3 与内置表没有 */
+    entry = comm_table_lookup_send(&x7_table, 0x54);
+    printf("0x54: x7 %s (timeout %u, retry %u), ap3 %s, builtin %s\n",
+           (entry != NULL) ? "found" : "missing",
+           (entry != NULL) ? entry->timeout : 0U, (entry != NULL) ? entry->retry_count : 0U,
+           (comm_table_lookup_send(&ap3_table, 0x54) != NULL) ? "found" : "missing",
+           (comm_table_find_by_send(0x54) != NULL) ? "found" : "missing");
+    if (entry == NULL || comm_table_lookup_send(&ap3_table, 0x54) != NULL)
+    {
+        bad++;
+    }
+    /* 应答长度随机型不同：USER_OPERATION 在 X7 为 13 字节，AP3 为 15 字节 */
+    entry = comm_table_lookup_resp(&x7_table, 0xF1);
+    printf("0xF1 resp len: x7 %u, ap3 %u\n", (entry != NULL) ? entry->resp_data_len : 0U,
+           comm_table_lookup_resp(&ap3_table, 0xF1)->resp_data_len);
+    if (entry == NULL || entry->resp_data_len != 13U || comm_table_lookup_resp(&ap3_table, 0xF1)->resp_data_len != 15U)
+    {
+        bad++;
+    }
+    if (comm_table_parse_json(&ap3_table, bad_json, strlen(bad_json), NULL) == COMM_OK)
+    {
+        printf("bad id accepted\n");
+        bad++;
+    }
+    /* 超出字段范围的数值不截断，报告所在行和键 */
+    if (comm_table_parse_json(&ap3_table, big_json, strlen(big_json), &err) == COMM_OK ||
+        err.line != 3U || strcmp(err.key, "timeout") != 0)
+    {
+        printf("overflowing timeout accepted or misreported (line %u, key \"%s\")\n", err.line, err.key);
+        bad++;
+    }
+
+    start = now_ns();
+    for (i = 0U; i < TEST_LOOKUP_NUM; i++)
+    {
+        entry = comm_table_lookup_send(&x7_table, (uint8_t)i);
+        sink += (entry != NULL) ? entry->timeout : 0U;
+    }
+    printf("lookup: %llu ps each\n", (unsigned long long)(((now_ns() - start) * 1000ULL) / TEST_LOOKUP_NUM));
+    printf("%s\n", (bad == 0U) ? "PASS" : "FAIL");
+    return (bad == 0U) ? 0 : 1;
+}
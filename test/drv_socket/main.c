@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "comm_mgr.h"
+#include "lib_comm.h"
+#include "drv_socket.h"
+#include "drv_uring.h"
+
+/* 多个 TCP 桥接：每条链路一个连接，一个 io_uring（内核不支持时用 epoll reactor）线程负责全部收发 */
+#define TEST_LINK_NUM       8U
+#define TEST_WORKER_NUM     2U
+#define TEST_HOST           "127.0.0.1"
+#define TEST_PORT           9000U
+
+comm_mgr_t comm_mgr_instance;
+comm_ctrl_t comm_links[TEST_LINK_NUM];
+lib_comm_link_t lib_links[TEST_LINK_NUM];
+drv_socket_conn_t socket_conns[TEST_LINK_NUM];
+drv_socket_reactor_t socket_reactor;
+drv_uring_t socket_uring;
+int use_uring;
+uint32_t resp_count[TEST_LINK_NUM];
+comm_stats_t link_stats[TEST_LINK_NUM];
+
+void reactor_thread(void *argument)
+{
+    while(1)
+    {
+        if (use_uring)
+        {
+            (void)drv_uring_poll(&socket_uring, 100);
+        }
+        else
+        {
+            (void)drv_socket_reactor_poll(&socket_reactor, 100);
+        }
+    }
+}
+
+void app_thread(void *argument)
+{
+    comm_data_t cmd;
+    comm_data_t recv;
+    comm_stats_t stats;
+    uint32_t ticks = 0U;
+    uint16_t i = 0U;
+
+    cmd.comm_id = 0xf0;
+    cmd.comm_len = 2;
+    cmd.comm_data[0] = 0x10;
+    cmd.comm_data[1] = 0x70;
+
+    comm_mgr_init(&comm_mgr_instance, TEST_WORKER_NUM, 0U);
+    if (use_uring && (drv_uring_init(&socket_uring) != COMM_OK))
+    {
+        use_uring = 0;
+    }
+    if (!use_uring)
+    {
+        drv_socket_reactor_init(&socket_reactor);
+    }
+    printf("transport: %s\n", use_uring ? "io_uring" : "epoll");
+    for (i = 0U; i < TEST_LINK_NUM; i++)
+    {
+        comm_mgr_add_link(&comm_mgr_instance, &comm_links[i], NULL);
+        lib_comm_link_init(&lib_links[i], &comm_links[i]);
+        comm_ctrl_set_stats(&comm_links[i], &link_stats[i]);
+        drv_socket_conn_init(&socket_conns[i]);
+        /* 网桥重启后按退避自动重连，断线期间的旧命令直接丢弃 */
+        drv_socket_conn_set_reconnect(&socket_conns[i], 1, 0U, 0U, DRV_SOCKET_TX_DROP);
+        if (drv_socket_conn_open(&socket_conns[i], TEST_HOST, TEST_PORT, 1) != 0)
+        {
+            printf("link%u: connect failed\n", i);
+            continue;
+        }
+        drv_socket_conn_tx_init(&socket_conns[i], 0U);
+        lib_comm_link_attach_socket(&lib_links[i], &socket_conns[i]);
+        /* 还没连上的链路也加入，连接和重连都由收发线程完成 */
+        if (use_uring)
+        {
+            (void)drv_uring_add(&socket_uring, &socket_conns[i], DRV_URING_FD_SOCKET);
+        }
+        else
+        {
+            (void)drv_socket_reactor_add(&socket_reactor, &socket_conns[i]);
+        }
+        comm_ctrl_send_period_command(&comm_links[i], &cmd);
+        comm_ctrl_start(&comm_links[i]);
+    }
+    comm_mgr_start(&comm_mgr_instance);
+    osThreadNew(reactor_thread, NULL, NULL);
+
+    while(1)
+    {
+        for (i = 0U; i < TEST_LINK_NUM; i++)
+        {
+            while (comm_ctrl_get_recv_data(&comm_links[i], &recv) == COMM_OK)
+            {
+                resp_count[i]++;
+            }
+        }
+        if ((++ticks % 100U) == 0U)
+        {
+            for (i = 0U; i < TEST_LINK_NUM; i++)
+            {
+                comm_ctrl_get_stats(&comm_links[i], &stats);
+                printf("link%u: connected %d, reconnects %u, responses %u, rejected %u\n", i,
+                       drv_socket_conn_is_connected(&socket_conns[i]), socket_conns[i].reconnects,
+                       resp_count[i], stats.rejected);
+            }
+        }
+        osDelay(10);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    /* "epoll" 参数强制使用 epoll reactor */
+    use_uring = !((argc > 1) && (strcmp(argv[1], "epoll") == 0));
+
+    osKernelInitialize();
+
+    osThreadNew(app_thread, NULL, NULL);
+
+    osKernelStart();  // 启动RTOS调度器,不会返回
+
+    return 0;
+}
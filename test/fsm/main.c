@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "fsm.h"
+
+enum { TEST_STATE_IDLE = 0, TEST_STATE_BUSY, TEST_STATE_DONE, TEST_STATE_MAX };
+enum { TEST_EVENT_GO = 0, TEST_EVENT_FINISH, TEST_EVENT_RESET, TEST_EVENT_MAX };
+
+#define TEST_TABLE_SIZE(t)  (sizeof(t) / sizeof((t)[0]))
+#define TEST_RING_SIZE      4U
+
+static struct fsm_cell cells[TEST_STATE_MAX * TEST_EVENT_MAX];
+static uint32_t go_count;
+static uint32_t finish_count;
+static uint32_t failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-52s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+static void on_go(void *handle)
+{
+    (void)handle;
+    go_count++;
+}
+
+static void on_finish(void *handle)
+{
+    (void)handle;
+    finish_count++;
+}
+
+static const struct fsm_transition good_table[] = {
+    {TEST_STATE_IDLE, TEST_EVENT_GO,     TEST_STATE_BUSY, on_go    },
+    {TEST_STATE_BUSY, TEST_EVENT_FINISH, TEST_STATE_DONE, on_finish},
+    {TEST_STATE_DONE, TEST_EVENT_RESET,  TEST_STATE_IDLE, NULL     },
+};
+
+/* 同一 (状态, 事件) 出现两次且结果相同 */
+static const struct fsm_transition duplicate_table[] = {
+    {TEST_STATE_IDLE, TEST_EVENT_GO,     TEST_STATE_BUSY, on_go    },
+    {TEST_STATE_BUSY, TEST_EVENT_FINISH, TEST_STATE_DONE, on_finish},
+    {TEST_STATE_IDLE, TEST_EVENT_GO,     TEST_STATE_BUSY, on_go    },
+};
+
+/* 同一 (状态, 事件) 出现两次但下一状态不同 */
+static const struct fsm_transition next_conflict_table[] = {
+    {TEST_STATE_IDLE, TEST_EVENT_GO,     TEST_STATE_BUSY, on_go    },
+    {TEST_STATE_IDLE, TEST_EVENT_GO,     TEST_STATE_DONE, on_go    },
+};
+
+/* 同一 (状态, 事件) 出现两次但动作不同 */
+static const struct fsm_transition action_conflict_table[] = {
+    {TEST_STATE_BUSY, TEST_EVENT_FINISH, TEST_STATE_DONE, on_finish},
+    {TEST_STATE_IDLE, TEST_EVENT_GO,     TEST_STATE_BUSY, on_go    },
+    {TEST_STATE_BUSY, TEST_EVENT_FINISH, TEST_STATE_DONE, on_go    },
+};
+
+static const struct fsm_transition range_table[] = {
+    {TEST_STATE_IDLE, TEST_EVENT_GO,     TEST_STATE_BUSY, on_go    },
+    {TEST_STATE_BUSY, TEST_EVENT_MAX,    TEST_STATE_DONE, on_finish},
+};
+
+/* 停在 IDLE，只统计事件处理次数 */
+static const struct fsm_transition tick_table[] = {
+    {TEST_STATE_IDLE, TEST_EVENT_GO,     TEST_STATE_IDLE, on_go    },
+    {TEST_STATE_IDLE, TEST_EVENT_FINISH, TEST_STATE_IDLE, on_finish},
+};
+
+/* 编译结果：正常表可以派发，重复和冲突的表被拒绝并指出出错的表项 */
+static void test_compile(void)
+{
+    fsm_jump_t jump;
+    fsm_t fsm;
+    size_t bad_index = 0U;
+    fsm_compile_result_t result = FSM_COMPILE_OK;
+
+    result = fsm_compile(&jump, good_table, TEST_TABLE_SIZE(good_table), cells,
+                         TEST_STATE_MAX, TEST_EVENT_MAX, &bad_index);
+    check(result == FSM_COMPILE_OK && jump.cells == cells, "valid table compiles");
+    fsm_init(&fsm, good_table, TEST_TABLE_SIZE(good_table), TEST_STATE_IDLE, NULL);
+    fsm_use_jump_table(&fsm, &jump);
+    check(fsm.jump == &jump, "compiled table is attached");
+    check(fsm_process_event(&fsm, TEST_EVENT_FINISH) == 0U && fsm.state == TEST_STATE_IDLE,
+          "pair without a transition is ignored");
+    check(fsm_process_event(&fsm, TEST_EVENT_GO) == 1U && fsm.state == TEST_STATE_BUSY && go_count == 1U,
+          "jump table runs the action and moves on");
+    check(fsm_process_event(&fsm, TEST_EVENT_FINISH) == 1U && fsm.state == TEST_STATE_DONE && finish_count == 1U,
+          "next transition follows from the new state");
+    check(fsm_process_event(&fsm, TEST_EVENT_RESET) == 1U && fsm.state == TEST_STATE_IDLE,
+          "transition without an action still moves on");
+
+    bad_index = 0U;
+    result = fsm_compile(&jump, duplicate_table, TEST_TABLE_SIZE(duplicate_table), cells,
+                         TEST_STATE_MAX, TEST_EVENT_MAX, &bad_index);
+    check(result == FSM_COMPILE_DUPLICATE && bad_index == 2U, "same pair with the same outcome is a DUPLICATE");
+    check(jump.cells == NULL, "rejected table leaves no jump table");
+    fsm_use_jump_table(&fsm, &jump);
+    check(fsm.jump == NULL, "rejected table keeps the linear scan");
+
+    bad_index = 0U;
+    result = fsm_compile(&jump, next_conflict_table, TEST_TABLE_SIZE(next_conflict_table), cells,
+                         TEST_STATE_MAX, TEST_EVENT_MAX, &bad_index);
+    check(result == FSM_COMPILE_CONFLICT && bad_index == 1U, "same pair with another next state is a CONFLICT");
+
+    bad_index = 0U;
+    result = fsm_compile(&jump, action_conflict_table, TEST_TABLE_SIZE(action_conflict_table), cells,
+                         TEST_STATE_MAX, TEST_EVENT_MAX, &bad_index);
+    check(result == FSM_COMPILE_CONFLICT && bad_index == 2U, "same pair with another action is a CONFLICT");
+
+    bad_index = 0U;
+    result = fsm_compile(&jump, range_table, TEST_TABLE_SIZE(range_table), cells,
+                         TEST_STATE_MAX, TEST_EVENT_MAX, &bad_index);
+    check(result == FSM_COMPILE_RANGE && bad_index == 1U, "event outside the jump table is out of RANGE");
+    result = fsm_compile(&jump, good_table, TEST_TABLE_SIZE(good_table), cells,
+                         TEST_STATE_DONE, TEST_EVENT_MAX, &bad_index);
+    check(result == FSM_COMPILE_RANGE && bad_index == 1U, "next state outside the jump table is out of RANGE");
+    result = fsm_compile(&jump, good_table, TEST_TABLE_SIZE(good_table), NULL,
+                         TEST_STATE_MAX, TEST_EVENT_MAX, &bad_index);
+    check(result == FSM_COMPILE_INVALID, "missing cell storage is INVALID");
+}
+
+static void send_repeat(fsm_t *fsm, event_t event, uint32_t n)
+{
+    uint32_t i = 0U;
+
+    for (i = 0U; i < n; i++)
+    {
+        fsm_send_event(fsm, event);
+    }
+}
+
+/*
+ * GO 是幂等事件：挂起期间重复发送只计入 coalesced，不占队列；FINISH 逐个入队，
+ * 队列满时丢弃并计入 dropped。local ring 与 mpsc ring 行为一致
+ */
+static void check_coalescing(fsm_t *fsm, const char *ring)
+{
+    char what[80];
+    uint32_t coalesced = 0U;
+    uint32_t dropped = 0U;
+
+    go_count = 0U;
+    finish_count = 0U;
+    fsm_set_coalesce(fsm, 1UL << TEST_EVENT_GO);
+
+    send_repeat(fsm, TEST_EVENT_GO, 3U);
+    fsm_get_event_counters(fsm, &coalesced, &dropped);
+    snprintf(what, sizeof(what), "%s: pending duplicates are merged", ring);
+    check(coalesced == 2U && dropped == 0U, what);
+
+    send_repeat(fsm, TEST_EVENT_FINISH, TEST_RING_SIZE);
+    fsm_get_event_counters(fsm, &coalesced, &dropped);
+    snprintf(what, sizeof(what), "%s: a full queue drops and counts", ring);
+    check(coalesced == 2U && dropped == 1U, what);
+
+    fsm_poll(fsm);
+    snprintf(what, sizeof(what), "%s: merged event runs once", ring);
+    check(go_count == 1U && finish_count == TEST_RING_SIZE - 1U, what);
+
+    fsm_send_event(fsm, TEST_EVENT_GO);
+    fsm_poll(fsm);
+    fsm_get_event_counters(fsm, &coalesced, &dropped);
+    snprintf(what, sizeof(what), "%s: a handled event queues again", ring);
+    check(go_count == 2U && coalesced == 2U, what);
+
+    /* 队列满时被丢弃的 GO 不能一直标记为挂起 */
+    send_repeat(fsm, TEST_EVENT_FINISH, TEST_RING_SIZE);
+    fsm_send_event(fsm, TEST_EVENT_GO);
+    fsm_poll(fsm);
+    fsm_send_event(fsm, TEST_EVENT_GO);
+    fsm_poll(fsm);
+    fsm_get_event_counters(fsm, &coalesced, &dropped);
+    snprintf(what, sizeof(what), "%s: a dropped event is not left pending", ring);
+    check(go_count == 3U && coalesced == 2U && dropped == 2U, what);
+}
+
+static void test_coalescing(void)
+{
+    static event_t local_events[TEST_RING_SIZE];
+    fsm_t fsm;
+
+    memset(&fsm, 0, sizeof(fsm));
+    fsm_init(&fsm, tick_table, TEST_TABLE_SIZE(tick_table), TEST_STATE_IDLE, NULL);
+    fsm_attach_local_event_ring(&fsm, local_events, TEST_RING_SIZE);
+    check_coalescing(&fsm, "local ring");
+
+    memset(&fsm, 0, sizeof(fsm));
+    fsm_init(&fsm, tick_table, TEST_TABLE_SIZE(tick_table), TEST_STATE_IDLE, NULL);
+    fsm_create_mpsc_event_queue(&fsm, TEST_RING_SIZE);
+    check(fsm.event_ring != NULL, "mpsc event queue created");
+    check_coalescing(&fsm, "mpsc ring");
+}
+
+void app_thread(void *argument)
+{
+    (void)argument;
+    test_compile();
+    test_coalescing();
+
+    printf("%s\n", (failures == 0U) ? "PASS" : "FAIL");
+    exit((failures == 0U) ? 0 : 1);
+}
+
+int main(int argc, char *argv[])
+{
+    osKernelInitialize();
+
+    osThreadNew(app_thread, NULL, NULL);
+
+    osKernelStart();  // 启动RTOS调度器,不会返回
+
+    return 0;
+}
@@ -41,6 +41,7 @@ void comm_recv_thread(void *argument)
 int main(int argc, char *argv[])
 {
     osKernelInitialize();
+    drv_socket_set_reconnect(1, 0U, 0U, DRV_SOCKET_TX_DROP);
     drv_socket_open("127.0.0.1", 9000, 1);
     osThreadNew(comm_ctrl_thread, NULL, NULL);
     osThreadNew(comm_send_thread, NULL, NULL);
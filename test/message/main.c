@@ -0,0 +1,242 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "message.h"
+
+#define TEST_TABLE_SIZE(t)  (sizeof(t) / sizeof((t)[0]))
+#define TEST_SLOT_COUNT     8U
+#define TEST_QUEUE_SIZE     2U
+#define TEST_ARENA_BLOCKS   (MSG_ARENA_CLASS_COUNT * MSG_ARENA_BLOCKS)
+
+static msg_callback slots[TEST_SLOT_COUNT];
+static message_arena_t arena;
+static uint8_t *blocks[TEST_ARENA_BLOCKS];
+static uint32_t last_id;
+static void *last_ctx;
+static uint32_t calls;
+static uint32_t failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-52s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+static void on_msg(void *ctx, message_t *msg)
+{
+    last_id = msg->msg_id;
+    last_ctx = ctx;
+    calls++;
+}
+
+/* id 从 100 开始，102 缺失，103 没有回调 */
+static const msg_table_t good_table[] = {
+    {101U, on_msg},
+    {100U, on_msg},
+    {103U, NULL  },
+    {104U, on_msg},
+};
+
+static const msg_table_t duplicate_table[] = {
+    {100U, on_msg},
+    {101U, on_msg},
+    {100U, on_msg},
+};
+
+/* 最高与最低 id 之差等于槽位数，放不下 */
+static const msg_table_t range_table[] = {
+    {100U,                   on_msg},
+    {100U + TEST_SLOT_COUNT, on_msg},
+};
+
+static msg_status_t dispatch_id(const msg_dispatch_t *dispatch, uint32_t msg_id, void *ctx)
+{
+    message_t msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_id = msg_id;
+    return message_dispatch(dispatch, &msg, ctx);
+}
+
+/* 编译与派发：命中的 id 带着 ctx 调用回调，其余 id 返回参数错误且不调用任何回调 */
+static void test_dispatch(void)
+{
+    msg_dispatch_t dispatch;
+    msg_dispatch_t untouched;
+    int ctx = 0;
+    msg_status_t status = MSG_OK;
+
+    memset(&dispatch, 0, sizeof(dispatch));
+    status = message_dispatch_build(&dispatch, good_table, TEST_TABLE_SIZE(good_table), slots, TEST_SLOT_COUNT);
+    check(status == MSG_OK && dispatch.base == 100U && dispatch.count == 5U,
+          "table with a gap and a NULL callback builds");
+
+    calls = 0U;
+    check(dispatch_id(&dispatch, 104U, &ctx) == MSG_OK && calls == 1U && last_id == 104U && last_ctx == &ctx,
+          "hit runs the callback with ctx");
+    check(dispatch_id(&dispatch, 100U, NULL) == MSG_OK && calls == 2U && last_id == 100U && last_ctx == NULL,
+          "lowest id dispatches");
+    check(dispatch_id(&dispatch, 102U, &ctx) == MSG_ERROR_PARAMETER && calls == 2U, "id in a gap is not dispatched");
+    check(dispatch_id(&dispatch, 103U, &ctx) == MSG_ERROR_PARAMETER && calls == 2U, "id with a NULL callback is not dispatched");
+    check(dispatch_id(&dispatch, 99U, &ctx) == MSG_ERROR_PARAMETER && calls == 2U, "id below the table is not dispatched");
+    check(dispatch_id(&dispatch, 105U, &ctx) == MSG_ERROR_PARAMETER && calls == 2U, "id above the table is not dispatched");
+    check(message_dispatch(&dispatch, NULL, &ctx) == MSG_ERROR_PARAMETER, "NULL message is rejected");
+
+    memset(&untouched, 0, sizeof(untouched));
+    status = message_dispatch_build(&untouched, duplicate_table, TEST_TABLE_SIZE(duplicate_table), slots, TEST_SLOT_COUNT);
+    check(status == MSG_ERROR_PARAMETER && untouched.slots == NULL, "id listed twice is rejected");
+    status = message_dispatch_build(&untouched, range_table, TEST_TABLE_SIZE(range_table), slots, TEST_SLOT_COUNT);
+    check(status == MSG_ERROR_NO_MEMORY && untouched.slots == NULL, "id range larger than the slots is rejected");
+    status = message_dispatch_build(&untouched, good_table, 0U, slots, TEST_SLOT_COUNT);
+    check(status == MSG_ERROR_PARAMETER && untouched.slots == NULL, "empty table is rejected");
+}
+
+static uint32_t arena_free_blocks(const message_arena_t *a)
+{
+    uint32_t count = 0U;
+    uint8_t c = 0U;
+
+    for (c = 0U; c < MSG_ARENA_CLASS_COUNT; c++)
+    {
+        count += (uint32_t)__builtin_popcount(a->free_map[c]);
+    }
+    return count;
+}
+
+static bool in_small_class(const uint8_t *block)
+{
+    return block >= arena.storage && block < &arena.storage[MSG_ARENA_BLOCKS * MSG_ARENA_SMALL_SIZE];
+}
+
+/* 分配从最小的合适尺寸开始，耗尽后升级；全部耗尽返回 NULL 并计数 */
+static void test_arena(void)
+{
+    uint32_t i = 0U;
+    uint32_t n = 0U;
+    uint8_t *block = NULL;
+    bool small = true;
+
+    message_arena_init(&arena);
+    check(arena_free_blocks(&arena) == TEST_ARENA_BLOCKS && arena.alloc_fail == 0U, "initialized arena is all free");
+
+    for (i = 0U; i < MSG_ARENA_BLOCKS; i++)
+    {
+        blocks[i] = (uint8_t *)message_payload_alloc(&arena, MSG_ARENA_SMALL_SIZE);
+        small = small && (blocks[i] != NULL) && in_small_class(blocks[i]);
+    }
+    check(small, "small allocations fill the small class");
+    blocks[MSG_ARENA_BLOCKS] = (uint8_t *)message_payload_alloc(&arena, 1U);
+    check(blocks[MSG_ARENA_BLOCKS] == &arena.storage[MSG_ARENA_BLOCKS * MSG_ARENA_SMALL_SIZE],
+          "full small class falls back to medium");
+
+    n = MSG_ARENA_BLOCKS + 1U;
+    while (n < TEST_ARENA_BLOCKS && (blocks[n] = (uint8_t *)message_payload_alloc(&arena, 1U)) != NULL)
+    {
+        n++;
+    }
+    check(n == TEST_ARENA_BLOCKS && arena_free_blocks(&arena) == 0U, "every block of every class is used");
+    check(message_payload_alloc(&arena, 1U) == NULL && arena.alloc_fail == 1U, "exhausted arena fails and counts");
+    check(message_payload_alloc(&arena, 0U) == NULL, "zero length is refused");
+    check(message_payload_alloc(&arena, MSG_ARENA_LARGE_SIZE + 1U) == NULL, "length above the large class is refused");
+
+    /* 不是块起始地址的指针被忽略 */
+    message_payload_free(&arena, blocks[3] + 1);
+    check(arena_free_blocks(&arena) == 0U, "misaligned free is ignored");
+    message_payload_free(&arena, blocks[3]);
+    check(arena_free_blocks(&arena) == 1U, "free returns the block");
+    block = (uint8_t *)message_payload_alloc(&arena, MSG_ARENA_SMALL_SIZE);
+    check(block == blocks[3] && arena_free_blocks(&arena) == 0U, "freed block is reused");
+
+    for (i = 0U; i < TEST_ARENA_BLOCKS; i++)
+    {
+        message_payload_free(&arena, blocks[i]);
+    }
+    check(arena_free_blocks(&arena) == TEST_ARENA_BLOCKS, "all blocks are back after freeing");
+}
+
+static message_t owned_message(uint32_t msg_id)
+{
+    message_t msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_id = msg_id;
+    msg.msg_len = 4U;
+    msg.msg_data = (uint8_t *)message_payload_alloc(&arena, msg.msg_len);
+    return msg;
+}
+
+/* 负载随消息交给接收方；发送失败或队列复位时负载回到 arena */
+static void test_owned(msg_backend_t backend, const char *name)
+{
+    char what[80];
+    message_queue_t queue = NULL;
+    message_t msg;
+    message_t received;
+    uint32_t i = 0U;
+    msg_status_t status = MSG_OK;
+
+    message_arena_init(&arena);
+    queue = message_queue_create_backend(TEST_QUEUE_SIZE, backend);
+    snprintf(what, sizeof(what), "%s: queue created", name);
+    check(queue != NULL, what);
+    if (queue == NULL)
+    {
+        return;
+    }
+
+    msg = owned_message(1U);
+    msg.msg_data[0] = 0x5AU;
+    status = message_queue_send_owned(queue, &msg, &arena, 0U);
+    memset(&received, 0, sizeof(received));
+    (void)message_queue_receive(queue, &received, 0U);
+    snprintf(what, sizeof(what), "%s: receiver gets the payload and its arena", name);
+    check(status == MSG_OK && received.msg_arena == &arena && received.msg_data == msg.msg_data &&
+          received.msg_data[0] == 0x5AU && arena_free_blocks(&arena) == TEST_ARENA_BLOCKS - 1U, what);
+    message_release(&received);
+    snprintf(what, sizeof(what), "%s: release returns the payload", name);
+    check(received.msg_arena == NULL && arena_free_blocks(&arena) == TEST_ARENA_BLOCKS, what);
+
+    for (i = 0U; i < TEST_QUEUE_SIZE; i++)
+    {
+        msg = owned_message(2U + i);
+        (void)message_queue_send_owned(queue, &msg, &arena, 0U);
+    }
+    msg = owned_message(9U);
+    status = message_queue_send_owned(queue, &msg, &arena, 0U);
+    snprintf(what, sizeof(what), "%s: send to a full queue frees the payload", name);
+    check(status != MSG_OK && arena_free_blocks(&arena) == TEST_ARENA_BLOCKS - TEST_QUEUE_SIZE, what);
+
+    status = message_queue_reset(queue);
+    snprintf(what, sizeof(what), "%s: reset releases queued payloads", name);
+    check(status == MSG_OK && message_queue_get_used(queue) == 0U && arena_free_blocks(&arena) == TEST_ARENA_BLOCKS,
+          what);
+    message_queue_delete(queue);
+}
+
+void app_thread(void *argument)
+{
+    (void)argument;
+    test_dispatch();
+    test_arena();
+    test_owned(MSG_BACKEND_RTOS, "rtos queue");
+    test_owned(MSG_BACKEND_MPSC, "mpsc queue");
+
+    printf("%s\n", (failures == 0U) ? "PASS" : "FAIL");
+    exit((failures == 0U) ? 0 : 1);
+}
+
+int main(int argc, char *argv[])
+{
+    osKernelInitialize();
+
+    osThreadNew(app_thread, NULL, NULL);
+
+    osKernelStart();  // 启动RTOS调度器,不会返回
+
+    return 0;
+}
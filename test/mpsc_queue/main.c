@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "mpsc_queue.h"
+
+#define TEST_PRODUCERS      4U
+#define TEST_PER_PRODUCER   200000U
+#define TEST_QUEUE_SIZE     16U
+#define TEST_TIMEOUT        50U
+
+typedef struct {
+    uint32_t producer;
+    uint32_t seq;
+} test_elem_t;
+
+static mpsc_queue_t *queue;
+static volatile uint32_t put_failed;
+static uint32_t failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-52s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+/* 每个生产者按序号递增投递，队列满时阻塞等待 */
+static void producer_thread(void *argument)
+{
+    test_elem_t elem;
+
+    elem.producer = (uint32_t)(uintptr_t)argument;
+    for (elem.seq = 0U; elem.seq < TEST_PER_PRODUCER; elem.seq++)
+    {
+        if (mpsc_queue_put(queue, &elem, osWaitForever) != osOK)
+        {
+            put_failed++;
+        }
+    }
+}
+
+/* 多生产者、单消费者：不丢失，每个生产者内部保持顺序 */
+static void test_ordering(void)
+{
+    uint32_t next[TEST_PRODUCERS] = {0U};
+    test_elem_t elem;
+    uint32_t total = 0U;
+    uint32_t out_of_order = 0U;
+    uint32_t i = 0U;
+
+    queue = mpsc_queue_create(TEST_QUEUE_SIZE, sizeof(test_elem_t));
+    for (i = 0U; i < TEST_PRODUCERS; i++)
+    {
+        osThreadNew(producer_thread, (void *)(uintptr_t)i, NULL);
+    }
+    while (total < TEST_PRODUCERS * TEST_PER_PRODUCER)
+    {
+        if (mpsc_queue_get(queue, &elem, 1000U) != osOK)
+        {
+            break;
+        }
+        if (elem.producer >= TEST_PRODUCERS || elem.seq != next[elem.producer])
+        {
+            out_of_order++;
+        }
+        else
+        {
+            next[elem.producer]++;
+        }
+        total++;
+    }
+    printf("%u producers, %u elements through a %u slot queue\n",
+           TEST_PRODUCERS, total, mpsc_queue_capacity(queue));
+    check(total == TEST_PRODUCERS * TEST_PER_PRODUCER && put_failed == 0U, "every element arrives");
+    check(out_of_order == 0U, "each producer's elements arrive in order");
+    check(mpsc_queue_get(queue, &elem, 0U) == osErrorResource, "nothing arrives twice");
+}
+
+static void waiting_producer(void *argument)
+{
+    test_elem_t elem = {0U, 0U};
+
+    (void)argument;
+    if (mpsc_queue_put(queue, &elem, TEST_TIMEOUT * 10U) != osOK)
+    {
+        put_failed++;
+    }
+}
+
+/* 队列满时带超时的投递：到时返回超时；有空位时不等到超时就完成 */
+static void test_timed_put(void)
+{
+    test_elem_t elem = {0U, 0U};
+    uint32_t start = 0U;
+    uint32_t elapsed = 0U;
+    uint32_t i = 0U;
+
+    queue = mpsc_queue_create(2U, sizeof(test_elem_t));
+    put_failed = 0U;
+    for (i = 0U; i < mpsc_queue_capacity(queue); i++)
+    {
+        (void)mpsc_queue_put(queue, &elem, 0U);
+    }
+    check(mpsc_queue_put(queue, &elem, 0U) == osErrorResource, "put on a full queue fails at once");
+    start = osKernelGetTickCount();
+    check(mpsc_queue_put(queue, &elem, TEST_TIMEOUT) == osErrorTimeout, "timed put on a full queue times out");
+    elapsed = osKernelGetTickCount() - start;
+    check(elapsed >= TEST_TIMEOUT && elapsed < TEST_TIMEOUT * 2U, "and waits for about the timeout");
+
+    osThreadNew(waiting_producer, NULL, NULL);
+    osDelay(TEST_TIMEOUT);
+    start = osKernelGetTickCount();
+    (void)mpsc_queue_get(queue, &elem, 0U);
+    while (mpsc_queue_count(queue) < mpsc_queue_capacity(queue) &&
+           (osKernelGetTickCount() - start) < TEST_TIMEOUT * 10U)
+    {
+        osDelay(1U);
+    }
+    elapsed = osKernelGetTickCount() - start;
+    check(put_failed == 0U && mpsc_queue_count(queue) == mpsc_queue_capacity(queue) && elapsed < TEST_TIMEOUT,
+          "a blocked put completes once a slot frees");
+}
+
+void app_thread(void *argument)
+{
+    (void)argument;
+    test_ordering();
+    test_timed_put();
+
+    printf("%s\n", (failures == 0U) ? "PASS" : "FAIL");
+    exit((failures == 0U) ? 0 : 1);
+}
+
+int main(int argc, char *argv[])
+{
+    osKernelInitialize();
+
+    osThreadNew(app_thread, NULL, NULL);
+
+    osKernelStart();  // 启动RTOS调度器,不会返回
+
+    return 0;
+}
@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Generate typed payload pack/unpack headers from a slave command JSON.
+
+    python3 tools/comm_codegen.py slave/ap3_cmd.json [-o comm_cmd_ap3.h] [--model ap3]
+
+For every command the header gets the request/response IDs and payload
+lengths, a request and a response struct, and inline encode/decode
+functions that go between the struct and a comm_data_t. Payload sizes are
+checked against COMM_DATA_MAX_LEN at compile time.
+
+Keys read per command (others are ignored, so the slave GUI keeps working):
+    name, cmd_id, resp_id       required, IDs as hex strings
+    resp_data_len               response payload bytes (after the ID)
+    cmd_data_len                request payload bytes, default 0
+    cmd_fields / resp_fields    optional field lists; without them the
+                                payload is a raw "data" byte array
+A field is {"name": "speed", "type": "u16", "count": 1}; types are
+u8 i8 u16 i16 u32 i32. Multi-byte fields use the top level "byte_order"
+("big" by default, or "little").
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+TYPES = {
+    "u8": ("uint8_t", 1),
+    "i8": ("int8_t", 1),
+    "u16": ("uint16_t", 2),
+    "i16": ("int16_t", 2),
+    "u32": ("uint32_t", 4),
+    "i32": ("int32_t", 4),
+}
+
+
+class GenError(Exception):
+    pass
+
+
+def ident(text):
+    name = re.sub(r"[^0-9A-Za-z]+", "_", text).strip("_")
+    if not name or name[0].isdigit():
+        raise GenError("bad name: %r" % text)
+    return name
+
+
+def parse_id(text, what, name):
+    try:
+        value = int(str(text), 16)
+    except ValueError:
+        raise GenError("%s: bad %s %r" % (name, what, text))
+    if not 0 <= value <= 0xFF:
+        raise GenError("%s: %s out of range" % (name, what))
+    return value
+
+
+def load_fields(cmd, key, length, name):
+    fields = cmd.get(key)
+    if fields is None:
+        return [("data", "u8", length)] if length > 0 else []
+    out = []
+    size = 0
+    for f in fields:
+        ftype = f.get("type", "u8")
+        if ftype not in TYPES:
+            raise GenError("%s.%s: unknown type %r" % (name, key, ftype))
+        count = int(f.get("count", 1))
+        if count < 1:
+            raise GenError("%s.%s: bad count" % (name, key))
+        out.append((ident(f["name"]).lower(), ftype, count))
+        size += TYPES[ftype][1] * count
+    if size != length:
+        raise GenError("%s.%s: fields take %u bytes, payload is %u" % (name, key, size, length))
+    return out
+
+
+def gen_struct(lines, tname, fields):
+    lines.append("typedef struct {")
+    for fname, ftype, count in fields:
+        ctype = TYPES[ftype][0]
+        if count == 1:
+            lines.append("    %s %s;" % (ctype, fname))
+        else:
+            lines.append("    %s %s[%u];" % (ctype, fname, count))
+    lines.append("} %s;" % tname)
+    lines.append("")
+
+
+def gen_pack(lines, fields, order, ptr, obj, unpack):
+    off = 0
+    for fname, ftype, count in fields:
+        ctype, size = TYPES[ftype]
+        if size == 1 and count > 1:
+            if unpack:
+                lines.append("    memcpy(%s->%s, &%s[%u], %uU);" % (obj, fname, ptr, off, count))
+            else:
+                lines.append("    memcpy(&%s[%u], %s->%s, %uU);" % (ptr, off, obj, fname, count))
+            off += count
+            continue
+        for i in range(count):
+            ref = "%s->%s" % (obj, fname) if count == 1 else "%s->%s[%u]" % (obj, fname, i)
+            if size == 1:
+                if unpack:
+                    lines.append("    %s = (%s)%s[%u];" % (ref, ctype, ptr, off))
+                else:
+                    lines.append("    %s[%u] = (uint8_t)%s;" % (ptr, off, ref))
+            else:
+                utype = "uint%u_t" % (size * 8)
+                suffix = "u%u%s" % (size * 8, "be" if order == "big" else "le")
+                if unpack:
+                    lines.append("    %s = (%s)comm_codec_get_%s(&%s[%u]);" % (ref, ctype, suffix, ptr, off))
+                else:
+                    lines.append("    comm_codec_put_%s(&%s[%u], (%s)%s);" % (suffix, ptr, off, utype, ref))
+            off += size
+
+
+def generate(data, model, source):
+    order = data.get("byte_order", "big")
+    if order not in ("big", "little"):
+        raise GenError("byte_order must be big or little")
+    cmds = data.get("commands")
+    if not isinstance(cmds, list):
+        raise GenError("no commands list")
+
+    upper = ident(model).upper()
+    lower = upper.lower()
+    guard = "COMM_CMD_%s_H" % upper
+    lines = [
+        "/**",
+        " * @file comm_cmd_%s.h" % lower,
+        " * @brief Typed command payloads for the %s command set" % model.upper(),
+        " *",
+        " * Generated by tools/comm_codegen.py from %s, do not edit." % source,
+        " *",
+        " * encode() fills a comm_data_t ready for comm_ctrl_send_single_command();",
+        " * decode() checks the response ID and length once and unpacks the fields.",
+        " */",
+        "",
+        "#ifndef %s" % guard,
+        "#define %s" % guard,
+        "",
+        "#include <stdint.h>",
+        "#include <stdbool.h>",
+        "#include <string.h>",
+        "#include \"comm_ctrl.h\"",
+        "#include \"comm_codec.h\"",
+        "",
+    ]
+    seen = set()
+    for cmd in cmds:
+        name = ident(cmd.get("name", "")).upper()
+        if name in seen:
+            raise GenError("duplicate command %s" % name)
+        seen.add(name)
+        req = parse_id(cmd.get("cmd_id"), "cmd_id", name)
+        resp = parse_id(cmd.get("resp_id"), "resp_id", name)
+        cmd_len = int(cmd.get("cmd_data_len", 0))
+        resp_len = int(cmd.get("resp_data_len", 0))
+        cmd_fields = load_fields(cmd, "cmd_fields", cmd_len, name)
+        resp_fields = load_fields(cmd, "resp_fields", resp_len, name)
+
+        macro = "COMM_%s_%s" % (upper, name)
+        func = "comm_%s_%s" % (lower, name.lower())
+        lines.append("/* %s: 0x%02X -> 0x%02X */" % (name, req, resp))
+        lines.append("#define %-48s 0x%02XU" % (macro + "_REQ", req))
+        lines.append("#define %-48s 0x%02XU" % (macro + "_RESP", resp))
+        lines.append("#define %-48s %uU" % (macro + "_CMD_LEN", cmd_len))
+        lines.append("#define %-48s %uU" % (macro + "_RESP_LEN", resp_len))
+        lines.append("typedef char %s_len_check_t[(%s_CMD_LEN <= COMM_DATA_MAX_LEN && %s_RESP_LEN <= COMM_DATA_MAX_LEN) ? 1 : -1];"
+                     % (func, macro, macro))
+        lines.append("")
+
+        if cmd_fields:
+            gen_struct(lines, func + "_cmd_t", cmd_fields)
+            lines.append("static inline void %s_encode(comm_data_t *out, const %s_cmd_t *cmd)" % (func, func))
+        else:
+            lines.append("static inline void %s_encode(comm_data_t *out)" % func)
+        lines.append("{")
+        lines.append("    out->comm_id = %s_REQ;" % macro)
+        lines.append("    out->comm_len = %s_CMD_LEN;" % macro)
+        gen_pack(lines, cmd_fields, order, "out->comm_data", "cmd", False)
+        lines.append("}")
+        lines.append("")
+
+        if resp_fields:
+            gen_struct(lines, func + "_resp_t", resp_fields)
+            lines.append("static inline bool %s_decode(const comm_data_t *in, %s_resp_t *resp)" % (func, func))
+        else:
+            lines.append("static inline bool %s_decode(const comm_data_t *in)" % func)
+        lines.append("{")
+        lines.append("    if (in->comm_id != %s_RESP || in->comm_len != %s_RESP_LEN)" % (macro, macro))
+        lines.append("    {")
+        lines.append("        return false;")
+        lines.append("    }")
+        gen_pack(lines, resp_fields, order, "in->comm_data", "resp", True)
+        lines.append("    return true;")
+        lines.append("}")
+        lines.append("")
+
+    lines.append("#endif // %s" % guard)
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("json", help="command set, e.g. slave/ap3_cmd.json")
+    ap.add_argument("-o", "--output", help="header to write, default comm_cmd_<model>.h")
+    ap.add_argument("--model", help="model name, default taken from the file name")
+    args = ap.parse_args()
+
+    model = args.model or re.sub(r"_cmd$", "", os.path.splitext(os.path.basename(args.json))[0])
+    output = args.output or "comm_cmd_%s.h" % ident(model).lower()
+    try:
+        with open(args.json, "r", encoding="utf-8") as f:
+            data = json.load(f)
+        text = generate(data, model, os.path.basename(args.json))
+    except (OSError, ValueError, KeyError, GenError) as e:
+        sys.stderr.write("comm_codegen: %s: %s\n" % (args.json, e))
+        return 1
+    with open(output, "w", encoding="utf-8") as f:
+        f.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())